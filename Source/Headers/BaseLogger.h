@@ -19,23 +19,87 @@
 #ifndef BASELOGGER_H
 #define BASELOGGER_H
 
+#include "BinaryLog.h"
 #include "LocalMutex.h"
 #include "Thread.h"
 
+#include <atomic>
 #include <queue>
 #include <stdint.h>
 #include <stdio.h>
 #include <string>
+#include <sys/uio.h>
 #include <vector>
 
 namespace base {
 
-struct Packet
+// Maximum number of planes of a buffer handed to the dump path
+#define DUMP_MAX_PLANES 8
+
+// This function type gives a referenced buffer back to its owner after it
+// was written or dropped
+//
+// Parameters:
+// [in] (void *) pContext - context passed together with the buffer
+typedef void (*DumpReleaseFunction)(void *pContext);
+
+struct DumpEntry
+{
+    // message of a dump or name of the output file
+    std::string          text;
+    struct iovec         planes[DUMP_MAX_PLANES];
+    uint32_t             planeCount;
+    // copied data is owned by the logger and counts against the budget
+    uint8_t             *pCopy;
+    uint32_t             length;
+    DumpReleaseFunction  releaseFunction;
+    void                *pReleaseContext;
+};
+
+struct DumpStatistics
 {
-    std::string message;
-    std::vector<uint8_t> buffer;
-    uint32_t length;
-    std::string filename;
+    uint64_t  writtenCount;
+    uint64_t  writtenBytes;
+    uint64_t  droppedCount;
+    uint64_t  failedCount;
+    uint64_t  copiedBytesInUse;
+    uint64_t  copyBudget;
+    uint32_t  pendingCount;
+};
+
+// Queue with a fixed number of entries, the storage is allocated once
+class DumpQueue
+{
+public:
+    DumpQueue(uint32_t capacity);
+
+    // This function appends an entry, the content of entry is moved
+    //
+    // Parameters:
+    // [in] (DumpEntry &) entry
+    //
+    // Returns:
+    // (bool) - false if the queue is full
+    bool Push(DumpEntry &entry);
+    // This function takes the oldest entry
+    //
+    // Parameters:
+    // [out] (DumpEntry &) entry
+    //
+    // Returns:
+    // (bool) - false if the queue is empty
+    bool Pop(DumpEntry &entry);
+    // This function returns the number of queued entries
+    //
+    // Returns:
+    // (uint32_t) - entry count
+    uint32_t GetSize();
+
+private:
+    LocalMutex              m_Mutex;
+    std::vector<DumpEntry>  m_Entries;
+    uint32_t                m_Head;
+    uint32_t                m_Count;
 };
 
 class BaseLogger
@@ -56,20 +120,42 @@ public:
     // Parameters:
     // [in] (const std::string &) message - new message to log
     void Log(const std::string &message);
-    // Ths function add new packet to the dump queue
+    // Ths function add new packet to the dump queue. The buffer is copied,
+    // the dump is dropped when the queue or the copy budget is full
     //
     // Parameters:
     // [in] (const std::string &) message
     // [in] (uint8_t *) buffer
     // [in] (uint32_t) length
     void LogDump(const std::string &message, uint8_t *buffer, uint32_t length);
-    // This function adds new packet to the queue buffer
+    // This function adds new packet to the queue buffer. The buffer is copied,
+    // the packet is dropped when the queue or the copy budget is full
     //
     // Parameters:
     // [in] (const std::string &) fileName - name of the output file
     // [in] (uint8_t *) buffer
     // [in] (uint32_t) length
     void LogBuffer(const std::string &fileName, uint8_t *buffer, uint32_t length);
+    // This function adds buffer planes to the queue buffer without copying
+    // them. The planes are written to one file with a single vectored write,
+    // afterwards releaseFunction hands them back to their owner
+    //
+    // Parameters:
+    // [in] (const std::string &) fileName - name of the output file
+    // [in] (const struct iovec *) pPlanes - planes which stay valid until released
+    // [in] (uint32_t) planeCount - up to DUMP_MAX_PLANES
+    // [in] (DumpReleaseFunction) releaseFunction - called on the buffer thread, may be NULL
+    // [in] (void *) pReleaseContext - passed to releaseFunction
+    //
+    // Returns:
+    // (bool) - false if the buffer was dropped, it was not released then
+    bool LogBuffer(const std::string &fileName, const struct iovec *pPlanes, uint32_t planeCount,
+                   DumpReleaseFunction releaseFunction, void *pReleaseContext);
+    // This function returns the counters of the dump and buffer queues
+    //
+    // Parameters:
+    // [out] (DumpStatistics &) statistics
+    void GetDumpStatistics(DumpStatistics &statistics);
 
 private:
     // This function prints start message
@@ -80,6 +166,38 @@ private:
     void PrintDumpExitMessage();
     // This function prints buffer exit message
     void PrintBufferExitMessage();
+    // This function formats and writes the records of all log rings and the
+    // queued text messages
+    void WritePendingMessages();
+    // This function reserves room for a copy of a buffer and queues it
+    //
+    // Parameters:
+    // [in] (DumpQueue &) queue
+    // [in] (const std::string &) text - message or file name
+    // [in] (uint8_t *) buffer
+    // [in] (uint32_t) length
+    void QueueCopy(DumpQueue &queue, const std::string &text, uint8_t *buffer, uint32_t length);
+    // This function writes a queued buffer to its file. The write back of the
+    // file is only started, it is finished with the next buffer file
+    //
+    // Parameters:
+    // [in] (DumpEntry &) entry
+    void WriteBufferEntry(DumpEntry &entry);
+    // This function waits for the write back of the previous buffer file,
+    // drops its pages from the page cache and closes it
+    void FinishPreviousBufferFile();
+    // This function writes a queued dump to the log
+    //
+    // Parameters:
+    // [in] (DumpEntry &) entry
+    void WriteDumpEntry(DumpEntry &entry);
+    // This function frees or releases the data of an entry
+    //
+    // Parameters:
+    // [in] (DumpEntry &) entry
+    void ReleaseEntry(DumpEntry &entry);
+    // This function logs how many dumps were dropped since the last call
+    void ReportDroppedDumps();
 
 private:
     // This function converts timestamp to string
@@ -101,14 +219,24 @@ private:
 
     FILE                          *m_pFile;
     LocalMutex                    m_Mutex;
-    LocalMutex                    m_DumpMutex;
-    LocalMutex                    m_BufferMutex;
     Thread                        m_LogTextThread;
     Thread                        m_DumpThread;
     Thread                        m_BufferThread;
     std::queue<std::string>       m_OutputQueue;
-    std::queue<Packet*>           m_DumpQueue;
-    std::queue<Packet*>           m_BufferQueue;
+    // Records of the log rings, only used by the logger thread
+    std::vector<LogRecord>        m_Records;
+    std::string                   m_Line;
+    DumpQueue                     m_DumpQueue;
+    DumpQueue                     m_BufferQueue;
+    const uint64_t                m_CopyBudget;
+    std::atomic<uint64_t>         m_CopiedBytesInUse;
+    std::atomic<uint64_t>         m_WrittenCount;
+    std::atomic<uint64_t>         m_WrittenBytes;
+    std::atomic<uint64_t>         m_DroppedCount;
+    std::atomic<uint64_t>         m_FailedCount;
+    uint64_t                      m_ReportedDroppedCount;
+    // Buffer file whose write back is still running, only used by the buffer thread
+    int                           m_PreviousBufferFile;
     bool                          m_bThreadRunning;
     bool                          m_bThreadStopped;
     bool                          m_bDumpThreadRunning;
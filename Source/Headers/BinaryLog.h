@@ -0,0 +1,239 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+
+
+#ifndef BINARYLOG_H
+#define BINARYLOG_H
+
+#include <atomic>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Size of a log record and number of records in the ring of every logging thread
+#define LOG_RECORD_SIZE     256
+#define LOG_RING_RECORDS    512
+
+namespace base {
+
+enum LogArgumentType
+{
+    LogArgumentSigned = 0,
+    LogArgumentUnsigned,
+    LogArgumentDouble,
+    LogArgumentPointer,
+    LogArgumentString,
+};
+
+// A message as it was logged. Format and file name are string literals, the
+// arguments are packed behind each other as type and value
+struct LogRecord
+{
+    uint64_t    timestamp;
+    const char  *pFilename;
+    const char  *pFormat;
+    int32_t     line;
+    uint16_t    dataLength;
+    uint16_t    bTruncated;
+    uint8_t     data[LOG_RECORD_SIZE - 16 - 2 * sizeof(const char*)];
+};
+
+// Ring of one producer thread and the logger thread, neither side blocks
+class LogRing
+{
+public:
+    LogRing();
+
+    // This function returns the next free record of the producer
+    //
+    // Returns:
+    // (LogRecord *) - record to fill, NULL if the ring is full
+    LogRecord *BeginWrite();
+    // This function hands the record of BeginWrite to the logger thread
+    void CommitWrite();
+    // This function returns the oldest record for the logger thread
+    //
+    // Returns:
+    // (LogRecord *) - record to format, NULL if the ring is empty
+    LogRecord *BeginRead();
+    // This function releases the record of BeginRead
+    void CommitRead();
+
+    // This function counts a message which did not fit into the ring
+    void AddDropped();
+    // This function returns and resets the number of dropped messages
+    //
+    // Returns:
+    // (uint32_t) - dropped messages
+    uint32_t TakeDropped();
+
+    // This function marks the ring of an exited thread, it is freed once it is empty
+    void SetOrphaned();
+    // This function returns whether the thread of the ring has exited
+    //
+    // Returns:
+    // (bool) - true if no more records are written
+    bool IsOrphaned() const;
+
+private:
+    std::vector<LogRecord>  m_Records;
+    alignas(64) std::atomic<uint32_t> m_WriteIndex;
+    alignas(64) std::atomic<uint32_t> m_ReadIndex;
+    std::atomic<uint32_t>   m_DroppedCount;
+    std::atomic<bool>       m_bOrphaned;
+};
+
+// Packs the arguments of a message into a record of the ring
+class LogRecordWriter
+{
+public:
+    LogRecordWriter(LogRing &ring, const char *pFilename, int line, const char *pFormat);
+
+    // This function returns whether the ring had room for the message
+    //
+    // Returns:
+    // (bool) - true if arguments can be added
+    bool IsValid() const
+    {
+        return (NULL != m_pRecord);
+    }
+
+    // This function adds an argument, only values which stay valid without
+    // the caller can be stored, strings are copied
+    //
+    // Parameters:
+    // [in] (const T &) value - number, pointer or C string
+    template<typename T>
+    void Add(const T &value)
+    {
+        typedef typename std::decay<T>::type Type;
+
+        if constexpr (std::is_enum<Type>::value)
+        {
+            Add(static_cast<typename std::underlying_type<Type>::type>(value));
+        }
+        else if constexpr (std::is_integral<Type>::value && std::is_signed<Type>::value)
+        {
+            AddValue(LogArgumentSigned, static_cast<uint64_t>(static_cast<int64_t>(value)));
+        }
+        else if constexpr (std::is_integral<Type>::value)
+        {
+            AddValue(LogArgumentUnsigned, static_cast<uint64_t>(value));
+        }
+        else if constexpr (std::is_floating_point<Type>::value)
+        {
+            double number = value;
+            uint64_t bits;
+            memcpy(&bits, &number, sizeof(bits));
+            AddValue(LogArgumentDouble, bits);
+        }
+        else if constexpr (std::is_convertible<Type, const char*>::value)
+        {
+            AddString(value);
+        }
+        else if constexpr (std::is_convertible<Type, const unsigned char*>::value)
+        {
+            // V4L2 structures keep their names in __u8 arrays
+            AddString(reinterpret_cast<const char*>(value));
+        }
+        else if constexpr (std::is_pointer<Type>::value)
+        {
+            AddValue(LogArgumentPointer, reinterpret_cast<uintptr_t>(value));
+        }
+        else
+        {
+            static_assert(sizeof(Type) == 0, "log arguments have to be numbers, pointers or C strings");
+        }
+    }
+
+    // This function hands the record to the logger thread
+    void Commit();
+
+private:
+    // This function appends a value of 8 bytes
+    //
+    // Parameters:
+    // [in] (LogArgumentType) type
+    // [in] (uint64_t) value
+    void AddValue(LogArgumentType type, uint64_t value);
+    // This function appends a string, it is shortened to the room left
+    //
+    // Parameters:
+    // [in] (const char *) pText - NULL is logged as (null)
+    void AddString(const char *pText);
+
+    LogRing     &m_Ring;
+    LogRecord   *m_pRecord;
+};
+
+class BinaryLog
+{
+public:
+    // This function returns the ring of the calling thread, it is created on first use
+    //
+    // Returns:
+    // (LogRing *) - ring of the thread
+    static LogRing *GetThreadRing();
+    // This function moves the records of all rings into a batch ordered by time
+    // and frees the rings of exited threads
+    //
+    // Parameters:
+    // [out] (std::vector<LogRecord> &) records - collected records
+    // [out] (uint32_t &) droppedCount - messages lost because a ring was full
+    static void CollectRecords(std::vector<LogRecord> &records, uint32_t &droppedCount);
+    // This function formats a record into a log line
+    //
+    // Parameters:
+    // [in] (const LogRecord &) record
+    // [out] (std::string &) line - time stamp, source position and message
+    static void FormatRecord(const LogRecord &record, std::string &line);
+
+    // This function reads the cycle counter of the CPU, the monotonic clock
+    // is used where there is none
+    //
+    // Returns:
+    // (uint64_t) - ticks
+    static inline uint64_t ReadTimestamp()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+        uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return ReadMonotonicTime();
+#endif
+    }
+    // This function measures the tick rate against the real time clock, it
+    // has to be called by the logger thread before the first record is formatted
+    static void CalibrateTimestamp();
+
+private:
+    // This function reads the monotonic clock
+    //
+    // Returns:
+    // (uint64_t) - nanoseconds
+    static uint64_t ReadMonotonicTime();
+};
+
+} // namespace base
+
+#endif // BINARYLOG_H
@@ -0,0 +1,111 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+
+#ifndef BUFFERARENA_H
+#define BUFFERARENA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// One contiguous memory range which all user pointer buffers of a stream are
+// carved from. It prefers explicit huge pages, falls back to transparent huge
+// pages and finally to normal pages. The range is pre-faulted and locked, so
+// the streaming does not take page faults on the first touch of a buffer.
+class BufferArena
+{
+public:
+    enum Backing
+    {
+        BackingNone              = 0,
+        BackingHugeTLB           = 1,
+        BackingTransparentHuge   = 2,
+        BackingNormalPages       = 3
+    };
+
+    BufferArena();
+    ~BufferArena();
+
+    // This function maps the arena, a previous one is released first
+    //
+    // Parameters:
+    // [in] (uint32_t) slotCount - number of buffers
+    // [in] (size_t) slotSize - size of a buffer, it is rounded up to whole pages
+    //
+    // Returns:
+    // (int) - 0 if the arena was mapped, -1 otherwise
+    int Create(uint32_t slotCount, size_t slotSize);
+    // This function unmaps the arena
+    void Release();
+
+    // This function returns the start of a buffer
+    //
+    // Parameters:
+    // [in] (uint32_t) index - index of the buffer
+    //
+    // Returns:
+    // (uint8_t *) - buffer memory, NULL if there is no arena
+    uint8_t *GetSlot(uint32_t index) const;
+    // This function returns whether a buffer lives in the arena
+    //
+    // Parameters:
+    // [in] (const uint8_t *) pBuffer
+    //
+    // Returns:
+    // (bool) - true if the buffer is a slot of the arena
+    bool Contains(const uint8_t *pBuffer) const;
+    // This function returns whether the arena can hold the buffers of a
+    // new stream without being mapped again
+    //
+    // Parameters:
+    // [in] (uint32_t) slotCount - number of buffers
+    // [in] (size_t) slotSize - size of a buffer
+    //
+    // Returns:
+    // (bool) - true if the arena is mapped and large enough
+    bool Fits(uint32_t slotCount, size_t slotSize) const;
+    // This function returns whether the arena is mapped
+    //
+    // Returns:
+    // (bool) - true if the buffers live in the arena
+    bool IsValid() const;
+    // This function returns the kind of pages of the arena
+    //
+    // Returns:
+    // (Backing) - page kind
+    Backing GetBacking() const;
+    // This function returns whether the arena is locked in memory
+    //
+    // Returns:
+    // (bool) - true if mlock succeeded
+    bool IsLocked() const;
+    // This function returns the mapped size
+    //
+    // Returns:
+    // (size_t) - size in bytes including the rounding
+    size_t GetMappedSize() const;
+
+private:
+    uint8_t *m_pMemory;
+    size_t m_MappedSize;
+    size_t m_SlotSize;
+    uint32_t m_SlotCount;
+    Backing m_Backing;
+    bool m_bLocked;
+};
+
+#endif // BUFFERARENA_H
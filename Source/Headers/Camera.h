@@ -21,7 +21,10 @@
 
 #include "FrameObserver.h"
 #include "CameraObserver.h"
+#include "ControlEnumerator.h"
+#include "ControlWriter.h"
 #include "AutoReader.h"
+#include "CapabilityCache.h"
 #include "V4L2EventHandler.h"
 
 #include <QObject>
@@ -38,6 +41,82 @@ enum IO_METHOD_TYPE
     IO_METHOD_USERPTR,
 };
 
+// Last known state of a control, kept up to date by the control events
+struct ControlCacheEntry
+{
+    int64_t   value;
+    uint32_t  flags;
+    bool      bValid;
+};
+
+// One control of a read or write transaction
+struct ControlTransactionItem
+{
+    uint32_t  controlID;
+    int64_t   value;
+    // 0 ok, -1 the control failed, -2 not done because another control
+    // of its group failed or the control is unknown, -3 a write that may
+    // have been applied before a later control of its group failed
+    int       result;
+};
+
+// An item of a menu or integer menu control
+struct ControlMenuItem
+{
+    uint32_t  index;
+    QString   name;
+    int64_t   value;
+};
+
+// An enumerated control, the value is read separately
+struct ControlDescription
+{
+    uint32_t  id;
+    uint32_t  type;
+    uint32_t  flags;
+    int       fileDescriptor;
+    int64_t   minimum;
+    int64_t   maximum;
+    QString   name;
+    QString   unit;
+    bool      bIsReadOnly;
+    // Items of a menu control, queried once when the menu is first needed
+    QList<ControlMenuItem> menuItems;
+    bool      bIsMenuRead;
+};
+
+// Values of the device state, set in the masks of DeviceState
+enum DeviceStateField
+{
+    DeviceStateGain             = 0x001,
+    DeviceStateAutoGain         = 0x002,
+    DeviceStateExposure         = 0x004,
+    DeviceStateAutoExposure     = 0x008,
+    DeviceStateGamma            = 0x010,
+    DeviceStateBrightness       = 0x020,
+    DeviceStateAutoWhiteBalance = 0x040,
+    DeviceStateFrameSize        = 0x080,
+};
+
+// Snapshot of the device state shown in the main panel, read on the
+// enumeration thread together with the control values
+struct DeviceState
+{
+    int64_t   gain;
+    bool      bAutoGain;
+    int64_t   exposure;
+    bool      bAutoExposure;
+    int64_t   gamma;
+    int64_t   brightness;
+    bool      bAutoWhiteBalance;
+    uint32_t  width;
+    uint32_t  height;
+    // DeviceStateField bits of the values the device provides
+    uint32_t  validMask;
+};
+
+Q_DECLARE_METATYPE(DeviceState)
+
 class IPixFormat;
 
 class Camera : public QObject
@@ -436,7 +515,8 @@ public:
     int ReadExtControl(int fileDescriptor, T &value, uint32_t controlID, const char *functionName, const char* controlName, uint32_t controlClass);
 
     // This function is used by all of the controls in the application,
-    // it reads control's value using ext approach
+    // it reads control's value using ext approach. Values of controls which
+    // send change events are served from the control cache
     //
     // Parameters:
     // [in] (T &) value - new value
@@ -444,11 +524,76 @@ public:
     // [in] (const char *) functionName - name of the function (used in logger)
     // [in] (const char *) controlName - name of the control (used in logger)
     // [in] (uint32_t) controlClass - class of the control
+    // [in] (bool) bRefresh - read the device, needed for volatile controls
     //
     // Returns:
     // (int) - result of the reading
     template<typename T>
-    int ReadExtControl(T &value, uint32_t controlID, const char *functionName, const char* controlName, uint32_t controlClass);
+    int ReadExtControl(T &value, uint32_t controlID, const char *functionName, const char* controlName, uint32_t controlClass, bool bRefresh = false);
+
+    // This function queues a control value for the control writer thread,
+    // a value still pending for the same control is replaced
+    //
+    // Parameters:
+    // [in] (int32_t) id - id of the control
+    // [in] (int64_t) value - new value
+    // [in] (bool) bNotify - emit SendSignalToUpdateWidgets after the write
+    void QueueControlWrite(int32_t id, int64_t value, bool bNotify = false);
+    // This function sets how often queued control values are written
+    //
+    // Parameters:
+    // [in] (uint32_t) writesPerSecond - 0 writes without limit
+    void SetControlWriteRate(uint32_t writesPerSecond);
+
+    // This function reads many controls, the controls of each file descriptor
+    // and control class are read with a single VIDIOC_G_EXT_CTRLS
+    //
+    // Parameters:
+    // [in/out] (std::vector<ControlTransactionItem> &) controls - ids in, values and results out
+    //
+    // Returns:
+    // (int) - 0 if all controls were read
+    int ReadExtControls(std::vector<ControlTransactionItem> &controls);
+    // This function writes many controls, the controls of each file descriptor
+    // and control class are applied together with a single VIDIOC_S_EXT_CTRLS
+    //
+    // Parameters:
+    // [in/out] (std::vector<ControlTransactionItem> &) controls - ids and values in, results out
+    //
+    // Returns:
+    // (int) - 0 if all controls were written
+    int SetExtControls(std::vector<ControlTransactionItem> &controls);
+    // This function reads all enumerated controls once per control and once
+    // as transaction from the device and measures both
+    //
+    // Parameters:
+    // [out] (double &) singleTimeMs - time of the reads per control
+    // [out] (double &) transactionTimeMs - time of the transaction
+    // [out] (uint32_t &) controlCount - number of controls read
+    //
+    // Returns:
+    // (int) - result of the transaction
+    int CompareControlReadTimes(double &singleTimeMs, double &transactionTimeMs, uint32_t &controlCount);
+
+    // This function adds a control to the control cache, only controls
+    // whose changes are reported by the event handler are cached
+    //
+    // Parameters:
+    // [in] (uint32_t) controlID
+    // [in] (int64_t) value - current value
+    // [in] (uint32_t) flags - flags of the control
+    void AddCachedControl(uint32_t controlID, int64_t value, uint32_t flags);
+    // This function stores a value read from the device in the control cache
+    //
+    // Parameters:
+    // [in] (uint32_t) controlID
+    // [in] (int64_t) value
+    void UpdateCachedControl(uint32_t controlID, int64_t value);
+    // This function makes the next read of a control go to the device
+    //
+    // Parameters:
+    // [in] (uint32_t) controlID
+    void InvalidateCachedControl(uint32_t controlID);
 
     // This function reads min and max of the given control
     //
@@ -499,13 +644,52 @@ public:
     // (int) - result of writing
     int WriteRegister(uint16_t nRegAddr, void* pBuffer, uint32_t nBufferSize, bool bConvertEndianess);
 
-    // This function enumerates all of the controls
-    // and emits found controls to the GUI class to create widgets.
+    // This function enumerates all of the controls once per opened device.
+    // Only the descriptions are queried, the values are read and sent
+    // to the GUI class by RequestControlValues. It runs on the enumeration
+    // thread, see RequestControlDescriptions
     //
     // Returns:
     // (int) - result of the enumeration
     int EnumAllControlNewStyle();
 
+    // This function queries the descriptions of the controls on the
+    // enumeration thread, SendControlsDescribed is emitted when they are known
+    void RequestControlDescriptions();
+
+    // This function reads the values of the enumerated controls on the
+    // enumeration thread and emits them to the GUI class to create or update
+    // the widgets, SendControlValuesRead is emitted after the last control
+    void RequestControlValues();
+
+    // This function reads the control values and the device state once a second
+    // while streaming, only changes are sent to the GUI class
+    void StartDeviceStateSync();
+    // This function stops the reads of StartDeviceStateSync
+    void StopDeviceStateSync();
+
+    // This function reads the items of a menu control, later calls are served
+    // from the description
+    //
+    // Parameters:
+    // [in] (int32_t) id - id of the control
+    // [out] (QList<QString> &) list - names of the menu items
+    //
+    // Returns:
+    // (int) - 0 on success, -1 if the control is not an enumerated menu
+    int ReadControlMenu(int32_t id, QList<QString> &list);
+
+    // This function reads the items of an integer menu control, later calls are
+    // served from the description
+    //
+    // Parameters:
+    // [in] (int32_t) id - id of the control
+    // [out] (QList<int64_t> &) list - values of the menu items
+    //
+    // Returns:
+    // (int) - 0 on success, -1 if the control is not an enumerated integer menu
+    int ReadControlMenu(int32_t id, QList<int64_t> &list);
+
     // This function reads crop
     //
     // Parameters:
@@ -665,6 +849,23 @@ public:
     // Returns:
     // (int) - result of deleting
     int DeleteUserBuffer();
+    // This function frees the buffers of the driver for a format change of
+    // a running stream, user pointer memory is reused by the next creation
+    //
+    // Returns:
+    // (int) - result of the release
+    int ReleaseUserBuffer();
+    // This function decides whether the buffer pool of the running stream has
+    // to grow because the driver ran out of queued buffers or reported
+    // underruns since the last call. The capture thread adds the buffers, so
+    // the caller does not wait for them. It is meant to be called periodically
+    //
+    // Parameters:
+    // [out] (uint32_t &) bufferCount - current buffer count
+    //
+    // Returns:
+    // (int) - 0 if the pool is sufficient or growing was requested, -1 at the limit
+    int AdaptBufferCount(uint32_t &bufferCount);
 
     // This function returns camera driver name
     //
@@ -739,12 +940,95 @@ public:
     // Returns:
     // (double) - rendered framerate
     double GetRenderedFPS();
+    // This function returns the mean time the capture thread spent on a frame
+    //
+    // Returns:
+    // (double) - capture time in milliseconds
+    double GetAverageCaptureTime();
+    // This function returns the longest time the capture thread spent on a frame
+    //
+    // Returns:
+    // (double) - capture time in milliseconds
+    double GetMaximumCaptureTime();
+    // This function resets the capture time statistics
+    void ResetCaptureTime();
+    // This function starts measuring the time until the first frame of the
+    // next stream arrives
+    void StartTimeToFirstFrame();
+    // This function returns the time from the start of the measurement to
+    // the first frame
+    //
+    // Returns:
+    // (double) - time in milliseconds, negative while no frame arrived
+    double GetTimeToFirstFrame();
 
     // This function switches frame transfer to gui
     //
     // Parameters:
     // [in] (bool) showFrames - state of frames visibility
     void SwitchFrameTransfer2GUI(bool showFrames);
+    // This function selects the YCbCr to RGB conversion of the stream
+    //
+    // Parameters:
+    // [in] (yuvconversion::ColorMatrix) colorMatrix - matrix, auto uses the driver colorimetry
+    // [in] (yuvconversion::ColorRange) colorRange - range, auto uses the driver quantization
+    void SetYuvConversion(yuvconversion::ColorMatrix colorMatrix, yuvconversion::ColorRange colorRange);
+    // This function selects the preview scaling of compressed formats
+    //
+    // Parameters:
+    // [in] (uint32_t) scaleDenominator - 1, 2, 4 or 8
+    void SetScaleDenominator(uint32_t scaleDenominator);
+    // This function selects 16 bit preview images for 10 and 12 bit formats
+    //
+    // Parameters:
+    // [in] (bool) bHighBitDepth - keep the full sample depth
+    void SetHighBitDepth(bool bHighBitDepth);
+    // This function sets the display tone curve of the preview. Unlike gamma
+    // and brightness of the camera it does not change the captured data
+    //
+    // Parameters:
+    // [in] (const tonemapping::Parameters &) toneMapping
+    void SetToneMapping(const tonemapping::Parameters &toneMapping);
+    // This function sets the window/level of 16 bit previews, the display
+    // image is mapped on the processing threads
+    //
+    // Parameters:
+    // [in] (bool) bAutoWindowLevel - follow the content of every frame
+    // [in] (uint16_t) low - 16 bit value which is shown black
+    // [in] (uint16_t) high - 16 bit value which is shown white
+    void SetWindowLevel(bool bAutoWindowLevel, uint16_t low, uint16_t high);
+    // This function selects whether the alignment of 10 and 12 bit data in
+    // 16 bit containers is detected from the first frames
+    //
+    // Parameters:
+    // [in] (bool) bAutoShift - analyze the data instead of relying on the SoC
+    void SetAutoShift(bool bAutoShift);
+    // This function selects whether user pointer buffers are carved from one
+    // pre-faulted and locked huge page arena
+    //
+    // Parameters:
+    // [in] (bool) bUseBufferArena - takes effect with the next buffer creation
+    void SetBufferArena(bool bUseBufferArena);
+    // This function selects the cache maintenance of the capture buffers and
+    // their preparation with VIDIOC_PREPARE_BUF
+    //
+    // Parameters:
+    // [in] (BufferCacheMode) cacheMode - takes effect with the next buffer creation
+    // [in] (bool) bPrepareBuffers - prepare the buffers before the first queuing
+    void SetBufferQueuing(BufferCacheMode cacheMode, bool bPrepareBuffers);
+    // This function sets whether the dequeue to read latency of the frames
+    // is measured and logged at the end of the stream
+    //
+    // Parameters:
+    // [in] (bool) bMeasureReadLatency
+    void SetReadLatencyBenchmark(bool bMeasureReadLatency);
+    // This function sets whether the frames of the stream are written to raw
+    // files by the logger, the buffers are not copied for it
+    //
+    // Parameters:
+    // [in] (bool) bDumpFrames
+    // [in] (const std::string &) directory - directory of the raw files
+    void SetFrameDump(bool bDumpFrames, const std::string &directory);
 
     // This function returns AVT Device firmware version
     //
@@ -765,8 +1049,105 @@ public:
 	void SetFrameSizeByIndex(int index);
 private:
     void QueryControls(int fd);
+    // This function groups the controls per file descriptor and control class
+    // and passes each group to the driver with one ioctl
+    //
+    // Parameters:
+    // [in/out] (std::vector<ControlTransactionItem> &) controls
+    // [in] (unsigned long) request - VIDIOC_G_EXT_CTRLS or VIDIOC_S_EXT_CTRLS
+    //
+    // Returns:
+    // (int) - 0 if all controls succeeded
+    int RunExtControlTransaction(std::vector<ControlTransactionItem> &controls, unsigned long request);
+    // This function returns a copy of the description of an enumerated control
+    //
+    // Parameters:
+    // [in] (uint32_t) controlID - id of the control
+    // [out] (ControlDescription &) description - the description
+    //
+    // Returns:
+    // (int) - -1 if the control was not enumerated
+    int GetControlDescription(uint32_t controlID, ControlDescription &description) const;
+    // This function queries range and flags of a control again after the driver
+    // reported a change of them
+    //
+    // Parameters:
+    // [in] (uint32_t) controlID - id of the control
+    // [in] (const v4l2_event_ctrl &) ctrl - the event, used if the query fails
+    void UpdateControlDescription(uint32_t controlID, const v4l2_event_ctrl &ctrl);
+    // This function returns the items of a menu or integer menu control, they are
+    // queried with VIDIOC_QUERYMENU on the first call and kept in the description
+    //
+    // Parameters:
+    // [in] (uint32_t) controlID - id of the control
+    // [out] (QList<ControlMenuItem> &) items - the items of the menu
+    //
+    // Returns:
+    // (int) - -1 if the control is no enumerated menu
+    int ReadMenuItems(uint32_t controlID, QList<ControlMenuItem> &items);
+    // This function fills the device state from the control values of a pass
+    // and reads the frame size
+    //
+    // Parameters:
+    // [in] (const std::map<uint32_t, int64_t> &) values - control values read by the pass
+    // [out] (DeviceState &) state - the device state
+    void ReadDeviceState(const std::map<uint32_t, int64_t> &values, DeviceState &state);
+    // This function adds an enumerated control to the descriptions and
+    // subscribes its events
+    //
+    // Parameters:
+    // [in] (const v4l2_query_ext_ctrl &) qctrl - the control as queried
+    // [in] (int) fileDescriptor - file descriptor of the device the control belongs to
+    void AddControlDescription(const v4l2_query_ext_ctrl &qctrl, int fileDescriptor);
+    // This function returns the capability queried when the device was opened
+    //
+    // Parameters:
+    // [in] (int) fileDescriptor - file descriptor of the device
+    // [out] (v4l2_capability &) cap - the capability
+    //
+    // Returns:
+    // (int) - -1 if the device is no V4L2 device
+    int QueryCapability(int fileDescriptor, v4l2_capability &cap);
+    // This function sets the key of the capability cache from the identity of the
+    // opened camera and loads the stored entry if the device still matches it
+    //
+    // Returns:
+    // (int) - 0 if the capabilities are served from the stored entry
+    int LoadCapabilityCache();
     std::string GetDeviceChar(uint32_t controlId);
     std::string GetDeviceCharFromFileDescriptor(int fileDescriptor);
+    // This function looks up the file descriptor a control lives on
+    //
+    // Parameters:
+    // [in] (uint32_t) controlID - the control id
+    //
+    // Returns:
+    // (int) - the file descriptor, -1 if the control is unknown
+    int GetControlFileDescriptor(uint32_t controlID) const;
+    // This function looks up the name of a control
+    //
+    // Parameters:
+    // [in] (uint32_t) controlID - the control id
+    //
+    // Returns:
+    // (std::string) - the name, empty if the control is unknown
+    std::string GetControlName(uint32_t controlID) const;
+    // This function looks up the type of a control
+    //
+    // Parameters:
+    // [in] (uint32_t) controlID - the control id
+    //
+    // Returns:
+    // (uint32_t) - the v4l2_ctrl_type, 0 if the control is unknown
+    uint32_t GetControlType(uint32_t controlID) const;
+    // This function looks up the device file name of a file descriptor
+    //
+    // Parameters:
+    // [in] (int) fileDescriptor - the file descriptor
+    //
+    // Returns:
+    // (std::string) - the device file name, empty if the descriptor is unknown
+    std::string GetFileDescriptorName(int fileDescriptor) const;
 
 public slots:
     // This slot function passes gain value from a thread
@@ -808,7 +1189,8 @@ public slots:
     // [in] (int32_t) id - id of the control
     // [in] (bool) val - new control value
     void SetEnumerationControlValue(int32_t id, bool val);
-    // This slot function performs action on enuemration button control click
+    // This slot function performs action on enuemration button control click,
+    // the press is queued on the control writer
     //
     // Parameters:
     // [in] (int32_t) id - control id
@@ -832,12 +1214,58 @@ private:
     std::vector<int>                m_SubDeviceFileDescriptors;
     std::map<uint32_t, int>         m_ControlIdToFileDescriptorMap;
     std::map<uint32_t, std::string> m_ControlIdToControlNameMap;
+    std::map<uint32_t, uint32_t>    m_ControlIdToTypeMap;
+    // Guards the control maps and m_FileDescriptorToNameMap, which are
+    // written while opening and enumerating and read from every thread
+    mutable QMutex                  m_ControlMapMutex;
     bool                            m_BlockingMode;
     bool                            m_ShowFrames;
+    yuvconversion::ColorMatrix      m_ColorMatrix;
+    yuvconversion::ColorRange       m_ColorRange;
+    uint32_t                        m_ScaleDenominator;
+    bool                            m_bHighBitDepth;
+    tonemapping::Parameters         m_ToneMapping;
+    bool                            m_bAutoWindowLevel;
+    uint16_t                        m_WindowLow;
+    uint16_t                        m_WindowHigh;
+    bool                            m_bAutoShift;
+    bool                            m_bUseBufferArena;
+    BufferCacheMode                 m_BufferCacheMode;
+    bool                            m_bPrepareBuffers;
+    bool                            m_bMeasureReadLatency;
+    bool                            m_bDumpFrames;
+    std::string                     m_FrameDumpDirectory;
+    // Size of the buffers of the stream and the driver underruns already seen
+    uint32_t                        m_UserBufferSize;
+    bool                            m_bFramesUnderrunKnown;
+    uint64_t                        m_FramesUnderrun;
     bool                            m_UseV4L2TryFmt;
     bool                            m_Recording;
     bool                            m_IsAvtCamera;
+    // Identity and capabilities, queried once per opened device
+    std::map<int, v4l2_capability>  m_DeviceCapabilities;
+    std::string                     m_AvtDeviceFirmwareVersion;
+    std::string                     m_AvtDeviceSerialNumber;
+    CapabilityCache                 m_CapabilityCache;
     QMutex                          m_ReadExtControlMutex;
+    QMutex                          m_ControlCacheMutex;
+    std::map<uint32_t, ControlCacheEntry> m_ControlCache;
+    uint64_t                        m_ControlCacheHits;
+    uint64_t                        m_ControlCacheMisses;
+    // Written by EnumAllControlNewStyle on the enumeration thread before
+    // its first pass, cleared after it was cancelled
+    std::vector<ControlDescription> m_ControlDescriptions;
+    std::map<uint32_t, size_t>      m_ControlDescriptionIndex;
+    // Guards range, flags and read-only state of the descriptions,
+    // which the event thread updates
+    mutable QMutex                  m_ControlDescriptionMutex;
+    // The controls of the last walk, handed to the capability cache on the
+    // GUI thread, guarded by m_ControlDescriptionMutex
+    std::vector<CachedControl>      m_DescribedControls;
+    // The values sent by the last pass of the enumeration thread,
+    // only used by this thread
+    std::map<uint32_t, int64_t>     m_LastControlValues;
+    DeviceState                     m_LastDeviceState;
     v4l2_buf_type                   m_DeviceBufferType;
     std::map<int, v4l2_buf_type>    m_SubDeviceBufferTypes;
     std::map<int, std::string>      m_FileDescriptorToNameMap;
@@ -847,9 +1275,12 @@ private:
 
     AutoReader          *m_pAutoExposureReader;
     AutoReader          *m_pAutoGainReader;
+    AutoReader          *m_pDeviceStateReader;
     V4L2EventHandler     *m_pEventHandler;
 
     CameraObserver                  m_CameraObserver;
+    ControlWriter                   m_ControlWriter;
+    ControlEnumerator               m_ControlEnumerator;
     QSharedPointer<FrameObserver>   m_pFrameObserver;
 
     std::vector<uint8_t>        m_CsvData;
@@ -864,7 +1295,7 @@ signals:
     // The sub-device list changed signal that passes the new camera and the its state directly
     void OnSubDeviceListChanged_Signal(const int &, unsigned int, unsigned long long, const QString &, const QString &);
     // Event will be called when a frame is processed by the internal thread and ready to show
-    void OnCameraFrameReady_Signal(const QImage &image, const unsigned long long &frameId);
+    void OnCameraFrameReady_Signal(const QImage &image, const QImage &displayImage, const unsigned long long &frameId);
     // Event will be called when a frame ID is processed by the internal thread and ready to show
     void OnCameraFrameID_Signal(const unsigned long long &frameId);
     // Event will be called when the a frame is recorded
@@ -899,6 +1330,12 @@ signals:
 
     // Event will be called on enumeration control change value
     void SendSignalToUpdateWidgets();
+    // Event will be called when the values of all enumerated controls were sent
+    void SendControlValuesRead(int32_t controlCount);
+    // Event will be called when the descriptions of the controls are known
+    void SendControlsDescribed(int32_t controlCount);
+    // Event will be called when the device state differs from the last one sent
+    void SendDeviceState(const DeviceState &state, uint32_t changedMask);
 
 	void SendControlStateChange(int32_t id,bool enabled);
 
@@ -908,11 +1345,23 @@ private slots:
     // The event handler to set or remove sub-devices
     void OnSubDeviceListChanged(const int &, unsigned int, unsigned long long, const QString &, const QString &);
     // The event handler to show the processed frame
-    void OnFrameReady(const QImage &image, const unsigned long long &frameId);
+    void OnFrameReady(const QImage &image, const QImage &displayImage, const unsigned long long &frameId);
     // The event handler to show the processed frame ID
     void OnFrameID(const unsigned long long &frameId);
     // Event will be called when the a frame is displayed
     void OnDisplayFrame(const unsigned long long &frameID);
+    // The event handler of the control writer thread, writes a queued value
+    void OnWriteControl(int32_t id, int64_t value);
+    // The event handler of the control writer thread after a batch of values
+    void OnControlsWritten(bool bNotify);
+    // The event handler of the enumeration thread, reads and sends the control values
+    void OnEnumerateControls();
+    // The event handler of the enumeration thread, queries the descriptions
+    void OnDescribeControls();
+    // The event handler after the descriptions were queried, runs on the GUI thread
+    void OnControlsDescribed();
+    // The event handler of the device state timer, requests a pass of the enumeration thread
+    void OnDeviceStateTimer();
 };
 
 #endif // CAMERA_H
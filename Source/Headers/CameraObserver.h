@@ -20,6 +20,7 @@
 #define CAMERAOBSERVER_H
 
 #include <QImage>
+#include <QMutex>
 #include <QObject>
 #include <QSharedPointer>
 #include <QThread>
@@ -27,6 +28,8 @@
 #include <stdint.h>
 
 #include <map>
+#include <set>
+#include <string>
 
 enum UpdateTriggerType
 {
@@ -43,8 +46,12 @@ public:
     CameraObserver(void);
     virtual ~CameraObserver(void);
 
-    // This function starts current thread
-    void Start();
+    // This function starts watching /dev, reports the video and sub-device
+    // nodes which already exist and starts the thread for later changes
+    //
+    // Returns:
+    // (int) - result of operation
+    int Start();
     // This function stops current thread
     void Stop();
 
@@ -55,19 +62,39 @@ public:
     // Do the work within this thread
     virtual void run();
 
-    // This function check for the devices, after finding
-    // any, emits signal with the device information
+    // This function probes a single video or sub-device node which was
+    // created or changed, after finding a capture device or sub-device, emits
+    // signal with the device information. Rejected nodes are not opened again
+    // until they are removed
+    //
+    // Parameters:
+    // [in] (const std::string &) nodeName - name of the node in /dev
     //
     // Returns:
     // (int) - result of operation
-    int CheckDevices();
+    int CheckDevice(const std::string &nodeName);
 
-    // This function check for the sub-devices, after finding
-    // any, emits signal with the sub-device information
+    // This function reports a removed node if it was a known device
+    //
+    // Parameters:
+    // [in] (const std::string &) nodeName - name of the node in /dev
     //
     // Returns:
     // (int) - result of operation
-    int CheckSubDevices();
+    int RemoveDevice(const std::string &nodeName);
+
+    // This function checks whether an opened node is a video capture device,
+    // or for sub-device nodes whether it is a V4L2 sub-device
+    //
+    // Parameters:
+    // [in] (int) fileDescriptor - the opened node
+    // [in] (bool) bSubDevice - the node is a v4l-subdev node
+    // [in] (const char *) deviceName - path of the node for the log
+    // [out] (std::string &) info - card name of the device
+    //
+    // Returns:
+    // (int) - 0 if the node is accepted, -1 otherwise
+    static int ProbeNode(int fileDescriptor, bool bSubDevice, const char *deviceName, std::string &info);
 
     // Callbacks
 
@@ -128,11 +155,32 @@ signals:
     void OnSubDeviceMessage_Signal(const QString &text);
 
 private:
+    // This function reads and handles the pending inotify events
+    void ProcessNodeEvents();
+    // This function probes every video and sub-device node in /dev
+    void ScanDevices();
+    // This function returns the kind of a node
+    //
+    // Parameters:
+    // [in] (const std::string &) nodeName - name of the node in /dev
+    // [out] (uint64_t &) nodeNumber - number at the end of the name
+    //
+    // Returns:
+    // (int) - 0 for video nodes, 1 for sub-device nodes, -1 for other nodes
+    static int GetNodeKind(const std::string &nodeName, uint64_t &nodeNumber);
+
     bool                                        m_bTerminate;
     // Variable to abort the running thread
     bool                                        m_bAbort;
-    std::map<int, std::string>                  m_DeviceList;
-    std::map<int, std::string>                  m_SubDeviceList;
+    int                                         m_InotifyFileDescriptor;
+    // Wakes the thread up when it has to stop
+    int                                         m_WakeFileDescriptor;
+    QMutex                                      m_DeviceListMutex;
+    // Known nodes and their card names
+    std::map<std::string, std::string>          m_DeviceList;
+    std::map<std::string, std::string>          m_SubDeviceList;
+    // Nodes which opened but are no capture device or sub-device
+    std::set<std::string>                       m_RejectedNodes;
 };
 
 #endif // CAMERAOBSERVER_H
@@ -0,0 +1,143 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+#ifndef CAPABILITYCACHE_H
+#define CAPABILITYCACHE_H
+
+#include <QList>
+#include <QString>
+
+#include <stdint.h>
+
+#include <map>
+#include <vector>
+
+// Pixel format as listed by VIDIOC_ENUM_FMT
+struct CachedPixelFormat
+{
+    uint32_t  pixelFormat;
+    QString   description;
+};
+
+// Static part of a control as listed by VIDIOC_QUERY_EXT_CTRL. The device is
+// the index of the file descriptor in the order the camera walks them
+// (sub-devices first). Range and flags change at runtime and are not kept.
+struct CachedControl
+{
+    uint32_t  id;
+    uint32_t  type;
+    int       device;
+    QString   name;
+};
+
+// Keeps the formats, frame sizes and the list of controls of an opened camera.
+// Filled by the first enumeration of a session and stored on disk under a key
+// built from the identity of the camera, so that the next open of the same
+// camera with the same firmware and driver can skip listing formats and frame
+// sizes. The key validates the entry, the controls are compared against the
+// control walk of the opened device and a mismatch drops the entry.
+class CapabilityCache
+{
+public:
+    CapabilityCache(void);
+    ~CapabilityCache(void);
+
+    // This function forgets everything, used when the device is closed
+    void Clear();
+
+    // This function sets the key of the camera, content of another key is dropped
+    //
+    // Parameters:
+    // [in] (const QString &) key - identity of the camera, empty keeps the cache in memory only
+    void SetKey(const QString &key);
+
+    // This function reads the file of the key
+    //
+    // Returns:
+    // (int) - 0 if a complete entry was read
+    int Load();
+
+    // This function writes the file of the key once formats and controls are known
+    //
+    // Returns:
+    // (int) - 0 if the file was written or was already up to date
+    int Save();
+
+    // This function drops the content and removes the file of the key,
+    // used when the device does not match the stored entry
+    void Invalidate();
+
+    // This function returns whether formats and controls are known
+    //
+    // Returns:
+    // (bool) - true if complete
+    bool IsComplete() const;
+
+    // This function returns the stored pixel formats
+    //
+    // Returns:
+    // (const QList<CachedPixelFormat> &) - pixel formats, empty if unknown
+    const QList<CachedPixelFormat> &GetPixelFormats() const;
+    // This function sets the pixel formats
+    //
+    // Parameters:
+    // [in] (const QList<CachedPixelFormat> &) pixelFormats - enumerated pixel formats
+    void SetPixelFormats(const QList<CachedPixelFormat> &pixelFormats);
+
+    // This function returns the stored frame sizes of a pixel format
+    //
+    // Parameters:
+    // [in] (uint32_t) pixelFormat - fourcc of the pixel format
+    // [out] (QList<QString> &) frameSizes - frame sizes as "<width>x<height>"
+    //
+    // Returns:
+    // (bool) - true if the frame sizes of the pixel format are known
+    bool GetFrameSizes(uint32_t pixelFormat, QList<QString> &frameSizes) const;
+    // This function sets the frame sizes of a pixel format
+    //
+    // Parameters:
+    // [in] (uint32_t) pixelFormat - fourcc of the pixel format
+    // [in] (const QList<QString> &) frameSizes - frame sizes as "<width>x<height>"
+    void SetFrameSizes(uint32_t pixelFormat, const QList<QString> &frameSizes);
+
+    // This function returns the stored controls
+    //
+    // Returns:
+    // (const std::vector<CachedControl> &) - every control the walk of each device returned, empty if unknown
+    const std::vector<CachedControl> &GetControls() const;
+    // This function sets the controls
+    //
+    // Parameters:
+    // [in] (const std::vector<CachedControl> &) controls - every control the walk of each device returned
+    void SetControls(const std::vector<CachedControl> &controls);
+
+private:
+    // This function returns the file of the key
+    //
+    // Returns:
+    // (QString) - path of the file, empty without key
+    QString GetFilePath() const;
+
+    QString                                 m_Key;
+    QList<CachedPixelFormat>                m_PixelFormats;
+    std::map<uint32_t, QList<QString> >     m_FrameSizes;
+    std::vector<CachedControl>              m_Controls;
+    // Set when the file holds the current content
+    bool                                    m_bIsStored;
+};
+
+#endif // CAPABILITYCACHE_H
@@ -0,0 +1,76 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+#ifndef CONTROLENUMERATOR_H
+#define CONTROLENUMERATOR_H
+
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+// Describes the controls and reads their values on its own thread, so that
+// opening a device with many controls does not block the GUI. Requests made
+// while a pass is running are merged into one further pass.
+class ControlEnumerator : public QThread
+{
+    Q_OBJECT
+
+public:
+    ControlEnumerator(void);
+    virtual ~ControlEnumerator(void);
+
+    // This function stops the thread, a pending pass is dropped
+    void Stop();
+
+    // This function requests a pass over all controls
+    void Request();
+
+    // This function requests the descriptions of the controls, they are
+    // queried before the values of a pending pass
+    void RequestDescriptions();
+
+    // This function drops a pending pass and waits until a pass in
+    // progress is finished, used before the device is closed
+    void Cancel();
+
+protected:
+    // Function of the thread
+    virtual void run();
+
+signals:
+    // This signal runs a pass, it has to be connected directly so that
+    // the ioctls run on this thread
+    void EnumerateControls_Signal();
+    // This signal queries the descriptions, it has to be connected directly
+    // so that the ioctls run on this thread
+    void DescribeControls_Signal();
+    // This signal is emitted after the descriptions were queried, it is
+    // delivered to the thread of the receiver
+    void ControlsDescribed_Signal();
+
+private:
+    // Guards the request flags
+    QMutex          m_Mutex;
+    // Held while a pass runs
+    QMutex          m_EnumerateMutex;
+    QWaitCondition  m_Condition;
+    bool            m_bRequested;
+    bool            m_bDescriptionsRequested;
+    bool            m_bAbort;
+};
+
+#endif // CONTROLENUMERATOR_H
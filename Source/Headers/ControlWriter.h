@@ -0,0 +1,110 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+#ifndef CONTROLWRITER_H
+#define CONTROLWRITER_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <stdint.h>
+
+#include <map>
+
+// Writes control values on its own thread. Values queued for the same control
+// before they were written are merged, only the newest value is written.
+class ControlWriter : public QThread
+{
+    Q_OBJECT
+
+public:
+    ControlWriter(void);
+    virtual ~ControlWriter(void);
+
+    // This function stops the thread, pending writes are dropped
+    void Stop();
+
+    // This function queues a control value
+    //
+    // Parameters:
+    // [in] (int32_t) id - id of the control
+    // [in] (int64_t) value - new value, replaces a value which is still pending
+    // [in] (bool) bNotify - emit ControlWritten_Signal with bNotify set after the write
+    void Queue(int32_t id, int64_t value, bool bNotify);
+
+    // This function drops the pending value of a control, used before
+    // the control is written directly
+    //
+    // Parameters:
+    // [in] (int32_t) id - id of the control
+    void Discard(int32_t id);
+
+    // This function drops all pending values and waits until a write in
+    // progress is finished, used before the device is closed
+    void DiscardAll();
+
+    // This function sets how often the queued values are written
+    //
+    // Parameters:
+    // [in] (uint32_t) writesPerSecond - 0 writes without limit
+    void SetMaxWriteRate(uint32_t writesPerSecond);
+
+    // This function returns the number of queued values
+    //
+    // Returns:
+    // (uint64_t) - queued values
+    uint64_t GetQueuedCount() const;
+
+    // This function returns the number of values written to the device
+    //
+    // Returns:
+    // (uint64_t) - written values
+    uint64_t GetWrittenCount() const;
+
+protected:
+    // Function of the thread
+    virtual void run();
+
+signals:
+    // This signal writes the value, it has to be connected directly so that
+    // the ioctl runs on this thread
+    void WriteControl_Signal(int32_t id, int64_t value);
+    // This signal is emitted after the values of a batch were written
+    void ControlWritten_Signal(bool bNotify);
+
+private:
+    struct PendingWrite
+    {
+        int64_t value;
+        bool    bNotify;
+    };
+
+    // Guards the pending values and the settings
+    mutable QMutex                  m_Mutex;
+    // Held while a batch is written
+    QMutex                          m_WriteMutex;
+    QWaitCondition                  m_Condition;
+    std::map<int32_t, PendingWrite> m_PendingWrites;
+    uint32_t                        m_MinWriteIntervalMs;
+    bool                            m_bAbort;
+    uint64_t                        m_QueuedCount;
+    uint64_t                        m_WrittenCount;
+};
+
+#endif // CONTROLWRITER_H
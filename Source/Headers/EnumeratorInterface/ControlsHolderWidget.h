@@ -22,21 +22,42 @@
 #include <QDialog>
 #include <QScrollArea>
 #include <QGridLayout>
+#include <QHash>
 #include <EnumeratorInterface/IControlEnumerationHolder.h>
 #include "ui_ControlsHolderWidget.h"
 
+#include <functional>
+
+// Creates the widget of a control, called when its row becomes visible
+typedef std::function<IControlEnumerationHolder*()> ControlWidgetFactory;
+
 class ControlsHolderWidget : public QWidget
 {
     Q_OBJECT
 public:
     explicit ControlsHolderWidget(QWidget *parent = nullptr);
-    // This function add new enumeration control to the list
+    // This function adds new enumeration control to the list. The row shows the name
+    // until it is scrolled into view, then the widget is created by the factory.
+    // Adding a control again replaces the factory of a widget not created yet.
     //
     // Parameters:
-    // [in] (IControlEnumerationHolder *) controlWidget - element which is dynamically casted to the specific control
-    void AddElement(IControlEnumerationHolder *controlWidget);
+    // [in] (int32_t) id - control id
+    // [in] (const QString &) name - name shown until the widget is created
+    // [in] (const ControlWidgetFactory &) factory - creates the widget of the control
+    void AddElement(int32_t id, const QString &name, const ControlWidgetFactory &factory);
     // This function removes all of the elements from the list, for example when camera is closed
     void RemoveElements();
+    // This function enables or disables the widget of a control, also when it is created later
+    //
+    // Parameters:
+    // [in] (int32_t) id - control id
+    // [in] (bool) bEnabled - new state
+    void SetElementEnabled(int32_t id, bool bEnabled);
+    // This function returns the number of controls which have a widget
+    //
+    // Returns:
+    // (int) - number of created widgets
+    int GetCreatedElementCount() const;
     // This function returns bool state which depends on whether control is already set or not. This is useful,
     // when updating some of the values
     //
@@ -46,7 +67,8 @@ public:
     // Returns:
     // (bool) - boolean value
     bool IsControlAlreadySet(int32_t id);
-    // This function returns IControlEnumerationHolder* depending on the passed id value
+    // This function returns IControlEnumerationHolder* depending on the passed id value,
+    // it fails for a control whose widget is not created yet
     //
     // Parameters:
     // [in] (int32_t) id - control id value
@@ -58,6 +80,10 @@ public:
 
     virtual QSize sizeHint() const override;
 
+protected:
+    virtual void showEvent(QShowEvent *event) override;
+    virtual void resizeEvent(QResizeEvent *event) override;
+
     Ui::ControlsHolderWidget ui;
 
 private slots:
@@ -66,10 +92,33 @@ private slots:
     // Parameters:
     // [in] row - current row
     void OnListItemChanged(int row);
+    // This slot function creates the widgets of the visible rows
+    void CreateVisibleElements();
 
 private:
-    // This vector stores all of the controls widgets
-    QVector<IControlEnumerationHolder*> m_itemVector;
+    struct ControlElement
+    {
+        int32_t                     id;
+        IControlEnumerationHolder  *pWidget;
+        ControlWidgetFactory        factory;
+        bool                        bStateChanged;
+        bool                        bEnabled;
+    };
+
+    // This function creates the widget of a row if it was not created yet
+    //
+    // Parameters:
+    // [in] (int) row - row of the control
+    void CreateElementWidget(int row);
+    // This function creates the widgets of the visible rows once the list is laid out
+    void ScheduleCreateVisibleElements();
+
+    // This vector stores all of the controls in the order of the rows
+    QVector<ControlElement> m_Elements;
+    // Row of each control id
+    QHash<int32_t, int> m_IdToRow;
+    int m_CreatedCount;
+    bool m_bCreatePending;
 };
 
 
@@ -31,6 +31,12 @@ public:
     // Parameters:
     // [in] (int64_t) value - new value for the widget
     void UpdateValue(int64_t value);
+    // This function updates the range of the widget when the driver changed it
+    //
+    // Parameters:
+    // [in] (int64_t) min - new minimum
+    // [in] (int64_t) max - new maximum
+    void UpdateRange(int64_t min, int64_t max);
 
 signals:
     // This signal passes new value from the line edit to the Camera class
@@ -72,6 +78,8 @@ private:
     // Returns:
     // (int32_t) - calculated value which is position of the slider
     int32_t GetSliderLogValue(int64_t value);
+    // This function fills the control info from the name, range and unit
+    void UpdateControlInfo();
 
     // This function is used internally inside this class, it converts a 64bit control value to a 32bit value for the slider.
     //
@@ -107,6 +115,8 @@ private:
     int64_t m_Max;
     int64_t m_Value;
     int64_t m_SliderValue;
+    QString m_Unit;
+    bool    m_bIsReadOnly;
 };
 
 #endif // INTEGER64ENUMERATIONCONTROL_H
@@ -31,6 +31,12 @@ public:
     // Parameters:
     // [in] (int32_t) value - new value for the widget
     void UpdateValue(int32_t value);
+    // This function updates the range of the widget when the driver changed it
+    //
+    // Parameters:
+    // [in] (int32_t) min - new minimum
+    // [in] (int32_t) max - new maximum
+    void UpdateRange(int32_t min, int32_t max);
 
 signals:
     // This signal passes new value from the line edit to the Camera class
@@ -72,6 +78,8 @@ private:
     // Returns:
     // (int32_t) - calculated value which is position of the slider
     int32_t GetSliderLogValue(int32_t value);
+    // This function fills the control info from the name, range and unit
+    void UpdateControlInfo();
 
     // One of the main elements of this widget, it allows to change value
     QSlider m_Slider;
@@ -81,6 +89,8 @@ private:
     int32_t m_Max;
     int32_t m_Value;
     int32_t m_SliderValue;
+    QString m_Unit;
+    bool    m_bIsReadOnly;
 };
 
 
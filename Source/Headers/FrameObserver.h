@@ -23,6 +23,7 @@
 #include "LocalMutex.h"
 #include <QImage>
 #include <QObject>
+#include <QElapsedTimer>
 #include <QSharedPointer>
 #include <QThread>
 
@@ -32,13 +33,23 @@
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 
+#include <atomic>
 #include <queue>
+#include <string>
 #include <vector>
 #include "V4L2Helper.h"
 #include "FPSCalculator.h"
 
 #define MAX_VIEWER_USER_BUFFER_COUNT    50
 
+// Cache maintenance of the capture buffers on non-coherent platforms
+enum BufferCacheMode
+{
+    BufferCacheMaintained = 0,  // the driver cleans and invalidates every buffer
+    BufferCacheSkipUnread,      // no clean, no invalidate while frames are not shown
+    BufferCacheSkipAlways,      // no maintenance at all, frames may show stale data
+};
+
 struct UserBuffer
 {
     uint8_t         *pBuffer;
@@ -90,6 +101,29 @@ public:
     // Returns:
     // (unsigned int) - rendered frames count
     double GetRenderedFPS();
+    // This function returns the mean time the capture thread spent on a
+    // frame, from the dequeue to the handoff, since the last reset
+    //
+    // Returns:
+    // (double) - capture time in milliseconds
+    double GetAverageCaptureTime();
+    // This function returns the longest capture time since the last reset
+    //
+    // Returns:
+    // (double) - capture time in milliseconds
+    double GetMaximumCaptureTime();
+    // This function resets the capture time statistics
+    void ResetCaptureTime();
+    // This function starts the time to first frame measurement, the time
+    // until the capture thread dequeues the first frame of the next stream
+    // is taken
+    void StartTimeToFirstFrame();
+    // This function returns the time from the last StartTimeToFirstFrame
+    // to the first frame of the stream
+    //
+    // Returns:
+    // (double) - time in milliseconds, negative while no frame arrived
+    double GetTimeToFirstFrame();
 
     // This function sets file descriptor
     //
@@ -130,12 +164,113 @@ public:
     // Returns:
     // (int) - result of the buffer removal
     virtual int DeleteAllUserBuffer();
+    // This function frees the buffers of the driver for a format change,
+    // memory owned by the viewer is kept for the next buffer creation
+    //
+    // Returns:
+    // (int) - result of the buffer release
+    virtual int ReleaseAllUserBuffer();
+    // This function adds buffers to the running stream with VIDIOC_CREATE_BUFS
+    // and queues them
+    //
+    // Parameters:
+    // [in] (uint32_t) bufferCount - number of additional buffers
+    //
+    // Returns:
+    // (int) - 0 if at least one buffer was added, -1 otherwise
+    virtual int AddUserBuffers(uint32_t bufferCount);
+    // This function asks the capture thread to add buffers to the running
+    // stream before it dequeues the next frame, the caller does not wait
+    //
+    // Parameters:
+    // [in] (uint32_t) bufferCount - number of additional buffers
+    void RequestUserBuffers(uint32_t bufferCount);
+    // This function returns the number of buffers of the stream
+    //
+    // Returns:
+    // (uint32_t) - buffer count
+    uint32_t GetUserBufferCount();
+    // This function returns the lowest number of buffers the driver had
+    // queued right after a dequeue since the last reset. 0 means the driver
+    // ran out of buffers
+    //
+    // Returns:
+    // (uint32_t) - minimum queue depth
+    uint32_t GetMinimumDriverQueueDepth();
+    // This function resets the minimum queue depth
+    void ResetMinimumDriverQueueDepth();
 
     // This function switches on/off frame transfer to gui
     //
     // Parameters:
     // [in] (bool) showFrames
     void SwitchFrameTransfer2GUI(bool showFrames);
+    // This function selects the YCbCr conversion used by the next stream,
+    // automatic values are resolved from the colorimetry the driver reports
+    //
+    // Parameters:
+    // [in] (yuvconversion::ColorMatrix) colorMatrix
+    // [in] (yuvconversion::ColorRange) colorRange
+    void SetYuvConversion(yuvconversion::ColorMatrix colorMatrix, yuvconversion::ColorRange colorRange);
+    // This function sets the DCT scaling of compressed formats for the next stream
+    //
+    // Parameters:
+    // [in] (uint32_t) scaleDenominator - 1, 2, 4 or 8
+    void SetScaleDenominator(uint32_t scaleDenominator);
+    // This function selects 16 bit images for 10 and 12 bit formats of the next stream
+    //
+    // Parameters:
+    // [in] (bool) bHighBitDepth - keep the full sample depth
+    void SetHighBitDepth(bool bHighBitDepth);
+    // This function sets the display tone curve, the table is only rebuilt
+    // when the parameters change and is used from the next frame on
+    //
+    // Parameters:
+    // [in] (const tonemapping::Parameters &) toneMapping
+    void SetToneMapping(const tonemapping::Parameters &toneMapping);
+    // This function sets the window/level which the processing threads use
+    // to map high bit depth frames to their display image
+    //
+    // Parameters:
+    // [in] (bool) bAutoWindowLevel - follow the content of every frame
+    // [in] (uint16_t) low - 16 bit value which is shown black
+    // [in] (uint16_t) high - 16 bit value which is shown white
+    void SetWindowLevel(bool bAutoWindowLevel, uint16_t low, uint16_t high);
+    // This function sets whether the alignment of 16 bit containers is
+    // detected from the first frames of the next stream
+    //
+    // Parameters:
+    // [in] (bool) bAutoShift - analyze the data instead of relying on the SoC
+    void SetAutoShift(bool bAutoShift);
+    // This function selects whether user pointer buffers are carved from one
+    // pre-faulted and locked huge page arena, used by the next buffer creation
+    //
+    // Parameters:
+    // [in] (bool) bUseBufferArena
+    void SetBufferArena(bool bUseBufferArena);
+    // This function selects the cache maintenance of the capture buffers and
+    // whether they are prepared with VIDIOC_PREPARE_BUF before the first
+    // queuing, used by the next buffer creation
+    //
+    // Parameters:
+    // [in] (BufferCacheMode) cacheMode
+    // [in] (bool) bPrepareBuffers
+    void SetBufferQueuing(BufferCacheMode cacheMode, bool bPrepareBuffers);
+    // This function sets whether the capture thread measures the time from
+    // the dequeue until the frame is read by the CPU, the result of the
+    // stream is logged when it stops
+    //
+    // Parameters:
+    // [in] (bool) bMeasureReadLatency
+    void SetReadLatencyBenchmark(bool bMeasureReadLatency);
+    // This function sets whether the frames of the next stream are written to
+    // raw files. The buffers are handed to the logger without copying and go
+    // back to the driver after they were written
+    //
+    // Parameters:
+    // [in] (bool) bDumpFrames
+    // [in] (const std::string &) directory - directory of the raw files
+    void SetFrameDump(bool bDumpFrames, const std::string &directory);
 
 protected:
     // v4l2
@@ -167,6 +302,89 @@ protected:
     int ProcessFrame(v4l2_buffer &buf);
     // This function dequeues and process current frame
     void DequeueAndProcessFrame();
+    // This function reads the plane count, sizes and strides of the current
+    // format into m_PlaneCount, m_PlaneLength and m_PlaneStride
+    //
+    // Returns:
+    // (int) - result of the format query
+    int QueryPlaneLayout();
+    // This function creates buffers with VIDIOC_CREATE_BUFS in the current format.
+    // It is called on the capture thread, the only one which adds buffers, so the
+    // buffer list does not change meanwhile and m_UsedBufferMutex is not needed
+    //
+    // Parameters:
+    // [in] (uint32_t) memory - V4L2_MEMORY_MMAP or V4L2_MEMORY_USERPTR
+    // [in] (uint32_t) bufferCount - number of buffers to create
+    // [out] (uint32_t &) createdCount - number of buffers the driver created
+    //
+    // Returns:
+    // (int) - result of the buffer creation
+    int CreateAdditionalBuffers(uint32_t memory, uint32_t bufferCount, uint32_t &createdCount);
+    // This function returns the V4L2_BUF_FLAG_NO_CACHE_* flags for the next
+    // queuing of a buffer and remembers whether it skips the invalidation.
+    // The caller holds m_UsedBufferMutex
+    //
+    // Parameters:
+    // [in] (uint32_t) index - index of the buffer
+    //
+    // Returns:
+    // (uint32_t) - buffer flags
+    uint32_t GetCacheFlags(uint32_t index);
+    // This function returns the V4L2_BUF_FLAG_NO_CACHE_* flags like GetCacheFlags
+    // without remembering them, used to prepare buffers without m_UsedBufferMutex
+    //
+    // Returns:
+    // (uint32_t) - buffer flags
+    uint32_t SelectCacheFlags() const;
+    // This function returns the V4L2_MEMORY_FLAG_* flags for the buffer
+    // requests, cache hints are only honored for non-coherent buffers
+    //
+    // Parameters:
+    // [in] (uint32_t) memory - V4L2_MEMORY_MMAP or V4L2_MEMORY_USERPTR
+    //
+    // Returns:
+    // (uint32_t) - memory flags
+    uint32_t GetMemoryFlags(uint32_t memory);
+    // This function logs whether the driver honors the cache hints
+    //
+    // Parameters:
+    // [in] (uint32_t) memory - V4L2_MEMORY_MMAP or V4L2_MEMORY_USERPTR
+    // [in] (uint32_t) capabilities - V4L2_BUF_CAP_* of the buffer request
+    void ReportCacheHintSupport(uint32_t memory, uint32_t capabilities);
+    // This function hands a frame to the next idle image processing thread
+    //
+    // Parameters:
+    // [in] (uint32_t) bufferIndex - index of the buffer
+    // [in] (uint8_t *) buffer - frame data
+    // [in] (uint32_t) length - length of the frame data
+    //
+    // Returns:
+    // (int) - 0 if a thread took the frame, -1 if all threads are busy
+    int QueueFrameToProcessingThread(uint32_t bufferIndex, uint8_t *buffer, uint32_t length);
+    // This function sets how many of the started image processing threads get
+    // frames, it is called at stream start and after buffers were added
+    void UpdateActiveProcessingThreads();
+    // This function stops all image processing threads
+    void StopImageProcessingThreads();
+    // This function hands a frame to the logger, which writes it to a raw file.
+    // The buffer gets a second reference which the logger releases
+    //
+    // Parameters:
+    // [in] (uint32_t) bufferIndex - index of the buffer
+    // [in] (uint8_t *) buffer - frame data
+    // [in] (uint32_t) length - length of the frame data
+    void DumpFrame(uint32_t bufferIndex, uint8_t *buffer, uint32_t length);
+    // This function gives up one reference of a buffer, the last one queues
+    // it to the driver again
+    //
+    // Parameters:
+    // [in] (uint32_t) bufferIndex - index of the buffer
+    void ReturnFrameBuffer(uint32_t bufferIndex);
+    // This function is called by the logger after a dumped frame was written
+    //
+    // Parameters:
+    // [in] (void *) pContext - FrameDumpContext of the frame
+    static void ReleaseDumpedFrame(void *pContext);
 
     // This function does the work within this thread
     virtual void run();
@@ -195,19 +413,75 @@ protected:
 
     bool m_ShowFrames;
 
+    yuvconversion::ColorMatrix m_ColorMatrix;
+    yuvconversion::ColorRange m_ColorRange;
+
+    // All planes of a buffer are placed in one contiguous range, so the frame
+    // is passed on as a single pointer plus the offsets of its planes
+    uint32_t m_PlaneCount;
+    uint32_t m_PlaneOffset[VIDEO_MAX_PLANES];
+    uint32_t m_PlaneLength[VIDEO_MAX_PLANES];
+    uint32_t m_PlaneStride[VIDEO_MAX_PLANES];
+
     std::vector<UserBuffer*>              m_UserBufferContainerList;
     base::LocalMutex                      m_UsedBufferMutex;
-
-    // Shared pointer to a worker thread for the image processing
-    QSharedPointer<ImageProcessingThread> m_pImageProcessingThread;
+    // Buffers queued at the driver, guarded by m_UsedBufferMutex
+    uint32_t                              m_DriverQueueDepth;
+    uint32_t                              m_MinimumDriverQueueDepth;
+    // Buffers queued with V4L2_BUF_FLAG_NO_CACHE_INVALIDATE, guarded by m_UsedBufferMutex
+    std::vector<bool>                     m_BufferSkipsInvalidate;
+    // Owners of the dequeued buffers while a frame is dumped, guarded by m_UsedBufferMutex
+    std::vector<uint32_t>                 m_BufferReferences;
+
+    uint32_t m_ScaleDenominator;
+    bool m_bHighBitDepth;
+    tonemapping::Parameters m_ToneMapping;
+    bool m_bAutoShift;
+    bool m_bUseBufferArena;
+    BufferCacheMode m_BufferCacheMode;
+    bool m_bPrepareBuffers;
+    // Raw files of the frames, the buffers stay referenced until written
+    bool m_bDumpFrames;
+    std::string m_FrameDumpDirectory;
+    std::atomic<uint32_t> m_PendingFrameDumps;
+    // Buffers the capture thread adds before the next dequeue
+    std::atomic<uint32_t> m_RequestedUserBuffers;
+
+    // Worker threads for the image processing, formats with independent
+    // frames use several of them in parallel
+    std::vector<QSharedPointer<ImageProcessingThread> > m_ImageProcessingThreads;
+    // Threads which get frames, limited by the buffer count
+    uint32_t m_ActiveProcessingThreads;
+    // Threads started with a plan for the stream
+    uint32_t m_MaxProcessingThreads;
+    uint32_t m_NextProcessingThread;
+    unsigned long long m_LastRenderedFrameId;
+
+    // Time from the dequeue to the handoff of a frame, written by the
+    // capture thread and read by the GUI
+    base::LocalMutex m_CaptureTimeMutex;
+    double m_dCaptureTimeSum;
+    double m_dCaptureTimeMax;
+    unsigned int m_CaptureCount;
+    // Stream setup until the first frame, guarded by m_CaptureTimeMutex
+    QElapsedTimer m_SetupTimer;
+    double m_dTimeToFirstFrame;
+
+    // Dequeue and first read of the frames, only used by the capture
+    // thread and reported after it stopped
+    bool m_bMeasureReadLatency;
+    double m_dDequeueTimeSum;
+    double m_dFirstReadTimeSum;
+    double m_dFirstReadTimeMax;
+    unsigned int m_ReadLatencyCount;
 
 private slots:
     //Event handler for getting the processed frame to an image
-    void OnFrameReadyFromThread(const QImage &image, const unsigned long long &frameId, const int &bufIndex);
+    void OnFrameReadyFromThread(const QImage &image, const QImage &displayImage, const unsigned long long &frameId, const int &bufIndex);
 
 signals:
     // Event will be called when a frame is processed by the internal thread and ready to show
-    void OnFrameReady_Signal(const QImage &image, const unsigned long long &frameId);
+    void OnFrameReady_Signal(const QImage &image, const QImage &displayImage, const unsigned long long &frameId);
     // Event will be called when a frame is processed by the internal thread and ready to show
     void OnFrameID_Signal(const unsigned long long &frameId);
     // Event will be called when the frame processing is done and the frame can be returned to streaming engine
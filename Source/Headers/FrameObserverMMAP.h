@@ -56,6 +56,15 @@ class FrameObserverMMAP : public FrameObserver
     // Returns:
     // (int) - result of the buffer removal
     virtual int DeleteAllUserBuffer();
+    // This function adds buffers to the running stream with VIDIOC_CREATE_BUFS
+    // and queues them
+    //
+    // Parameters:
+    // [in] (uint32_t) bufferCount - number of additional buffers
+    //
+    // Returns:
+    // (int) - 0 if at least one buffer was added, -1 otherwise
+    virtual int AddUserBuffers(uint32_t bufferCount);
 
 protected:
     // v4l2
@@ -79,7 +88,27 @@ protected:
     virtual int GetFrameData(v4l2_buffer &buf, uint8_t *&buffer, uint32_t &length);
 
 private:
-
+    // This function prepares buffers with VIDIOC_PREPARE_BUF, so their
+    // queuing does not pay for the cache maintenance and page pinning. Added
+    // buffers are prepared before they are put into the buffer list
+    //
+    // Parameters:
+    // [in] (uint32_t) firstIndex - index of the first buffer
+    // [in] (uint32_t) bufferCount - number of buffers
+    //
+    // Returns:
+    // (int) - result of the preparation
+    int PrepareUserBuffers(uint32_t firstIndex, uint32_t bufferCount);
+    // This function maps a buffer of the driver
+    //
+    // Parameters:
+    // [in] (uint32_t) index - index of the buffer
+    // [in] (size_t) pageSize - alignment of the planes
+    // [out] (UserBuffer *&) pUserBuffer - mapped buffer
+    //
+    // Returns:
+    // (int) - result of the mapping
+    int MapBuffer(uint32_t index, size_t pageSize, UserBuffer *&pUserBuffer);
 };
 
 #endif // FRAMEOBSERVERMMAP_H
@@ -19,6 +19,7 @@
 #ifndef FRAMEOBSERVERUSER_H
 #define FRAMEOBSERVERUSER_H
 
+#include "BufferArena.h"
 #include "FrameObserver.h"
 
 class FrameObserverUSER : public FrameObserver
@@ -56,6 +57,21 @@ class FrameObserverUSER : public FrameObserver
     // Returns:
     // (int) - result of the buffer removal
     virtual int DeleteAllUserBuffer();
+    // This function frees the buffers of the driver and keeps their memory,
+    // the next buffer creation reuses it when it is large enough
+    //
+    // Returns:
+    // (int) - result of the buffer release
+    virtual int ReleaseAllUserBuffer();
+    // This function adds buffers to the running stream with VIDIOC_CREATE_BUFS
+    // and queues them
+    //
+    // Parameters:
+    // [in] (uint32_t) bufferCount - number of additional buffers
+    //
+    // Returns:
+    // (int) - 0 if at least one buffer was added, -1 otherwise
+    virtual int AddUserBuffers(uint32_t bufferCount);
 
 protected:
     // v4l2
@@ -79,6 +95,37 @@ protected:
     virtual int GetFrameData(v4l2_buffer &buf, uint8_t *&buffer, uint32_t &length);
 
 private:
+    // This function prepares buffers with VIDIOC_PREPARE_BUF, so their
+    // queuing does not pay for the cache maintenance and page pinning. Added
+    // buffers are prepared before they are put into the buffer list
+    //
+    // Parameters:
+    // [in] (uint32_t) firstIndex - index of the first buffer
+    // [in] (const std::vector<UserBuffer*> &) userBuffers - the buffers from firstIndex on
+    //
+    // Returns:
+    // (int) - result of the preparation
+    int PrepareUserBuffers(uint32_t firstIndex, const std::vector<UserBuffer*> &userBuffers);
+    // This function fills the user pointers of a buffer, one per plane
+    // for multi-planar buffers
+    //
+    // Parameters:
+    // [in/out] (v4l2_buffer &) buf - buffer to queue
+    // [in] (v4l2_plane *) planes - plane array with room for VIDEO_MAX_PLANES entries
+    // [in] (const UserBuffer *) pUserBuffer - memory of the buffer
+    void SetBufferPointers(v4l2_buffer &buf, v4l2_plane *planes, const UserBuffer *pUserBuffer);
+    // This function frees the memory kept from the previous stream
+    void FreeReusableBuffers();
+
+    // Memory of all buffers when the arena is enabled, the buffers are
+    // allocated one by one otherwise
+    BufferArena m_BufferArena;
+    // Size of a buffer including all planes, buffers added while streaming get it as well
+    uint32_t m_BufferSize;
+    // Allocation size of the buffers outside the arena, all have the same
+    size_t m_BufferCapacity;
+    // Memory of the previous stream which is kept over a format change
+    std::vector<uint8_t*> m_ReusableBuffers;
 };
 
 #endif // FRAMEOBSERVERUSER_H
@@ -19,6 +19,8 @@
 #ifndef IMAGEPORCESSINGTHREAD_H
 #define IMAGEPORCESSINGTHREAD_H
 
+#include <ImageTransform.h>
+#include <LocalMutex.h>
 #include <MyFrame.h>
 #include <MyFrameQueue.h>
 
@@ -73,6 +75,32 @@ public:
     // (int) - result of queuing
     int QueueFrame(QSharedPointer<MyFrame> pFrame);
 
+    // This function sets the conversion plan of the stream. It has to be
+    // called before the thread is started
+    //
+    // Parameters:
+    // [in] (QSharedPointer<ConversionPlan>) pPlan
+    void SetConversionPlan(QSharedPointer<ConversionPlan> pPlan);
+
+    // This function sets the display table which is applied to the following
+    // frames. It can be called while the thread is running
+    //
+    // Parameters:
+    // [in] (QSharedPointer<const std::vector<uint8_t> >) pToneTable - 256 entries, null for none
+    // [in] (const tonemapping::Parameters &) toneMapping - parameters of the table, they are
+    //                                                      folded into the window/level table
+    void SetToneTable(QSharedPointer<const std::vector<uint8_t> > pToneTable,
+                      const tonemapping::Parameters &toneMapping);
+
+    // This function sets the window/level which maps the following high bit
+    // depth frames to their display image. It can be called while the thread is running
+    //
+    // Parameters:
+    // [in] (bool) bAutoWindowLevel - follow the content of every frame
+    // [in] (uint16_t) low - 16 bit value which is shown black without the automatic
+    // [in] (uint16_t) high - 16 bit value which is shown white without the automatic
+    void SetWindowLevel(bool bAutoWindowLevel, uint16_t low, uint16_t high);
+
     // This function starts thread
     void StartThread();
 
@@ -84,17 +112,43 @@ protected:
     virtual void run();
 
 private:
+    // This function maps a high bit depth frame to its 8 bit display image
+    // with the current window/level
+    //
+    // Parameters:
+    // [in] (const QImage &) image - Grayscale16 or RGBX64 frame
+    // [out] (QImage &) displayImage - new image of the mapped frame
+    void CreateDisplayImage(const QImage &image, QImage &displayImage);
+
     const static int MAX_QUEUE_SIZE = 1;
 
     // Frame queue
     MyFrameQueue m_FrameQueue;
 
+    // Conversion plan of the current stream
+    QSharedPointer<ConversionPlan> m_pConversionPlan;
+
+    // Display table of the following frames, it is replaced as a whole
+    QSharedPointer<const std::vector<uint8_t> > m_pToneTable;
+    base::LocalMutex m_ToneTableMutex;
+    // Window/level of high bit depth frames, guarded by m_ToneTableMutex
+    tonemapping::Parameters m_ToneMapping;
+    bool m_bAutoWindowLevel;
+    uint16_t m_WindowLow;
+    uint16_t m_WindowHigh;
+    // Window/level table and its inputs, only used by the thread
+    std::vector<uint8_t> m_WindowLevelTable;
+    tonemapping::Parameters m_TableToneMapping;
+    uint16_t m_TableLow;
+    uint16_t m_TableHigh;
+
     // Variable to abort the running thread
     bool m_bAbort;
 
 signals:
-    // Event will be called when an image is processed by the thread
-    void OnFrameReady_Signal(const QImage &image, const unsigned long long &frameId, const int &bufIndex);
+    // Event will be called when an image is processed by the thread, the display
+    // image is the 8 bit mapping of high bit depth images and the image itself otherwise
+    void OnFrameReady_Signal(const QImage &image, const QImage &displayImage, const unsigned long long &frameId, const int &bufIndex);
 };
 
 #endif // IMAGEPORCESSINGTHREAD_H
@@ -19,9 +19,90 @@
 #ifndef IMAGETRANSFORM_H
 #define IMAGETRANSFORM_H
 
+#include "ToneMapping.h"
+#include "YuvConversion.h"
+
 #include <QImage>
+#include <QSharedPointer>
 
 #include <stdint.h>
+#include <vector>
+
+// Maximum number of image planes a conversion kernel reads
+#define MAX_CONVERSION_PLANES 3
+// Maximum number of image processing threads for formats with independent frames
+#define MAX_DECODE_WORKERS 3
+// Frames which are analyzed to find the alignment of 16 bit containers
+#define AUTO_SHIFT_FRAMES 4
+
+// CPU features which are relevant for the selection of conversion kernels
+enum CpuFeature
+{
+    CpuFeatureNone    = 0x0,
+    CpuFeatureSSE2    = 0x1,
+    CpuFeatureAVX2    = 0x2,
+    CpuFeatureNEON    = 0x4,
+    CpuFeatureSSSE3   = 0x8
+};
+
+struct ConversionPlan;
+class MjpegDecoder;
+
+// Kernel which converts a frame according to an already resolved plan
+typedef void (*ConvertFunction)(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage);
+
+// All per-format decisions of a stream. The plan is resolved once when the
+// stream is started and only used by the image processing thread afterwards.
+struct ConversionPlan
+{
+    uint32_t pixelFormat;
+    uint32_t width;
+    uint32_t height;
+    uint32_t bytesPerLine;
+    uint32_t payloadSize;
+    // bytes filled by the driver in the current frame, set by ConvertFrame
+    uint32_t frameLength;
+    // 8 bit bayer pattern used for demosaicing, 0 for non bayer formats
+    uint32_t bayerPixelFormat;
+    // right shift which narrows 16 bit containers to 8 bit
+    int shift;
+    // frames which are still analyzed to find the shift from the data, 0 keeps
+    // the shift of the SoC detection
+    uint32_t autoShiftFrames;
+    // samples of the analyzed frames which have the respective bit set
+    uint32_t bitUsage[16];
+    uint32_t bitUsageSamples;
+    // source lines are padded and have to be compacted first
+    bool bRemovePadding;
+    // combination of CpuFeature values
+    uint32_t cpuFeatures;
+    // 10/12 bit formats are kept as Grayscale16/RGBX64, MSB aligned
+    bool bHighBitDepth;
+    // significant bits of the source samples
+    uint32_t bitDepth;
+    // image planes relative to the start of the frame, in memory order
+    uint32_t planeCount;
+    uint32_t planeOffset[MAX_CONVERSION_PLANES];
+    uint32_t planeStride[MAX_CONVERSION_PLANES];
+    // YCbCr conversion, ColorMatrixApproximate selects the legacy kernels
+    yuvconversion::ColorMatrix colorMatrix;
+    yuvconversion::ColorRange colorRange;
+    yuvconversion::Coefficients yuvCoefficients;
+    // decoder of compressed formats and its DCT scaling (1, 2, 4 or 8)
+    QSharedPointer<MjpegDecoder> pMjpegDecoder;
+    uint32_t scaleDenominator;
+    // number of image processing threads the format can keep busy
+    uint32_t maxWorkerCount;
+    // 256 entry display table of the current frame, NULL for none. It is set
+    // by the image processing thread before every conversion
+    const uint8_t *pToneTable;
+    // the kernel applies pToneTable to every line it stores, other kernels
+    // get a separate pass over the converted image
+    bool bFusedToneTable;
+    ConvertFunction convertFunction;
+    // intermediate buffer for multi-stage conversions
+    std::vector<uint8_t> conversionBuffer;
+};
 
 class ImageTransform
 {
@@ -31,23 +112,97 @@ public:
 
     virtual ~ImageTransform();
 
-    // This function convert frame and return results of conversion
+    // This function convert frame with the given plan and return results of conversion
     //
     // Parameters:
+    // [in] (ConversionPlan &) plan - plan created by CreateConversionPlan
     // [in] (const uint8_t *) pBuffer
     // [in] (uint32_t) length - length of the buffer
+    // [out] (QImage &) convertedImage
+    //
+    // Returns:
+    // (int) - result of converting
+    static int ConvertFrame(ConversionPlan &plan, const uint8_t *pBuffer, uint32_t length,
+                            QImage &convertedImage);
+
+    // This function resolves the conversion kernel and all format dependent
+    // parameters for a stream
+    //
+    // Parameters:
+    // [in] (uint32_t) pixelFormat
     // [in] (uint32_t) width - width of the frame
     // [in] (uint32_t) height - height of the frame
-    // [in] (uint32_t) pixelFormat
-    // [in] (uint32_t &) payloadSize
-    // [in] (uint32_t &) bytesPerLine
-    // [in] (QImage &) convertedImage
+    // [in] (uint32_t) bytesPerLine
+    // [in] (uint32_t) payloadSize
+    // [in] (yuvconversion::ColorMatrix) colorMatrix - matrix for YCbCr formats
+    // [in] (yuvconversion::ColorRange) colorRange - range for YCbCr formats
+    // [in] (bool) bHighBitDepth - keep more than 8 bit where the format provides it
+    // [out] (ConversionPlan &) plan - resolved plan
     //
     // Returns:
-    // (int) - result of converting
-    static int ConvertFrame(const uint8_t* pBuffer, uint32_t length,
-                            uint32_t width, uint32_t height, uint32_t pixelFormat,
-                            uint32_t &payloadSize, uint32_t &bytesPerLine, QImage &convertedImage);
+    // (int) - result of operation, -1 when the pixel format is not supported
+    static int CreateConversionPlan(uint32_t pixelFormat, uint32_t width, uint32_t height,
+                                    uint32_t bytesPerLine, uint32_t payloadSize,
+                                    yuvconversion::ColorMatrix colorMatrix,
+                                    yuvconversion::ColorRange colorRange,
+                                    bool bHighBitDepth,
+                                    ConversionPlan &plan);
+
+    // This function returns the CPU features of the running machine
+    //
+    // Returns:
+    // (uint32_t) - combination of CpuFeature values
+    static uint32_t GetCpuFeatures();
+
+    // This function returns whether the image holds more than 8 bit per channel
+    //
+    // Parameters:
+    // [in] (const QImage &) image
+    //
+    // Returns:
+    // (bool) - true for Grayscale16 and RGBX64 images
+    static bool IsHighBitDepth(const QImage &image);
+    // This function creates the 16 to 8 bit table of a window/level mapping
+    //
+    // Parameters:
+    // [in] (uint16_t) low - value mapped to black
+    // [in] (uint16_t) high - value mapped to white
+    // [in] (const tonemapping::Parameters &) toneMapping - display tone curve applied on top
+    // [out] (std::vector<uint8_t> &) table - 65536 entries
+    static void CreateWindowLevelTable(uint16_t low, uint16_t high, const tonemapping::Parameters &toneMapping,
+                                       std::vector<uint8_t> &table);
+    // This function maps a high bit depth image to an 8 bit display image,
+    // Grayscale16 stays single channel (Grayscale8), RGBX64 becomes RGB32
+    //
+    // Parameters:
+    // [in] (const QImage &) source - Grayscale16 or RGBX64 image
+    // [in] (const std::vector<uint8_t> &) table - table of CreateWindowLevelTable
+    // [out] (QImage &) display - mapped image
+    //
+    // Returns:
+    // (int) - result of mapping, -1 for images without high bit depth
+    static int ApplyWindowLevel(const QImage &source, const std::vector<uint8_t> &table, QImage &display);
+    // This function estimates the range of the image content from a sparse
+    // histogram, the darkest and brightest 0.1% are ignored
+    //
+    // Parameters:
+    // [in] (const QImage &) source - Grayscale16 or RGBX64 image
+    // [out] (uint16_t &) low
+    // [out] (uint16_t &) high
+    //
+    // Returns:
+    // (int) - result of operation, -1 for images without high bit depth
+    static int GetImageRange(const QImage &source, uint16_t &low, uint16_t &high);
+    // This function maps an 8 bit image through a display table in place,
+    // high bit depth images are left to the window/level mapping
+    //
+    // Parameters:
+    // [in] (const uint8_t *) toneTable - 256 entries
+    // [in/out] (QImage &) image - converted image
+    //
+    // Returns:
+    // (int) - result of mapping, -1 for images which are not mapped
+    static int ApplyToneTable(const uint8_t *toneTable, QImage &image);
 };
 
 #endif // IMAGETRANSFORM_H
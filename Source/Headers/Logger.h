@@ -20,9 +20,11 @@
 #define LOGGER_H
 
 #include "BaseLogger.h"
+#include "BinaryLog.h"
 
 #include <QSharedPointer>
 
+#include <atomic>
 #include <string>
 
 class Logger
@@ -41,14 +43,33 @@ public:
     // Parameters:
     // [in] (const std::string &) message
     static void Log(const std::string &message);
-    // This function logs passed message with additional arguments.
+    // This function logs passed message with additional arguments. Only the
+    // arguments are stored, the logger thread formats the message.
     // It is preferable to use the LOG_EX macro below
     //
     // Parameters:
-    // [in] (const char *) filename
+    // [in] (const char *) filename - string literal
     // [in] (int) line - set to a negative number to disable logging of filename and line number
-    // [in] (const char *text) text
-    static void LogEx(const char *filename, int line, const char *text, ...);
+    // [in] (const char *text) text - printf like format, string literal
+    // [in] (const Args &...) args - numbers, pointers and C strings
+    template<typename... Args>
+    static void LogEx(const char *filename, int line, const char *text, const Args &... args)
+    {
+        base::LogRecordWriter writer(GetThreadRing(), filename, line, text);
+        if (writer.IsValid())
+        {
+            (writer.Add(args), ...);
+            writer.Commit();
+        }
+    }
+    // This function returns whether messages are logged
+    //
+    // Returns:
+    // (bool) - logger state
+    static bool IsEnabled()
+    {
+        return m_LogSwitch.load(std::memory_order_relaxed);
+    }
     // This function dumps passed message
     //
     // Parameters:
@@ -63,6 +84,27 @@ public:
     // [in] (uint8_t *) buffer
     // [in] (uint32_t) length
     static void LogBuffer(const std::string &filename, uint8_t *buffer, uint32_t length);
+    // This function writes buffer planes to a file without copying them
+    //
+    // Parameters:
+    // [in] (const std::string &) filename
+    // [in] (const struct iovec *) pPlanes - planes which stay valid until released
+    // [in] (uint32_t) planeCount
+    // [in] (base::DumpReleaseFunction) releaseFunction - gives the planes back to their owner
+    // [in] (void *) pReleaseContext
+    //
+    // Returns:
+    // (bool) - false if the buffer was dropped, the caller keeps it then
+    static bool LogBuffer(const std::string &filename, const struct iovec *pPlanes, uint32_t planeCount,
+                          base::DumpReleaseFunction releaseFunction, void *pReleaseContext);
+    // This function returns the counters of the dump path
+    //
+    // Parameters:
+    // [out] (base::DumpStatistics &) statistics
+    //
+    // Returns:
+    // (bool) - false if no logger exists
+    static bool GetDumpStatistics(base::DumpStatistics &statistics);
     // This function swtich logger's turn state
     //
     // Parameters:
@@ -70,8 +112,15 @@ public:
     static void LogSwitch(bool flag);
 
 private:
+    // This function returns the log ring of the calling thread, the logger
+    // is created when nobody did it before
+    //
+    // Returns:
+    // (base::LogRing &) - ring of the thread
+    static base::LogRing &GetThreadRing();
+
     static QSharedPointer<base::BaseLogger> m_pBaseLogger;
-    static bool m_LogSwitch;
+    static std::atomic<bool> m_LogSwitch;
 };
 
 constexpr const char* filepathToFilename(const char* filepath)
@@ -89,7 +138,14 @@ constexpr const char* filepathToFilename(const char* filepath)
 
 #define __FILENAME__ filepathToFilename(__FILE__)
 
+// A disabled logger costs a single branch, LOGGER_DISABLED removes the messages
+// completely. The format has to be a string literal, it is read by the logger thread
+#ifdef LOGGER_DISABLED
+#define LOG_EX(...) \
+    do { } while (0)
+#else
 #define LOG_EX(...) \
-    Logger::LogEx(__FILENAME__, __LINE__, __VA_ARGS__)
+    do { if (Logger::IsEnabled()) Logger::LogEx(__FILENAME__, __LINE__, "" __VA_ARGS__); } while (0)
+#endif
 
 #endif // LOGGER_H
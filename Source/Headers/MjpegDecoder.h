@@ -0,0 +1,89 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+
+#ifndef MJPEGDECODER_H
+#define MJPEGDECODER_H
+
+#include <QImage>
+
+#include <stdint.h>
+
+#if defined(HAVE_LIBJPEG)
+#include <csetjmp>
+#include <cstdio>
+#include <jpeglib.h>
+#endif
+
+// Decodes MJPEG frames directly with libjpeg(-turbo). Every decoder keeps its
+// own decompressor and output images, so one instance must only be used by a
+// single thread at a time.
+class MjpegDecoder
+{
+public:
+    MjpegDecoder();
+    ~MjpegDecoder();
+
+    // This function decodes a JPEG frame
+    //
+    // Parameters:
+    // [in] (const uint8_t *) pBuffer - compressed frame
+    // [in] (uint32_t) length - length of the buffer
+    // [in] (uint32_t) scaleDenominator - 1, 2, 4 or 8, the image is reduced in the DCT domain
+    // [in] (const uint8_t *) toneTable - 256 entry display table applied to the
+    //                                    decoded lines, NULL for none
+    // [out] (QImage &) image - decoded image
+    //
+    // Returns:
+    // (int) - result of decoding, -1 for a corrupt frame
+    int Decode(const uint8_t *pBuffer, uint32_t length, uint32_t scaleDenominator,
+               const uint8_t *toneTable, QImage &image);
+
+private:
+    // Number of output images which are reused while the display does not
+    // hold a reference to them anymore
+    const static int IMAGE_POOL_SIZE = 3;
+
+    // This function returns a pooled image which is not referenced elsewhere
+    //
+    // Parameters:
+    // [in] (int) width
+    // [in] (int) height
+    // [in] (QImage::Format) format
+    //
+    // Returns:
+    // (QImage &) - image to decode into
+    QImage &GetPooledImage(int width, int height, QImage::Format format);
+
+    QImage m_ImagePool[IMAGE_POOL_SIZE];
+
+#if defined(HAVE_LIBJPEG)
+    struct ErrorManager
+    {
+        jpeg_error_mgr base;
+        jmp_buf jumpBuffer;
+    };
+
+    static void OnError(j_common_ptr cinfo);
+    static void OnMessage(j_common_ptr cinfo);
+
+    jpeg_decompress_struct m_Decompressor;
+    ErrorManager m_ErrorManager;
+#endif
+};
+
+#endif // MJPEGDECODER_H
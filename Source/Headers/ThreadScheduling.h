@@ -0,0 +1,126 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+
+#ifndef THREADSCHEDULING_H
+#define THREADSCHEDULING_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// Scheduling policy, priority and CPU affinity of the worker threads. The
+// settings come from the command line or a settings file and every thread
+// applies the settings of its role when it starts. Threads without settings
+// keep the default scheduling.
+namespace threadscheduling {
+
+enum ThreadRole
+{
+    ThreadRoleCapture       = 0,
+    ThreadRoleProcessing    = 1,
+    ThreadRoleEvents        = 2,
+    ThreadRoleLogger        = 3,
+    ThreadRoleCount         = 4
+};
+
+struct Settings
+{
+    // SCHED_OTHER, SCHED_FIFO or SCHED_RR
+    int policy;
+    // 1..99 for the real-time policies, 0 for SCHED_OTHER
+    int priority;
+    // CPUs the thread may run on, empty keeps the inherited affinity
+    std::vector<int> cpus;
+    bool bConfigured;
+};
+
+// This function parses the settings of one role, the format is
+// "policy[:priority][@cpulist]" with the policies other, fifo and rr and
+// a cpu list like "2,4-5". Examples: "fifo:80@2", "rr:10", "other@0-3"
+//
+// Parameters:
+// [in] (const std::string &) text
+// [out] (Settings &) settings
+//
+// Returns:
+// (int) - 0 if the text is valid, -1 otherwise
+int ParseSettings(const std::string &text, Settings &settings);
+// This function takes the options --sched-capture, --sched-processing,
+// --sched-events, --sched-logger (each "=<settings>") and --sched-file=<path>
+// from the command line, other arguments are ignored
+//
+// Parameters:
+// [in] (int) argc
+// [in] (char *[]) argv
+//
+// Returns:
+// (int) - 0 if all scheduling options were valid, -1 otherwise
+int ParseCommandLine(int argc, char *argv[]);
+// This function reads a settings file with lines "<role> = <settings>",
+// the roles are capture, processing, events and logger, '#' starts a comment
+//
+// Parameters:
+// [in] (const std::string &) fileName
+//
+// Returns:
+// (int) - 0 if the file was read without errors, -1 otherwise
+int LoadFile(const std::string &fileName);
+
+// This function sets the settings of a role for threads started afterwards
+//
+// Parameters:
+// [in] (ThreadRole) role
+// [in] (const Settings &) settings
+void SetSettings(ThreadRole role, const Settings &settings);
+// This function returns the settings of a role
+//
+// Parameters:
+// [in] (ThreadRole) role
+//
+// Returns:
+// (Settings) - requested settings, bConfigured is false if there are none
+Settings GetSettings(ThreadRole role);
+
+// This function applies the settings of a role to the calling thread and
+// keeps the resulting scheduling for the report. It does not log, so the
+// logger threads can use it as well.
+//
+// Parameters:
+// [in] (ThreadRole) role
+//
+// Returns:
+// (int) - 0 if the settings were applied or there are none, -1 otherwise
+int ApplyToCurrentThread(ThreadRole role);
+// This function measures how late the calling thread wakes up from
+// periodic sleeps, which shows the scheduling latency of its settings
+//
+// Parameters:
+// [in] (uint32_t) samples - number of sleeps
+// [in] (uint32_t) periodUs - length of a sleep in microseconds
+// [out] (double &) average - mean wake up delay in microseconds
+// [out] (double &) maximum - longest wake up delay in microseconds
+//
+// Returns:
+// (int) - 0 if the measurement succeeded, -1 otherwise
+int MeasureWakeupLatency(uint32_t samples, uint32_t periodUs, double &average, double &maximum);
+// This function logs the requested and the effective scheduling of all roles
+void ReportSettings();
+
+} // namespace threadscheduling
+
+#endif // THREADSCHEDULING_H
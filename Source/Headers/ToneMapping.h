@@ -0,0 +1,89 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+#ifndef TONEMAPPING_H
+#define TONEMAPPING_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace tonemapping
+{
+
+// Display only tone adjustment of the preview, the camera data is not changed
+struct Parameters
+{
+    // 1.0 is neutral, larger values brighten the shadows
+    double gamma;
+    // -100 to 100 percent, 0 is neutral
+    int contrast;
+    // -100 to 100 percent of the full scale, 0 is neutral
+    int brightness;
+};
+
+// This function returns the neutral parameters
+//
+// Returns:
+// (Parameters) - gamma 1.0, no contrast or brightness change
+Parameters GetDefaultParameters();
+// This function returns whether the parameters leave the image unchanged
+//
+// Parameters:
+// [in] (const Parameters &) parameters
+//
+// Returns:
+// (bool) - true for the neutral parameters
+bool IsIdentity(const Parameters &parameters);
+// This function compares two parameter sets
+//
+// Parameters:
+// [in] (const Parameters &) first
+// [in] (const Parameters &) second
+//
+// Returns:
+// (bool) - true when both result in the same table
+bool IsEqual(const Parameters &first, const Parameters &second);
+// This function applies the tone curve to a normalized value
+//
+// Parameters:
+// [in] (const Parameters &) parameters
+// [in] (double) value - 0.0 (black) to 1.0 (white)
+//
+// Returns:
+// (double) - mapped value, clamped to 0.0 to 1.0
+double ApplyCurve(const Parameters &parameters, double value);
+// This function creates the 256 entry table of the tone curve
+//
+// Parameters:
+// [in] (const Parameters &) parameters
+// [out] (std::vector<uint8_t> &) table - 256 entries
+void CreateTable(const Parameters &parameters, std::vector<uint8_t> &table);
+// This function maps one line of 8 bit pixels through the table. The
+// conversion kernels call it right after a line was stored, while it is
+// still in the cache
+//
+// Parameters:
+// [in] (const uint8_t *) table - 256 entries
+// [in/out] (uint8_t *) pixels - line to be mapped
+// [in] (uint32_t) width - pixels in the line
+// [in] (uint32_t) bytesPerPixel - 1 (gray), 3 (RGB) or 4 (RGB with padding
+//                                 byte, which is left unchanged)
+void ApplyTableToLine(const uint8_t *table, uint8_t *pixels, uint32_t width, uint32_t bytesPerPixel);
+
+} // namespace tonemapping
+
+#endif // TONEMAPPING_H
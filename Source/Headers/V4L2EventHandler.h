@@ -23,6 +23,10 @@
 #include <QVector>
 #include <linux/videodev2.h>
 
+#include <atomic>
+#include <map>
+#include <stdint.h>
+
 class V4L2EventHandler : public QThread {
     Q_OBJECT
 public:
@@ -37,6 +41,13 @@ public:
 
     // This function stops the event handling and the underlying thread
     void Stop();
+
+    // This function returns the number of control events read from the driver
+    uint64_t GetReceivedEventCount() const;
+
+    // This function returns the number of control changes passed on, events of
+    // the same control within one delivery interval are merged
+    uint64_t GetDeliveredEventCount() const;
 signals:
     // This signal is emitted when the value of a control has changed and contains the new value
     void ControlChanged(int cid,v4l2_event_ctrl value);
@@ -44,9 +55,20 @@ protected:
     // Function of the thread
     void run() override;
 private:
+    // This function reads all pending events of a file descriptor and keeps
+    // the latest state of each control
+    void DrainEvents(int fd);
+
+    // This function emits the collected control changes
+    void DeliverPendingControls();
+
     // File descriptor of the camera
     std::vector<int> m_Fds;
     int m_eventFd;
+    // Latest state of each changed control, only used by the thread
+    std::map<int, v4l2_event_ctrl> m_PendingControls;
+    std::atomic<uint64_t> m_ReceivedEventCount;
+    std::atomic<uint64_t> m_DeliveredEventCount;
 };
 
 #endif //V4L2EVENTREADER_H
@@ -26,7 +26,7 @@
 #include "AboutWidget.h"
 #include "ui_V4L2Viewer.h"
 #include "ControlsHolderWidget.h"
-#include "CustomGraphicsView.h"
+#include "VideoSurfaceWidget.h"
 
 #include <list>
 
@@ -74,14 +74,14 @@ private:
     QVector<QString> m_SubDevices;
     // The state of the camera (opened/closed)
     bool m_bIsOpen;
+    // Set while the image information of a newly opened camera is pending
+    bool m_bIsDescribedFromOpen;
     // The current streaming state
     bool m_bIsStreaming;
     // Timer to show the frames received from the frame observer
     QTimer m_FramesReceivedTimer;
-    // Graphics scene to show the image
-    QSharedPointer<QGraphicsScene> m_pScene;
-    // Pixel map for the graphics scene
-    QGraphicsPixmapItem *m_PixmapItem;
+    // Measures the time from opening the camera until its controls are listed
+    QElapsedTimer m_OpenTimer;
     // store radio buttons for blocking/non-blocking mode in a group
     QButtonGroup* m_BlockingModeRadioButtonGroup;
     // This value holds translations for the internationalization
@@ -90,6 +90,35 @@ private:
     AboutWidget *m_pAboutWidget;
     // The settings menu on the top bar
     QMenu *m_pSettingsMenu;
+    // The exclusive YCbCr conversion choices of the settings menu
+    QActionGroup *m_pYuvConversionGroup;
+    // The exclusive MJPEG preview scaling choices of the settings menu
+    QActionGroup *m_pMjpegScaleGroup;
+    // The settings menu switch for 16 bit previews of 10 and 12 bit formats
+    QAction *m_pHighBitDepthAction;
+    // The settings menu switch for the automatic window/level of 16 bit previews
+    QAction *m_pAutoWindowLevelAction;
+    // The settings menu switch for the data based alignment of 16 bit containers
+    QAction *m_pAutoShiftAction;
+    // The settings menu switch for the locked huge page arena of user pointer buffers
+    QAction *m_pBufferArenaAction;
+    // The settings menu switch for the buffer count which grows with the demand
+    QAction *m_pAdaptiveBufferCountAction;
+    // The exclusive cache maintenance choices of the capture buffers
+    QActionGroup *m_pBufferCacheGroup;
+    // The exclusive rate choices of the queued control writes
+    QActionGroup *m_pControlWriteRateGroup;
+    // The settings menu switch for preparing the buffers before they are queued
+    QAction *m_pPrepareBuffersAction;
+    // The settings menu switch for the dequeue to read latency benchmark
+    QAction *m_pReadLatencyAction;
+    // The settings menu switch for writing the raw frames to files
+    QAction *m_pFrameDumpAction;
+    // The dialog with the display tone curve, it is created on first use
+    QDialog *m_pToneMappingDialog;
+    QSlider *m_pDisplayGammaSlider;
+    QSlider *m_pDisplayContrastSlider;
+    QSlider *m_pDisplayBrightnessSlider;
     // This variable stores minimum exposure for the logarithmic slider calculations
     int64_t m_MinimumExposure;
     // This variable stores maximum exposure for the logarithmic slider calculations
@@ -115,6 +144,14 @@ private:
     // [in] (const QString &) deviceName
     // [in] (const QString &) info - information about device
     void UpdateCameraListBox(uint32_t cardNumber, uint64_t cameraID, const QString &deviceName, const QString &info);
+    // This function returns the row of a camera in the camera list
+    //
+    // Parameters:
+    // [in] (const QString &) deviceName - path of the device node
+    //
+    // Returns:
+    // (int) - row of the camera or -1
+    int FindCameraListRow(const QString &deviceName);
     // Update the viewer range
     void UpdateViewerLayout();
     // Update the zoom buttons
@@ -145,6 +182,14 @@ private:
     // [in] (uint32_t) height
     // [in] (uint32_t) bytesPerLine
     void StartStreaming(uint32_t pixelFormat, uint32_t payloadSize, uint32_t width, uint32_t height, uint32_t bytesPerLine);
+    // This function starts streaming with the format the camera is set to
+    void StartStreamingWithCurrentFormat();
+    // This function stops a running stream for a format change, the
+    // threads and the user pointer memory are kept for the restart
+    //
+    // Returns:
+    // (bool) - true if a stream was running and has to be restarted
+    bool SuspendStreaming();
 
     // This function overrides change event, in order to
     // update language when changed
@@ -156,7 +201,7 @@ private:
     // This function is called by master viewer window
     void RemoteClose();
     // This function reads all data from the camera and updates
-    // widgets
+    // widgets, the widgets are updated when the controls are described
     void GetImageInformation(const bool isCalledFromOnOpen = false);
     // Check if IO Read was checked and remove it when not capable
     void Check4IOReadAbility();
@@ -204,6 +249,31 @@ private slots:
 
     // The event handler to resize the image to fit to window
     void OnZoomFitButtonClicked();
+    // This slot function is called when the automatic window/level is toggled
+    //
+    // Parameters:
+    // [in] (bool) checked - new state of the menu entry
+    void OnAutoWindowLevelToggled(bool checked);
+    // This slot function passes a new window/level of the image view to the
+    // processing threads
+    //
+    // Parameters:
+    // [in] (bool) bAutoWindowLevel - state of the automatic window/level
+    // [in] (int) low - 16 bit value which is shown black
+    // [in] (int) high - 16 bit value which is shown white
+    void OnWindowLevelChanged(bool bAutoWindowLevel, int low, int high);
+    // This slot function opens the display tone curve dialog
+    void OnToneMappingClicked();
+    // This slot function passes the display tone curve sliders to the
+    // conversion and the image view
+    void OnToneMappingChanged();
+    // This slot function restores the neutral display tone curve
+    void OnToneMappingReset();
+    // This slot function measures reading all controls one by one
+    // against reading them as transaction
+    void OnCompareControlReadTimes();
+    // This slot function sets the rate of the queued control writes
+    void OnControlWriteRateChanged(QAction *action);
     // The slot function is called when the zoom in buton is clicked
     void OnZoomInButtonClicked();
     // The slot function is called when the zoom out buton is clicked
@@ -213,7 +283,7 @@ private slots:
     // The event handler to show the frames received
     void OnUpdateFramesReceived();
     // The event handler to show the processed frame
-    void OnFrameReady(const QImage &image, const unsigned long long &frameId);
+    void OnFrameReady(const QImage &image, const QImage &displayImage, const unsigned long long &frameId);
     // The event handler to show the processed frame ID
     void OnFrameID(const unsigned long long &frameId);
     // The event handler to open a camera on double click event
@@ -382,6 +452,23 @@ private slots:
     // [in] (QString) unit - unit of the control
     // [in] (bool) bIsReadOnly - state which indicates whether control is readonly
     void PassListDataToEnumerationWidget(int32_t id, int32_t value, QList<int64_t> list, QString name, QString unit, bool bIsReadOnly);
+    // This slot function is called when the values of all controls were passed
+    //
+    // Parameters:
+    // [in] (int32_t) controlCount - number of the passed controls
+    void OnControlValuesRead(int32_t controlCount);
+    // This slot function is called when the descriptions of the controls are
+    // known, it fills the image information requested by GetImageInformation
+    //
+    // Parameters:
+    // [in] (int32_t) controlCount - number of the described controls
+    void OnControlsDescribed(int32_t controlCount);
+    // This slot function is called when the background sync found the device state changed
+    //
+    // Parameters:
+    // [in] (const DeviceState &) state - device state snapshot
+    // [in] (uint32_t) changedMask - DeviceStateField bits of the fields that changed
+    void OnDeviceStateChanged(const DeviceState &state, uint32_t changedMask);
 
     void OnUpdateZoomLabel();
     // This slot function is called when the dock widget is docked or undocked
@@ -0,0 +1,225 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+#ifndef VIDEOSURFACEWIDGET_H
+#define VIDEOSURFACEWIDGET_H
+
+#include <QAbstractScrollArea>
+#include <QImage>
+#include <QPoint>
+
+#include "ToneMapping.h"
+
+#include <stdint.h>
+#include <vector>
+
+// Video surface which paints the converted frame directly onto the viewport.
+// The widget backing store provides the double buffering, a new frame of
+// unchanged geometry only invalidates the visible image area. Images with
+// more than 8 bit are kept as they are and shown through a window/level table.
+class VideoSurfaceWidget : public QAbstractScrollArea
+{
+    Q_OBJECT
+public:
+    VideoSurfaceWidget(QWidget *parent);
+    // This function sets the image which is shown on the surface. The image is
+    // implicitly shared, so no pixel data is copied here. High bit depth images
+    // are mapped with the window/level of the widget before the next paint
+    //
+    // Parameters:
+    // [in] (const QImage &) image - image to be shown
+    void SetImage(const QImage &image);
+    // This function sets a streamed frame together with its display image,
+    // which the processing thread already mapped with the window/level
+    //
+    // Parameters:
+    // [in] (const QImage &) image - image with its full bit depth
+    // [in] (const QImage &) displayImage - 8 bit image which is painted
+    void SetImage(const QImage &image, const QImage &displayImage);
+    // This function returns the currently shown image with its full bit depth
+    //
+    // Returns:
+    // (QImage) - shown image
+    QImage GetImage() const;
+    // This function sets whether the window/level of high bit depth images
+    // follows the content of every frame
+    //
+    // Parameters:
+    // [in] (bool) state - new state value to be passed
+    void SetAutoWindowLevel(bool state);
+    // This function sets a fixed window/level for high bit depth images
+    //
+    // Parameters:
+    // [in] (uint16_t) low - 16 bit value which is shown black
+    // [in] (uint16_t) high - 16 bit value which is shown white
+    void SetWindowLevel(uint16_t low, uint16_t high);
+    // This function sets the display tone curve of high bit depth images, it
+    // is folded into the window/level table. 8 bit images get it in the conversion
+    //
+    // Parameters:
+    // [in] (const tonemapping::Parameters &) toneMapping
+    void SetToneMapping(const tonemapping::Parameters &toneMapping);
+    // This function restore scale factor on the image area
+    void SetScaleFactorToDefault();
+    // This function returns current value of the scale factor
+    //
+    // Returns:
+    // (double) - scale factor
+    double GetScaleFactorValue();
+    // This function scales the image to fit the area boundaries
+    //
+    // Returns:
+    // (double) - scale factor which fits the image into the view
+    double FitToView();
+    // This function performs zoom in on the image view
+    void OnZoomIn();
+    // This function performs zoom out on the image view
+    void OnZoomOut();
+    // This function sets whether zoom is allowed or not. It is mostly used
+    // when camera is being opened or closed
+    //
+    // Parameters:
+    // [in] (bool) state - new state value to be passed
+    void SetZoomAllowed(bool state);
+    // This function returns the mean paint time since the last reset
+    //
+    // Returns:
+    // (double) - paint time in milliseconds
+    double GetAveragePaintTime();
+    // This function returns the longest paint time since the last reset
+    //
+    // Returns:
+    // (double) - paint time in milliseconds
+    double GetMaximumPaintTime();
+    // This function resets the paint time statistics
+    void ResetPaintTime();
+
+    // This static attribute contains maximum zoom in value
+    static double MAX_ZOOM_IN;
+    // This static attribute contains maximum zoom out value
+    static double MAX_ZOOM_OUT;
+    // This static attribute contains increment step
+    static double ZOOM_INCREMENT;
+
+signals:
+    // This signal sends information about updating label which shows
+    // zoom in percentages
+    void UpdateZoomLabel();
+    // This signal reports that the automatic window/level was switched
+    //
+    // Parameters:
+    // [in] (bool) state - new state of the automatic window/level
+    void AutoWindowLevelChanged(bool state);
+    // This signal reports a new window/level, so the following frames are
+    // mapped with it
+    //
+    // Parameters:
+    // [in] (bool) bAutoWindowLevel - state of the automatic window/level
+    // [in] (int) low - 16 bit value which is shown black
+    // [in] (int) high - 16 bit value which is shown white
+    void WindowLevelChanged(bool bAutoWindowLevel, int low, int high);
+
+protected:
+    // This function paints the damaged part of the viewport
+    //
+    // Parameters:
+    // [in] (QPaintEvent *) event - event to be passed
+    virtual void paintEvent(QPaintEvent *event) override;
+    // This function updates the scroll ranges to the new viewport size
+    //
+    // Parameters:
+    // [in] (QResizeEvent *) event - event to be passed
+    virtual void resizeEvent(QResizeEvent *event) override;
+    // This function repaints the viewport after the scroll bars were moved
+    //
+    // Parameters:
+    // [in] (int) dx - horizontal offset
+    // [in] (int) dy - vertical offset
+    virtual void scrollContentsBy(int dx, int dy) override;
+    // This function is overrided, and it performs wheel event in order
+    // to perform only zooming around the cursor, not moving with scroll bars
+    //
+    // Parameters:
+    // [in] (QWheelEvent *) event - event to be passed
+    virtual void wheelEvent(QWheelEvent *event) override;
+    // This function is overrided, and it performs press event
+    // in order to show tooltip with pixel data and to start panning
+    //
+    // Parameters:
+    // [in] (QMouseEvent *) event - event to be passed
+    virtual void mousePressEvent(QMouseEvent *event) override;
+    // This function pans the image while the left button is held and
+    // changes the window/level while the right button is held
+    //
+    // Parameters:
+    // [in] (QMouseEvent *) event - event to be passed
+    virtual void mouseMoveEvent(QMouseEvent *event) override;
+    // This function finishes panning and window/level changes
+    //
+    // Parameters:
+    // [in] (QMouseEvent *) event - event to be passed
+    virtual void mouseReleaseEvent(QMouseEvent *event) override;
+
+private:
+    // This function returns the viewport rectangle covered by the scaled image
+    //
+    // Returns:
+    // (QRect) - image rectangle in viewport coordinates
+    QRect GetImageRect() const;
+    // This function maps a viewport position to image coordinates
+    //
+    // Parameters:
+    // [in] (const QPoint &) position - position in viewport coordinates
+    //
+    // Returns:
+    // (QPointF) - position in image coordinates
+    QPointF MapToImage(const QPoint &position) const;
+    // This function sets the scroll bar ranges for the current scale
+    void UpdateScrollBars();
+    // This function sets a new scale factor and keeps the image point
+    // below the anchor at the same viewport position
+    //
+    // Parameters:
+    // [in] (double) scaleFactor - new scale factor
+    // [in] (const QPoint &) anchor - position in viewport coordinates
+    void ZoomAt(double scaleFactor, const QPoint &anchor);
+    // This function maps the current image to the 8 bit display image when
+    // the image or the window/level changed since the last paint
+    void UpdateDisplayImage();
+    // This function sets the window to the value range of the current image
+    void UpdateAutoWindowLevel();
+
+    QImage m_Image;
+    QImage m_DisplayImage;
+    bool m_bDisplayImageDirty;
+    std::vector<uint8_t> m_WindowLevelTable;
+    bool m_bAutoWindowLevel;
+    uint16_t m_WindowLow;
+    uint16_t m_WindowHigh;
+    tonemapping::Parameters m_ToneMapping;
+    bool m_bIsWindowing;
+    QPoint m_LastWindowPosition;
+    double m_dScaleFactor;
+    bool m_bIsZoomAllowed;
+    bool m_bIsPanning;
+    QPoint m_LastPanPosition;
+    double m_dPaintTimeSum;
+    double m_dPaintTimeMax;
+    unsigned int m_PaintCount;
+};
+
+#endif // VIDEOSURFACEWIDGET_H
@@ -0,0 +1,184 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+#ifndef YUVCONVERSION_H
+#define YUVCONVERSION_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace yuvconversion
+{
+
+// Matrix which is used to convert YCbCr to RGB
+enum ColorMatrix
+{
+    ColorMatrixAuto             = 0, // as reported by the driver
+    ColorMatrixApproximate      = 1, // legacy multiplication free conversion
+    ColorMatrixBT601            = 2,
+    ColorMatrixBT709            = 3
+};
+
+// Quantization range of the YCbCr data
+enum ColorRange
+{
+    ColorRangeAuto              = 0, // as reported by the driver
+    ColorRangeLimited           = 1,
+    ColorRangeFull              = 2
+};
+
+// Fixed point coefficients of a YCbCr to RGB conversion. The luma term is
+// the high half of (Y * 257) * yGain minus yBias, the chroma terms are Q6.
+// All terms are scaled by 64, the sum is rounded and shifted right by 6.
+struct Coefficients
+{
+    uint16_t yGain;
+    int16_t  yBias;
+    int16_t  rv;
+    int16_t  gu;
+    int16_t  gv;
+    int16_t  bu;
+};
+
+// This function calculates the fixed point coefficients for a matrix and range
+//
+// Parameters:
+// [in] (ColorMatrix) colorMatrix - BT.601 or BT.709
+// [in] (ColorRange) colorRange - limited or full range
+// [out] (Coefficients &) coefficients - calculated coefficients
+//
+// Returns:
+// (int) - result of operation, -1 for the approximate or an unresolved matrix
+int GetCoefficients(ColorMatrix colorMatrix, ColorRange colorRange, Coefficients &coefficients);
+// This function maps the V4L2 format colorimetry to a color matrix
+//
+// Parameters:
+// [in] (uint32_t) colorspace - v4l2_colorspace of the format
+// [in] (uint32_t) ycbcrEncoding - v4l2_ycbcr_encoding of the format
+//
+// Returns:
+// (ColorMatrix) - BT.601 or BT.709
+ColorMatrix ResolveColorMatrix(uint32_t colorspace, uint32_t ycbcrEncoding);
+// This function maps the V4L2 format quantization to a color range
+//
+// Parameters:
+// [in] (uint32_t) colorspace - v4l2_colorspace of the format
+// [in] (uint32_t) quantization - v4l2_quantization of the format
+//
+// Returns:
+// (ColorRange) - limited or full range
+ColorRange ResolveColorRange(uint32_t colorspace, uint32_t quantization);
+
+// These functions convert packed 4:2:2 frames to QImage::Format_RGB32
+//
+// Parameters:
+// [in] (const Coefficients &) coefficients
+// [in] (const uint8_t *) src - source frame
+// [in] (uint32_t) srcStride - bytes per source line
+// [out] (uint8_t *) dst - destination frame
+// [in] (uint32_t) dstStride - bytes per destination line
+// [in] (uint32_t) width - width of the frame
+// [in] (uint32_t) height - height of the frame
+// [in] (const uint8_t *) toneTable - 256 entry display table applied to every
+//                                    stored line, NULL for none
+void ConvertYUYVToRGB32(const Coefficients &coefficients, const uint8_t *src, uint32_t srcStride,
+                        uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                        const uint8_t *toneTable = NULL);
+void ConvertYVYUToRGB32(const Coefficients &coefficients, const uint8_t *src, uint32_t srcStride,
+                        uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                        const uint8_t *toneTable = NULL);
+void ConvertUYVYToRGB32(const Coefficients &coefficients, const uint8_t *src, uint32_t srcStride,
+                        uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                        const uint8_t *toneTable = NULL);
+void ConvertVYUYToRGB32(const Coefficients &coefficients, const uint8_t *src, uint32_t srcStride,
+                        uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                        const uint8_t *toneTable = NULL);
+
+// This function converts a planar 4:2:0 frame to QImage::Format_RGB32
+//
+// Parameters:
+// [in] (const Coefficients &) coefficients
+// [in] (const uint8_t *) srcY - luma plane
+// [in] (uint32_t) strideY - bytes per luma line
+// [in] (const uint8_t *) srcU - Cb plane
+// [in] (const uint8_t *) srcV - Cr plane
+// [in] (uint32_t) strideUV - bytes per chroma line
+// [out] (uint8_t *) dst - destination frame
+// [in] (uint32_t) dstStride - bytes per destination line
+// [in] (uint32_t) width - width of the frame
+// [in] (uint32_t) height - height of the frame
+// [in] (const uint8_t *) toneTable - 256 entry display table, NULL for none
+void ConvertPlanar420ToRGB32(const Coefficients &coefficients,
+                             const uint8_t *srcY, uint32_t strideY,
+                             const uint8_t *srcU, const uint8_t *srcV, uint32_t strideUV,
+                             uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                             const uint8_t *toneTable = NULL);
+
+// This function converts a semi-planar frame (NV12/NV21 for 4:2:0,
+// NV16/NV61 for 4:2:2) to QImage::Format_RGB32
+//
+// Parameters:
+// [in] (const Coefficients &) coefficients
+// [in] (const uint8_t *) srcY - luma plane
+// [in] (uint32_t) strideY - bytes per luma line
+// [in] (const uint8_t *) srcUV - interleaved chroma plane
+// [in] (uint32_t) strideUV - bytes per chroma line
+// [in] (bool) crFirst - true when Cr precedes Cb (NV21/NV61)
+// [in] (bool) verticalSubsampling - true for 4:2:0, one chroma line per two luma lines
+// [out] (uint8_t *) dst - destination frame
+// [in] (uint32_t) dstStride - bytes per destination line
+// [in] (uint32_t) width - width of the frame
+// [in] (uint32_t) height - height of the frame
+// [in] (const uint8_t *) toneTable - 256 entry display table, NULL for none
+void ConvertSemiPlanarToRGB32(const Coefficients &coefficients,
+                              const uint8_t *srcY, uint32_t strideY,
+                              const uint8_t *srcUV, uint32_t strideUV,
+                              bool crFirst, bool verticalSubsampling,
+                              uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                              const uint8_t *toneTable = NULL);
+
+// This function converts a single pixel with floating point math, it is
+// the reference for the fixed point kernels
+//
+// Parameters:
+// [in] (ColorMatrix) colorMatrix
+// [in] (ColorRange) colorRange
+// [in] (uint8_t) y, u, v - source pixel
+// [out] (uint8_t &) r, g, b - converted pixel
+void ReferenceConvertPixel(ColorMatrix colorMatrix, ColorRange colorRange,
+                           uint8_t y, uint8_t u, uint8_t v,
+                           uint8_t &r, uint8_t &g, uint8_t &b);
+// This function runs the YUYV, UYVY and NV12 kernels over a sweep of the
+// YCbCr cube and compares them against the floating point reference
+//
+// Parameters:
+// [in] (ColorMatrix) colorMatrix
+// [in] (ColorRange) colorRange
+// [out] (int &) maxDeviation - largest per channel difference
+//
+// Returns:
+// (int) - 0 if the deviation is within the allowed tolerance, -1 otherwise
+int ValidateKernels(ColorMatrix colorMatrix, ColorRange colorRange, int &maxDeviation);
+// This function returns the name of the compiled in kernel variant
+//
+// Returns:
+// (const char *) - "SSE2", "NEON" or "scalar"
+const char *GetKernelName();
+
+} // namespace yuvconversion
+
+#endif // YUVCONVERSION_H
@@ -18,33 +18,99 @@
 
 #include "LocalMutexLockGuard.h"
 #include "Logger.h"
+#include "ThreadScheduling.h"
 
+#include <errno.h>
+#include <fcntl.h>
 #include <iomanip>
 #include <sstream>
+#include <stdlib.h>
 #include <unistd.h>
 
 #define MIN_DURATION_BETWEEN_LOG_WRITES_MS             3
 #define ALLOWED_DURATION_FOR_LOG_FILE_COMPLETION_MS   10
+// Entries of the dump queue and of the buffer queue each
+#define DUMP_QUEUE_CAPACITY                           16
+// Bytes copied dumps and buffers may occupy together
+#define DEFAULT_DUMP_COPY_BUDGET                      (64 * 1024 * 1024)
 
 namespace base {
 
 void BufferThreadProc(BaseLogger *pBaseLogger)
 {
+    threadscheduling::ApplyToCurrentThread(threadscheduling::ThreadRoleLogger);
     pBaseLogger->BufThreadProc();
 }
 
 void DumpThreadProc(BaseLogger *pBaseLogger)
 {
+    threadscheduling::ApplyToCurrentThread(threadscheduling::ThreadRoleLogger);
     pBaseLogger->DmpThreadProc();
 }
 
 void LoggerThreadProc(BaseLogger *pBaseLogger)
 {
+    threadscheduling::ApplyToCurrentThread(threadscheduling::ThreadRoleLogger);
     pBaseLogger->ThreadProc();
 }
 
+DumpQueue::DumpQueue(uint32_t capacity)
+    : m_Entries(capacity)
+    , m_Head(0)
+    , m_Count(0)
+{
+}
+
+bool DumpQueue::Push(DumpEntry &entry)
+{
+    LocalMutexLockGuard guard(m_Mutex);
+
+    if (m_Count == m_Entries.size())
+    {
+        return false;
+    }
+
+    std::swap(m_Entries[(m_Head + m_Count) % m_Entries.size()], entry);
+    m_Count++;
+
+    return true;
+}
+
+bool DumpQueue::Pop(DumpEntry &entry)
+{
+    LocalMutexLockGuard guard(m_Mutex);
+
+    if (0 == m_Count)
+    {
+        return false;
+    }
+
+    std::swap(m_Entries[m_Head], entry);
+    m_Head = (m_Head + 1) % m_Entries.size();
+    m_Count--;
+
+    return true;
+}
+
+uint32_t DumpQueue::GetSize()
+{
+    LocalMutexLockGuard guard(m_Mutex);
+
+    return m_Count;
+}
+
 BaseLogger::BaseLogger(const std::string &fileName, bool bAppend)
     : m_pFile(NULL)
+    , m_DumpQueue(DUMP_QUEUE_CAPACITY)
+    , m_BufferQueue(DUMP_QUEUE_CAPACITY)
+    , m_CopyBudget(DEFAULT_DUMP_COPY_BUDGET)
+    , m_CopiedBytesInUse(0)
+    , m_WrittenCount(0)
+    , m_WrittenBytes(0)
+    , m_DroppedCount(0)
+    , m_FailedCount(0)
+    , m_ReportedDroppedCount(0)
+    , m_PreviousBufferFile(-1)
     , m_bThreadRunning(true)
     , m_bThreadStopped(false)
     , m_bDumpThreadRunning(true)
@@ -162,80 +228,286 @@ void BaseLogger::LogDump(const std::string &message, uint8_t *buffer, uint32_t l
 {
     if(m_bDumpThreadRunning)
     {
-        LocalMutexLockGuard guard(m_DumpMutex);
+        QueueCopy(m_DumpQueue, message, buffer, length);
+    }
+}
 
-        Packet* pPacket = new Packet;
-        pPacket->buffer.resize(length);
-        memcpy(&pPacket->buffer[0], buffer, length);
-        pPacket->length = length;
-        pPacket->message = message;
+void BaseLogger::LogBuffer(const std::string &filename, uint8_t *buffer, uint32_t length)
+{
+    if(m_bBufferThreadRunning)
+    {
+        QueueCopy(m_BufferQueue, filename, buffer, length);
+    }
+}
 
-        m_DumpQueue.push(pPacket);
+bool BaseLogger::LogBuffer(const std::string &filename, const struct iovec *pPlanes, uint32_t planeCount,
+                           DumpReleaseFunction releaseFunction, void *pReleaseContext)
+{
+    if(!m_bBufferThreadRunning || 0 == planeCount || planeCount > DUMP_MAX_PLANES)
+    {
+        m_DroppedCount++;
+        return false;
+    }
+
+    DumpEntry entry = DumpEntry();
+    entry.text = filename;
+    entry.planeCount = planeCount;
+    entry.length = 0;
+    for(uint32_t i = 0; i < planeCount; i++)
+    {
+        entry.planes[i] = pPlanes[i];
+        entry.length += pPlanes[i].iov_len;
     }
+    entry.releaseFunction = releaseFunction;
+    entry.pReleaseContext = pReleaseContext;
+
+    if(!m_BufferQueue.Push(entry))
+    {
+        m_DroppedCount++;
+        return false;
+    }
+
+    return true;
 }
 
-void BaseLogger::LogBuffer(const std::string &filename, uint8_t *buffer, uint32_t length)
+void BaseLogger::QueueCopy(DumpQueue &queue, const std::string &text, uint8_t *buffer, uint32_t length)
 {
-    if(m_bDumpThreadRunning)
+    // reserve the bytes first, the budget is shared by all callers
+    uint64_t inUse = m_CopiedBytesInUse.load();
+    do
+    {
+        if(NULL == buffer || inUse + length > m_CopyBudget)
+        {
+            m_DroppedCount++;
+            return;
+        }
+    } while(!m_CopiedBytesInUse.compare_exchange_weak(inUse, inUse + length));
+
+    DumpEntry entry = DumpEntry();
+    entry.pCopy = static_cast<uint8_t*>(malloc(length > 0 ? length : 1));
+    if(NULL == entry.pCopy)
     {
-        LocalMutexLockGuard guard(m_DumpMutex);
+        m_CopiedBytesInUse -= length;
+        m_DroppedCount++;
+        return;
+    }
 
-        Packet* pPacket = new Packet;
-        pPacket->buffer.resize(length);
-        memcpy(&pPacket->buffer[0], buffer, length);
-        pPacket->length = length;
-        pPacket->filename = filename;
+    memcpy(entry.pCopy, buffer, length);
+    entry.text = text;
+    entry.planes[0].iov_base = entry.pCopy;
+    entry.planes[0].iov_len = length;
+    entry.planeCount = 1;
+    entry.length = length;
 
-        m_BufferQueue.push(pPacket);
+    if(!queue.Push(entry))
+    {
+        // entry holds the copy again if the queue was full
+        ReleaseEntry(entry);
+        m_DroppedCount++;
     }
 }
 
-void BaseLogger::ThreadProc()
+void BaseLogger::ReleaseEntry(DumpEntry &entry)
 {
-    PrintStartMessage();
+    if(NULL != entry.pCopy)
+    {
+        free(entry.pCopy);
+        entry.pCopy = NULL;
+        m_CopiedBytesInUse -= entry.length;
+    }
+    else if(NULL != entry.releaseFunction)
+    {
+        entry.releaseFunction(entry.pReleaseContext);
+    }
 
-    while(m_bThreadRunning)
+    entry.releaseFunction = NULL;
+    entry.pReleaseContext = NULL;
+    entry.planeCount = 0;
+    entry.length = 0;
+}
+
+void BaseLogger::WriteBufferEntry(DumpEntry &entry)
+{
+    int fileDescriptor = open(entry.text.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    bool bResult = (fileDescriptor >= 0);
+
+    // all planes go to the file with one call, partial writes are continued
+    struct iovec *pPlanes = entry.planes;
+    uint32_t planeCount = entry.planeCount;
+    while(bResult && planeCount > 0)
     {
-        if(NULL != m_pFile && m_OutputQueue.size() > 0)
+        ssize_t written = writev(fileDescriptor, pPlanes, planeCount);
+        if(written < 0)
         {
-            std::string text;
-            {
-                LocalMutexLockGuard guard(m_Mutex);
+            bResult = (EINTR == errno);
+            continue;
+        }
 
-                text = m_OutputQueue.front();
-                m_OutputQueue.pop();
-            }
-            fprintf(m_pFile, "%s\n", text.c_str());
-            fflush(m_pFile);
+        while(planeCount > 0 && static_cast<size_t>(written) >= pPlanes->iov_len)
+        {
+            written -= pPlanes->iov_len;
+            pPlanes++;
+            planeCount--;
+        }
+        if(planeCount > 0)
+        {
+            pPlanes->iov_base = static_cast<uint8_t*>(pPlanes->iov_base) + written;
+            pPlanes->iov_len -= written;
         }
+    }
+
+    // the write back runs while the next buffer is queued, waiting for it
+    // here would stall the queue for the whole disk latency of every file
+    FinishPreviousBufferFile();
+    if(fileDescriptor >= 0)
+    {
+        if(bResult)
+        {
+            sync_file_range(fileDescriptor, 0, 0, SYNC_FILE_RANGE_WRITE);
+            m_PreviousBufferFile = fileDescriptor;
+        }
+        else
+        {
+            close(fileDescriptor);
+        }
+    }
+
+    if(bResult)
+    {
+        m_WrittenCount++;
+        m_WrittenBytes += entry.length;
+    }
+    else
+    {
+        m_FailedCount++;
+    }
+
+    ReleaseEntry(entry);
+}
+
+void BaseLogger::FinishPreviousBufferFile()
+{
+    if(m_PreviousBufferFile < 0)
+    {
+        return;
+    }
+
+    // the frames are not read again, keep the page cache small. Only pages
+    // which are written back can be dropped
+    sync_file_range(m_PreviousBufferFile, 0, 0,
+                    SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE | SYNC_FILE_RANGE_WAIT_AFTER);
+    posix_fadvise(m_PreviousBufferFile, 0, 0, POSIX_FADV_DONTNEED);
+    close(m_PreviousBufferFile);
+    m_PreviousBufferFile = -1;
+}
+
+void BaseLogger::WriteDumpEntry(DumpEntry &entry)
+{
+    Log(entry.text + ConvertPacketToString(entry.pCopy, entry.length));
+
+    m_WrittenCount++;
+    m_WrittenBytes += entry.length;
+
+    ReleaseEntry(entry);
+}
+
+void BaseLogger::ReportDroppedDumps()
+{
+    uint64_t droppedCount = m_DroppedCount.load();
+    if(droppedCount != m_ReportedDroppedCount)
+    {
+        std::stringstream text;
+        text << "***** " << droppedCount - m_ReportedDroppedCount << " dumps dropped, the dump queues or the copy budget were full";
+        Log(text.str());
+        m_ReportedDroppedCount = droppedCount;
+    }
+}
+
+void BaseLogger::GetDumpStatistics(DumpStatistics &statistics)
+{
+    statistics.writtenCount = m_WrittenCount.load();
+    statistics.writtenBytes = m_WrittenBytes.load();
+    statistics.droppedCount = m_DroppedCount.load();
+    statistics.failedCount = m_FailedCount.load();
+    statistics.copiedBytesInUse = m_CopiedBytesInUse.load();
+    statistics.copyBudget = m_CopyBudget;
+    statistics.pendingCount = m_DumpQueue.GetSize() + m_BufferQueue.GetSize();
+}
+
+void BaseLogger::ThreadProc()
+{
+    PrintStartMessage();
+
+    // the records are stamped with CPU ticks, they are converted while formatting
+    BinaryLog::CalibrateTimestamp();
+
+    while(m_bThreadRunning)
+    {
+        WritePendingMessages();
 
         usleep(MIN_DURATION_BETWEEN_LOG_WRITES_MS * 1000);
     }
 
+    WritePendingMessages();
     PrintExitMessage();
 
     m_bThreadStopped = true;
 }
 
+void BaseLogger::WritePendingMessages()
+{
+    uint32_t droppedCount = 0;
+    BinaryLog::CollectRecords(m_Records, droppedCount);
+
+    std::queue<std::string> outputQueue;
+    {
+        LocalMutexLockGuard guard(m_Mutex);
+        outputQueue.swap(m_OutputQueue);
+    }
+
+    if(NULL == m_pFile)
+    {
+        return;
+    }
+
+    bool bWritten = !m_Records.empty() || droppedCount > 0 || !outputQueue.empty();
+    for(size_t i = 0; i < m_Records.size(); i++)
+    {
+        BinaryLog::FormatRecord(m_Records[i], m_Line);
+        fprintf(m_pFile, "%s\n", m_Line.c_str());
+    }
+
+    if(droppedCount > 0)
+    {
+        fprintf(m_pFile, "%s: %u messages dropped, the log rings were full\n", ConvertTimeStampToString().c_str(), droppedCount);
+    }
+
+    while(outputQueue.size() > 0)
+    {
+        fprintf(m_pFile, "%s\n", outputQueue.front().c_str());
+        outputQueue.pop();
+    }
+
+    // one flush per cycle instead of one per message
+    if(bWritten)
+    {
+        fflush(m_pFile);
+    }
+}
+
 void BaseLogger::DmpThreadProc()
 {
+    DumpEntry entry = DumpEntry();
+
     while(m_bDumpThreadRunning)
     {
-        if(m_DumpQueue.size() > 0)
+        while(m_DumpQueue.Pop(entry))
         {
-            std::string text;
-            Packet* pPacket;
-            {
-                LocalMutexLockGuard guard(m_DumpMutex);
-
-                pPacket = m_DumpQueue.front();
-                m_DumpQueue.pop();
-            }
-            text = ConvertPacketToString(&pPacket->buffer[0], pPacket->length);
-            Log(pPacket->message + text);
-            delete pPacket;
+            WriteDumpEntry(entry);
         }
 
+        ReportDroppedDumps();
+
         usleep(MIN_DURATION_BETWEEN_LOG_WRITES_MS * 1000);
     }
 
@@ -246,28 +518,14 @@ void BaseLogger::DmpThreadProc()
 
 void BaseLogger::BufThreadProc()
 {
+    DumpEntry entry = DumpEntry();
+
     while(m_bBufferThreadRunning)
     {
-        if(m_BufferQueue.size() > 0)
+        // drain everything, a slow disk fills the queue and drops new buffers
+        while(m_BufferQueue.Pop(entry))
         {
-            Packet* pPacket;
-
-            {
-                LocalMutexLockGuard guard(m_BufferMutex);
-                pPacket = m_BufferQueue.front();
-                m_BufferQueue.pop();
-            }
-
-            FILE *localFile = fopen(pPacket->filename.c_str(), "wb");
-
-            if(NULL != localFile)
-            {
-                fwrite(&pPacket->buffer[0], 1, pPacket->length, localFile);
-
-                fflush(localFile);
-                fclose(localFile);
-            }
-            delete pPacket;
+            WriteBufferEntry(entry);
         }
 
         usleep(MIN_DURATION_BETWEEN_LOG_WRITES_MS * 1000);
@@ -326,46 +584,40 @@ void BaseLogger::PrintDumpExitMessage()
         return;
     }
 
-    text << ConvertTimeStampToString() << ": ***** Dump logger exiting, " << m_DumpQueue.size() << " dumps left";
+    text << ConvertTimeStampToString() << ": ***** Dump logger exiting, " << m_DumpQueue.GetSize() << " dumps left";
     fprintf(m_pFile, "%s\n", text.str().c_str());
     fflush(m_pFile);
 
-    while(m_DumpQueue.size() > 0)
+    DumpEntry entry = DumpEntry();
+    while(m_DumpQueue.Pop(entry))
     {
-        std::string out;
-        Packet* pPacket = m_DumpQueue.front();
-        m_DumpQueue.pop();
-        out = ConvertPacketToString(&pPacket->buffer[0], pPacket->length);
-        delete pPacket;
+        std::string out = ConvertPacketToString(entry.pCopy, entry.length);
+        ReleaseEntry(entry);
 
         fprintf(m_pFile, "%s\n", out.c_str());
         fflush(m_pFile);
     }
 
+    DumpStatistics statistics;
+    GetDumpStatistics(statistics);
     text.str("");
-    text << ConvertTimeStampToString() << ": ***** Dump logger stopped. *****";
+    text << ConvertTimeStampToString() << ": ***** Dump logger stopped, " << statistics.writtenCount << " written, "
+         << statistics.droppedCount << " dropped, " << statistics.failedCount << " failed *****";
     fprintf(m_pFile, "%s\n", text.str().c_str());
     fflush(m_pFile);
 }
 
 void BaseLogger::PrintBufferExitMessage()
 {
-    while(m_BufferQueue.size() > 0)
-    {
-        Packet* pPacket = m_BufferQueue.front();
-        FILE *localFile = fopen(pPacket->filename.c_str(), "wb");
+    DumpEntry entry = DumpEntry();
 
-        m_BufferQueue.pop();
-
-        if(NULL != localFile)
-        {
-            fwrite(&pPacket->buffer[0], 1, pPacket->length, localFile);
-
-            fflush(localFile);
-            fclose(localFile);
-        }
-        delete pPacket;
+    // referenced buffers have to be written and released before the owners go away
+    while(m_BufferQueue.Pop(entry))
+    {
+        WriteBufferEntry(entry);
     }
+
+    FinishPreviousBufferFile();
 }
 
 } // namespace base
@@ -0,0 +1,491 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+
+
+#include "BinaryLog.h"
+#include "LocalMutexLockGuard.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+// duration of the tick rate measurement of the logger thread
+#define TIMESTAMP_CALIBRATION_US    20000
+
+namespace base {
+
+namespace {
+
+// value and kind of one packed argument
+struct LogArgument
+{
+    LogArgumentType type;
+    uint64_t        value;
+    std::string     text;
+};
+
+// all rings which may still hold records
+LocalMutex &GetRegistryMutex()
+{
+    static LocalMutex registryMutex;
+    return registryMutex;
+}
+
+std::vector<LogRing*> &GetRegistry()
+{
+    static std::vector<LogRing*> registry;
+    return registry;
+}
+
+// the ring is handed to the logger thread when its thread exits
+struct ThreadRingHolder
+{
+    ThreadRingHolder()
+        : pRing(new LogRing)
+    {
+        LocalMutexLockGuard guard(GetRegistryMutex());
+        GetRegistry().push_back(pRing);
+    }
+    ~ThreadRingHolder()
+    {
+        pRing->SetOrphaned();
+    }
+
+    LogRing *pRing;
+};
+
+// conversion of ticks into the real time, written once by the logger thread
+uint64_t g_ReferenceTicks = 0;
+uint64_t g_ReferenceRealTime = 0;
+double g_NanosecondsPerTick = 1.0;
+
+uint64_t ReadRealTime()
+{
+    timespec time;
+    clock_gettime(CLOCK_REALTIME, &time);
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000ULL + time.tv_nsec;
+}
+
+bool ReadArgument(const LogRecord &record, size_t &offset, LogArgument &argument)
+{
+    if (offset + 1 > record.dataLength)
+        return false;
+
+    argument.type = static_cast<LogArgumentType>(record.data[offset++]);
+    if (LogArgumentString == argument.type)
+    {
+        uint16_t length = 0;
+        if (offset + sizeof(length) > record.dataLength)
+            return false;
+        memcpy(&length, &record.data[offset], sizeof(length));
+        offset += sizeof(length);
+        if (offset + length > record.dataLength)
+            return false;
+        argument.text.assign(reinterpret_cast<const char*>(&record.data[offset]), length);
+        offset += length;
+    }
+    else
+    {
+        if (offset + sizeof(argument.value) > record.dataLength)
+            return false;
+        memcpy(&argument.value, &record.data[offset], sizeof(argument.value));
+        offset += sizeof(argument.value);
+    }
+
+    return true;
+}
+
+template<typename T>
+void AppendFormatted(std::string &line, const std::string &specification, T value)
+{
+    char text[128];
+    int length = snprintf(text, sizeof(text), specification.c_str(), value);
+    if (length < 0)
+        return;
+
+    if (static_cast<size_t>(length) < sizeof(text))
+    {
+        line.append(text, length);
+    }
+    else
+    {
+        std::vector<char> longText(length + 1);
+        snprintf(&longText[0], longText.size(), specification.c_str(), value);
+        line.append(&longText[0], length);
+    }
+}
+
+double GetDouble(const LogArgument &argument)
+{
+    double number = 0.0;
+    if (LogArgumentDouble == argument.type)
+        memcpy(&number, &argument.value, sizeof(number));
+    else if (LogArgumentSigned == argument.type)
+        number = static_cast<double>(static_cast<int64_t>(argument.value));
+    else
+        number = static_cast<double>(argument.value);
+    return number;
+}
+
+// formats the arguments the way printf would have done it on the calling thread
+void FormatMessage(const LogRecord &record, std::string &line)
+{
+    const char *p = record.pFormat;
+    size_t offset = 0;
+    LogArgument argument;
+
+    while ('\0' != *p)
+    {
+        if ('%' != *p)
+        {
+            const char *pEnd = strchr(p, '%');
+            if (NULL == pEnd)
+                pEnd = p + strlen(p);
+            line.append(p, pEnd - p);
+            p = pEnd;
+            continue;
+        }
+
+        if ('%' == p[1])
+        {
+            line += '%';
+            p += 2;
+            continue;
+        }
+
+        // flags, width and precision are kept, the length is replaced by the stored size
+        std::string specification = "%";
+        p++;
+        while ('\0' != *p && NULL != strchr("-+ #0'", *p))
+            specification += *p++;
+        for (int part = 0; part < 2; part++)
+        {
+            if (1 == part)
+            {
+                if ('.' != *p)
+                    break;
+                specification += *p++;
+            }
+            if ('*' == *p)
+            {
+                p++;
+                if (ReadArgument(record, offset, argument))
+                    specification += std::to_string(static_cast<int>(argument.value));
+            }
+            while (*p >= '0' && *p <= '9')
+                specification += *p++;
+        }
+
+        std::string length;
+        while ('\0' != *p && NULL != strchr("hlLqjzt", *p))
+            length += *p++;
+
+        char conversion = *p;
+        if ('\0' == conversion)
+            break;
+        p++;
+
+        if (!ReadArgument(record, offset, argument))
+        {
+            line += "<missing>";
+            continue;
+        }
+
+        switch (conversion)
+        {
+            case 'd':
+            case 'i':
+            {
+                int64_t value = static_cast<int64_t>(argument.value);
+                if (length.empty())
+                    value = static_cast<int>(value);
+                else if ("h" == length)
+                    value = static_cast<short>(value);
+                else if ("hh" == length)
+                    value = static_cast<signed char>(value);
+                AppendFormatted(line, specification + "lld", static_cast<long long>(value));
+                break;
+            }
+            case 'u':
+            case 'o':
+            case 'x':
+            case 'X':
+            {
+                uint64_t value = argument.value;
+                if (length.empty())
+                    value = static_cast<unsigned int>(value);
+                else if ("h" == length)
+                    value = static_cast<unsigned short>(value);
+                else if ("hh" == length)
+                    value = static_cast<unsigned char>(value);
+                AppendFormatted(line, specification + "ll" + conversion, static_cast<unsigned long long>(value));
+                break;
+            }
+            case 'c':
+                AppendFormatted(line, specification + "c", static_cast<int>(argument.value));
+                break;
+            case 'f':
+            case 'F':
+            case 'e':
+            case 'E':
+            case 'g':
+            case 'G':
+            case 'a':
+            case 'A':
+                AppendFormatted(line, specification + conversion, GetDouble(argument));
+                break;
+            case 's':
+                if (LogArgumentString == argument.type)
+                    AppendFormatted(line, specification + "s", argument.text.c_str());
+                else
+                    line += "<not a string>";
+                break;
+            case 'p':
+                AppendFormatted(line, specification + "p", reinterpret_cast<void*>(static_cast<uintptr_t>(argument.value)));
+                break;
+            default:
+                line += "<unknown conversion>";
+                break;
+        }
+    }
+}
+
+} // namespace
+
+LogRing::LogRing()
+    : m_Records(LOG_RING_RECORDS)
+    , m_WriteIndex(0)
+    , m_ReadIndex(0)
+    , m_DroppedCount(0)
+    , m_bOrphaned(false)
+{
+}
+
+LogRecord *LogRing::BeginWrite()
+{
+    uint32_t writeIndex = m_WriteIndex.load(std::memory_order_relaxed);
+    if (writeIndex - m_ReadIndex.load(std::memory_order_acquire) >= LOG_RING_RECORDS)
+        return NULL;
+
+    return &m_Records[writeIndex % LOG_RING_RECORDS];
+}
+
+void LogRing::CommitWrite()
+{
+    m_WriteIndex.store(m_WriteIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+LogRecord *LogRing::BeginRead()
+{
+    uint32_t readIndex = m_ReadIndex.load(std::memory_order_relaxed);
+    if (readIndex == m_WriteIndex.load(std::memory_order_acquire))
+        return NULL;
+
+    return &m_Records[readIndex % LOG_RING_RECORDS];
+}
+
+void LogRing::CommitRead()
+{
+    m_ReadIndex.store(m_ReadIndex.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+void LogRing::AddDropped()
+{
+    m_DroppedCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t LogRing::TakeDropped()
+{
+    return m_DroppedCount.exchange(0, std::memory_order_relaxed);
+}
+
+void LogRing::SetOrphaned()
+{
+    m_bOrphaned.store(true, std::memory_order_release);
+}
+
+bool LogRing::IsOrphaned() const
+{
+    return m_bOrphaned.load(std::memory_order_acquire);
+}
+
+LogRecordWriter::LogRecordWriter(LogRing &ring, const char *pFilename, int line, const char *pFormat)
+    : m_Ring(ring)
+    , m_pRecord(ring.BeginWrite())
+{
+    if (NULL == m_pRecord)
+    {
+        m_Ring.AddDropped();
+        return;
+    }
+
+    m_pRecord->timestamp = BinaryLog::ReadTimestamp();
+    m_pRecord->pFilename = pFilename;
+    m_pRecord->pFormat = pFormat;
+    m_pRecord->line = line;
+    m_pRecord->dataLength = 0;
+    m_pRecord->bTruncated = 0;
+}
+
+void LogRecordWriter::AddValue(LogArgumentType type, uint64_t value)
+{
+    if (m_pRecord->dataLength + 1 + sizeof(value) > sizeof(m_pRecord->data))
+    {
+        m_pRecord->bTruncated = 1;
+        return;
+    }
+
+    m_pRecord->data[m_pRecord->dataLength++] = static_cast<uint8_t>(type);
+    memcpy(&m_pRecord->data[m_pRecord->dataLength], &value, sizeof(value));
+    m_pRecord->dataLength += sizeof(value);
+}
+
+void LogRecordWriter::AddString(const char *pText)
+{
+    if (NULL == pText)
+        pText = "(null)";
+
+    uint16_t length = 0;
+    if (m_pRecord->dataLength + 1 + sizeof(length) > sizeof(m_pRecord->data))
+    {
+        m_pRecord->bTruncated = 1;
+        return;
+    }
+
+    size_t room = sizeof(m_pRecord->data) - m_pRecord->dataLength - 1 - sizeof(length);
+    size_t textLength = strnlen(pText, room + 1);
+    if (textLength > room)
+    {
+        textLength = room;
+        m_pRecord->bTruncated = 1;
+    }
+    length = static_cast<uint16_t>(textLength);
+
+    m_pRecord->data[m_pRecord->dataLength++] = static_cast<uint8_t>(LogArgumentString);
+    memcpy(&m_pRecord->data[m_pRecord->dataLength], &length, sizeof(length));
+    m_pRecord->dataLength += sizeof(length);
+    memcpy(&m_pRecord->data[m_pRecord->dataLength], pText, length);
+    m_pRecord->dataLength += length;
+}
+
+void LogRecordWriter::Commit()
+{
+    if (NULL != m_pRecord)
+        m_Ring.CommitWrite();
+    m_pRecord = NULL;
+}
+
+LogRing *BinaryLog::GetThreadRing()
+{
+    static thread_local ThreadRingHolder holder;
+    return holder.pRing;
+}
+
+void BinaryLog::CollectRecords(std::vector<LogRecord> &records, uint32_t &droppedCount)
+{
+    records.clear();
+    droppedCount = 0;
+
+    {
+        LocalMutexLockGuard guard(GetRegistryMutex());
+        std::vector<LogRing*> &registry = GetRegistry();
+
+        for (size_t i = 0; i < registry.size(); )
+        {
+            // an orphaned ring gets no more records, so it is complete after the drain
+            bool bOrphaned = registry[i]->IsOrphaned();
+
+            LogRecord *pRecord;
+            while (NULL != (pRecord = registry[i]->BeginRead()))
+            {
+                records.push_back(*pRecord);
+                registry[i]->CommitRead();
+            }
+            droppedCount += registry[i]->TakeDropped();
+
+            if (bOrphaned)
+            {
+                delete registry[i];
+                registry.erase(registry.begin() + i);
+            }
+            else
+            {
+                i++;
+            }
+        }
+    }
+
+    std::stable_sort(records.begin(), records.end(),
+                     [](const LogRecord &first, const LogRecord &second) { return first.timestamp < second.timestamp; });
+}
+
+void BinaryLog::FormatRecord(const LogRecord &record, std::string &line)
+{
+    int64_t ticks = static_cast<int64_t>(record.timestamp - g_ReferenceTicks);
+    uint64_t realTime = g_ReferenceRealTime + static_cast<int64_t>(ticks * g_NanosecondsPerTick);
+    time_t seconds = static_cast<time_t>(realTime / 1000000000ULL);
+    struct tm localTime;
+    localtime_r(&seconds, &localTime);
+
+    char prefix[32];
+    snprintf(prefix, sizeof(prefix), "%02d:%02d:%02d.%06u: ", localTime.tm_hour, localTime.tm_min, localTime.tm_sec,
+             static_cast<unsigned int>((realTime % 1000000000ULL) / 1000));
+
+    line = prefix;
+    if (record.line > -1)
+    {
+        line += record.pFilename;
+        line += ":" + std::to_string(record.line) + ": ";
+    }
+
+    FormatMessage(record, line);
+
+    if (record.bTruncated)
+        line += " <truncated>";
+}
+
+void BinaryLog::CalibrateTimestamp()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint64_t startTicks = ReadTimestamp();
+    uint64_t startTime = ReadMonotonicTime();
+    usleep(TIMESTAMP_CALIBRATION_US);
+    uint64_t endTicks = ReadTimestamp();
+    uint64_t endTime = ReadMonotonicTime();
+    if (endTicks > startTicks)
+        g_NanosecondsPerTick = static_cast<double>(endTime - startTime) / (endTicks - startTicks);
+#elif defined(__aarch64__)
+    uint64_t frequency;
+    asm volatile("mrs %0, cntfrq_el0" : "=r"(frequency));
+    if (0 != frequency)
+        g_NanosecondsPerTick = 1000000000.0 / frequency;
+#endif
+    g_ReferenceTicks = ReadTimestamp();
+    g_ReferenceRealTime = ReadRealTime();
+}
+
+uint64_t BinaryLog::ReadMonotonicTime()
+{
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<uint64_t>(time.tv_sec) * 1000000000ULL + time.tv_nsec;
+}
+
+} // namespace base
@@ -0,0 +1,185 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+
+#include "BufferArena.h"
+#include "Logger.h"
+#include "V4L2Helper.h"
+
+#include <QElapsedTimer>
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// size of a huge page on all supported platforms, it is only used for rounding
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+static const char *GetBackingName(BufferArena::Backing backing)
+{
+    switch (backing)
+    {
+    case BufferArena::BackingHugeTLB:         return "huge pages";
+    case BufferArena::BackingTransparentHuge: return "transparent huge pages";
+    case BufferArena::BackingNormalPages:     return "normal pages";
+    default:                                  return "none";
+    }
+}
+
+BufferArena::BufferArena()
+    : m_pMemory(NULL)
+    , m_MappedSize(0)
+    , m_SlotSize(0)
+    , m_SlotCount(0)
+    , m_Backing(BackingNone)
+    , m_bLocked(false)
+{
+}
+
+BufferArena::~BufferArena()
+{
+    Release();
+}
+
+int BufferArena::Create(uint32_t slotCount, size_t slotSize)
+{
+    Release();
+
+    if (0 == slotCount || 0 == slotSize)
+        return -1;
+
+    size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t alignedSlotSize = ((slotSize + pageSize - 1) / pageSize) * pageSize;
+    size_t size = ((alignedSlotSize * slotCount + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE) * HUGE_PAGE_SIZE;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // explicit huge pages need a reserved pool (vm.nr_hugepages)
+    void *pMemory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+    if (MAP_FAILED != pMemory)
+    {
+        m_Backing = BackingHugeTLB;
+    }
+    else
+    {
+        LOG_EX("BufferArena::Create MAP_HUGETLB of %zu bytes failed errno=%d=%s, using transparent huge pages",
+               size, errno, v4l2helper::ConvertErrno2String(errno).c_str());
+
+        // one huge page more, so the start can be moved to a huge page boundary
+        size_t reservedSize = size + HUGE_PAGE_SIZE;
+        uint8_t *pReserved = static_cast<uint8_t *>(mmap(NULL, reservedSize, PROT_READ | PROT_WRITE,
+                                                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+        if (MAP_FAILED == pReserved)
+        {
+            LOG_EX("BufferArena::Create mmap of %zu bytes failed errno=%d=%s",
+                   reservedSize, errno, v4l2helper::ConvertErrno2String(errno).c_str());
+            return -1;
+        }
+
+        uint8_t *pAligned = reinterpret_cast<uint8_t *>(
+            (reinterpret_cast<uintptr_t>(pReserved) + HUGE_PAGE_SIZE - 1) & ~static_cast<uintptr_t>(HUGE_PAGE_SIZE - 1));
+        size_t head = pAligned - pReserved;
+        if (0 != head)
+            munmap(pReserved, head);
+        if (HUGE_PAGE_SIZE != head)
+            munmap(pAligned + size, HUGE_PAGE_SIZE - head);
+        pMemory = pAligned;
+
+        m_Backing = (0 == madvise(pMemory, size, MADV_HUGEPAGE)) ? BackingTransparentHuge : BackingNormalPages;
+
+        // the first write of every page happens here and not while streaming
+        for (size_t offset = 0; offset < size; offset += pageSize)
+            static_cast<volatile uint8_t *>(pMemory)[offset] = 0;
+    }
+
+    m_pMemory = static_cast<uint8_t *>(pMemory);
+    m_MappedSize = size;
+    m_SlotSize = alignedSlotSize;
+    m_SlotCount = slotCount;
+
+    // locking needs CAP_IPC_LOCK or a sufficient RLIMIT_MEMLOCK, the arena is
+    // used unlocked otherwise
+    m_bLocked = (0 == mlock(m_pMemory, m_MappedSize));
+    if (!m_bLocked)
+    {
+        LOG_EX("BufferArena::Create mlock failed errno=%d=%s, the buffers may be swapped out",
+               errno, v4l2helper::ConvertErrno2String(errno).c_str());
+    }
+
+    LOG_EX("BufferArena::Create %u buffers of %zu bytes in %zu bytes of %s, %slocked, prepared in %.1f ms",
+           slotCount, alignedSlotSize, size, GetBackingName(m_Backing), m_bLocked ? "" : "not ",
+           timer.nsecsElapsed() / 1000000.0);
+
+    return 0;
+}
+
+void BufferArena::Release()
+{
+    if (NULL != m_pMemory)
+    {
+        if (m_bLocked)
+            munlock(m_pMemory, m_MappedSize);
+        munmap(m_pMemory, m_MappedSize);
+    }
+
+    m_pMemory = NULL;
+    m_MappedSize = 0;
+    m_SlotSize = 0;
+    m_SlotCount = 0;
+    m_Backing = BackingNone;
+    m_bLocked = false;
+}
+
+uint8_t *BufferArena::GetSlot(uint32_t index) const
+{
+    if (NULL == m_pMemory || index >= m_SlotCount)
+        return NULL;
+
+    return m_pMemory + index * m_SlotSize;
+}
+
+bool BufferArena::Contains(const uint8_t *pBuffer) const
+{
+    return (NULL != m_pMemory && pBuffer >= m_pMemory && pBuffer < m_pMemory + m_MappedSize);
+}
+
+bool BufferArena::Fits(uint32_t slotCount, size_t slotSize) const
+{
+    return (NULL != m_pMemory && slotCount <= m_SlotCount && slotSize <= m_SlotSize);
+}
+
+bool BufferArena::IsValid() const
+{
+    return (NULL != m_pMemory);
+}
+
+BufferArena::Backing BufferArena::GetBacking() const
+{
+    return m_Backing;
+}
+
+bool BufferArena::IsLocked() const
+{
+    return m_bLocked;
+}
+
+size_t BufferArena::GetMappedSize() const
+{
+    return m_MappedSize;
+}
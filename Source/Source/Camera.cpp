@@ -27,6 +27,7 @@
 #include <QStringList>
 #include <QSysInfo>
 #include <QMutexLocker>
+#include <QElapsedTimer>
 #include <QFile>
 
 #include <errno.h>
@@ -73,6 +74,10 @@ struct v4l2_stats_t
 
 #define VIDIOC_STREAMSTAT                   _IOR('V', BASE_VIDIOC_PRIVATE + 5, struct v4l2_stats_t)
 
+// Buffers added at once by the adaptive buffer count and the memory all buffers may take
+#define ADAPTIVE_BUFFER_STEP                2
+#define ADAPTIVE_BUFFER_MEMORY_LIMIT        (1024ULL * 1024 * 1024)
+
 #define V4L2_CID_PREFFERED_STRIDE               (V4L2_CID_CAMERA_CLASS_BASE+5998)
 
 class IPixFormat
@@ -207,9 +212,29 @@ Camera::Camera()
     , m_ControlIdToFileDescriptorMap()
     , m_BlockingMode(false)
     , m_ShowFrames(true)
+    , m_ColorMatrix(yuvconversion::ColorMatrixAuto)
+    , m_ColorRange(yuvconversion::ColorRangeAuto)
+    , m_ScaleDenominator(1)
+    , m_bHighBitDepth(false)
+    , m_ToneMapping(tonemapping::GetDefaultParameters())
+    , m_bAutoWindowLevel(true)
+    , m_WindowLow(0)
+    , m_WindowHigh(0xFFFF)
+    , m_bAutoShift(false)
+    , m_bUseBufferArena(false)
+    , m_BufferCacheMode(BufferCacheMaintained)
+    , m_bPrepareBuffers(false)
+    , m_bMeasureReadLatency(false)
+    , m_bDumpFrames(false)
+    , m_UserBufferSize(0)
+    , m_bFramesUnderrunKnown(false)
+    , m_FramesUnderrun(0)
     , m_UseV4L2TryFmt(true)
     , m_Recording(false)
     , m_IsAvtCamera(true)
+    , m_ControlCacheHits(0)
+    , m_ControlCacheMisses(0)
+    , m_LastDeviceState()
     , m_DeviceBufferType(V4L2_BUF_TYPE_VIDEO_CAPTURE)
     , m_SubDeviceBufferTypes()
     , m_FrameRateDeviceFileDescriptor(-1)
@@ -229,6 +254,22 @@ Camera::Camera()
     connect(m_pAutoGainReader->GetAutoReaderWorker(), SIGNAL(ReadSignal()), this, SLOT(PassGainValue()), Qt::DirectConnection);
     m_pAutoGainReader->MoveToThreadAndStart();
 
+    // while streaming the state is read in the background, the GUI only gets the changes
+    m_pDeviceStateReader = new AutoReader();
+    connect(m_pDeviceStateReader->GetAutoReaderWorker(), SIGNAL(ReadSignal()), this, SLOT(OnDeviceStateTimer()), Qt::DirectConnection);
+    m_pDeviceStateReader->MoveToThreadAndStart();
+
+    // slider values are written on the writer thread, the GUI never waits for the ioctl
+    connect(&m_ControlWriter, SIGNAL(WriteControl_Signal(int32_t, int64_t)), this, SLOT(OnWriteControl(int32_t, int64_t)), Qt::DirectConnection);
+    connect(&m_ControlWriter, SIGNAL(ControlWritten_Signal(bool)), this, SLOT(OnControlsWritten(bool)), Qt::DirectConnection);
+    m_ControlWriter.start();
+
+    // the controls are described and read on the enumeration thread, the widgets are created on demand
+    connect(&m_ControlEnumerator, SIGNAL(EnumerateControls_Signal()), this, SLOT(OnEnumerateControls()), Qt::DirectConnection);
+    connect(&m_ControlEnumerator, SIGNAL(DescribeControls_Signal()), this, SLOT(OnDescribeControls()), Qt::DirectConnection);
+    connect(&m_ControlEnumerator, SIGNAL(ControlsDescribed_Signal()), this, SLOT(OnControlsDescribed()), Qt::QueuedConnection);
+    m_ControlEnumerator.start();
+
 }
 
 Camera::~Camera()
@@ -237,8 +278,12 @@ Camera::~Camera()
     m_pAutoExposureReader = nullptr;
     delete m_pAutoGainReader;
     m_pAutoGainReader = nullptr;
+    delete m_pDeviceStateReader;
+    m_pDeviceStateReader = nullptr;
 
     m_CameraObserver.SetTerminateFlag();
+    m_ControlWriter.Stop();
+    m_ControlEnumerator.Stop();
     if (NULL != m_pFrameObserver.data())
         m_pFrameObserver->StopStream();
 
@@ -264,6 +309,31 @@ double Camera::GetRenderedFPS()
     return m_pFrameObserver->GetRenderedFPS();
 }
 
+double Camera::GetAverageCaptureTime()
+{
+    return m_pFrameObserver->GetAverageCaptureTime();
+}
+
+double Camera::GetMaximumCaptureTime()
+{
+    return m_pFrameObserver->GetMaximumCaptureTime();
+}
+
+void Camera::ResetCaptureTime()
+{
+    m_pFrameObserver->ResetCaptureTime();
+}
+
+void Camera::StartTimeToFirstFrame()
+{
+    m_pFrameObserver->StartTimeToFirstFrame();
+}
+
+double Camera::GetTimeToFirstFrame()
+{
+    return m_pFrameObserver->GetTimeToFirstFrame();
+}
+
 int Camera::OpenDevice(std::string &deviceName, QVector<QString>& subDevices, bool blockingMode, IO_METHOD_TYPE ioMethodType,
                bool v4l2TryFmt)
 {
@@ -305,7 +375,10 @@ int Camera::OpenDevice(std::string &deviceName, QVector<QString>& subDevices, bo
         else
             m_DeviceFileDescriptor = open(deviceName.c_str(), O_RDWR | O_NONBLOCK, 0);
 
-        m_FileDescriptorToNameMap[m_DeviceFileDescriptor] = deviceName;
+        {
+            QMutexLocker locker(&m_ControlMapMutex);
+            m_FileDescriptorToNameMap[m_DeviceFileDescriptor] = deviceName;
+        }
 
         LOG_EX("Camera::OpenDevice device %s has file descriptor %d", deviceName.c_str(), m_DeviceFileDescriptor);
 
@@ -316,6 +389,11 @@ int Camera::OpenDevice(std::string &deviceName, QVector<QString>& subDevices, bo
         }
         else
         {
+            m_DeviceCapabilities[m_DeviceFileDescriptor] = cap;
+            if (std::string((char*) cap.driver).find("avt") != std::string::npos)
+            {
+                m_IsAvtCamera = true;
+            }
             m_DeviceBufferType = (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) ? V4L2_BUF_TYPE_VIDEO_CAPTURE : (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE) ? V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE : V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
             if (m_DeviceBufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE)
@@ -334,16 +412,12 @@ int Camera::OpenDevice(std::string &deviceName, QVector<QString>& subDevices, bo
             }
         }
 
-        QueryControls(m_DeviceFileDescriptor);
-
         if (m_DeviceFileDescriptor == -1)
         {
             LOG_EX("Camera::OpenDevice open %s failed errno=%d=%s", deviceName.c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
         }
         else
         {
-            getAvtDeviceFirmwareVersion();
-
             LOG_EX("Camera::OpenDevice open %s OK", deviceName.c_str());
 
             m_DeviceName = deviceName;
@@ -364,6 +438,7 @@ int Camera::OpenDevice(std::string &deviceName, QVector<QString>& subDevices, bo
                 LOG_EX("Camera::OpenDevice sub-device %s has file descriptor %d", subDevice.toStdString().c_str(), subDeviceFileDescriptor);
                 m_SubDeviceFileDescriptors.push_back(subDeviceFileDescriptor);
 
+                QMutexLocker locker(&m_ControlMapMutex);
                 m_FileDescriptorToNameMap[subDeviceFileDescriptor] = subDevice.toStdString();
             }
 
@@ -373,6 +448,11 @@ int Camera::OpenDevice(std::string &deviceName, QVector<QString>& subDevices, bo
             }
             else
             {
+                m_DeviceCapabilities[subDeviceFileDescriptor] = cap;
+                if (std::string((char*) cap.driver).find("avt") != std::string::npos)
+                {
+                    m_IsAvtCamera = true;
+                }
                 m_SubDeviceBufferTypes[subDeviceFileDescriptor] = (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) ? V4L2_BUF_TYPE_VIDEO_CAPTURE : (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE) ? V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE : V4L2_BUF_TYPE_VIDEO_CAPTURE;
 
                 if (m_SubDeviceBufferTypes[subDeviceFileDescriptor] == V4L2_BUF_TYPE_VIDEO_CAPTURE)
@@ -388,8 +468,6 @@ int Camera::OpenDevice(std::string &deviceName, QVector<QString>& subDevices, bo
                     LOG_EX("Camera::OpenDevice %s is no video capture device", subDevice.toStdString().c_str());
                 }
             }
-
-            QueryControls(subDeviceFileDescriptor);
         }
     }
     else
@@ -420,7 +498,17 @@ int Camera::OpenDevice(std::string &deviceName, QVector<QString>& subDevices, bo
             m_pFrameObserver = QSharedPointer<FrameObserverUSER>(new FrameObserverUSER(m_ShowFrames));
             break;
     }
-    connect(m_pFrameObserver.data(), SIGNAL(OnFrameReady_Signal(const QImage &, const unsigned long long &)), this, SLOT(OnFrameReady(const QImage &, const unsigned long long &)));
+    m_pFrameObserver->SetYuvConversion(m_ColorMatrix, m_ColorRange);
+    m_pFrameObserver->SetScaleDenominator(m_ScaleDenominator);
+    m_pFrameObserver->SetHighBitDepth(m_bHighBitDepth);
+    m_pFrameObserver->SetToneMapping(m_ToneMapping);
+    m_pFrameObserver->SetWindowLevel(m_bAutoWindowLevel, m_WindowLow, m_WindowHigh);
+    m_pFrameObserver->SetAutoShift(m_bAutoShift);
+    m_pFrameObserver->SetBufferArena(m_bUseBufferArena);
+    m_pFrameObserver->SetBufferQueuing(m_BufferCacheMode, m_bPrepareBuffers);
+    m_pFrameObserver->SetReadLatencyBenchmark(m_bMeasureReadLatency);
+    m_pFrameObserver->SetFrameDump(m_bDumpFrames, m_FrameDumpDirectory);
+    connect(m_pFrameObserver.data(), SIGNAL(OnFrameReady_Signal(const QImage &, const QImage &, const unsigned long long &)), this, SLOT(OnFrameReady(const QImage &, const QImage &, const unsigned long long &)));
     connect(m_pFrameObserver.data(), SIGNAL(OnFrameID_Signal(const unsigned long long &)), this, SLOT(OnFrameID(const unsigned long long &)));
     connect(m_pFrameObserver.data(), SIGNAL(OnDisplayFrame_Signal(const unsigned long long &)), this, SLOT(OnDisplayFrame(const unsigned long long &)));
 
@@ -436,6 +524,15 @@ int Camera::OpenDevice(std::string &deviceName, QVector<QString>& subDevices, bo
 
     m_pEventHandler->start();
 
+    // a known camera lists its formats and controls from the stored entry,
+    // the full listing below is only written to the log
+    if (0 == result && 0 != LoadCapabilityCache())
+    {
+        for (const auto fileDescriptor : fileDescriptors)
+        {
+            QueryControls(fileDescriptor);
+        }
+    }
 
     return result;
 }
@@ -444,6 +541,10 @@ int Camera::CloseDevice()
 {
     int result = -1;
 
+    // queued values belong to this device
+    m_ControlWriter.DiscardAll();
+    m_ControlEnumerator.Cancel();
+
     if (m_pEventHandler != nullptr)
     {
 		m_pEventHandler->Stop();
@@ -452,15 +553,22 @@ int Camera::CloseDevice()
         m_pEventHandler = nullptr;
     }
 
+    // no thread looks at the descriptions anymore
+    m_ControlDescriptions.clear();
+    m_ControlDescriptionIndex.clear();
+    m_DescribedControls.clear();
+    m_LastControlValues.clear();
+    m_LastDeviceState = DeviceState();
+
     if (-1 != m_DeviceFileDescriptor)
     {
         if (-1 == close(m_DeviceFileDescriptor))
         {
-            LOG_EX("Camera::CloseDevice close %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+            LOG_EX("Camera::CloseDevice close %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
         }
         else
         {
-            LOG_EX("Camera::CloseDevice close %s OK", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str());
+            LOG_EX("Camera::CloseDevice close %s OK", GetFileDescriptorName(m_DeviceFileDescriptor).c_str());
             result = 0;
         }
     }
@@ -471,18 +579,38 @@ int Camera::CloseDevice()
     {
         if (-1 == close(subDeviceFileDescriptor))
         {
-            LOG_EX("Camera::CloseDevice sub-device close %s failed errno=%d=%s", m_FileDescriptorToNameMap[subDeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+            LOG_EX("Camera::CloseDevice sub-device close %s failed errno=%d=%s", GetFileDescriptorName(subDeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
         }
         else
         {
-            LOG_EX("Camera::CloseDevice sub-device close %s OK", m_FileDescriptorToNameMap[subDeviceFileDescriptor].c_str());
+            LOG_EX("Camera::CloseDevice sub-device close %s OK", GetFileDescriptorName(subDeviceFileDescriptor).c_str());
             result = 0;
         }
     }
     m_SubDeviceFileDescriptors.clear();
     m_SubDeviceBufferTypes.clear();
 
-    m_FileDescriptorToNameMap.clear();
+    {
+        // the controls of the next device may live on other file descriptors
+        QMutexLocker locker(&m_ControlMapMutex);
+        m_FileDescriptorToNameMap.clear();
+        m_ControlIdToFileDescriptorMap.clear();
+        m_ControlIdToControlNameMap.clear();
+        m_ControlIdToTypeMap.clear();
+    }
+
+    m_DeviceCapabilities.clear();
+    m_AvtDeviceFirmwareVersion.clear();
+    m_AvtDeviceSerialNumber.clear();
+    m_CapabilityCache.Clear();
+
+    {
+        QMutexLocker locker(&m_ControlCacheMutex);
+        LOG_EX("Camera::CloseDevice control cache served %llu reads, %llu reads went to the device", static_cast<unsigned long long>(m_ControlCacheHits), static_cast<unsigned long long>(m_ControlCacheMisses));
+        m_ControlCache.clear();
+        m_ControlCacheHits = 0;
+        m_ControlCacheMisses = 0;
+    }
 
     return result;
 }
@@ -491,7 +619,7 @@ void Camera::QueryControls(int fd)
 {
     const unsigned next_fl = V4L2_CTRL_FLAG_NEXT_CTRL | V4L2_CTRL_FLAG_NEXT_COMPOUND;
 
-    LOG_EX("Camera::QueryControls querying controls for %s", m_FileDescriptorToNameMap[fd].c_str());
+    LOG_EX("Camera::QueryControls querying controls for %s", GetFileDescriptorName(fd).c_str());
     v4l2_queryctrl qctrl;
     qctrl.id = next_fl;
     while (iohelper::xioctl(fd, VIDIOC_QUERYCTRL, &qctrl) == 0)
@@ -524,9 +652,9 @@ void Camera::QueryControls(int fd)
 /********************************************************************************/
 
 // The event handler to show the processed frame
-void Camera::OnFrameReady(const QImage &image, const unsigned long long &frameId)
+void Camera::OnFrameReady(const QImage &image, const QImage &displayImage, const unsigned long long &frameId)
 {
-    emit OnCameraFrameReady_Signal(image, frameId);
+    emit OnCameraFrameReady_Signal(image, displayImage, frameId);
 }
 
 // The event handler to show the processed frame ID
@@ -559,70 +687,15 @@ void Camera::OnSubDeviceListChanged(const int &reason, unsigned int cardNumber,
 
 int Camera::DeviceDiscoveryStart()
 {
-    uint32_t deviceCount = 0;
-    QString deviceName;
-    int fileDiscriptor = -1;
-
-    do
-    {
-        deviceName = QString("/dev/video%1").arg(deviceCount);
-
-        if ((fileDiscriptor = open(deviceName.toStdString().c_str(), O_RDWR)) == -1)
-        {
-            LOG_EX("Camera::DeviceDiscoveryStart open %s failed errno=%d=%s", deviceName.toLatin1().data(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
-        }
-        else
-        {
-            v4l2_capability cap;
-
-            LOG_EX("Camera::DeviceDiscoveryStart open %s found", deviceName.toLatin1().data());
-
-            // query device capabilities
-            if (-1 == iohelper::xioctl(fileDiscriptor, VIDIOC_QUERYCAP, &cap))
-            {
-                LOG_EX("Camera::DeviceDiscoveryStart %s is no V4L2 device errno=%d=%s", deviceName.toLatin1().data(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
-            }
-            else
-            {
-                if (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE)
-                {
-                    LOG_EX("CameraObserver::DeviceDiscoveryStart %s is a single-plane video capture device", deviceName.toLatin1().data());
-                }
-                else if (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE)
-                {
-                    LOG_EX("CameraObserver::DeviceDiscoveryStart %s is a multi-plane video capture device", deviceName.toLatin1().data());
-                }
-
-                if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) && !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE))
-                {
-                    LOG_EX("Camera::DeviceDiscoveryStart %s is no video capture device", deviceName.toLatin1().data());
-                }
-                else
-                {
-                    emit OnCameraListChanged_Signal(UpdateTriggerPluggedIn, 0, deviceCount, deviceName, (const char*) cap.card);
-                }
-            }
-
-
-            if (-1 == close(fileDiscriptor))
-            {
-                LOG_EX("Camera::DeviceDiscoveryStart close %s failed errno=%d=%s", deviceName.toLatin1().data(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
-            }
-            else
-            {
-                LOG_EX("Camera::DeviceDiscoveryStart close %s OK", deviceName.toLatin1().data());
-            }
-        }
-
-        deviceCount++;
-    }
-    while(deviceCount < 20);
-
-    return 0;
+    // the observer scans /dev for video and sub-device nodes once its watch exists,
+    // later changes are reported when /dev changes
+    return m_CameraObserver.Start();
 }
 
 int Camera::DeviceDiscoveryStop()
 {
+    m_CameraObserver.Stop();
+
     LOG_EX("Device Discovery stopped.");
 
     return 0;
@@ -630,62 +703,8 @@ int Camera::DeviceDiscoveryStop()
 
 int Camera::SubDeviceDiscoveryStart()
 {
-    uint32_t subDeviceCount = 0;
-    QString subDeviceName;
-    int fileDiscriptor = -1;
-
-    do
-    {
-        subDeviceName = QString("/dev/v4l-subdev%1").arg(subDeviceCount);
-
-        if ((fileDiscriptor = open(subDeviceName.toStdString().c_str(), O_RDWR)) == -1)
-        {
-            LOG_EX("Camera::SubDeviceDiscoveryStart open %s failed errno=%d=%s", subDeviceName.toLatin1().data(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
-        }
-        else
-        {
-            v4l2_capability cap;
-
-            LOG_EX("Camera::SubDeviceDiscoveryStart open %s found", subDeviceName.toLatin1().data());
-
-            // query sub-device capabilities
-            if (-1 == iohelper::xioctl(fileDiscriptor, VIDIOC_QUERYCAP, &cap))
-            {
-                LOG_EX("Camera::SubDeviceDiscoveryStart %s is no V4L2 device errno=%d=%s", subDeviceName.toLatin1().data(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
-            }
-            else
-            {
-                if (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE)
-                {
-                    LOG_EX("CameraObserver::SubDeviceDiscoveryStart %s is a single-plane video capture device", subDeviceName.toLatin1().data());
-                }
-                else if (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE)
-                {
-                    LOG_EX("CameraObserver::SubDeviceDiscoveryStart %s is a multi-plane video capture device", subDeviceName.toLatin1().data());
-                }
-
-                if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) && !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE))
-                {
-                    LOG_EX("Camera::SubDeviceDiscoveryStart %s is no video capture device", subDeviceName.toLatin1().data());
-                }
-                else
-                {
-                    emit OnSubDeviceListChanged_Signal(UpdateTriggerPluggedIn, 0, subDeviceCount, subDeviceName, (const char*) cap.card);
-                }
-            }
-
-            if (-1 == close(fileDiscriptor))
-            {
-                LOG_EX("Camera::SubDeviceDiscoveryStart close %s failed errno=%d=%s", subDeviceName.toLatin1().data(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
-            }
-            else
-            {
-                LOG_EX("Camera::SubDeviceDiscoveryStart close %s OK", subDeviceName.toLatin1().data());
-            }
-        }
-
-        subDeviceCount++;
-    } while (subDeviceCount < 20);
+    // sub-devices are found by the scan of DeviceDiscoveryStart
+    LOG_EX("Sub-device discovery started.");
 
     return 0;
 }
@@ -707,7 +726,7 @@ int Camera::StartStreamChannel(uint32_t pixelFormat, uint32_t payloadSize, uint3
 {
     int nResult = 0;
 
-    LOG_EX("Camera::StartStreamChannel %s pixelFormat=%d, payloadSize=%d, width=%d, height=%d.", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), pixelFormat, payloadSize, width, height);
+    LOG_EX("Camera::StartStreamChannel %s pixelFormat=%d, payloadSize=%d, width=%d, height=%d.", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), pixelFormat, payloadSize, width, height);
 
     m_pFrameObserver->StartStream(m_BlockingMode, m_DeviceFileDescriptor, pixelFormat,
                                   payloadSize, width, height, bytesPerLine,
@@ -756,7 +775,7 @@ int Camera::StartStreaming()
 
     if (-1 == iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_STREAMON, &type))
     {
-        LOG_EX("Camera::StartStreaming VIDIOC_STREAMON %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::StartStreaming VIDIOC_STREAMON %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
     }
     else
     {
@@ -777,7 +796,7 @@ int Camera::StopStreaming()
 
     if (-1 == iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_STREAMOFF, &type))
     {
-        LOG_EX("Camera::StopStreaming VIDIOC_STREAMOFF %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::StopStreaming VIDIOC_STREAMOFF %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
     }
     else
     {
@@ -801,13 +820,13 @@ int Camera::ReadPayloadSize(uint32_t &payloadSize)
     {
         payloadSize = m_pPixFormat->GetSizeImage(fmt);
 
-        LOG_EX("Camera::ReadPayloadSize VIDIOC_G_FMT %s OK =%d", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), payloadSize);
+        LOG_EX("Camera::ReadPayloadSize VIDIOC_G_FMT %s OK =%d", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), payloadSize);
 
         result = 0;
     }
     else
     {
-        LOG_EX("Camera::ReadPayloadSize VIDIOC_G_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::ReadPayloadSize VIDIOC_G_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
     }
 
     return result;
@@ -826,13 +845,13 @@ int Camera::ReadFrameSize(uint32_t &width, uint32_t &height)
         width = m_pPixFormat->GetWidth(fmt);
         height = m_pPixFormat->GetHeight(fmt);
 
-        LOG_EX("Camera::ReadFrameSize VIDIOC_G_FMT %s OK =%dx%d", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), width, height);
+        LOG_EX("Camera::ReadFrameSize VIDIOC_G_FMT %s OK =%dx%d", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), width, height);
 
         result = 0;
     }
     else
     {
-        LOG_EX("Camera::ReadFrameSize VIDIOC_G_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::ReadFrameSize VIDIOC_G_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
     }
 
     return result;
@@ -861,7 +880,7 @@ int Camera::SetFrameSize(uint32_t width, uint32_t height)
             result = iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_TRY_FMT, &fmt);
             if (result != 0)
             {
-                LOG_EX("Camera::SetFrameSize VIDIOC_TRY_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+                LOG_EX("Camera::SetFrameSize VIDIOC_TRY_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
             }
         }
         else
@@ -872,19 +891,19 @@ int Camera::SetFrameSize(uint32_t width, uint32_t height)
             result = iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_S_FMT, &fmt);
             if (-1 != result)
             {
-                LOG_EX("Camera::SetFrameSize VIDIOC_S_FMT %s OK =%dx%d", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), width, height);
+                LOG_EX("Camera::SetFrameSize VIDIOC_S_FMT %s OK =%dx%d", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), width, height);
 
                 result = 0;
             }
             else
             {
-                LOG_EX("Camera::SetFrameSize VIDIOC_S_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+                LOG_EX("Camera::SetFrameSize VIDIOC_S_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
             }
         }
     }
     else
     {
-        LOG_EX("Camera::SetFrameSize VIDIOC_G_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::SetFrameSize VIDIOC_G_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
     }
 
     return result;
@@ -900,7 +919,7 @@ int Camera::SetWidth(uint32_t width)
 
     if (-1 != iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_G_FMT, &fmt))
     {
-        LOG_EX("Camera::SetWidth VIDIOC_G_FMT %s OK", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str());
+        LOG_EX("Camera::SetWidth VIDIOC_G_FMT %s OK", GetFileDescriptorName(m_DeviceFileDescriptor).c_str());
 
         m_pPixFormat->SetWidth(fmt, width);
         m_pPixFormat->SetField(fmt, V4L2_FIELD_ANY);
@@ -912,16 +931,16 @@ int Camera::SetWidth(uint32_t width)
             result = iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_TRY_FMT, &fmt);
             if (result != 0)
             {
-                LOG_EX("Camera::SetWidth VIDIOC_TRY_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+                LOG_EX("Camera::SetWidth VIDIOC_TRY_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
             }
             else
             {
-                LOG_EX("Camera::SetWidth VIDIOC_TRY_FMT %s OK", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str());
+                LOG_EX("Camera::SetWidth VIDIOC_TRY_FMT %s OK", GetFileDescriptorName(m_DeviceFileDescriptor).c_str());
             }
         }
         else
         {
-            LOG_EX("Camera::SetWidth VIDIOC_TRY_FMT %s not used", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str());
+            LOG_EX("Camera::SetWidth VIDIOC_TRY_FMT %s not used", GetFileDescriptorName(m_DeviceFileDescriptor).c_str());
             result = 0;
         }
 
@@ -930,19 +949,19 @@ int Camera::SetWidth(uint32_t width)
             result = iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_S_FMT, &fmt);
             if (-1 != result)
             {
-                LOG_EX("Camera::SetWidth VIDIOC_S_FMT %s OK =%d", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), width);
+                LOG_EX("Camera::SetWidth VIDIOC_S_FMT %s OK =%d", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), width);
 
                 result = 0;
             }
             else
             {
-                LOG_EX("Camera::SetWidth VIDIOC_S_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+                LOG_EX("Camera::SetWidth VIDIOC_S_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
             }
         }
     }
     else
     {
-        LOG_EX("Camera::SetWidth VIDIOC_G_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::SetWidth VIDIOC_G_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
     }
 
     return result;
@@ -960,13 +979,13 @@ int Camera::ReadWidth(uint32_t &width)
     {
         width = m_pPixFormat->GetWidth(fmt);
 
-        LOG_EX("Camera::ReadWidth VIDIOC_G_FMT %s OK =%d", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), width);
+        LOG_EX("Camera::ReadWidth VIDIOC_G_FMT %s OK =%d", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), width);
 
         result = 0;
     }
     else
     {
-        LOG_EX("Camera::ReadWidth VIDIOC_G_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::ReadWidth VIDIOC_G_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
     }
 
     return result;
@@ -982,7 +1001,7 @@ int Camera::SetHeight(uint32_t height)
 
     if (-1 != iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_G_FMT, &fmt))
     {
-        LOG_EX("Camera::SetHeight VIDIOC_G_FMT %s OK", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str());
+        LOG_EX("Camera::SetHeight VIDIOC_G_FMT %s OK", GetFileDescriptorName(m_DeviceFileDescriptor).c_str());
 
         m_pPixFormat->SetHeight(fmt, height);
         m_pPixFormat->SetField(fmt, V4L2_FIELD_ANY);
@@ -994,16 +1013,16 @@ int Camera::SetHeight(uint32_t height)
             result = iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_TRY_FMT, &fmt);
             if (result != 0)
             {
-                LOG_EX("Camera::SetHeight VIDIOC_TRY_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+                LOG_EX("Camera::SetHeight VIDIOC_TRY_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
             }
             else
             {
-                LOG_EX("Camera::SetHeight VIDIOC_TRY_FMT %s OK", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str());
+                LOG_EX("Camera::SetHeight VIDIOC_TRY_FMT %s OK", GetFileDescriptorName(m_DeviceFileDescriptor).c_str());
             }
         }
         else
         {
-            LOG_EX("Camera::SetHeight VIDIOC_TRY_FMT %s not used", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str());
+            LOG_EX("Camera::SetHeight VIDIOC_TRY_FMT %s not used", GetFileDescriptorName(m_DeviceFileDescriptor).c_str());
 
             result = 0;
         }
@@ -1013,19 +1032,19 @@ int Camera::SetHeight(uint32_t height)
             result = iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_S_FMT, &fmt);
             if (-1 != result)
             {
-                LOG_EX("Camera::SetHeight VIDIOC_S_FMT %s OK =%d", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), height);
+                LOG_EX("Camera::SetHeight VIDIOC_S_FMT %s OK =%d", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), height);
 
                 result = 0;
             }
             else
             {
-                LOG_EX("Camera::SetHeight VIDIOC_S_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+                LOG_EX("Camera::SetHeight VIDIOC_S_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
             }
         }
     }
     else
     {
-        LOG_EX("Camera::SetHeight VIDIOC_G_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::SetHeight VIDIOC_G_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
     }
 
     return result;
@@ -1049,7 +1068,7 @@ int Camera::ReadHeight(uint32_t &height)
     }
     else
     {
-        LOG_EX("Camera::ReadHeight VIDIOC_G_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::ReadHeight VIDIOC_G_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
     }
 
     return result;
@@ -1061,7 +1080,20 @@ int Camera::ReadFormats()
     v4l2_fmtdesc fmt;
     v4l2_frmsizeenum fmtsize;
 
-    LOG_EX("Camera::ReadFormats %s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str());
+    LOG_EX("Camera::ReadFormats %s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str());
+
+    if (!m_CapabilityCache.GetPixelFormats().isEmpty())
+    {
+        for (const CachedPixelFormat &pixelFormat : m_CapabilityCache.GetPixelFormats())
+        {
+            emit OnCameraPixelFormat_Signal(QString("%1").arg(QString(v4l2helper::ConvertPixelFormat2String(pixelFormat.pixelFormat).c_str())));
+        }
+
+        LOG_EX("Camera::ReadFormats %d pixel formats served from the capability cache", static_cast<int>(m_CapabilityCache.GetPixelFormats().size()));
+        return 0;
+    }
+
+    QList<CachedPixelFormat> pixelFormats;
 
     CLEAR(fmt);
     fmt.type = m_DeviceBufferType;
@@ -1072,16 +1104,31 @@ int Camera::ReadFormats()
 
         emit OnCameraPixelFormat_Signal(QString("%1").arg(QString(v4l2helper::ConvertPixelFormat2String(fmt.pixelformat).c_str())));
 
+        CachedPixelFormat pixelFormat;
+        pixelFormat.pixelFormat = fmt.pixelformat;
+        pixelFormat.description = QString((const char*) fmt.description);
+        pixelFormats.append(pixelFormat);
+        // only a list of discrete sizes is kept, others are read from the device
+        QList<QString> frameSizes;
+        bool bAllDiscrete = true;
+
         CLEAR(fmtsize);
         fmtsize.type = m_DeviceBufferType;
         fmtsize.pixel_format = fmt.pixelformat;
         fmtsize.index = 0;
         while (iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_ENUM_FRAMESIZES, &fmtsize) >= 0 && fmtsize.index <= 100)
         {
+            if (fmtsize.type != V4L2_FRMSIZE_TYPE_DISCRETE)
+            {
+                bAllDiscrete = false;
+            }
+
             if (fmtsize.type == V4L2_FRMSIZE_TYPE_DISCRETE)
             {
                 v4l2_frmivalenum fmtival;
 
+                frameSizes.append(QString("%1x%2").arg(fmtsize.discrete.width).arg(fmtsize.discrete.height));
+
                 LOG_EX("Camera::ReadFormats VIDIOC_ENUM_FRAMESIZES size enum discrete width = %d height = %d", fmtsize.discrete.width, fmtsize.discrete.height);
 
                 //emit OnCameraFrameSize_Signal(QString("disc:%1x%2").arg(fmtsize.discrete.width).arg(fmtsize.discrete.height));
@@ -1113,6 +1160,10 @@ int Camera::ReadFormats()
         {
             LOG_EX("Camera::ReadFormats no VIDIOC_ENUM_FRAMESIZES never terminated with EINVAL within 100 loops.");
         }
+        else if (bAllDiscrete)
+        {
+            m_CapabilityCache.SetFrameSizes(fmt.pixelformat, frameSizes);
+        }
 
         fmt.index++;
     }
@@ -1121,6 +1172,11 @@ int Camera::ReadFormats()
     {
         LOG_EX("Camera::ReadFormats no VIDIOC_ENUM_FMT never terminated with EINVAL within 100 loops.");
     }
+    else
+    {
+        m_CapabilityCache.SetPixelFormats(pixelFormats);
+        m_CapabilityCache.Save();
+    }
 
     return result;
 }
@@ -1135,7 +1191,7 @@ int Camera::SetPixelFormat(uint32_t pixelFormat, QString pfText)
 
     if (-1 != iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_G_FMT, &fmt))
     {
-        LOG_EX("Camera::SetPixelFormat VIDIOC_G_FMT %s OK", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str());
+        LOG_EX("Camera::SetPixelFormat VIDIOC_G_FMT %s OK", GetFileDescriptorName(m_DeviceFileDescriptor).c_str());
 
         m_pPixFormat->SetPixelFormat(fmt, pixelFormat);
         m_pPixFormat->SetField(fmt, V4L2_FIELD_ANY);
@@ -1147,11 +1203,11 @@ int Camera::SetPixelFormat(uint32_t pixelFormat, QString pfText)
             result = iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_TRY_FMT, &fmt);
             if (result != 0)
             {
-                LOG_EX("Camera::SetPixelFormat VIDIOC_TRY_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+                LOG_EX("Camera::SetPixelFormat VIDIOC_TRY_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
             }
             else
             {
-                LOG_EX("Camera::SetPixelFormat VIDIOC_TRY_FMT %s OK", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str());
+                LOG_EX("Camera::SetPixelFormat VIDIOC_TRY_FMT %s OK", GetFileDescriptorName(m_DeviceFileDescriptor).c_str());
             }
         }
         else
@@ -1164,19 +1220,19 @@ int Camera::SetPixelFormat(uint32_t pixelFormat, QString pfText)
             result = iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_S_FMT, &fmt);
             if (-1 != result)
             {
-                LOG_EX("Camera::SetPixelFormat VIDIOC_S_FMT %s to %d OK", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), pixelFormat);
+                LOG_EX("Camera::SetPixelFormat VIDIOC_S_FMT %s to %d OK", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), pixelFormat);
                 result = 0;
             }
             else
             {
-                LOG_EX("Camera::SetPixelFormat VIDIOC_S_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+                LOG_EX("Camera::SetPixelFormat VIDIOC_S_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
             }
         }
 
     }
     else
     {
-        LOG_EX("Camera::SetPixelFormat VIDIOC_G_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::SetPixelFormat VIDIOC_G_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
     }
 
     return result;
@@ -1188,16 +1244,32 @@ QList<QString> Camera::GetFrameSizes(uint32_t fourcc)
 	v4l2_frmsizeenum frmsizeenum;
 	QList<QString> framesizes;
 
+	if (m_CapabilityCache.GetFrameSizes(fourcc, framesizes))
+	{
+		return framesizes;
+	}
+
 	frmsizeenum.pixel_format = fourcc;
 	frmsizeenum.index = index;
 
+	bool bAllDiscrete = true;
 	while (!iohelper::xioctl(m_DeviceFileDescriptor,VIDIOC_ENUM_FRAMESIZES,&frmsizeenum)) {
 		framesizes.append(QString("%1x%2").arg(frmsizeenum.discrete.width).arg(frmsizeenum.discrete.height));
 
+		if (frmsizeenum.type != V4L2_FRMSIZE_TYPE_DISCRETE)
+		{
+			bAllDiscrete = false;
+		}
 
 		frmsizeenum.index = (++index);
 	}
 
+	// stepwise and continuous sizes are not kept
+	if (bAllDiscrete)
+	{
+		m_CapabilityCache.SetFrameSizes(fourcc, framesizes);
+	}
+
 	return framesizes;
 }
 
@@ -1270,7 +1342,7 @@ int Camera::ReadPixelFormat(uint32_t &pixelFormat, uint32_t &bytesPerLine, QStri
 
     if (-1 != iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_G_FMT, &fmt))
     {
-        LOG_EX("Camera::ReadPixelFormat VIDIOC_G_FMT %s OK =%d", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), fmt.fmt.pix.pixelformat);
+        LOG_EX("Camera::ReadPixelFormat VIDIOC_G_FMT %s OK =%d", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), fmt.fmt.pix.pixelformat);
 
         pixelFormat = m_pPixFormat->GetPixelFormat(fmt);
         bytesPerLine = m_pPixFormat->GetBytesPerLine(fmt);
@@ -1280,7 +1352,7 @@ int Camera::ReadPixelFormat(uint32_t &pixelFormat, uint32_t &bytesPerLine, QStri
     }
     else
     {
-        LOG_EX("Camera::ReadPixelFormat VIDIOC_G_FMT %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::ReadPixelFormat VIDIOC_G_FMT %s failed errno=%d=%s", GetFileDescriptorName(m_DeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
     }
 
     return result;
@@ -1288,173 +1360,80 @@ int Camera::ReadPixelFormat(uint32_t &pixelFormat, uint32_t &bytesPerLine, QStri
 
 //////////////////// Extended Controls ////////////////////////
 
+// Stored and walked controls match when every control has the same id, type and device
+static bool IsSameControlWalk(const std::vector<CachedControl> &storedControls, const std::vector<CachedControl> &controls)
+{
+    if (storedControls.size() != controls.size())
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < controls.size(); i++)
+    {
+        if (storedControls[i].id != controls[i].id || storedControls[i].type != controls[i].type || storedControls[i].device != controls[i].device)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
 int Camera::EnumAllControlNewStyle()
 {
+    // the controls of an opened device do not change, refreshes only read the values
+    if (!m_ControlDescriptions.empty())
+    {
+        return 0;
+    }
+
     int result = -1;
+    QElapsedTimer enumerationTimer;
+    enumerationTimer.start();
 
     std::vector<int> allFileDescriptors = m_SubDeviceFileDescriptors;
     allFileDescriptors.push_back(m_DeviceFileDescriptor);
 
-    for (const auto fileDescriptor : allFileDescriptors)
+    // range and flags are runtime state, the controls are always walked once and the
+    // same walk validates the stored entry
+    std::vector<CachedControl> controls;
+
+    for (size_t device = 0; device < allFileDescriptors.size(); device++)
     {
+        int fileDescriptor = allFileDescriptors[device];
         v4l2_query_ext_ctrl qctrl;
-        v4l2_querymenu queryMenu;
 
         int cidCount = 0;
 
         CLEAR(qctrl);
-        CLEAR(queryMenu);
 
         qctrl.id = V4L2_CTRL_FLAG_NEXT_CTRL;
 
         while (0 == iohelper::xioctl(fileDescriptor, VIDIOC_QUERY_EXT_CTRL, &qctrl))
         {
+            CachedControl control;
+            control.id = qctrl.id;
+            control.type = qctrl.type;
+            control.device = static_cast<int>(device);
+            control.name = QString((const char*) qctrl.name);
+            controls.push_back(control);
+
             if (!(qctrl.flags & V4L2_CTRL_FLAG_DISABLED))
             {
-                bool bIsReadOnly = false;
                 if (qctrl.flags & V4L2_CTRL_FLAG_READ_ONLY || qctrl.id == V4L2_CID_PREFFERED_STRIDE)
                 {
-                    bIsReadOnly = true;
                     qctrl.id |= V4L2_CTRL_FLAG_NEXT_CTRL;
                     continue;
                 }
 
-				if (qctrl.flags & V4L2_CTRL_FLAG_INACTIVE || qctrl.flags & V4L2_CTRL_FLAG_GRABBED)
-				{
-					bIsReadOnly = true;
-				}
-
-				if (qctrl.flags & V4L2_CTRL_FLAG_VOLATILE && (qctrl.flags & V4L2_CTRL_FLAG_EXECUTE_ON_WRITE) == 0)
-				{
-					bIsReadOnly = true;
-				}
-
-				if (m_pEventHandler != nullptr) {
-					m_pEventHandler->SubscribeControl(qctrl.id);
-				}
-
-                LOG_EX("Camera::EnumAllControlNewStyle VIDIOC_QUERYCTRL %s id=%d=%s min=%ld, max=%ld, default=%ld", m_FileDescriptorToNameMap[fileDescriptor].c_str(), qctrl.id, v4l2helper::ConvertControlID2String(qctrl.id).c_str(), qctrl.minimum, qctrl.maximum, qctrl.default_value);
-                cidCount++;
-
-                QString name = QString((const char*) qctrl.name);
-                if(UsesSubdevices()) {
-                    name += QString(" (") + (fileDescriptor == m_DeviceFileDescriptor ? "d" : "s") + ")";
-                }
-
-                QString unit = QString::fromStdString(v4l2helper::GetControlUnit(qctrl.id));
-
-                if (qctrl.type == V4L2_CTRL_TYPE_INTEGER)
-                {
-                    int result = -1;
-                    int32_t value;
-                    int32_t max = qctrl.maximum;
-                    int32_t min = qctrl.minimum;
-                    int32_t id = qctrl.id;
-
-                    result = ReadExtControl(fileDescriptor, value, id, "ReadEnumerationControl", "V4L2_CTRL_TYPE_INTEGER", V4L2_CTRL_ID2CLASS(qctrl.id));
-
-                    if (result == 0)
-                    {
-                        LOG_EX("Camera::EnumAllControlNewStyle VIDIOC_QUERYCTRL %s will be used for %s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), qctrl.name);
-                        m_ControlIdToControlNameMap[qctrl.id] = qctrl.name;
-                        m_ControlIdToFileDescriptorMap[qctrl.id] = fileDescriptor;
-                        emit SendIntDataToEnumerationWidget(id, min, max, value, name, unit, bIsReadOnly);
-                    }
-                }
-                else if (qctrl.type == V4L2_CTRL_TYPE_INTEGER64)
-                {
-                    int result = -1;
-                    int64_t value;
-                    int64_t max = qctrl.maximum;
-                    int64_t min = qctrl.minimum;
-                    int32_t id = qctrl.id;
-
-                    result = ReadExtControl(fileDescriptor, value, id, "ReadEnumerationControl", "V4L2_CTRL_TYPE_INTEGER64", V4L2_CTRL_ID2CLASS(qctrl.id));
-
-                    if (result == 0)
-                    {
-                        LOG_EX("Camera::EnumAllControlNewStyle VIDIOC_QUERYCTRL %s will be used for %s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), qctrl.name);
-                        m_ControlIdToControlNameMap[qctrl.id] = qctrl.name;
-                        m_ControlIdToFileDescriptorMap[qctrl.id] = fileDescriptor;
-                        emit SentInt64DataToEnumerationWidget(id, min, max, value, name, unit, bIsReadOnly);
-                    }
-                }
-                else if (qctrl.type == V4L2_CTRL_TYPE_BOOLEAN)
-                {
-                    int result = -1;
-                    int32_t value;
-                    int32_t id = qctrl.id;
-
-                    result = ReadExtControl(fileDescriptor, value, id, "ReadEnumerationControl", "V4L2_CTRL_TYPE_BOOLEAN", V4L2_CTRL_ID2CLASS(qctrl.id));
-
-                    if (result == 0)
-                    {
-                        LOG_EX("Camera::EnumAllControlNewStyle VIDIOC_QUERYCTRL %s will be used for %s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), qctrl.name);
-                        m_ControlIdToControlNameMap[qctrl.id] = qctrl.name;
-                        m_ControlIdToFileDescriptorMap[qctrl.id] = fileDescriptor;
-                        emit SendBoolDataToEnumerationWidget(id, static_cast<bool>(value), name, unit, bIsReadOnly);
-                    }
-                }
-                else if (qctrl.type == V4L2_CTRL_TYPE_BUTTON)
-                {
-                    int32_t id = qctrl.id;
-                    LOG_EX("Camera::EnumAllControlNewStyle VIDIOC_QUERYCTRL %s will be used for %s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), qctrl.name);
-                    m_ControlIdToControlNameMap[qctrl.id] = qctrl.name;
-                    m_ControlIdToFileDescriptorMap[qctrl.id] = fileDescriptor;
-                    emit SendButtonDataToEnumerationWidget(id, name, unit, bIsReadOnly);
-                }
-                else if (qctrl.type == V4L2_CTRL_TYPE_MENU)
-                {
-                    int result = -1;
-                    int32_t id = qctrl.id;
-                    int32_t value;
-                    QList<QString> list;
-
-                    result = ReadExtControl(fileDescriptor, value, id, "ReadEnumerationControl", "V4L2_CTRL_TYPE_MENU", V4L2_CTRL_ID2CLASS(qctrl.id));
-
-                    if (result == 0)
-                    {
-                        queryMenu.id = qctrl.id;
-                        for (queryMenu.index = qctrl.minimum; queryMenu.index <= qctrl.maximum; queryMenu.index++)
-                        {
-
-                            if (0 == iohelper::xioctl(fileDescriptor,
-                            VIDIOC_QUERYMENU, &queryMenu))
-                            {
-                                list.append(QString((const char*) queryMenu.name));
-                            }
-                        }
-                        LOG_EX("Camera::EnumAllControlNewStyle VIDIOC_QUERYCTRL %s will be used for %s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), qctrl.name);
-                        m_ControlIdToControlNameMap[qctrl.id] = qctrl.name;
-                        m_ControlIdToFileDescriptorMap[qctrl.id] = fileDescriptor;
-                        emit SendListDataToEnumerationWidget(id, value, list, name, unit, bIsReadOnly);
-                    }
-                }
-                else if (qctrl.type == V4L2_CTRL_TYPE_INTEGER_MENU)
+                if (qctrl.type == V4L2_CTRL_TYPE_INTEGER || qctrl.type == V4L2_CTRL_TYPE_INTEGER64 ||
+                    qctrl.type == V4L2_CTRL_TYPE_BOOLEAN || qctrl.type == V4L2_CTRL_TYPE_BUTTON ||
+                    qctrl.type == V4L2_CTRL_TYPE_MENU || qctrl.type == V4L2_CTRL_TYPE_INTEGER_MENU)
                 {
-                    int result = -1;
-                    int32_t id = qctrl.id;
-                    int32_t value;
-                    QList<int64_t> list;
-
-                    result = ReadExtControl(fileDescriptor, value, id, "ReadEnumerationControl", "V4L2_CTRL_TYPE_INTEGER_MENU", V4L2_CTRL_ID2CLASS(qctrl.id));
+                    LOG_EX("Camera::EnumAllControlNewStyle VIDIOC_QUERYCTRL %s id=%d=%s min=%ld, max=%ld, default=%ld", GetFileDescriptorName(fileDescriptor).c_str(), qctrl.id, v4l2helper::ConvertControlID2String(qctrl.id).c_str(), qctrl.minimum, qctrl.maximum, qctrl.default_value);
+                    cidCount++;
 
-                    if (result == 0)
-                    {
-                        queryMenu.id = qctrl.id;
-                        for (queryMenu.index = qctrl.minimum; queryMenu.index <= qctrl.maximum; queryMenu.index++)
-                        {
-                            if (0 == iohelper::xioctl(fileDescriptor,
-                            VIDIOC_QUERYMENU, &queryMenu))
-                            {
-                                list.append(queryMenu.value);
-                            }
-                        }
-                        LOG_EX("Camera::EnumAllControlNewStyle VIDIOC_QUERYCTRL %s will be used for %s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), qctrl.name);
-                        m_ControlIdToControlNameMap[qctrl.id] = qctrl.name;
-                        m_ControlIdToFileDescriptorMap[qctrl.id] = fileDescriptor;
-                        emit SendListIntDataToEnumerationWidget(id, value, list, name, unit, bIsReadOnly);
-                    }
+                    AddControlDescription(qctrl, fileDescriptor);
                 }
             }
             qctrl.id |= V4L2_CTRL_FLAG_NEXT_CTRL;
@@ -1462,121 +1441,835 @@ int Camera::EnumAllControlNewStyle()
 
         if (0 == cidCount)
         {
-            LOG_EX("Camera::EnumAllControlNewStyle VIDIOC_QUERYCTRL %s returned error, no controls can be enumerated.", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+            LOG_EX("Camera::EnumAllControlNewStyle VIDIOC_QUERYCTRL %s returned error, no controls can be enumerated.", GetFileDescriptorName(fileDescriptor).c_str());
         }
         else
         {
-            LOG_EX("Camera::EnumAllControlNewStyle VIDIOC_QUERYCTRL %s: NumControls=%d", m_FileDescriptorToNameMap[fileDescriptor].c_str(), cidCount);
+            LOG_EX("Camera::EnumAllControlNewStyle VIDIOC_QUERYCTRL %s: NumControls=%d", GetFileDescriptorName(fileDescriptor).c_str(), cidCount);
             result = 0;
         }
     }
+
+    LOG_EX("Camera::EnumAllControlNewStyle %d controls described in %lld ms", static_cast<int>(m_ControlDescriptions.size()), static_cast<long long>(enumerationTimer.elapsed()));
+
+    // the capability cache belongs to the GUI thread, OnControlsDescribed compares the walk
+    QMutexLocker locker(&m_ControlDescriptionMutex);
+    m_DescribedControls.swap(controls);
+
     return result;
 }
 
-template<typename T> T        getExtCtrlValue          (const v4l2_ext_control& extCtrl);
-template<>           int32_t  getExtCtrlValue<int32_t> (const v4l2_ext_control& extCtrl) {return extCtrl.value;}
-template<>           uint32_t getExtCtrlValue<uint32_t>(const v4l2_ext_control& extCtrl) {return extCtrl.value;}
-template<>           int64_t  getExtCtrlValue<int64_t> (const v4l2_ext_control& extCtrl) {return extCtrl.value64;}
-template<>           uint64_t getExtCtrlValue<uint64_t>(const v4l2_ext_control& extCtrl) {return extCtrl.value64;}
-
-template<typename T>
-int Camera::ReadExtControl(int fileDescriptor, T &value, uint32_t controlID, const char *functionName, const char *controlName, uint32_t controlClass)
+// Inactive, grabbed and volatile controls are shown but not written
+static bool IsControlReadOnly(uint32_t flags)
 {
-    QMutexLocker locker(&m_ReadExtControlMutex);
-    int result = -1;
-    v4l2_queryctrl ctrl;
-
-    CLEAR(ctrl);
-    ctrl.id = controlID;
+    if (flags & V4L2_CTRL_FLAG_INACTIVE || flags & V4L2_CTRL_FLAG_GRABBED)
+    {
+        return true;
+    }
 
-    if (iohelper::xioctl(fileDescriptor, VIDIOC_QUERYCTRL, &ctrl) >= 0)
+    if (flags & V4L2_CTRL_FLAG_VOLATILE && (flags & V4L2_CTRL_FLAG_EXECUTE_ON_WRITE) == 0)
     {
-        v4l2_ext_controls extCtrls;
-        v4l2_ext_control extCtrl;
+        return true;
+    }
 
-        LOG_EX("Camera::ReadExtControl VIDIOC_QUERYCTRL %s function name: %s control name: %s OK, min=%d, max=%d, default=%d", m_FileDescriptorToNameMap[fileDescriptor].c_str(), functionName, controlName, ctrl.minimum, ctrl.maximum, ctrl.default_value);
+    return false;
+}
 
-        CLEAR(extCtrls);
-        CLEAR(extCtrl);
-        extCtrl.id = controlID;
+void Camera::AddControlDescription(const v4l2_query_ext_ctrl &qctrl, int fileDescriptor)
+{
+    if (m_pEventHandler != nullptr) {
+        m_pEventHandler->SubscribeControl(qctrl.id);
+    }
 
-        extCtrls.controls = &extCtrl;
-        extCtrls.count = 1;
-        extCtrls.ctrl_class = controlClass;
+    ControlDescription description;
+    description.id = qctrl.id;
+    description.type = qctrl.type;
+    description.flags = qctrl.flags;
+    description.fileDescriptor = fileDescriptor;
+    description.minimum = qctrl.minimum;
+    description.maximum = qctrl.maximum;
+    description.name = QString((const char*) qctrl.name);
+    if(UsesSubdevices()) {
+        description.name += QString(" (") + (fileDescriptor == m_DeviceFileDescriptor ? "d" : "s") + ")";
+    }
+    description.unit = QString::fromStdString(v4l2helper::GetControlUnit(qctrl.id));
+    description.bIsReadOnly = IsControlReadOnly(qctrl.flags);
+    description.bIsMenuRead = false;
 
-        if (-1 != iohelper::xioctl(fileDescriptor, VIDIOC_G_EXT_CTRLS, &extCtrls))
-        {
-            LOG_EX("Camera::ReadExtControl VIDIOC_G_EXT_CTRLS %s function name: %s control name: %s OK =%d", m_FileDescriptorToNameMap[fileDescriptor].c_str(), functionName, controlName, extCtrl.value);
+    {
+        // events of the controls subscribed above may already arrive
+        QMutexLocker locker(&m_ControlDescriptionMutex);
+        m_ControlDescriptionIndex[qctrl.id] = m_ControlDescriptions.size();
+        m_ControlDescriptions.push_back(description);
+    }
 
-            value = getExtCtrlValue<T>(extCtrl);
+    QMutexLocker locker(&m_ControlMapMutex);
+    m_ControlIdToControlNameMap[qctrl.id] = (const char*) qctrl.name;
+    m_ControlIdToFileDescriptorMap[qctrl.id] = fileDescriptor;
+    m_ControlIdToTypeMap[qctrl.id] = qctrl.type;
+}
 
-            result = 0;
-        }
-        else
-        {
-            LOG_EX("Camera::ReadExtControl VIDIOC_G_CTRL %s function name: %s control name: %s failed errno=%d=%s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), functionName, controlName, errno, v4l2helper::ConvertErrno2String(errno).c_str());
+int Camera::LoadCapabilityCache()
+{
+    m_CapabilityCache.Clear();
 
-            result = -2;
-        }
+    v4l2_capability cap;
+    std::string serialNumber = getAvtDeviceSerialNumber();
+    if (serialNumber.empty() || -1 == QueryCapability(m_DeviceFileDescriptor, cap))
+    {
+        LOG_EX("Camera::LoadCapabilityCache %s has no serial number, the capabilities are kept for this session only", m_DeviceName.c_str());
+        return -1;
     }
-    else
+
+    QString key = QString("%1/%2/%3/%4/%5.%6.%7/%8")
+        .arg(QString::fromStdString(serialNumber))
+        .arg(QString::fromStdString(getAvtDeviceFirmwareVersion()))
+        .arg(QString((const char*) cap.driver))
+        .arg(QString((const char*) cap.card))
+        .arg((cap.version >> 16) & 0xFF)
+        .arg((cap.version >> 8) & 0xFF)
+        .arg(cap.version & 0xFF)
+        .arg(static_cast<int>(m_SubDeviceFileDescriptors.size()));
+
+    // the key holds everything which changes the capabilities, the controls of the
+    // entry are compared with the single walk of EnumAllControlNewStyle
+    m_CapabilityCache.SetKey(key);
+    if (0 != m_CapabilityCache.Load())
     {
-        LOG_EX("Camera::ReadExtControl VIDIOC_QUERYCTRL %s function name: %s control name: %s failed errno=%d=%s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), functionName, controlName, errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        return -1;
+    }
 
-        result = -2;
+    LOG_EX("Camera::LoadCapabilityCache capabilities of %s served from the stored entry", m_DeviceName.c_str());
+
+    return 0;
+}
+
+int Camera::QueryCapability(int fileDescriptor, v4l2_capability &cap)
+{
+    std::map<int, v4l2_capability>::const_iterator it = m_DeviceCapabilities.find(fileDescriptor);
+    if (it != m_DeviceCapabilities.end())
+    {
+        cap = it->second;
+        return 0;
+    }
+
+    return iohelper::xioctl(fileDescriptor, VIDIOC_QUERYCAP, &cap);
+}
+
+void Camera::RequestControlValues()
+{
+    bool bIsDescribed = false;
+    {
+        QMutexLocker locker(&m_ControlDescriptionMutex);
+        bIsDescribed = !m_ControlDescriptions.empty();
+    }
+
+    if (bIsDescribed)
+    {
+        m_ControlEnumerator.Request();
+    }
+}
+
+void Camera::RequestControlDescriptions()
+{
+    m_ControlEnumerator.RequestDescriptions();
+}
+
+void Camera::OnDescribeControls()
+{
+    EnumAllControlNewStyle();
+}
+
+void Camera::OnControlsDescribed()
+{
+    std::vector<CachedControl> controls;
+    int32_t controlCount = 0;
+    {
+        QMutexLocker locker(&m_ControlDescriptionMutex);
+        controls.swap(m_DescribedControls);
+        controlCount = static_cast<int32_t>(m_ControlDescriptions.size());
+    }
+
+    // a firmware or driver which adds or removes any control drops the stored entry,
+    // the formats are listed again by the next ReadFormats
+    if (!controls.empty())
+    {
+        if (!m_CapabilityCache.GetControls().empty() && !IsSameControlWalk(m_CapabilityCache.GetControls(), controls))
+        {
+            LOG_EX("Camera::OnControlsDescribed stored capabilities of %s do not match the device, they are listed again", m_DeviceName.c_str());
+            m_CapabilityCache.Invalidate();
+        }
+
+        if (m_CapabilityCache.GetControls().empty())
+        {
+            m_CapabilityCache.SetControls(controls);
+            m_CapabilityCache.Save();
+        }
+    }
+
+    emit SendControlsDescribed(controlCount);
+}
+
+void Camera::OnEnumerateControls()
+{
+    QElapsedTimer enumerationTimer;
+    enumerationTimer.start();
+
+    std::vector<ControlTransactionItem> items;
+    std::vector<size_t> itemIndices(m_ControlDescriptions.size(), 0);
+    for (size_t i = 0; i < m_ControlDescriptions.size(); i++)
+    {
+        if (V4L2_CTRL_TYPE_BUTTON != m_ControlDescriptions[i].type)
+        {
+            ControlTransactionItem item = {m_ControlDescriptions[i].id, 0, -2};
+            itemIndices[i] = items.size();
+            items.push_back(item);
+        }
+    }
+
+    // one ioctl per device and control class instead of two per control
+    ReadExtControls(items);
+
+    std::map<uint32_t, int64_t> values;
+    int32_t controlCount = 0;
+    int32_t changedCount = 0;
+    for (size_t i = 0; i < m_ControlDescriptions.size(); i++)
+    {
+        ControlDescription description;
+        {
+            QMutexLocker locker(&m_ControlDescriptionMutex);
+            description = m_ControlDescriptions[i];
+        }
+        int32_t id = description.id;
+        int64_t value = 0;
+        int result = 0;
+
+        if (V4L2_CTRL_TYPE_BUTTON != description.type)
+        {
+            value = items[itemIndices[i]].value;
+            result = items[itemIndices[i]].result;
+
+            // a group is rejected as a whole when one of its controls fails
+            if (0 != result)
+            {
+                if (V4L2_CTRL_TYPE_INTEGER64 == description.type)
+                {
+                    result = ReadExtControl(description.fileDescriptor, value, id, "ReadEnumerationControl", "V4L2_CTRL_TYPE_INTEGER64", V4L2_CTRL_ID2CLASS(id));
+                }
+                else
+                {
+                    int32_t value32 = 0;
+                    result = ReadExtControl(description.fileDescriptor, value32, id, "ReadEnumerationControl", "V4L2_CTRL_TYPE_INTEGER", V4L2_CTRL_ID2CLASS(id));
+                    value = value32;
+                }
+            }
+
+            if (0 != result)
+            {
+                continue;
+            }
+
+            AddCachedControl(id, value, description.flags);
+            values[id] = value;
+        }
+        controlCount++;
+
+        // only changed values are sent, the first pass after opening sends all
+        std::map<uint32_t, int64_t>::iterator itLast = m_LastControlValues.find(id);
+        if (itLast != m_LastControlValues.end() && itLast->second == value)
+        {
+            continue;
+        }
+        m_LastControlValues[id] = value;
+        changedCount++;
+
+        // menus are sent without items, they are read when the widget is created
+        switch (description.type)
+        {
+        case V4L2_CTRL_TYPE_INTEGER:
+            emit SendIntDataToEnumerationWidget(id, static_cast<int32_t>(description.minimum), static_cast<int32_t>(description.maximum), static_cast<int32_t>(value), description.name, description.unit, description.bIsReadOnly);
+            break;
+        case V4L2_CTRL_TYPE_INTEGER64:
+            emit SentInt64DataToEnumerationWidget(id, description.minimum, description.maximum, value, description.name, description.unit, description.bIsReadOnly);
+            break;
+        case V4L2_CTRL_TYPE_BOOLEAN:
+            emit SendBoolDataToEnumerationWidget(id, static_cast<bool>(value), description.name, description.unit, description.bIsReadOnly);
+            break;
+        case V4L2_CTRL_TYPE_BUTTON:
+            emit SendButtonDataToEnumerationWidget(id, description.name, description.unit, description.bIsReadOnly);
+            break;
+        case V4L2_CTRL_TYPE_MENU:
+            emit SendListDataToEnumerationWidget(id, static_cast<int32_t>(value), QList<QString>(), description.name, description.unit, description.bIsReadOnly);
+            break;
+        case V4L2_CTRL_TYPE_INTEGER_MENU:
+            emit SendListIntDataToEnumerationWidget(id, static_cast<int32_t>(value), QList<int64_t>(), description.name, description.unit, description.bIsReadOnly);
+            break;
+        }
+    }
+
+    DeviceState state;
+    ReadDeviceState(values, state);
+
+    // a value which appeared or disappeared is a change as well
+    uint32_t changedMask = state.validMask ^ m_LastDeviceState.validMask;
+    uint32_t commonMask = state.validMask & m_LastDeviceState.validMask;
+    if ((commonMask & DeviceStateGain) && state.gain != m_LastDeviceState.gain)                                 changedMask |= DeviceStateGain;
+    if ((commonMask & DeviceStateAutoGain) && state.bAutoGain != m_LastDeviceState.bAutoGain)                   changedMask |= DeviceStateAutoGain;
+    if ((commonMask & DeviceStateExposure) && state.exposure != m_LastDeviceState.exposure)                     changedMask |= DeviceStateExposure;
+    if ((commonMask & DeviceStateAutoExposure) && state.bAutoExposure != m_LastDeviceState.bAutoExposure)       changedMask |= DeviceStateAutoExposure;
+    if ((commonMask & DeviceStateGamma) && state.gamma != m_LastDeviceState.gamma)                              changedMask |= DeviceStateGamma;
+    if ((commonMask & DeviceStateBrightness) && state.brightness != m_LastDeviceState.brightness)               changedMask |= DeviceStateBrightness;
+    if ((commonMask & DeviceStateAutoWhiteBalance) && state.bAutoWhiteBalance != m_LastDeviceState.bAutoWhiteBalance) changedMask |= DeviceStateAutoWhiteBalance;
+    if ((commonMask & DeviceStateFrameSize) && (state.width != m_LastDeviceState.width || state.height != m_LastDeviceState.height)) changedMask |= DeviceStateFrameSize;
+    m_LastDeviceState = state;
+
+    LOG_EX("Camera::OnEnumerateControls %d control values read in %lld ms, %d changed, device state changes 0x%x", controlCount, static_cast<long long>(enumerationTimer.elapsed()), changedCount, changedMask);
+
+    if (0 != changedMask)
+    {
+        emit SendDeviceState(state, changedMask);
+    }
+
+    emit SendControlValuesRead(controlCount);
+}
+
+void Camera::ReadDeviceState(const std::map<uint32_t, int64_t> &values, DeviceState &state)
+{
+    std::map<uint32_t, int64_t>::const_iterator itValue;
+
+    state = DeviceState();
+
+    // the controls of the main panel are part of the pass already
+    if ((itValue = values.find(V4L2_CID_GAIN)) != values.end())
+    {
+        state.gain = itValue->second;
+        state.validMask |= DeviceStateGain;
+    }
+    if ((itValue = values.find(V4L2_CID_AUTOGAIN)) != values.end())
+    {
+        state.bAutoGain = (0 != itValue->second);
+        state.validMask |= DeviceStateAutoGain;
+    }
+    if ((itValue = values.find(V4L2_CID_EXPOSURE)) != values.end())
+    {
+        state.exposure = itValue->second;
+        state.validMask |= DeviceStateExposure;
+    }
+    if ((itValue = values.find(V4L2_CID_EXPOSURE_AUTO)) != values.end())
+    {
+        state.bAutoExposure = (V4L2_EXPOSURE_AUTO == itValue->second);
+        state.validMask |= DeviceStateAutoExposure;
+    }
+    if ((itValue = values.find(V4L2_CID_GAMMA)) != values.end())
+    {
+        state.gamma = itValue->second;
+        state.validMask |= DeviceStateGamma;
+    }
+    if ((itValue = values.find(V4L2_CID_BRIGHTNESS)) != values.end())
+    {
+        state.brightness = itValue->second;
+        state.validMask |= DeviceStateBrightness;
+    }
+    if ((itValue = values.find(V4L2_CID_AUTO_WHITE_BALANCE)) != values.end())
+    {
+        state.bAutoWhiteBalance = (V4L2_WHITE_BALANCE_AUTO == itValue->second);
+        state.validMask |= DeviceStateAutoWhiteBalance;
+    }
+
+    if (0 == ReadFrameSize(state.width, state.height))
+    {
+        state.validMask |= DeviceStateFrameSize;
+    }
+}
+
+int Camera::GetControlDescription(uint32_t controlID, ControlDescription &description) const
+{
+    QMutexLocker locker(&m_ControlDescriptionMutex);
+
+    std::map<uint32_t, size_t>::const_iterator itIndex = m_ControlDescriptionIndex.find(controlID);
+    if (itIndex == m_ControlDescriptionIndex.end())
+    {
+        return -1;
+    }
+
+    description = m_ControlDescriptions[itIndex->second];
+    return 0;
+}
+
+void Camera::UpdateControlDescription(uint32_t controlID, const v4l2_event_ctrl &ctrl)
+{
+    ControlDescription description;
+    if (0 != GetControlDescription(controlID, description))
+    {
+        return;
+    }
+
+    // the event carries a 32 bit range only
+    int64_t minimum = ctrl.minimum;
+    int64_t maximum = ctrl.maximum;
+    uint32_t flags = ctrl.flags;
+
+    v4l2_query_ext_ctrl qctrl;
+    CLEAR(qctrl);
+    qctrl.id = controlID;
+    if (0 == iohelper::xioctl(description.fileDescriptor, VIDIOC_QUERY_EXT_CTRL, &qctrl))
+    {
+        minimum = qctrl.minimum;
+        maximum = qctrl.maximum;
+        flags = qctrl.flags;
+    }
+
+    QMutexLocker locker(&m_ControlDescriptionMutex);
+
+    std::map<uint32_t, size_t>::const_iterator itIndex = m_ControlDescriptionIndex.find(controlID);
+    if (itIndex != m_ControlDescriptionIndex.end())
+    {
+        ControlDescription &current = m_ControlDescriptions[itIndex->second];
+        if (ctrl.changes & V4L2_EVENT_CTRL_CH_RANGE)
+        {
+            current.minimum = minimum;
+            current.maximum = maximum;
+            // the items are queried again for the new range
+            current.menuItems.clear();
+            current.bIsMenuRead = false;
+        }
+        current.flags = flags;
+        current.bIsReadOnly = IsControlReadOnly(flags);
+    }
+}
+
+void Camera::StartDeviceStateSync()
+{
+    m_pDeviceStateReader->StartThread();
+}
+
+void Camera::StopDeviceStateSync()
+{
+    m_pDeviceStateReader->StopThread();
+}
+
+void Camera::OnDeviceStateTimer()
+{
+    // passes requested while one is running are merged
+    RequestControlValues();
+}
+
+int Camera::ReadMenuItems(uint32_t controlID, QList<ControlMenuItem> &items)
+{
+    ControlDescription description;
+    if (0 != GetControlDescription(controlID, description) ||
+        (V4L2_CTRL_TYPE_MENU != description.type && V4L2_CTRL_TYPE_INTEGER_MENU != description.type))
+    {
+        return -1;
+    }
+
+    if (description.bIsMenuRead)
+    {
+        items = description.menuItems;
+        return 0;
+    }
+
+    v4l2_querymenu queryMenu;
+
+    CLEAR(queryMenu);
+    queryMenu.id = description.id;
+    for (int64_t index = description.minimum; index <= description.maximum; index++)
+    {
+        queryMenu.index = static_cast<uint32_t>(index);
+        if (0 == iohelper::xioctl(description.fileDescriptor, VIDIOC_QUERYMENU, &queryMenu))
+        {
+            ControlMenuItem item;
+            item.index = queryMenu.index;
+            item.name = QString((const char*) queryMenu.name);
+            item.value = queryMenu.value;
+            items.append(item);
+        }
+    }
+
+    QMutexLocker locker(&m_ControlDescriptionMutex);
+
+    // a range change while the menu was queried leaves the items to the next call
+    std::map<uint32_t, size_t>::const_iterator itIndex = m_ControlDescriptionIndex.find(controlID);
+    if (itIndex != m_ControlDescriptionIndex.end())
+    {
+        ControlDescription &current = m_ControlDescriptions[itIndex->second];
+        if (current.minimum == description.minimum && current.maximum == description.maximum)
+        {
+            current.menuItems = items;
+            current.bIsMenuRead = true;
+        }
+    }
+
+    return 0;
+}
+
+int Camera::ReadControlMenu(int32_t id, QList<QString> &list)
+{
+    QList<ControlMenuItem> items;
+    if (V4L2_CTRL_TYPE_MENU != GetControlType(id) || 0 != ReadMenuItems(id, items))
+    {
+        return -1;
+    }
+
+    for (const ControlMenuItem &item : items)
+    {
+        list.append(item.name);
+    }
+
+    return 0;
+}
+
+int Camera::ReadControlMenu(int32_t id, QList<int64_t> &list)
+{
+    QList<ControlMenuItem> items;
+    if (V4L2_CTRL_TYPE_INTEGER_MENU != GetControlType(id) || 0 != ReadMenuItems(id, items))
+    {
+        return -1;
+    }
+
+    for (const ControlMenuItem &item : items)
+    {
+        list.append(item.value);
+    }
+
+    return 0;
+}
+
+template<typename T> T        getExtCtrlValue          (const v4l2_ext_control& extCtrl);
+template<>           int32_t  getExtCtrlValue<int32_t> (const v4l2_ext_control& extCtrl) {return extCtrl.value;}
+template<>           uint32_t getExtCtrlValue<uint32_t>(const v4l2_ext_control& extCtrl) {return extCtrl.value;}
+template<>           int64_t  getExtCtrlValue<int64_t> (const v4l2_ext_control& extCtrl) {return extCtrl.value64;}
+template<>           uint64_t getExtCtrlValue<uint64_t>(const v4l2_ext_control& extCtrl) {return extCtrl.value64;}
+
+template<typename T>
+int Camera::ReadExtControl(int fileDescriptor, T &value, uint32_t controlID, const char *functionName, const char *controlName, uint32_t controlClass)
+{
+    QMutexLocker locker(&m_ReadExtControlMutex);
+    int result = -1;
+    v4l2_queryctrl ctrl;
+
+    CLEAR(ctrl);
+    ctrl.id = controlID;
+
+    if (iohelper::xioctl(fileDescriptor, VIDIOC_QUERYCTRL, &ctrl) >= 0)
+    {
+        v4l2_ext_controls extCtrls;
+        v4l2_ext_control extCtrl;
+
+        LOG_EX("Camera::ReadExtControl VIDIOC_QUERYCTRL %s function name: %s control name: %s OK, min=%d, max=%d, default=%d", GetFileDescriptorName(fileDescriptor).c_str(), functionName, controlName, ctrl.minimum, ctrl.maximum, ctrl.default_value);
+
+        CLEAR(extCtrls);
+        CLEAR(extCtrl);
+        extCtrl.id = controlID;
+
+        extCtrls.controls = &extCtrl;
+        extCtrls.count = 1;
+        extCtrls.ctrl_class = controlClass;
+
+        if (-1 != iohelper::xioctl(fileDescriptor, VIDIOC_G_EXT_CTRLS, &extCtrls))
+        {
+            LOG_EX("Camera::ReadExtControl VIDIOC_G_EXT_CTRLS %s function name: %s control name: %s OK =%d", GetFileDescriptorName(fileDescriptor).c_str(), functionName, controlName, extCtrl.value);
+
+            value = getExtCtrlValue<T>(extCtrl);
+
+            result = 0;
+        }
+        else
+        {
+            LOG_EX("Camera::ReadExtControl VIDIOC_G_CTRL %s function name: %s control name: %s failed errno=%d=%s", GetFileDescriptorName(fileDescriptor).c_str(), functionName, controlName, errno, v4l2helper::ConvertErrno2String(errno).c_str());
+
+            result = -2;
+        }
+    }
+    else
+    {
+        LOG_EX("Camera::ReadExtControl VIDIOC_QUERYCTRL %s function name: %s control name: %s failed errno=%d=%s", GetFileDescriptorName(fileDescriptor).c_str(), functionName, controlName, errno, v4l2helper::ConvertErrno2String(errno).c_str());
+
+        result = -2;
+    }
+
+    return result;
+}
+
+template<typename T>
+int Camera::ReadExtControl(T &value, uint32_t controlID, const char *functionName, const char* controlName, uint32_t controlClass, bool bRefresh)
+{
+    {
+        QMutexLocker locker(&m_ControlCacheMutex);
+        std::map<uint32_t, ControlCacheEntry>::const_iterator itEntry = m_ControlCache.find(controlID);
+
+        // volatile values change without events, they are only read again when asked for
+        if (!bRefresh && itEntry != m_ControlCache.end() && itEntry->second.bValid)
+        {
+            value = static_cast<T>(itEntry->second.value);
+            m_ControlCacheHits++;
+            return 0;
+        }
+
+        m_ControlCacheMisses++;
+    }
+
+    int fileDescriptor = GetControlFileDescriptor(controlID);
+    if (-1 == fileDescriptor)
+    {
+        LOG_EX("Camera::ReadExtControl function name: %s control name: %s is not enumerated", functionName, controlName);
+        return -1;
+    }
+
+    LOG_EX("Camera::ReadExtControl %s control %s", GetFileDescriptorName(fileDescriptor).c_str(), GetControlName(controlID).c_str());
+    int result = ReadExtControl(fileDescriptor, value, controlID, functionName, controlName, controlClass);
+
+    if (0 == result)
+    {
+        UpdateCachedControl(controlID, static_cast<int64_t>(value));
+    }
+
+    return result;
+}
+
+void Camera::AddCachedControl(uint32_t controlID, int64_t value, uint32_t flags)
+{
+    // without events a cached value could not be kept up to date
+    if (m_pEventHandler == nullptr)
+    {
+        return;
+    }
+
+    QMutexLocker locker(&m_ControlCacheMutex);
+    ControlCacheEntry &entry = m_ControlCache[controlID];
+    entry.value = value;
+    entry.flags = flags;
+    entry.bValid = true;
+}
+
+void Camera::UpdateCachedControl(uint32_t controlID, int64_t value)
+{
+    QMutexLocker locker(&m_ControlCacheMutex);
+    std::map<uint32_t, ControlCacheEntry>::iterator itEntry = m_ControlCache.find(controlID);
+
+    if (itEntry != m_ControlCache.end())
+    {
+        itEntry->second.value = value;
+        itEntry->second.bValid = true;
+    }
+}
+
+void Camera::InvalidateCachedControl(uint32_t controlID)
+{
+    QMutexLocker locker(&m_ControlCacheMutex);
+    std::map<uint32_t, ControlCacheEntry>::iterator itEntry = m_ControlCache.find(controlID);
+
+    if (itEntry != m_ControlCache.end())
+    {
+        itEntry->second.bValid = false;
+    }
+}
+
+template<typename T> void setExtCtrlValue                         (v4l2_ext_control& extCtrl, const T& value);
+template<>           void setExtCtrlValue<int32_t>                (v4l2_ext_control& extCtrl, const int32_t& value)                 {extCtrl.value = value;}
+template<>           void setExtCtrlValue<uint32_t>               (v4l2_ext_control& extCtrl, const uint32_t& value)                {extCtrl.value = value;}
+template<>           void setExtCtrlValue<int64_t>                (v4l2_ext_control& extCtrl, const int64_t& value)                 {extCtrl.value64 = value;}
+template<>           void setExtCtrlValue<uint64_t>               (v4l2_ext_control& extCtrl, const uint64_t& value)                {extCtrl.value64 = value;}
+template<>           void setExtCtrlValue<v4l2_exposure_auto_type>(v4l2_ext_control& extCtrl, const v4l2_exposure_auto_type& value) {extCtrl.value = value;}
+template<>           void setExtCtrlValue<bool>                   (v4l2_ext_control& extCtrl, const bool& value)                    {extCtrl.value = value;}
+
+template<typename T>
+int Camera::SetExtControl(T value, uint32_t controlID, const char *functionName, const char *controlName, uint32_t controlClass)
+{
+    int result = -1;
+    v4l2_ext_controls extCtrls;
+    v4l2_ext_control extCtrl;
+
+    // a direct write replaces a value the writer thread has not written yet
+    if (QThread::currentThread() != &m_ControlWriter)
+    {
+        m_ControlWriter.Discard(controlID);
+    }
+
+    CLEAR(extCtrls);
+    CLEAR(extCtrl);
+    extCtrl.id = controlID;
+    setExtCtrlValue<T>(extCtrl, value);
+
+    extCtrls.controls = &extCtrl;
+    extCtrls.count = 1;
+    extCtrls.ctrl_class = controlClass;
+
+    int fileDescriptor = GetControlFileDescriptor(controlID);
+    if (-1 == fileDescriptor)
+    {
+        LOG_EX("Camera::SetExtControl function name: %s control name: %s is not enumerated", functionName, controlName);
+        return result;
+    }
+    const std::string deviceName = GetFileDescriptorName(fileDescriptor);
+    const std::string name = GetControlName(controlID);
+
+    if (-1 != iohelper::xioctl(fileDescriptor, VIDIOC_TRY_EXT_CTRLS, &extCtrls))
+    {
+        // the driver may adjust the value, the next read asks the device
+        InvalidateCachedControl(controlID);
+
+        if (-1 != iohelper::xioctl(fileDescriptor, VIDIOC_S_EXT_CTRLS, &extCtrls))
+        {
+            LOG_EX("Camera::SetExtControl VIDIOC_S_EXT_CTRLS %s function name: %s control name: %s (%s) to %d OK", deviceName.c_str(), functionName, controlName, name.c_str(), value);
+            result = 0;
+        }
+        else
+        {
+            LOG_EX("Camera::SetExtControlVIDIOC_S_EXT_CTRLS %s function name: %s control name: %s (%s) failed errno=%d=%s", deviceName.c_str(), functionName, controlName, name.c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        }
+    }
+    else
+    {
+        LOG_EX("Camera::SetExtControl VIDIOC_TRY_EXT_CTRLS %s function name: %s control name: %s (%s) failed errno=%d=%s", deviceName.c_str(), functionName, controlName, name.c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+    }
+
+    return result;
+}
+
+int Camera::RunExtControlTransaction(std::vector<ControlTransactionItem> &controls, unsigned long request)
+{
+    const char *requestName = (VIDIOC_S_EXT_CTRLS == request) ? "VIDIOC_S_EXT_CTRLS" : "VIDIOC_G_EXT_CTRLS";
+    std::map<std::pair<int, uint32_t>, std::vector<size_t> > groups;
+    int result = 0;
+
+    for (size_t i = 0; i < controls.size(); i++)
+    {
+        int fileDescriptor = GetControlFileDescriptor(controls[i].controlID);
+
+        controls[i].result = -2;
+        if (-1 == fileDescriptor)
+        {
+            LOG_EX("Camera::RunExtControlTransaction control %d is unknown", controls[i].controlID);
+            result = -1;
+            continue;
+        }
+
+        groups[std::make_pair(fileDescriptor, V4L2_CTRL_ID2CLASS(controls[i].controlID))].push_back(i);
+    }
+
+    std::vector<v4l2_ext_control> extCtrlList;
+    for (const auto & group : groups)
+    {
+        const std::vector<size_t> &indices = group.second;
+        int fileDescriptor = group.first.first;
+
+        extCtrlList.assign(indices.size(), v4l2_ext_control());
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            const ControlTransactionItem &item = controls[indices[i]];
+
+            extCtrlList[i].id = item.controlID;
+            if (VIDIOC_S_EXT_CTRLS == request)
+            {
+                if (V4L2_CTRL_TYPE_INTEGER64 == GetControlType(item.controlID))
+                {
+                    extCtrlList[i].value64 = item.value;
+                }
+                else
+                {
+                    extCtrlList[i].value = static_cast<int32_t>(item.value);
+                }
+                // the driver may adjust the values, the next read asks the device
+                InvalidateCachedControl(item.controlID);
+            }
+        }
+
+        v4l2_ext_controls extCtrls;
+        CLEAR(extCtrls);
+        extCtrls.ctrl_class = group.first.second;
+        extCtrls.count = extCtrlList.size();
+        extCtrls.controls = &extCtrlList[0];
+
+        if (-1 != iohelper::xioctl(fileDescriptor, request, &extCtrls))
+        {
+            LOG_EX("Camera::RunExtControlTransaction %s %s %d controls OK", requestName, GetFileDescriptorName(fileDescriptor).c_str(), extCtrls.count);
+
+            for (size_t i = 0; i < indices.size(); i++)
+            {
+                ControlTransactionItem &item = controls[indices[i]];
+
+                if (VIDIOC_G_EXT_CTRLS == request)
+                {
+                    item.value = (V4L2_CTRL_TYPE_INTEGER64 == GetControlType(item.controlID)) ? extCtrlList[i].value64 : extCtrlList[i].value;
+                    UpdateCachedControl(item.controlID, item.value);
+                }
+                item.result = 0;
+            }
+        }
+        else
+        {
+            LOG_EX("Camera::RunExtControlTransaction %s %s failed at index %d of %d errno=%d=%s", requestName, GetFileDescriptorName(fileDescriptor).c_str(), extCtrls.error_idx, extCtrls.count, errno, v4l2helper::ConvertErrno2String(errno).c_str());
+
+            // error_idx equal to count means the group was rejected by the validation
+            // and nothing was applied, the controls stay at -2. Otherwise the control at
+            // error_idx failed and a write may already have applied the ones before it.
+            if (extCtrls.error_idx < indices.size())
+            {
+                if (VIDIOC_S_EXT_CTRLS == request)
+                {
+                    for (size_t i = 0; i < extCtrls.error_idx; i++)
+                    {
+                        controls[indices[i]].result = -3;
+                    }
+                }
+                controls[indices[extCtrls.error_idx]].result = -1;
+            }
+            result = -1;
+        }
     }
 
     return result;
 }
 
-template<typename T>
-int Camera::ReadExtControl(T &value, uint32_t controlID, const char *functionName, const char* controlName, uint32_t controlClass)
+int Camera::ReadExtControls(std::vector<ControlTransactionItem> &controls)
 {
-    LOG_EX("Camera::ReadExtControl %s control %s", m_FileDescriptorToNameMap[m_ControlIdToFileDescriptorMap[controlID]].c_str(), m_ControlIdToControlNameMap[controlID].c_str());
-    return ReadExtControl(m_ControlIdToFileDescriptorMap[controlID], value, controlID, functionName, controlName, controlClass);
-}
+    QMutexLocker locker(&m_ReadExtControlMutex);
 
-template<typename T> void setExtCtrlValue                         (v4l2_ext_control& extCtrl, const T& value);
-template<>           void setExtCtrlValue<int32_t>                (v4l2_ext_control& extCtrl, const int32_t& value)                 {extCtrl.value = value;}
-template<>           void setExtCtrlValue<uint32_t>               (v4l2_ext_control& extCtrl, const uint32_t& value)                {extCtrl.value = value;}
-template<>           void setExtCtrlValue<int64_t>                (v4l2_ext_control& extCtrl, const int64_t& value)                 {extCtrl.value64 = value;}
-template<>           void setExtCtrlValue<uint64_t>               (v4l2_ext_control& extCtrl, const uint64_t& value)                {extCtrl.value64 = value;}
-template<>           void setExtCtrlValue<v4l2_exposure_auto_type>(v4l2_ext_control& extCtrl, const v4l2_exposure_auto_type& value) {extCtrl.value = value;}
-template<>           void setExtCtrlValue<bool>                   (v4l2_ext_control& extCtrl, const bool& value)                    {extCtrl.value = value;}
+    return RunExtControlTransaction(controls, VIDIOC_G_EXT_CTRLS);
+}
 
-template<typename T>
-int Camera::SetExtControl(T value, uint32_t controlID, const char *functionName, const char *controlName, uint32_t controlClass)
+int Camera::SetExtControls(std::vector<ControlTransactionItem> &controls)
 {
-    int result = -1;
-    v4l2_ext_controls extCtrls;
-    v4l2_ext_control extCtrl;
-
-    CLEAR(extCtrls);
-    CLEAR(extCtrl);
-    extCtrl.id = controlID;
-    setExtCtrlValue<T>(extCtrl, value);
-
-    extCtrls.controls = &extCtrl;
-    extCtrls.count = 1;
-    extCtrls.ctrl_class = controlClass;
+    return RunExtControlTransaction(controls, VIDIOC_S_EXT_CTRLS);
+}
 
+int Camera::CompareControlReadTimes(double &singleTimeMs, double &transactionTimeMs, uint32_t &controlCount)
+{
+    std::vector<ControlTransactionItem> controls;
+    std::map<uint32_t, uint32_t> controlTypes;
+    {
+        QMutexLocker locker(&m_ControlMapMutex);
+        controlTypes = m_ControlIdToTypeMap;
+    }
 
-    if (-1 != iohelper::xioctl(m_ControlIdToFileDescriptorMap[controlID], VIDIOC_TRY_EXT_CTRLS, &extCtrls))
+    for (const auto & control : controlTypes)
     {
-        if (-1 != iohelper::xioctl(m_ControlIdToFileDescriptorMap[controlID], VIDIOC_S_EXT_CTRLS, &extCtrls))
-        {
-            LOG_EX("Camera::SetExtControl VIDIOC_S_EXT_CTRLS %s function name: %s control name: %s (%s) to %d OK", m_FileDescriptorToNameMap[m_ControlIdToFileDescriptorMap[controlID]].c_str(), functionName, controlName, m_ControlIdToControlNameMap[controlID].c_str(), value);
-            result = 0;
-        }
-        else
+        // buttons have no value
+        if (V4L2_CTRL_TYPE_BUTTON != control.second)
         {
-            LOG_EX("Camera::SetExtControlVIDIOC_S_EXT_CTRLS %s function name: %s control name: %s (%s) failed errno=%d=%s", m_FileDescriptorToNameMap[m_ControlIdToFileDescriptorMap[controlID]].c_str(), functionName, controlName, m_ControlIdToControlNameMap[controlID].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+            ControlTransactionItem item = {control.first, 0, -2};
+            controls.push_back(item);
         }
     }
-    else
+
+    controlCount = controls.size();
+
+    // both paths go to the device, the control cache is not used
+    QElapsedTimer timer;
+    timer.start();
+    for (const auto & item : controls)
     {
-        LOG_EX("Camera::SetExtControl VIDIOC_TRY_EXT_CTRLS %s function name: %s control name: %s (%s) failed errno=%d=%s", m_FileDescriptorToNameMap[m_ControlIdToFileDescriptorMap[controlID]].c_str(), functionName, controlName, m_ControlIdToControlNameMap[controlID].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        int64_t value = 0;
+        ReadExtControl(GetControlFileDescriptor(item.controlID), value, item.controlID, "CompareControlReadTimes", "single", V4L2_CTRL_ID2CLASS(item.controlID));
     }
+    singleTimeMs = timer.nsecsElapsed() / 1000000.0;
+
+    timer.restart();
+    int result = ReadExtControls(controls);
+    transactionTimeMs = timer.nsecsElapsed() / 1000000.0;
+
+    LOG_EX("Camera::CompareControlReadTimes %d controls: %.3f ms one by one, %.3f ms as transaction", controlCount, singleTimeMs, transactionTimeMs);
 
     return result;
 }
@@ -1602,15 +2295,15 @@ int Camera::ReadMinMax(T &min, T &max, uint32_t controlID, const char *functionN
     CLEAR(ctrl);
     ctrl.id = controlID;
 
-    if (iohelper::xioctl(m_ControlIdToFileDescriptorMap[controlID], vidioc_queryctrl<T>, &ctrl) >= 0)
+    if (iohelper::xioctl(GetControlFileDescriptor(controlID), vidioc_queryctrl<T>, &ctrl) >= 0)
     {
-        LOG_EX("Camera::ReadMinMax VIDIOC_QUERYCTRL %s function name: %s control name: %s (%s) OK, min=%d, max=%d, default=%d", m_FileDescriptorToNameMap[m_ControlIdToFileDescriptorMap[controlID]].c_str(), functionName, controlName, m_ControlIdToControlNameMap[controlID].c_str(), ctrl.minimum, ctrl.maximum, ctrl.default_value);
+        LOG_EX("Camera::ReadMinMax VIDIOC_QUERYCTRL %s function name: %s control name: %s (%s) OK, min=%d, max=%d, default=%d", GetFileDescriptorName(GetControlFileDescriptor(controlID)).c_str(), functionName, controlName, GetControlName(controlID).c_str(), ctrl.minimum, ctrl.maximum, ctrl.default_value);
         min = ctrl.minimum;
         max = ctrl.maximum;
     }
     else
     {
-        LOG_EX("Camera::ReadMinMax VIDIOC_QUERYCTRL %s function name: %s control name: %s (%s) failed errno=%d=%s", m_FileDescriptorToNameMap[m_ControlIdToFileDescriptorMap[controlID]].c_str(), functionName, controlName, m_ControlIdToControlNameMap[controlID].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::ReadMinMax VIDIOC_QUERYCTRL %s function name: %s control name: %s (%s) failed errno=%d=%s", GetFileDescriptorName(GetControlFileDescriptor(controlID)).c_str(), functionName, controlName, GetControlName(controlID).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
         result = -2;
     }
 
@@ -1624,14 +2317,14 @@ int Camera::ReadStep(int32_t &step, uint32_t controlID, const char *functionName
 
     CLEAR(ctrl);
     ctrl.id = controlID;
-    if (iohelper::xioctl(m_ControlIdToFileDescriptorMap[controlID], VIDIOC_QUERYCTRL, &ctrl) >= 0)
+    if (iohelper::xioctl(GetControlFileDescriptor(controlID), VIDIOC_QUERYCTRL, &ctrl) >= 0)
     {
-        LOG_EX("Camera::ReadStep VIDIOC_QUERYCTRL %s function name: %s control name: %s (%s) OK, step=%d", m_FileDescriptorToNameMap[m_ControlIdToFileDescriptorMap[controlID]].c_str(), functionName, controlName, m_ControlIdToControlNameMap[controlID].c_str(), ctrl.step);
+        LOG_EX("Camera::ReadStep VIDIOC_QUERYCTRL %s function name: %s control name: %s (%s) OK, step=%d", GetFileDescriptorName(GetControlFileDescriptor(controlID)).c_str(), functionName, controlName, GetControlName(controlID).c_str(), ctrl.step);
         step = ctrl.step;
     }
     else
     {
-        LOG_EX("Camera::ReadStep VIDIOC_QUERYCTRL %s function name: %s control name: %s (%s) failed errno=%d=%s", m_FileDescriptorToNameMap[m_ControlIdToFileDescriptorMap[controlID]].c_str(), functionName, controlName, m_ControlIdToControlNameMap[controlID].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::ReadStep VIDIOC_QUERYCTRL %s function name: %s control name: %s (%s) failed errno=%d=%s", GetFileDescriptorName(GetControlFileDescriptor(controlID)).c_str(), functionName, controlName, GetControlName(controlID).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
         result = -2;
     }
 
@@ -1658,7 +2351,11 @@ int Camera::SetAutoExposure(bool autoexposure)
 {
 	uint32_t value = autoexposure ? V4L2_EXPOSURE_AUTO : V4L2_EXPOSURE_MANUAL;
 
-	emit SendListDataToEnumerationWidget(V4L2_CID_EXPOSURE_AUTO, value, QList<QString>(), "", "", false);
+	ControlDescription description;
+	if (0 == GetControlDescription(V4L2_CID_EXPOSURE_AUTO, description))
+	{
+		emit SendListDataToEnumerationWidget(V4L2_CID_EXPOSURE_AUTO, value, QList<QString>(), description.name, description.unit, description.bIsReadOnly);
+	}
 
     return SetExtControl(value, V4L2_CID_EXPOSURE_AUTO, "SetAutoExposure", "V4L2_CID_EXPOSURE_AUTO", V4L2_CTRL_CLASS_CAMERA);
 }
@@ -1694,7 +2391,11 @@ int Camera::ReadAutoGain(bool &flag)
 
 int Camera::SetAutoGain(bool value)
 {
-	emit SendBoolDataToEnumerationWidget(V4L2_CID_AUTOGAIN, value, "", "", false);
+	ControlDescription description;
+	if (0 == GetControlDescription(V4L2_CID_AUTOGAIN, description))
+	{
+		emit SendBoolDataToEnumerationWidget(V4L2_CID_AUTOGAIN, value, description.name, description.unit, description.bIsReadOnly);
+	}
 
     return SetExtControl(value, V4L2_CID_AUTOGAIN, "SetAutoGain", "V4L2_CID_AUTOGAIN", V4L2_CTRL_CLASS_USER);
 }
@@ -1766,7 +2467,7 @@ bool Camera::IsAutoWhiteBalanceSupported()
     CLEAR(qctrl);
     qctrl.id = V4L2_CID_AUTO_WHITE_BALANCE;
 
-    if (iohelper::xioctl(m_ControlIdToFileDescriptorMap[V4L2_CID_AUTO_WHITE_BALANCE], VIDIOC_QUERYCTRL, &qctrl) == 0)
+    if (iohelper::xioctl(GetControlFileDescriptor(V4L2_CID_AUTO_WHITE_BALANCE), VIDIOC_QUERYCTRL, &qctrl) == 0)
     {
         return !(qctrl.flags & V4L2_CTRL_FLAG_DISABLED);
     }
@@ -1779,7 +2480,11 @@ bool Camera::IsAutoWhiteBalanceSupported()
 int Camera::SetAutoWhiteBalance(bool flag)
 {
 
-	emit SendBoolDataToEnumerationWidget(V4L2_CID_AUTO_WHITE_BALANCE, flag,  "", "", false);
+	ControlDescription description;
+	if (0 == GetControlDescription(V4L2_CID_AUTO_WHITE_BALANCE, description))
+	{
+		emit SendBoolDataToEnumerationWidget(V4L2_CID_AUTO_WHITE_BALANCE, flag, description.name, description.unit, description.bIsReadOnly);
+	}
 
     if (flag)
     {
@@ -1820,7 +2525,7 @@ void Camera::PrepareFrameRate()
         if (iohelper::xioctl(fileDescriptor, VIDIOC_G_PARM, &parm) >= 0 && parm.parm.capture.capability & V4L2_CAP_TIMEPERFRAME)
         {
             m_FrameRateDeviceFileDescriptor = fileDescriptor;
-            LOG_EX("Camera::PrepareFrameRate VIDIOC_G_CROP %s", m_FileDescriptorToNameMap[m_FrameRateDeviceFileDescriptor].c_str());
+            LOG_EX("Camera::PrepareFrameRate VIDIOC_G_CROP %s", GetFileDescriptorName(m_FrameRateDeviceFileDescriptor).c_str());
         }
     }
 
@@ -1845,7 +2550,7 @@ void Camera::PrepareCrop()
         if (iohelper::xioctl(fileDescriptor, VIDIOC_G_CROP, &crop) >= 0)
         {
             m_CropDeviceFileDescriptor = fileDescriptor;
-            LOG_EX("Camera::PrepareCrop VIDIOC_G_CROP %s", m_FileDescriptorToNameMap[m_CropDeviceFileDescriptor].c_str());
+            LOG_EX("Camera::PrepareCrop VIDIOC_G_CROP %s", GetFileDescriptorName(m_CropDeviceFileDescriptor).c_str());
         }
     }
 
@@ -1867,9 +2572,10 @@ bool Camera::UsesSubdevices() {
 std::string Camera::GetDeviceChar(uint32_t controlId)
 {
     std::string deviceChar = "unknown";
-    if(m_ControlIdToFileDescriptorMap.count(controlId))
+    int fileDescriptor = GetControlFileDescriptor(controlId);
+    if(-1 != fileDescriptor)
     {
-        deviceChar = GetDeviceCharFromFileDescriptor(m_ControlIdToFileDescriptorMap[controlId]);
+        deviceChar = GetDeviceCharFromFileDescriptor(fileDescriptor);
     }
     return deviceChar;
 }
@@ -1877,9 +2583,9 @@ std::string Camera::GetDeviceChar(uint32_t controlId)
 std::string Camera::GetDeviceCharFromFileDescriptor(int fileDescriptor)
 {
     std::string deviceChar = "no device";
-    if(m_FileDescriptorToNameMap.count(fileDescriptor))
+    const std::string deviceFileName = GetFileDescriptorName(fileDescriptor);
+    if(!deviceFileName.empty())
     {
-        const std::string deviceFileName = m_FileDescriptorToNameMap[fileDescriptor];
         if(deviceFileName.find("subdev") != std::string::npos)
         {
             deviceChar = "s";
@@ -1896,6 +2602,34 @@ std::string Camera::GetDeviceCharFromFileDescriptor(int fileDescriptor)
     return deviceChar;
 }
 
+int Camera::GetControlFileDescriptor(uint32_t controlID) const
+{
+    QMutexLocker locker(&m_ControlMapMutex);
+    std::map<uint32_t, int>::const_iterator it = m_ControlIdToFileDescriptorMap.find(controlID);
+    return (it != m_ControlIdToFileDescriptorMap.end()) ? it->second : -1;
+}
+
+std::string Camera::GetControlName(uint32_t controlID) const
+{
+    QMutexLocker locker(&m_ControlMapMutex);
+    std::map<uint32_t, std::string>::const_iterator it = m_ControlIdToControlNameMap.find(controlID);
+    return (it != m_ControlIdToControlNameMap.end()) ? it->second : std::string();
+}
+
+uint32_t Camera::GetControlType(uint32_t controlID) const
+{
+    QMutexLocker locker(&m_ControlMapMutex);
+    std::map<uint32_t, uint32_t>::const_iterator it = m_ControlIdToTypeMap.find(controlID);
+    return (it != m_ControlIdToTypeMap.end()) ? it->second : 0;
+}
+
+std::string Camera::GetFileDescriptorName(int fileDescriptor) const
+{
+    QMutexLocker locker(&m_ControlMapMutex);
+    std::map<int, std::string>::const_iterator it = m_FileDescriptorToNameMap.find(fileDescriptor);
+    return (it != m_FileDescriptorToNameMap.end()) ? it->second : std::string();
+}
+
 std::string Camera::GetGainDeviceChar()
 {
     return GetDeviceChar(V4L2_CID_GAIN);
@@ -1998,7 +2732,7 @@ int Camera::ReadFrameRate(uint32_t &numerator, uint32_t &denominator, uint32_t w
         }
         if (frmival.index == 0)
         {
-            LOG_EX("Camera::ReadFrameRate VIDIOC_ENUM_FRAMEINTERVALS %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_FrameRateDeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+            LOG_EX("Camera::ReadFrameRate VIDIOC_ENUM_FRAMEINTERVALS %s failed errno=%d=%s", GetFileDescriptorName(m_FrameRateDeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
         }
 
         v4l2_streamparm parm;
@@ -2009,16 +2743,16 @@ int Camera::ReadFrameRate(uint32_t &numerator, uint32_t &denominator, uint32_t w
         {
             numerator = parm.parm.capture.timeperframe.numerator;
             denominator = parm.parm.capture.timeperframe.denominator;
-            LOG_EX("Camera::ReadFrameRate VIDIOC_G_PARM %s %d/%dOK", m_FileDescriptorToNameMap[m_FrameRateDeviceFileDescriptor].c_str(), numerator, denominator);
+            LOG_EX("Camera::ReadFrameRate VIDIOC_G_PARM %s %d/%dOK", GetFileDescriptorName(m_FrameRateDeviceFileDescriptor).c_str(), numerator, denominator);
         }
         else
         {
-            LOG_EX("Camera::ReadFrameRate VIDIOC_G_PARM %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_FrameRateDeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+            LOG_EX("Camera::ReadFrameRate VIDIOC_G_PARM %s failed errno=%d=%s", GetFileDescriptorName(m_FrameRateDeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
         }
     }
     else
     {
-        LOG_EX("Camera::ReadFrameRate VIDIOC_G_PARM %s failed (or V4L2_CAP_TIMEPERFRAME not in cap) errno=%d=%s", m_FileDescriptorToNameMap[m_FrameRateDeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::ReadFrameRate VIDIOC_G_PARM %s failed (or V4L2_CAP_TIMEPERFRAME not in cap) errno=%d=%s", GetFileDescriptorName(m_FrameRateDeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
         result = -2;
     }
 
@@ -2043,12 +2777,12 @@ int Camera::SetFrameRate(uint32_t numerator, uint32_t denominator)
                 parm.parm.capture.timeperframe.denominator = denominator;
                 if (-1 != iohelper::xioctl(fileDescriptor, VIDIOC_S_PARM, &parm))
                 {
-                    LOG_EX("Camera::SetFrameRate VIDIOC_S_PARM %s to %d/%d (%.2f) OK", m_FileDescriptorToNameMap[fileDescriptor].c_str(), numerator, denominator, numerator / denominator);
+                    LOG_EX("Camera::SetFrameRate VIDIOC_S_PARM %s to %d/%d (%.2f) OK", GetFileDescriptorName(fileDescriptor).c_str(), numerator, denominator, numerator / denominator);
                     result = 0;
                 }
                 else
                 {
-                    LOG_EX("Camera::SetFrameRate VIDIOC_S_PARM %s failed errno=%d=%s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+                    LOG_EX("Camera::SetFrameRate VIDIOC_S_PARM %s failed errno=%d=%s", GetFileDescriptorName(fileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
                 }
             }
         }
@@ -2071,13 +2805,13 @@ int Camera::ReadCrop(int32_t &xOffset, int32_t &yOffset, uint32_t &width, uint32
         yOffset = crop.c.top;
         width = crop.c.width;
         height = crop.c.height;
-        LOG_EX("Camera::ReadCrop VIDIOC_G_CROP %s x=%d, y=%d, w=%d, h=%d OK", m_FileDescriptorToNameMap[m_CropDeviceFileDescriptor].c_str(), xOffset, yOffset, width, height);
+        LOG_EX("Camera::ReadCrop VIDIOC_G_CROP %s x=%d, y=%d, w=%d, h=%d OK", GetFileDescriptorName(m_CropDeviceFileDescriptor).c_str(), xOffset, yOffset, width, height);
 
         result = 0;
     }
     else
     {
-        LOG_EX("Camera::ReadCrop VIDIOC_G_CROP %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_CropDeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::ReadCrop VIDIOC_G_CROP %s failed errno=%d=%s", GetFileDescriptorName(m_CropDeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
     }
 
     return result;
@@ -2098,13 +2832,13 @@ int Camera::SetCrop(int32_t xOffset, int32_t yOffset, uint32_t width, uint32_t h
 
     if (iohelper::xioctl(m_CropDeviceFileDescriptor, VIDIOC_S_CROP, &crop) >= 0)
     {
-        LOG_EX("Camera::SetCrop VIDIOC_S_CROP %s left=%d, top=%d, width=%d, height=%d OK", m_FileDescriptorToNameMap[m_CropDeviceFileDescriptor].c_str(), xOffset, yOffset, width, height);
+        LOG_EX("Camera::SetCrop VIDIOC_S_CROP %s left=%d, top=%d, width=%d, height=%d OK", GetFileDescriptorName(m_CropDeviceFileDescriptor).c_str(), xOffset, yOffset, width, height);
 
         result = 0;
     }
     else
     {
-        LOG_EX("Camera::SetCrop VIDIOC_S_CROP %s failed errno=%d=%s", m_FileDescriptorToNameMap[m_CropDeviceFileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        LOG_EX("Camera::SetCrop VIDIOC_S_CROP %s failed errno=%d=%s", GetFileDescriptorName(m_CropDeviceFileDescriptor).c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
     }
 
     return result;
@@ -2122,6 +2856,8 @@ int Camera::CreateUserBuffer(uint32_t bufferCount, uint32_t bufferSize)
     m_pFrameObserver->setBufferType(m_DeviceBufferType);
 
     ret = m_pFrameObserver->CreateAllUserBuffer(bufferCount, bufferSize);
+    m_UserBufferSize = bufferSize;
+    m_bFramesUnderrunKnown = false;
 
     return ret;
 }
@@ -2148,11 +2884,57 @@ int Camera::DeleteUserBuffer()
 {
     int result = 0;
 
+    LOG_EX("Camera::DeleteUserBuffer stream used %d buffers", m_pFrameObserver->GetUserBufferCount());
+
     result = m_pFrameObserver->DeleteAllUserBuffer();
 
     return result;
 }
 
+int Camera::ReleaseUserBuffer()
+{
+    LOG_EX("Camera::ReleaseUserBuffer stream used %d buffers", m_pFrameObserver->GetUserBufferCount());
+
+    return m_pFrameObserver->ReleaseAllUserBuffer();
+}
+
+int Camera::AdaptBufferCount(uint32_t &bufferCount)
+{
+    bufferCount = m_pFrameObserver->GetUserBufferCount();
+
+    // underruns are only reported by Allied Vision drivers, the queue depth
+    // shows a starving driver for all others
+    bool bUnderrun = false;
+    uint64_t framesCount = 0, packetCRCError = 0, framesUnderrun = 0, framesIncomplete = 0;
+    double currentFrameRate = 0.0;
+    if (getDriverStreamStat(framesCount, packetCRCError, framesUnderrun, framesIncomplete, currentFrameRate))
+    {
+        bUnderrun = m_bFramesUnderrunKnown && framesUnderrun > m_FramesUnderrun;
+        m_FramesUnderrun = framesUnderrun;
+        m_bFramesUnderrunKnown = true;
+    }
+
+    uint32_t minimumQueueDepth = m_pFrameObserver->GetMinimumDriverQueueDepth();
+    m_pFrameObserver->ResetMinimumDriverQueueDepth();
+
+    if (!bUnderrun && 0 < minimumQueueDepth)
+        return 0;
+
+    if (bufferCount + ADAPTIVE_BUFFER_STEP > MAX_VIEWER_USER_BUFFER_COUNT ||
+        static_cast<uint64_t>(bufferCount + ADAPTIVE_BUFFER_STEP) * m_UserBufferSize > ADAPTIVE_BUFFER_MEMORY_LIMIT)
+    {
+        LOG_EX("Camera::AdaptBufferCount limit reached with %d buffers", bufferCount);
+        return -1;
+    }
+
+    // the capture thread creates and queues the buffers before its next dequeue
+    m_pFrameObserver->RequestUserBuffers(ADAPTIVE_BUFFER_STEP);
+    LOG_EX("Camera::AdaptBufferCount %s, %d more buffers requested",
+           bUnderrun ? "driver underrun" : "driver queue ran empty", ADAPTIVE_BUFFER_STEP);
+
+    return 0;
+}
+
 /*********************************************************************************************************/
 // Info
 /*********************************************************************************************************/
@@ -2169,32 +2951,32 @@ int Camera::GetCameraDriverName(std::string &strText)
         v4l2_capability cap;
 
         // query device capabilities
-        if (-1 == iohelper::xioctl(fileDescriptor, VIDIOC_QUERYCAP, &cap))
+        if (-1 == QueryCapability(fileDescriptor, cap))
         {
-            LOG_EX("Camera::GetCameraDriverName VIDIOC_QUERYCAP %s is no V4L2 device\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+            LOG_EX("Camera::GetCameraDriverName VIDIOC_QUERYCAP %s is no V4L2 device\n", GetFileDescriptorName(fileDescriptor).c_str());
         }
         else
         {
             if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) && !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE))
             {
-                LOG_EX("Camera::GetCameraDriverName %s is no video capture device\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+                LOG_EX("Camera::GetCameraDriverName %s is no video capture device\n", GetFileDescriptorName(fileDescriptor).c_str());
             }
             else
             {
                 if(((char* )cap.driver)[0] == '\0')
                 {
-                    LOG_EX("Camera::GetCameraDriverName VIDIOC_QUERYCAP %s no driver name\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+                    LOG_EX("Camera::GetCameraDriverName VIDIOC_QUERYCAP %s no driver name\n", GetFileDescriptorName(fileDescriptor).c_str());
                 }
                 else
                 {
-                    LOG_EX("Camera::GetCameraDriverName VIDIOC_QUERYCAP %s driver name=%s\n", m_FileDescriptorToNameMap[fileDescriptor].c_str(), (char* )cap.driver);
+                    LOG_EX("Camera::GetCameraDriverName VIDIOC_QUERYCAP %s driver name=%s\n", GetFileDescriptorName(fileDescriptor).c_str(), (char* )cap.driver);
                     if (info.empty())
                     {
-                        info = std::string((char*) cap.driver) + " (" + m_FileDescriptorToNameMap[fileDescriptor] + ")";
+                        info = std::string((char*) cap.driver) + " (" + GetFileDescriptorName(fileDescriptor) + ")";
                     }
                     else
                     {
-                        info += std::string(",<br>") + std::string((char*) cap.driver) + " (" + m_FileDescriptorToNameMap[fileDescriptor] + ")";
+                        info += std::string(",<br>") + std::string((char*) cap.driver) + " (" + GetFileDescriptorName(fileDescriptor) + ")";
                     }
                     result = 0;
                 }
@@ -2219,32 +3001,32 @@ int Camera::GetCameraDeviceName(std::string &strText)
         v4l2_capability cap;
 
         // query device capabilities
-        if (-1 == iohelper::xioctl(fileDescriptor, VIDIOC_QUERYCAP, &cap))
+        if (-1 == QueryCapability(fileDescriptor, cap))
         {
-            LOG_EX("Camera::GetCameraDeviceName VIDIOC_QUERYCAP %s is no V4L2 device\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+            LOG_EX("Camera::GetCameraDeviceName VIDIOC_QUERYCAP %s is no V4L2 device\n", GetFileDescriptorName(fileDescriptor).c_str());
         }
         else
         {
             if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) && !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE))
             {
-                LOG_EX("Camera::GetCameraDeviceName %s is no video capture device\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+                LOG_EX("Camera::GetCameraDeviceName %s is no video capture device\n", GetFileDescriptorName(fileDescriptor).c_str());
             }
             else
             {
                 if(((char* )cap.card)[0] == '\0')
                 {
-                    LOG_EX("Camera::GetCameraDeviceName VIDIOC_QUERYCAP %s no device name\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+                    LOG_EX("Camera::GetCameraDeviceName VIDIOC_QUERYCAP %s no device name\n", GetFileDescriptorName(fileDescriptor).c_str());
                 }
                 else
                 {
-                    LOG_EX("Camera::GetCameraDeviceName VIDIOC_QUERYCAP %s device name=%s\n", m_FileDescriptorToNameMap[fileDescriptor].c_str(), (char* )cap.card);
+                    LOG_EX("Camera::GetCameraDeviceName VIDIOC_QUERYCAP %s device name=%s\n", GetFileDescriptorName(fileDescriptor).c_str(), (char* )cap.card);
                     if (info.empty())
                     {
-                        info = std::string((char*) cap.card) + " (" + m_FileDescriptorToNameMap[fileDescriptor] + ")";
+                        info = std::string((char*) cap.card) + " (" + GetFileDescriptorName(fileDescriptor) + ")";
                     }
                     else
                     {
-                        info += std::string(",<br>") + std::string((char*) cap.card) + " (" + m_FileDescriptorToNameMap[fileDescriptor] + ")";
+                        info += std::string(",<br>") + std::string((char*) cap.card) + " (" + GetFileDescriptorName(fileDescriptor) + ")";
                     }
                     result = 0;
                 }
@@ -2269,32 +3051,32 @@ int Camera::GetCameraBusInfo(std::string &strText)
         v4l2_capability cap;
 
         // query device capabilities
-        if (-1 == iohelper::xioctl(fileDescriptor, VIDIOC_QUERYCAP, &cap))
+        if (-1 == QueryCapability(fileDescriptor, cap))
         {
-            LOG_EX("Camera::GetCameraBusInfo VIDIOC_QUERYCAP %s is no V4L2 device\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+            LOG_EX("Camera::GetCameraBusInfo VIDIOC_QUERYCAP %s is no V4L2 device\n", GetFileDescriptorName(fileDescriptor).c_str());
         }
         else
         {
             if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) && !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE))
             {
-                LOG_EX("Camera::GetCameraBusInfo %s is no video capture device\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+                LOG_EX("Camera::GetCameraBusInfo %s is no video capture device\n", GetFileDescriptorName(fileDescriptor).c_str());
             }
             else
             {
                 if(((char* )cap.bus_info)[0] == '\0')
                 {
-                    LOG_EX("Camera::GetCameraBusInfo VIDIOC_QUERYCAP %s no bus info\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+                    LOG_EX("Camera::GetCameraBusInfo VIDIOC_QUERYCAP %s no bus info\n", GetFileDescriptorName(fileDescriptor).c_str());
                 }
                 else
                 {
-                    LOG_EX("Camera::GetCameraBusInfo VIDIOC_QUERYCAP %s bus info=%s\n", m_FileDescriptorToNameMap[fileDescriptor].c_str(), (char* )cap.bus_info);
+                    LOG_EX("Camera::GetCameraBusInfo VIDIOC_QUERYCAP %s bus info=%s\n", GetFileDescriptorName(fileDescriptor).c_str(), (char* )cap.bus_info);
                     if (info.empty())
                     {
-                        info = std::string((char*) cap.bus_info) + " (" + m_FileDescriptorToNameMap[fileDescriptor] + ")";
+                        info = std::string((char*) cap.bus_info) + " (" + GetFileDescriptorName(fileDescriptor) + ")";
                     }
                     else
                     {
-                        info += std::string(",<br>") + std::string((char*) cap.bus_info) + " (" + m_FileDescriptorToNameMap[fileDescriptor] + ")";
+                        info += std::string(",<br>") + std::string((char*) cap.bus_info) + " (" + GetFileDescriptorName(fileDescriptor) + ")";
                     }
                     result = 0;
                 }
@@ -2319,27 +3101,27 @@ int Camera::GetCameraDriverVersion(std::string &strText)
         v4l2_capability cap;
 
         // query device capabilities
-        if (-1 == iohelper::xioctl(fileDescriptor, VIDIOC_QUERYCAP, &cap))
+        if (-1 == QueryCapability(fileDescriptor, cap))
         {
-            LOG_EX("Camera::GetCameraDriverVersion VIDIOC_QUERYCAP %s is no V4L2 device\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+            LOG_EX("Camera::GetCameraDriverVersion VIDIOC_QUERYCAP %s is no V4L2 device\n", GetFileDescriptorName(fileDescriptor).c_str());
         }
         else
         {
             if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) && !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE))
             {
-                LOG_EX("Camera::GetCameraDriverVersion %s is no video capture device\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+                LOG_EX("Camera::GetCameraDriverVersion %s is no video capture device\n", GetFileDescriptorName(fileDescriptor).c_str());
             }
             else
             {
                 if(((char* )cap.card)[0] == '\0')
                 {
-                    LOG_EX("Camera::GetCameraDriverVersion VIDIOC_QUERYCAP %s no driver version info\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+                    LOG_EX("Camera::GetCameraDriverVersion VIDIOC_QUERYCAP %s no driver version info\n", GetFileDescriptorName(fileDescriptor).c_str());
                 }
                 else
                 {
                     std::string cameraDriverInfo = (char*)cap.card;
 
-                    LOG_EX("Camera::GetCameraDriverVersion VIDIOC_QUERYCAP %s driver version info string=%s\n", m_FileDescriptorToNameMap[fileDescriptor].c_str(), cameraDriverInfo.c_str());
+                    LOG_EX("Camera::GetCameraDriverVersion VIDIOC_QUERYCAP %s driver version info string=%s\n", GetFileDescriptorName(fileDescriptor).c_str(), cameraDriverInfo.c_str());
 
                     QString name = QString::fromStdString(cameraDriverInfo);
                     QStringList list = name.split(" ");
@@ -2372,40 +3154,40 @@ int Camera::GetCameraDriverVersion(std::string &strText)
                         QFile file(QString("/sys/bus/i2c/drivers/avt_csi2/%1/driver_version").arg(part));
                         if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
                         {
-                            LOG_EX("Camera::GetCameraDriverVersion Couldn't get driver version for VIDIOC_QUERYCAP %s device name=%s, driver version file=%s\n", m_FileDescriptorToNameMap[fileDescriptor].c_str(), (char*)cap.card, file.fileName().toStdString().c_str());
+                            LOG_EX("Camera::GetCameraDriverVersion Couldn't get driver version for VIDIOC_QUERYCAP %s device name=%s, driver version file=%s\n", GetFileDescriptorName(fileDescriptor).c_str(), (char*)cap.card, file.fileName().toStdString().c_str());
                             QFile file_alt(QString("/sys/bus/i2c/drivers/avt3/%1/driver_version").arg(part));
                             if (!file_alt.open(QIODevice::ReadOnly | QIODevice::Text))
                             {
-                                LOG_EX("Camera::GetCameraDriverVersion Couldn't get driver version for VIDIOC_QUERYCAP %s device name=%s, driver version file=%s\n", m_FileDescriptorToNameMap[fileDescriptor].c_str(), (char*)cap.card, file_alt.fileName().toStdString().c_str());
+                                LOG_EX("Camera::GetCameraDriverVersion Couldn't get driver version for VIDIOC_QUERYCAP %s device name=%s, driver version file=%s\n", GetFileDescriptorName(fileDescriptor).c_str(), (char*)cap.card, file_alt.fileName().toStdString().c_str());
                                 version = "unknown";
                             }
                             else
                             {
                                 QByteArray line = file_alt.readLine();
                                 version = line.toStdString();
-                                LOG_EX("Camera::GetCameraDriverVersion got driver version for VIDIOC_QUERYCAP %s device name=%s, driver version file=%s\n", m_FileDescriptorToNameMap[fileDescriptor].c_str(), (char*)cap.card, file_alt.fileName().toStdString().c_str());
+                                LOG_EX("Camera::GetCameraDriverVersion got driver version for VIDIOC_QUERYCAP %s device name=%s, driver version file=%s\n", GetFileDescriptorName(fileDescriptor).c_str(), (char*)cap.card, file_alt.fileName().toStdString().c_str());
                             }
                         }
                         else
                         {
                             QByteArray line = file.readLine();
                             version = line.toStdString();
-                            LOG_EX("Camera::GetCameraDriverVersion got driver version for VIDIOC_QUERYCAP %s device name=%s, driver version file=%s\n", m_FileDescriptorToNameMap[fileDescriptor].c_str(), (char*)cap.card, file.fileName().toStdString().c_str());
+                            LOG_EX("Camera::GetCameraDriverVersion got driver version for VIDIOC_QUERYCAP %s device name=%s, driver version file=%s\n", GetFileDescriptorName(fileDescriptor).c_str(), (char*)cap.card, file.fileName().toStdString().c_str());
                         }
                     }
                     else
                     {
-                        LOG_EX("Camera::GetCameraDriverVersion Couldn't get driver version for VIDIOC_QUERYCAP %s device name=%s\n", m_FileDescriptorToNameMap[fileDescriptor].c_str(), (char*)cap.card);
+                        LOG_EX("Camera::GetCameraDriverVersion Couldn't get driver version for VIDIOC_QUERYCAP %s device name=%s\n", GetFileDescriptorName(fileDescriptor).c_str(), (char*)cap.card);
                         version = "unknown";
                     }
 
                     if (info.empty())
                     {
-                        info = version + " (" + m_FileDescriptorToNameMap[fileDescriptor] + ")";
+                        info = version + " (" + GetFileDescriptorName(fileDescriptor) + ")";
                     }
                     else
                     {
-                        info += std::string(",<br>") + version + " (" + m_FileDescriptorToNameMap[fileDescriptor] + ")";
+                        info += std::string(",<br>") + version + " (" + GetFileDescriptorName(fileDescriptor) + ")";
                     }
                     result = 0;
                 }
@@ -2433,24 +3215,24 @@ int Camera::GetCameraReadCapability(bool &flag)
         v4l2_capability cap;
 
         // query device capabilities
-        if (-1 == iohelper::xioctl(fileDescriptor, VIDIOC_QUERYCAP, &cap))
+        if (-1 == QueryCapability(fileDescriptor, cap))
         {
-            LOG_EX("Camera::GetCameraReadCapability %s is no V4L2 device\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+            LOG_EX("Camera::GetCameraReadCapability %s is no V4L2 device\n", GetFileDescriptorName(fileDescriptor).c_str());
         }
         else
         {
             if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) && !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE))
             {
-                LOG_EX("Camera::GetCameraReadCapability %s is no video capture device\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+                LOG_EX("Camera::GetCameraReadCapability %s is no video capture device\n", GetFileDescriptorName(fileDescriptor).c_str());
             }
             else
             {
                 tmp << "0x" << std::hex << cap.capabilities << std::endl << "    Read/Write = " << ((cap.capabilities & V4L2_CAP_READWRITE) ? "Yes" : "No") << std::endl << "    Streaming = " << ((cap.capabilities & V4L2_CAP_STREAMING) ? "Yes" : "No");
-                LOG_EX("Camera::GetCameraReadCapability VIDIOC_QUERYCAP %s capabilities=%s\n", m_FileDescriptorToNameMap[fileDescriptor].c_str(), tmp.str().c_str());
+                LOG_EX("Camera::GetCameraReadCapability VIDIOC_QUERYCAP %s capabilities=%s\n", GetFileDescriptorName(fileDescriptor).c_str(), tmp.str().c_str());
 
                 if(result == 0)
                 {
-                    LOG_EX("Camera::GetCameraReadCapability VIDIOC_QUERYCAP %s setting flag again", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+                    LOG_EX("Camera::GetCameraReadCapability VIDIOC_QUERYCAP %s setting flag again", GetFileDescriptorName(fileDescriptor).c_str());
                 }
 
                 if (cap.capabilities & V4L2_CAP_READWRITE)
@@ -2483,9 +3265,9 @@ int Camera::GetCameraCapabilities(std::string &strText)
         v4l2_capability cap;
 
         // query device capabilities
-        if (-1 == iohelper::xioctl(m_DeviceFileDescriptor, VIDIOC_QUERYCAP, &cap))
+        if (-1 == QueryCapability(m_DeviceFileDescriptor, cap))
         {
-            LOG_EX("Camera::GetCameraCapabilities %s is no V4L2 device\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+            LOG_EX("Camera::GetCameraCapabilities %s is no V4L2 device\n", GetFileDescriptorName(fileDescriptor).c_str());
         }
         else
         {
@@ -2498,19 +3280,19 @@ int Camera::GetCameraCapabilities(std::string &strText)
 
             if (!(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE) && !(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE))
             {
-                LOG_EX("Camera::GetCameraCapabilities %s is no video capture device\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+                LOG_EX("Camera::GetCameraCapabilities %s is no video capture device\n", GetFileDescriptorName(fileDescriptor).c_str());
             }
             else
             {
                 tmp << "0x" << std::hex << cap.capabilities << std::endl << "    Read/Write = " << ((cap.capabilities & V4L2_CAP_READWRITE) ? "Yes" : "No") << std::endl << "    Streaming = " << ((cap.capabilities & V4L2_CAP_STREAMING) ? "Yes" : "No");
-                LOG_EX("Camera::GetCameraCapabilities VIDIOC_QUERYCAP %s capabilities=%s\n", m_FileDescriptorToNameMap[fileDescriptor].c_str(), tmp.str().c_str());
+                LOG_EX("Camera::GetCameraCapabilities VIDIOC_QUERYCAP %s capabilities=%s\n", GetFileDescriptorName(fileDescriptor).c_str(), tmp.str().c_str());
                 if (info.empty())
                 {
-                    info = tmp.str() + " (" + m_FileDescriptorToNameMap[fileDescriptor] + ") ";
+                    info = tmp.str() + " (" + GetFileDescriptorName(fileDescriptor) + ") ";
                 }
                 else
                 {
-                    info += std::string(",<br>") + tmp.str() + " (" + m_FileDescriptorToNameMap[fileDescriptor] + ") ";
+                    info += std::string(",<br>") + tmp.str() + " (" + GetFileDescriptorName(fileDescriptor) + ") ";
                 }
                 result = 0;
             }
@@ -2534,6 +3316,91 @@ void Camera::SwitchFrameTransfer2GUI(bool showFrames)
     m_ShowFrames = showFrames;
 }
 
+void Camera::SetYuvConversion(yuvconversion::ColorMatrix colorMatrix, yuvconversion::ColorRange colorRange)
+{
+    if (m_pFrameObserver != 0)
+        m_pFrameObserver->SetYuvConversion(colorMatrix, colorRange);
+
+    m_ColorMatrix = colorMatrix;
+    m_ColorRange = colorRange;
+}
+
+void Camera::SetScaleDenominator(uint32_t scaleDenominator)
+{
+    if (m_pFrameObserver != 0)
+        m_pFrameObserver->SetScaleDenominator(scaleDenominator);
+
+    m_ScaleDenominator = scaleDenominator;
+}
+
+void Camera::SetHighBitDepth(bool bHighBitDepth)
+{
+    if (m_pFrameObserver != 0)
+        m_pFrameObserver->SetHighBitDepth(bHighBitDepth);
+
+    m_bHighBitDepth = bHighBitDepth;
+}
+
+void Camera::SetAutoShift(bool bAutoShift)
+{
+    if (m_pFrameObserver != 0)
+        m_pFrameObserver->SetAutoShift(bAutoShift);
+
+    m_bAutoShift = bAutoShift;
+}
+
+void Camera::SetBufferArena(bool bUseBufferArena)
+{
+    if (m_pFrameObserver != 0)
+        m_pFrameObserver->SetBufferArena(bUseBufferArena);
+
+    m_bUseBufferArena = bUseBufferArena;
+}
+
+void Camera::SetBufferQueuing(BufferCacheMode cacheMode, bool bPrepareBuffers)
+{
+    if (m_pFrameObserver != 0)
+        m_pFrameObserver->SetBufferQueuing(cacheMode, bPrepareBuffers);
+
+    m_BufferCacheMode = cacheMode;
+    m_bPrepareBuffers = bPrepareBuffers;
+}
+
+void Camera::SetReadLatencyBenchmark(bool bMeasureReadLatency)
+{
+    if (m_pFrameObserver != 0)
+        m_pFrameObserver->SetReadLatencyBenchmark(bMeasureReadLatency);
+
+    m_bMeasureReadLatency = bMeasureReadLatency;
+}
+
+void Camera::SetFrameDump(bool bDumpFrames, const std::string &directory)
+{
+    if (m_pFrameObserver != 0)
+        m_pFrameObserver->SetFrameDump(bDumpFrames, directory);
+
+    m_bDumpFrames = bDumpFrames;
+    m_FrameDumpDirectory = directory;
+}
+
+void Camera::SetToneMapping(const tonemapping::Parameters &toneMapping)
+{
+    if (m_pFrameObserver != 0)
+        m_pFrameObserver->SetToneMapping(toneMapping);
+
+    m_ToneMapping = toneMapping;
+}
+
+void Camera::SetWindowLevel(bool bAutoWindowLevel, uint16_t low, uint16_t high)
+{
+    if (m_pFrameObserver != 0)
+        m_pFrameObserver->SetWindowLevel(bAutoWindowLevel, low, high);
+
+    m_bAutoWindowLevel = bAutoWindowLevel;
+    m_WindowLow = low;
+    m_WindowHigh = high;
+}
+
 /*********************************************************************************************************/
 // Tools
 /*********************************************************************************************************/
@@ -2550,14 +3417,16 @@ size_t Camera::fsize(const char *filename)
 
 std::string Camera::getAvtDeviceFirmwareVersion()
 {
+    // the register is read once per opened device
+    if (!m_AvtDeviceFirmwareVersion.empty())
+    {
+        return m_AvtDeviceFirmwareVersion;
+    }
+
     std::string result = "";
 
     if(m_pFrameObserver)
     {
-        // dummy call to set m_isAvtCamera
-        std::string dummy;
-        GetCameraCapabilities(dummy);
-
         if(m_IsAvtCamera)
         {
             const int CCI_BCRM_REG = 0x0014;
@@ -2583,6 +3452,7 @@ std::string Camera::getAvtDeviceFirmwareVersion()
                     std::stringstream ss;
                     ss << (unsigned)specialVersion << "." << (unsigned)majorVersion << "." << (unsigned)minorVersion << "." << std::hex << std::setw(8) << std::setfill('0') << (unsigned)patchVersion;
                     result = ss.str();
+                    m_AvtDeviceFirmwareVersion = result;
                 }
             }
         }
@@ -2594,14 +3464,16 @@ std::string Camera::getAvtDeviceFirmwareVersion()
 
 std::string Camera::getAvtDeviceSerialNumber()
 {
+    // the register is read once per opened device
+    if (!m_AvtDeviceSerialNumber.empty())
+    {
+        return m_AvtDeviceSerialNumber;
+    }
+
     std::string result = "";
 
     if(m_pFrameObserver)
     {
-        // dummy call to set m_isAvtCamera
-        std::string dummy;
-        GetCameraCapabilities(dummy);
-
         if(m_IsAvtCamera)
         {
             const int DEVICE_SERIAL_NUMBER = 0x0198;
@@ -2622,6 +3494,7 @@ std::string Camera::getAvtDeviceSerialNumber()
                 }
 
                 result = ss.str();
+                m_AvtDeviceSerialNumber = result;
             }
         }
     }
@@ -2640,10 +3513,6 @@ bool Camera::getDriverStreamStat(uint64_t &FramesCount, uint64_t &PacketCRCError
     {
         if(m_pFrameObserver)
         {
-            // dummy call to set m_isAvtCamera
-            std::string dummy;
-            GetCameraCapabilities(dummy);
-
             if(m_IsAvtCamera)
             {
                 v4l2_stats_t stream_stats;
@@ -2657,11 +3526,11 @@ bool Camera::getDriverStreamStat(uint64_t &FramesCount, uint64_t &PacketCRCError
                     CurrentFrameRate = (stream_stats.current_frame_interval > 0) ? (double)stream_stats.current_frame_count / ((double)stream_stats.current_frame_interval / 1000000.0)
                                                                                 : 0;
                     result = true;
-                    LOG_EX("Camera::GetCameraCapabilities VIDIOC_STREAMSTAT %s OK\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+                    LOG_EX("Camera::GetCameraCapabilities VIDIOC_STREAMSTAT %s OK\n", GetFileDescriptorName(fileDescriptor).c_str());
                 }
                 else
                 {
-                    LOG_EX("Camera::GetCameraCapabilities VIDIOC_STREAMSTAT %s not OK\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+                    LOG_EX("Camera::GetCameraCapabilities VIDIOC_STREAMSTAT %s not OK\n", GetFileDescriptorName(fileDescriptor).c_str());
                 }
             }
         }
@@ -2702,11 +3571,11 @@ int Camera::ReadRegister(uint16_t nRegAddr, void* pBuffer, uint32_t nBufferSize,
             {
                 reverseBytes(pBuffer, nBufferSize);
             }
-            LOG_EX("Camera::ReadRegister VIDIOC_R_I2C %s OK\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+            LOG_EX("Camera::ReadRegister VIDIOC_R_I2C %s OK\n", GetFileDescriptorName(fileDescriptor).c_str());
         }
         else
         {
-            LOG_EX("Camera::ReadRegister VIDIOC_R_I2C %s not OK\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+            LOG_EX("Camera::ReadRegister VIDIOC_R_I2C %s not OK\n", GetFileDescriptorName(fileDescriptor).c_str());
         }
     }
 
@@ -2738,11 +3607,11 @@ int Camera::WriteRegister(uint16_t nRegAddr, void* pBuffer, uint32_t nBufferSize
         if (res >= 0)
         {
             iRet = 0;
-            LOG_EX("Camera::ReadRegister VIDIOC_R_I2C %s OK\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+            LOG_EX("Camera::ReadRegister VIDIOC_R_I2C %s OK\n", GetFileDescriptorName(fileDescriptor).c_str());
         }
         else
         {
-            LOG_EX("Camera::ReadRegister VIDIOC_R_I2C %s not OK\n", m_FileDescriptorToNameMap[fileDescriptor].c_str());
+            LOG_EX("Camera::ReadRegister VIDIOC_R_I2C %s not OK\n", GetFileDescriptorName(fileDescriptor).c_str());
         }
     }
 
@@ -2752,12 +3621,32 @@ int Camera::WriteRegister(uint16_t nRegAddr, void* pBuffer, uint32_t nBufferSize
 void Camera::PassGainValue()
 {
     int32_t value = 0;
-    ReadExtControl(value, V4L2_CID_GAIN, "ReadGain", "V4L2_CID_GAIN", V4L2_CTRL_CLASS_USER);
+    ReadExtControl(value, V4L2_CID_GAIN, "ReadGain", "V4L2_CID_GAIN", V4L2_CTRL_CLASS_USER, true);
     emit PassAutoGainValue(value);
 }
 
 void Camera::OnCtrlUpdate(int cid, v4l2_event_ctrl ctrl)
 {
+    {
+        QMutexLocker locker(&m_ControlCacheMutex);
+        std::map<uint32_t, ControlCacheEntry>::iterator itEntry = m_ControlCache.find(cid);
+
+        if (itEntry != m_ControlCache.end())
+        {
+            if (ctrl.changes & V4L2_EVENT_CTRL_CH_VALUE)
+            {
+                itEntry->second.value = (ctrl.type == V4L2_CTRL_TYPE_INTEGER64) ? ctrl.value64 : ctrl.value;
+                itEntry->second.bValid = true;
+            }
+            else if (ctrl.changes & V4L2_EVENT_CTRL_CH_FLAGS)
+            {
+                // e.g. switching auto exposure makes the value volatile or not
+                itEntry->second.bValid = false;
+            }
+            itEntry->second.flags = ctrl.flags;
+        }
+    }
+
 	switch (cid)
 	{
 		case V4L2_CID_GAIN:
@@ -2770,23 +3659,34 @@ void Camera::OnCtrlUpdate(int cid, v4l2_event_ctrl ctrl)
 			break;
 	}
 
-	switch (ctrl.type) {
-		case V4L2_CTRL_TYPE_INTEGER:
-			emit SendIntDataToEnumerationWidget(cid, 0, 0, ctrl.value, "", "", false);
-			break;
-		case V4L2_CTRL_TYPE_INTEGER_MENU:
-			emit SendListIntDataToEnumerationWidget(cid, ctrl.value, QList<int64_t>(), "", "", false);
-			break;
-		case V4L2_CTRL_TYPE_MENU:
-			emit SendListDataToEnumerationWidget(cid, ctrl.value, QList<QString>(), "", "", false);
-			break;
-		case V4L2_CTRL_TYPE_INTEGER64:
-			emit SentInt64DataToEnumerationWidget(cid, 0, 0, ctrl.value64, "", "", false);
-			break;
-		case V4L2_CTRL_TYPE_BOOLEAN:
-			emit SendBoolDataToEnumerationWidget(cid,ctrl.value,"","",false);
-		default:
-			break;
+	// e.g. the exposure range follows frame size and frame rate
+	if (ctrl.changes & (V4L2_EVENT_CTRL_CH_RANGE | V4L2_EVENT_CTRL_CH_FLAGS))
+	{
+		UpdateControlDescription(cid, ctrl);
+	}
+
+	// a widget created later is made from this data, it needs the enumerated description
+	ControlDescription description;
+	if (0 == GetControlDescription(cid, description))
+	{
+		switch (ctrl.type) {
+			case V4L2_CTRL_TYPE_INTEGER:
+				emit SendIntDataToEnumerationWidget(cid, static_cast<int32_t>(description.minimum), static_cast<int32_t>(description.maximum), ctrl.value, description.name, description.unit, description.bIsReadOnly);
+				break;
+			case V4L2_CTRL_TYPE_INTEGER_MENU:
+				emit SendListIntDataToEnumerationWidget(cid, ctrl.value, QList<int64_t>(), description.name, description.unit, description.bIsReadOnly);
+				break;
+			case V4L2_CTRL_TYPE_MENU:
+				emit SendListDataToEnumerationWidget(cid, ctrl.value, QList<QString>(), description.name, description.unit, description.bIsReadOnly);
+				break;
+			case V4L2_CTRL_TYPE_INTEGER64:
+				emit SentInt64DataToEnumerationWidget(cid, description.minimum, description.maximum, ctrl.value64, description.name, description.unit, description.bIsReadOnly);
+				break;
+			case V4L2_CTRL_TYPE_BOOLEAN:
+				emit SendBoolDataToEnumerationWidget(cid, ctrl.value, description.name, description.unit, description.bIsReadOnly);
+			default:
+				break;
+		}
 	}
 
 	if (ctrl.changes & V4L2_EVENT_CTRL_CH_FLAGS)
@@ -2806,161 +3706,127 @@ void Camera::OnCtrlUpdate(int cid, v4l2_event_ctrl ctrl)
 void Camera::PassExposureValue()
 {
     int64_t value = 0;
-    ReadExtControl(value, V4L2_CID_EXPOSURE, "ReadExposure", "V4L2_CID_EXPOSURE", V4L2_CTRL_CLASS_USER);
+    ReadExtControl(value, V4L2_CID_EXPOSURE, "ReadExposure", "V4L2_CID_EXPOSURE", V4L2_CTRL_CLASS_USER, true);
     LOG_EX("Camera::PassExposureValue: exposure is now %d", value);
     emit PassAutoExposureValue(value);
 }
 
 void Camera::SetEnumerationControlValueIntList(int32_t id, int64_t val)
 {
-    int result = -1;
-
-    std::vector<int> allFileDescriptors = m_SubDeviceFileDescriptors;
-    allFileDescriptors.push_back(m_DeviceFileDescriptor);
-
-    for (const auto fileDescriptor : allFileDescriptors)
+    QList<ControlMenuItem> items;
+    if (0 != ReadMenuItems(id, items))
     {
-        v4l2_query_ext_ctrl qctrl;
-        v4l2_ext_control extCtrl;
-        v4l2_querymenu queryMenu;
-
-        CLEAR(extCtrl);
-        CLEAR(qctrl);
-        CLEAR(queryMenu);
-
-        extCtrl.id = id;
-        qctrl.id = id;
+        LOG_EX("Camera::SetEnumerationControlValueIntList control %d is no integer menu", id);
+        return;
+    }
 
-        if (0 == iohelper::xioctl(fileDescriptor, VIDIOC_QUERY_EXT_CTRL, &qctrl))
-        {
-            queryMenu.id = qctrl.id;
-            for (queryMenu.index = qctrl.minimum; queryMenu.index <= qctrl.maximum; queryMenu.index++)
-            {
-                if (0 == iohelper::xioctl(fileDescriptor, VIDIOC_QUERYMENU, &queryMenu))
-                {
-                    if (val == queryMenu.value)
-                    {
-                        LOG_EX("Camera::SetEnumerationControlValueIntList %s setting index for menu %s", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), queryMenu.name);
-                        result = SetExtControl(queryMenu.index, id, "SetEnumerationControl", "V4L2_CTRL_TYPE_MENU", V4L2_CTRL_ID2CLASS(id));
-                        if (result < 0)
-                        {
-                            LOG_EX("Camera::SetEnumerationControlValueIntList %s index for name %s cannot be set with V4L2_CTRL_CLASS_USER class", m_FileDescriptorToNameMap[m_DeviceFileDescriptor].c_str(), qctrl.name);
-                        }
-                        emit SendSignalToUpdateWidgets();
-                        break;
-                    }
-                }
-                else
-                {
-                    LOG_EX("Camera::SetEnumerationControlValueIntList VIDIOC_QUERYMENU %s failed errno=%d=%s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
-                }
-            }
-        }
-        else
+    // the index is resolved from the items the widget was built from
+    for (const ControlMenuItem &item : items)
+    {
+        if (val == item.value)
         {
-            LOG_EX("Camera::SetEnumerationControlValueIntList VIDIOC_QUERY_EXT_CTRL %s failed errno=%d=%s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+            LOG_EX("Camera::SetEnumerationControlValueIntList setting index %u for menu %d", item.index, id);
+            QueueControlWrite(id, item.index, true);
+            return;
         }
     }
+
+    LOG_EX("Camera::SetEnumerationControlValueIntList control %d has no item %lld", id, static_cast<long long>(val));
 }
 
 void Camera::SetEnumerationControlValueList(int32_t id, const char *str)
 {
-    int result = -1;
-
-    std::vector<int> allFileDescriptors = m_SubDeviceFileDescriptors;
-    allFileDescriptors.push_back(m_DeviceFileDescriptor);
-
-    for (const auto fileDescriptor : allFileDescriptors)
+    QList<ControlMenuItem> items;
+    if (0 != ReadMenuItems(id, items))
     {
-        v4l2_query_ext_ctrl qctrl;
-        v4l2_ext_control extCtrl;
-        v4l2_querymenu queryMenu;
-
-        CLEAR(extCtrl);
-        CLEAR(qctrl);
-        CLEAR(queryMenu);
-
-        extCtrl.id = id;
-        qctrl.id = id;
+        LOG_EX("Camera::SetEnumerationControlValueList control %d is no menu", id);
+        return;
+    }
 
-        if (0 == iohelper::xioctl(fileDescriptor, VIDIOC_QUERY_EXT_CTRL, &qctrl))
-        {
-            queryMenu.id = qctrl.id;
-            for (queryMenu.index = qctrl.minimum; queryMenu.index <= qctrl.maximum; queryMenu.index++)
-            {
-                if (0 == iohelper::xioctl(fileDescriptor, VIDIOC_QUERYMENU, &queryMenu))
-                {
-                    if (strcmp((const char*) queryMenu.name, str) == 0)
-                    {
-                        LOG_EX("Camera::SetEnumerationControlValueList %s setting index for menu %s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), queryMenu.name);
-                        result = SetExtControl(queryMenu.index, id, "SetEnumerationControl", "V4L2_CTRL_TYPE_MENU", V4L2_CTRL_ID2CLASS(id));
-                        if (result < 0)
-                        {
-                            LOG_EX("Camera::SetEnumerationControlValueList %s index for name %s cannot be set with V4L2_CTRL_CLASS_USER class", m_FileDescriptorToNameMap[fileDescriptor].c_str(), queryMenu.name);
-                        }
-                        emit SendSignalToUpdateWidgets();
-                        break;
-                    }
-                }
-                else
-                {
-                    LOG_EX("Camera::SetEnumerationControlValueList VIDIOC_QUERYMENU %s failed errno=%d=%s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
-                }
-            }
-        }
-        else
+    for (const ControlMenuItem &item : items)
+    {
+        if (item.name == str)
         {
-            LOG_EX("Camera::SetEnumerationControlValueList VIDIOC_QUERY_EXT_CTRL %s failed errno=%d=%s", m_FileDescriptorToNameMap[fileDescriptor].c_str(), errno, v4l2helper::ConvertErrno2String(errno).c_str());
+            LOG_EX("Camera::SetEnumerationControlValueList setting index %u for menu %s", item.index, str);
+            QueueControlWrite(id, item.index, true);
+            return;
         }
     }
+
+    LOG_EX("Camera::SetEnumerationControlValueList control %d has no item %s", id, str);
 }
 
 void Camera::SetEnumerationControlValue(int32_t id, int32_t val)
 {
-    int result = SetExtControl(val, id, "SetEnumerationControl", "V4L2_CTRL_TYPE_INTEGER32", V4L2_CTRL_ID2CLASS (id));
-    if (result < 0)
-    {
-        LOG_EX("Enumeration control of type V4L2_CTRL_TYPE_INTEGER32 cannot be set with V4L2_CTRL_CLASS_USER class");
-    }
-    emit SendSignalToUpdateWidgets();
+    // queued behind the slider values of the control, the widgets are updated after the write
+    QueueControlWrite(id, val, true);
 }
 
 void Camera::SetEnumerationControlValue(int32_t id, int64_t val)
 {
-    int result = SetExtControl(val, id, "SetEnumerationControl", "V4L2_CTRL_TYPE_INTEGER64", V4L2_CTRL_ID2CLASS (id));
-    if (result < 0)
-    {
-        LOG_EX("Enumeration control of type V4L2_CTRL_TYPE_INTEGER64 cannot be set with V4L2_CTRL_CLASS_USER class");
-    }
-    emit SendSignalToUpdateWidgets();
+    QueueControlWrite(id, val, true);
 }
 
 void Camera::SetEnumerationControlValue(int32_t id, bool val)
 {
-    int result = SetExtControl(static_cast<int32_t>(val), id, "SetEnumerationControl", "V4L2_CTRL_TYPE_BOOL", V4L2_CTRL_ID2CLASS (id));
-    if (result < 0)
-    {
-        LOG_EX("Enumeration control of type V4L2_CTRL_TYPE_BOOL cannot be set with V4L2_CTRL_CLASS_USER class");
-    }
-    emit SendSignalToUpdateWidgets();
+    QueueControlWrite(id, val ? 1 : 0, true);
 }
 
 void Camera::SetEnumerationControlValue(int32_t id)
 {
-    int result = SetExtControl(0, id, "SetEnumerationControl", "V4L2_CTRL_TYPE_BUTTON", V4L2_CTRL_ID2CLASS (id));
-    if (result < 0)
-    {
-        LOG_EX("Enumeration control of type V4L2_CTRL_TYPE_BUTTON cannot be set with V4L2_CTRL_CLASS_USER class");
-    }
-    emit SendSignalToUpdateWidgets();
+    // a press which is still pending is merged with this one
+    QueueControlWrite(id, 0, true);
 }
 
 void Camera::SetSliderEnumerationControlValue(int32_t id, int32_t val)
 {
-    SetExtControl(val, id, "SetEnumerationControl", "V4L2_CTRL_TYPE_INTEGER32", V4L2_CTRL_ID2CLASS (id));
+    QueueControlWrite(id, val);
 }
 
 void Camera::SetSliderEnumerationControlValue(int32_t id, int64_t val)
 {
-    SetExtControl(val, id, "SetEnumerationControl", "V4L2_CTRL_TYPE_INTEGER64", V4L2_CTRL_ID2CLASS (id));
+    QueueControlWrite(id, val);
+}
+
+void Camera::QueueControlWrite(int32_t id, int64_t value, bool bNotify)
+{
+    m_ControlWriter.Queue(id, value, bNotify);
+}
+
+void Camera::SetControlWriteRate(uint32_t writesPerSecond)
+{
+    m_ControlWriter.SetMaxWriteRate(writesPerSecond);
+}
+
+void Camera::OnWriteControl(int32_t id, int64_t value)
+{
+    uint32_t type = GetControlType(id);
+    if (0 == type)
+    {
+        LOG_EX("Camera::OnWriteControl control %d is unknown", id);
+        return;
+    }
+
+    int result = -1;
+    if (V4L2_CTRL_TYPE_INTEGER64 == type)
+    {
+        result = SetExtControl(value, id, "OnWriteControl", "V4L2_CTRL_TYPE_INTEGER64", V4L2_CTRL_ID2CLASS (id));
+    }
+    else
+    {
+        result = SetExtControl(static_cast<int32_t>(value), id, "OnWriteControl", "V4L2_CTRL_TYPE_INTEGER32", V4L2_CTRL_ID2CLASS (id));
+    }
+
+    if (result < 0)
+    {
+        LOG_EX("Camera::OnWriteControl control %d cannot be set to %lld", id, static_cast<long long>(value));
+    }
+}
+
+void Camera::OnControlsWritten(bool bNotify)
+{
+    if (bNotify)
+    {
+        emit SendSignalToUpdateWidgets();
+    }
 }
@@ -19,18 +19,37 @@
 #include "CameraObserver.h"
 #include "Logger.h"
 
+#include <algorithm>
+#include <dirent.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <IOHelper.h>
+#include <linux/v4l2-subdev.h>
 #include <linux/videodev2.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
-
-#define MAX_DEVICE_COUNT 10
+#include <utility>
+#include <vector>
+
+#define DEVICE_DIRECTORY            "/dev"
+#define VIDEO_NODE_PREFIX           "video"
+#define SUB_DEVICE_NODE_PREFIX      "v4l-subdev"
+// udev creates the node first and sets the permissions afterwards, so
+// attribute changes are watched as well
+#define NODE_EVENT_MASK             (IN_CREATE | IN_DELETE | IN_ATTRIB | IN_MOVED_TO | IN_MOVED_FROM)
+#define NODE_EVENT_BUFFER_SIZE      4096
+// card name reported for sub-devices which only implement the sub-device API
+#define SUB_DEVICE_INFO             "V4L2 sub-device"
 
 CameraObserver::CameraObserver(void)
     : m_bTerminate(false)
     , m_bAbort(false)
+    , m_InotifyFileDescriptor(-1)
+    , m_WakeFileDescriptor(-1)
 {
 
 }
@@ -41,9 +60,78 @@ CameraObserver::~CameraObserver(void)
     Stop();
 }
 
-void CameraObserver::Start()
+int CameraObserver::Start()
 {
+    if (isRunning())
+    {
+        return 0;
+    }
+
+    m_InotifyFileDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (-1 == m_InotifyFileDescriptor)
+    {
+        LOG_EX("CameraObserver::Start inotify_init1 failed errno=%d", errno);
+        return -1;
+    }
+
+    if (-1 == inotify_add_watch(m_InotifyFileDescriptor, DEVICE_DIRECTORY, NODE_EVENT_MASK))
+    {
+        LOG_EX("CameraObserver::Start watching %s failed errno=%d", DEVICE_DIRECTORY, errno);
+        close(m_InotifyFileDescriptor);
+        m_InotifyFileDescriptor = -1;
+        return -1;
+    }
+
+    m_WakeFileDescriptor = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (-1 == m_WakeFileDescriptor)
+    {
+        LOG_EX("CameraObserver::Start eventfd failed errno=%d", errno);
+        close(m_InotifyFileDescriptor);
+        m_InotifyFileDescriptor = -1;
+        return -1;
+    }
+
+    // the watch exists before the scan, a node created meanwhile is queued as
+    // an event and the known list keeps it from being reported twice
+    ScanDevices();
+
+    m_bAbort = false;
     start();
+
+    LOG_EX("CameraObserver::Start watching %s for device nodes", DEVICE_DIRECTORY);
+
+    return 0;
+}
+
+void CameraObserver::ScanDevices()
+{
+    DIR *pDirectory = opendir(DEVICE_DIRECTORY);
+    if (NULL == pDirectory)
+    {
+        LOG_EX("CameraObserver::ScanDevices opendir %s failed errno=%d", DEVICE_DIRECTORY, errno);
+        return;
+    }
+
+    // video nodes before sub-devices, both in the order of their numbers
+    std::vector<std::pair<std::pair<int, uint64_t>, std::string> > nodes;
+    struct dirent *pEntry = NULL;
+    while (NULL != (pEntry = readdir(pDirectory)))
+    {
+        uint64_t nodeNumber = 0;
+        std::string nodeName(pEntry->d_name);
+        int nodeKind = GetNodeKind(nodeName, nodeNumber);
+        if (-1 != nodeKind)
+        {
+            nodes.push_back(std::make_pair(std::make_pair(nodeKind, nodeNumber), nodeName));
+        }
+    }
+    closedir(pDirectory);
+
+    std::sort(nodes.begin(), nodes.end());
+    for (size_t i = 0; i < nodes.size(); i++)
+    {
+        CheckDevice(nodes[i].second);
+    }
 }
 
 void CameraObserver::Stop()
@@ -51,9 +139,28 @@ void CameraObserver::Stop()
     // stop the internal processing thread and wait until the thread is really stopped
     m_bAbort = true;
 
+    if (-1 != m_WakeFileDescriptor)
+    {
+        uint64_t wake = 1;
+        if (-1 == write(m_WakeFileDescriptor, &wake, sizeof(wake)))
+        {
+            LOG_EX("CameraObserver::Stop waking the thread failed errno=%d", errno);
+        }
+    }
+
     // wait until the thread is stopped
-    while (isRunning())
-        QThread::msleep(10);
+    wait();
+
+    if (-1 != m_InotifyFileDescriptor)
+    {
+        close(m_InotifyFileDescriptor);
+        m_InotifyFileDescriptor = -1;
+    }
+    if (-1 != m_WakeFileDescriptor)
+    {
+        close(m_WakeFileDescriptor);
+        m_WakeFileDescriptor = -1;
+    }
 }
 
 void CameraObserver::SetTerminateFlag()
@@ -64,289 +171,291 @@ void CameraObserver::SetTerminateFlag()
 // Do the work within this thread
 void CameraObserver::run()
 {
+    struct pollfd fileDescriptors[2];
+    fileDescriptors[0].fd = m_InotifyFileDescriptor;
+    fileDescriptors[0].events = POLLIN;
+    fileDescriptors[1].fd = m_WakeFileDescriptor;
+    fileDescriptors[1].events = POLLIN;
+
+    // sleep until a node changes, nothing is opened while nothing happens
     while (!m_bAbort)
     {
-        CheckDevices();
-        CheckSubDevices();
+        int result = poll(fileDescriptors, 2, -1);
+        if (-1 == result)
+        {
+            if (EINTR == errno)
+            {
+                continue;
+            }
+
+            LOG_EX("CameraObserver::run poll failed errno=%d", errno);
+            break;
+        }
 
-        QThread::msleep(1000);
+        if (!m_bAbort && (fileDescriptors[0].revents & POLLIN))
+        {
+            ProcessNodeEvents();
+        }
     }
 }
 
-int CameraObserver::CheckDevices()
+void CameraObserver::ProcessNodeEvents()
 {
-    uint32_t deviceCount = 0;
-    QString deviceName;
-    int fileDiscriptor = -1;
-    std::map<int, std::string>    deviceList;
+    char buffer[NODE_EVENT_BUFFER_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
 
-    do
+    while (true)
     {
-        deviceName = QString("/dev/video%1").arg(deviceCount);
-
-        if ((fileDiscriptor = open(deviceName.toStdString().c_str(), O_RDWR)) == -1)
+        ssize_t length = read(m_InotifyFileDescriptor, buffer, sizeof(buffer));
+        if (length <= 0)
         {
-            LOG_EX("CameraObserver::CheckDevices open %s failed", deviceName.toLatin1().data());
-            emit OnCameraError_Signal("CameraObserver::CheckDevices: open " + deviceName + " failed");
+            break;
         }
-        else
-        {
-            v4l2_capability cap;
 
-            LOG_EX("CameraObserver::CheckDevices open %s found", deviceName.toLatin1().data());
-            emit OnCameraMessage_Signal("CameraObserver::CheckDevices: open " + deviceName + " found");
+        for (char *pEvent = buffer; pEvent < buffer + length; )
+        {
+            const struct inotify_event *pNodeEvent = reinterpret_cast<const struct inotify_event*>(pEvent);
+            pEvent += sizeof(struct inotify_event) + pNodeEvent->len;
 
-            // query device capabilities
-            if (-1 == iohelper::xioctl(fileDiscriptor, VIDIOC_QUERYCAP, &cap))
+            if (pNodeEvent->mask & IN_Q_OVERFLOW)
             {
-                LOG_EX("CameraObserver::CheckDevices %s is no V4L2 device", deviceName.toLatin1().data());
-                emit OnCameraError_Signal("CameraObserver::CheckDevices: " + deviceName + " is no V4L2 device");
+                LOG_EX("CameraObserver::ProcessNodeEvents events of %s were lost", DEVICE_DIRECTORY);
+                continue;
             }
-            else
+            if (0 == pNodeEvent->len)
             {
-                if(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE)
-                {
-                    LOG_EX("CameraObserver::CheckDevices %s is a single-plane video capture device", deviceName.toLatin1().data());
-                }
-                else if(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE)
-                {
-                    LOG_EX("CameraObserver::CheckDevices %s is a multi-plane video capture device", deviceName.toLatin1().data());
-                }
-                else
-                {
-                    LOG_EX("CameraObserver::CheckDevices %s is no video capture device", deviceName.toLatin1().data());
-                    emit OnCameraError_Signal("CameraObserver::CheckDevices: " + deviceName + " is no video capture device");
-                }
+                continue;
             }
 
-
-            if (-1 == close(fileDiscriptor))
+            std::string nodeName(pNodeEvent->name);
+            if (pNodeEvent->mask & (IN_DELETE | IN_MOVED_FROM))
             {
-                LOG_EX("CameraObserver::CheckDevices close %s failed", deviceName.toLatin1().data());
-                emit OnCameraError_Signal("CameraObserver::CheckDevices: close " + deviceName + " failed");
+                RemoveDevice(nodeName);
             }
             else
             {
-                deviceList[deviceCount] = deviceName.toStdString();
-
-                deviceCount++;
-
-                LOG_EX("CameraObserver::CheckDevices close %s OK", deviceName.toLatin1().data());
-                emit OnCameraMessage_Signal("CameraObserver::CheckDevices: close " + deviceName + " OK");
+                CheckDevice(nodeName);
             }
         }
     }
-    while(++deviceCount < MAX_DEVICE_COUNT);
+}
 
-    for (unsigned int i=0; i<deviceList.size(); i++)
-    {
-        bool found = false;
+int CameraObserver::GetNodeKind(const std::string &nodeName, uint64_t &nodeNumber)
+{
+    int nodeKind = -1;
+    size_t prefixLength = 0;
 
-        for (unsigned int ii=0; ii<m_DeviceList.size(); ii++)
-        {
-            if (deviceList[i] == m_DeviceList[ii])
-            {
-                found = true;
-                break;
-            }
-        }
+    if (0 == nodeName.compare(0, sizeof(VIDEO_NODE_PREFIX) - 1, VIDEO_NODE_PREFIX))
+    {
+        nodeKind = 0;
+        prefixLength = sizeof(VIDEO_NODE_PREFIX) - 1;
+    }
+    else if (0 == nodeName.compare(0, sizeof(SUB_DEVICE_NODE_PREFIX) - 1, SUB_DEVICE_NODE_PREFIX))
+    {
+        nodeKind = 1;
+        prefixLength = sizeof(SUB_DEVICE_NODE_PREFIX) - 1;
+    }
 
-        if (!found)
-        {
-            unsigned int ii = 0;
-            for (ii=0; ii<m_DeviceList.size(); ii++)
-            {
-                bool found = false;
-                for (std::map<int, std::string>::iterator iii=m_DeviceList.begin(); iii!=m_DeviceList.end(); iii++)
-                {
-                    if (iii->first == static_cast<int>(ii) )
-                    {
-                        found = true;
-                        break;
-                    }
-                }
-                if (found == false)
-                    break;
-            }
-            m_DeviceList[ii] = deviceList[i].c_str();
-            emit OnCameraListChanged_Signal(UpdateTriggerPluggedIn, 0, ii, m_DeviceList[ii].c_str(), "");
-        }
+    // only the numbered nodes are devices, e.g. not /dev/video-links
+    if (-1 == nodeKind || nodeName.length() == prefixLength)
+    {
+        return -1;
     }
 
-    for (unsigned int i=0; i<m_DeviceList.size(); i++)
+    char *pEnd = NULL;
+    nodeNumber = strtoull(nodeName.c_str() + prefixLength, &pEnd, 10);
+    if ('\0' != *pEnd)
     {
-        bool found = false;
+        return -1;
+    }
 
-        for (unsigned int ii=0; ii<deviceList.size(); ii++)
-        {
-            if (deviceList[ii] == m_DeviceList[i])
-            {
-                found = true;
-                break;
-            }
-        }
+    return nodeKind;
+}
+
+int CameraObserver::CheckDevice(const std::string &nodeName)
+{
+    uint64_t nodeNumber = 0;
+    int nodeKind = GetNodeKind(nodeName, nodeNumber);
+
+    if (-1 == nodeKind)
+    {
+        return 0;
+    }
 
-        if (!found)
+    {
+        // known and rejected nodes are not opened again, attribute changes of an open camera are ignored
+        QMutexLocker locker(&m_DeviceListMutex);
+        std::map<std::string, std::string> &knownList = (0 == nodeKind) ? m_DeviceList : m_SubDeviceList;
+        if (knownList.find(nodeName) != knownList.end() || m_RejectedNodes.count(nodeName))
         {
-            m_DeviceList.erase(i);
-            emit OnCameraListChanged_Signal(UpdateTriggerPluggedOut, 0, i, m_DeviceList[i].c_str(), "");
+            return 0;
         }
     }
 
-    return 0;
-}
-
-// Callbacks
+    QString deviceName = QString(DEVICE_DIRECTORY "/%1").arg(QString::fromStdString(nodeName));
+    int fileDiscriptor = open(deviceName.toStdString().c_str(), O_RDWR);
 
-void CameraObserver::OnDeviceReady(uint32_t cardNumber, uint64_t deviceID, const void *pPrivateData)
-{
-    if (!m_bTerminate)
+    if (-1 == fileDiscriptor)
     {
-        emit OnCameraListChanged_Signal(UpdateTriggerPluggedIn, cardNumber, deviceID, "", "");
+        // udev may not have set the permissions yet, the attribute change will follow
+        LOG_EX("CameraObserver::CheckDevice open %s failed errno=%d", deviceName.toLatin1().data(), errno);
+        return -1;
     }
-}
 
-void CameraObserver::OnDeviceRemoved(uint32_t cardNumber, uint64_t deviceID, const void *pPrivateData)
-{
-    if (!m_bTerminate)
+    std::string cardName;
+    int result = ProbeNode(fileDiscriptor, 1 == nodeKind, deviceName.toLatin1().data(), cardName);
+
+    if (-1 == close(fileDiscriptor))
     {
-        emit OnCameraListChanged_Signal(UpdateTriggerPluggedOut, cardNumber, deviceID, "", "");
+        LOG_EX("CameraObserver::CheckDevice close %s failed", deviceName.toLatin1().data());
     }
-}
 
-void CameraObserver::OnMessage(const char *text, void *pPrivateData)
-{
-    if (!m_bTerminate)
+    if (0 != result)
     {
-        LOG_EX("CameraObserver: message = '%s'", text);
+        QMutexLocker locker(&m_DeviceListMutex);
+        m_RejectedNodes.insert(nodeName);
+        return -1;
     }
-}
-
-int CameraObserver::CheckSubDevices()
-{
-    uint32_t subDeviceCount = 0;
-    QString subDeviceName;
-    int fileDiscriptor = -1;
-    std::map<int, std::string>    subDeviceList;
 
-    do
+    QString info = QString::fromStdString(cardName);
     {
-        subDeviceName = QString("/dev/video%1").arg(subDeviceCount);
+        QMutexLocker locker(&m_DeviceListMutex);
+        std::map<std::string, std::string> &knownList = (0 == nodeKind) ? m_DeviceList : m_SubDeviceList;
+        knownList[nodeName] = cardName;
+    }
 
-        if ((fileDiscriptor = open(subDeviceName.toStdString().c_str(), O_RDWR)) == -1)
+    if (!m_bTerminate)
+    {
+        if (0 == nodeKind)
         {
-            LOG_EX("CameraObserver::CheckSubDevices open %s failed", subDeviceName.toLatin1().data());
-            emit OnSubDeviceError_Signal("CameraObserver::CheckSubDevices: open " + subDeviceName + " failed");
+            emit OnCameraListChanged_Signal(UpdateTriggerPluggedIn, 0, nodeNumber, deviceName, info);
         }
         else
         {
-            v4l2_capability cap;
-
-            LOG_EX("CameraObserver::CheckSubDevices open %s found", subDeviceName.toLatin1().data());
-            emit OnCameraMessage_Signal("CameraObserver::CheckSubDevices: open " + subDeviceName + " found");
+            emit OnSubDeviceListChanged_Signal(UpdateTriggerPluggedIn, 0, nodeNumber, deviceName, info);
+        }
+    }
 
-            // query device capabilities
-            if (-1 == iohelper::xioctl(fileDiscriptor, VIDIOC_QUERYCAP, &cap))
-            {
-                LOG_EX("CameraObserver::CheckSubDevices %s is no V4L2 device", subDeviceName.toLatin1().data());
-                emit OnSubDeviceError_Signal("CameraObserver::CheckSubDevices: " + subDeviceName + " is no V4L2 device");
-            }
-            else
-            {
-                if(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE)
-                {
-                    LOG_EX("CameraObserver::CheckSubDevices %s is a single-plane video capture device", subDeviceName.toLatin1().data());
-                }
-                else if(cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE)
-                {
-                    LOG_EX("CameraObserver::CheckSubDevices %s is a multi-plane video capture device", subDeviceName.toLatin1().data());
-                }
-                else
-                {
-                    LOG_EX("CameraObserver::CheckSubDevices %s is no video capture device", subDeviceName.toLatin1().data());
-                    emit OnSubDeviceError_Signal("CameraObserver::CheckSubDevices: " + subDeviceName + " is no video capture device");
-                }
-            }
+    return 0;
+}
 
+int CameraObserver::RemoveDevice(const std::string &nodeName)
+{
+    uint64_t nodeNumber = 0;
+    int nodeKind = GetNodeKind(nodeName, nodeNumber);
+    QString info;
 
-            if (-1 == close(fileDiscriptor))
-            {
-                LOG_EX("CameraObserver::CheckSubDevices close %s failed", subDeviceName.toLatin1().data());
-                emit OnCameraError_Signal("CameraObserver::CheckSubDevices: close " + subDeviceName + " failed");
-            }
-            else
-            {
-                subDeviceList[subDeviceCount] = subDeviceName.toStdString();
+    if (-1 == nodeKind)
+    {
+        return 0;
+    }
 
-                subDeviceCount++;
+    {
+        QMutexLocker locker(&m_DeviceListMutex);
+        // a new node with the same name is probed again
+        m_RejectedNodes.erase(nodeName);
 
-                LOG_EX("CameraObserver::CheckDevices close %s OK", subDeviceName.toLatin1().data());
-                emit OnSubDeviceMessage_Signal("CameraObserver::CheckDevices: close " + subDeviceName + " OK");
-            }
+        std::map<std::string, std::string> &knownList = (0 == nodeKind) ? m_DeviceList : m_SubDeviceList;
+        std::map<std::string, std::string>::iterator itNode = knownList.find(nodeName);
+        if (itNode == knownList.end())
+        {
+            return 0;
         }
+
+        info = QString::fromStdString(itNode->second);
+        knownList.erase(itNode);
     }
-    while(++subDeviceCount < MAX_DEVICE_COUNT);
 
-    for (unsigned int i=0; i<subDeviceList.size(); i++)
-    {
-        bool found = false;
+    QString deviceName = QString(DEVICE_DIRECTORY "/%1").arg(QString::fromStdString(nodeName));
+    LOG_EX("CameraObserver::RemoveDevice %s was removed", deviceName.toLatin1().data());
 
-        for (unsigned int ii=0; ii<m_SubDeviceList.size(); ii++)
+    if (!m_bTerminate)
+    {
+        if (0 == nodeKind)
         {
-            if (subDeviceList[i] == m_SubDeviceList[ii])
-            {
-                found = true;
-                break;
-            }
+            emit OnCameraListChanged_Signal(UpdateTriggerPluggedOut, 0, nodeNumber, deviceName, info);
         }
-
-        if (!found)
+        else
         {
-            unsigned int ii = 0;
-            for (ii=0; ii<m_SubDeviceList.size(); ii++)
-            {
-                bool found = false;
-                for (std::map<int, std::string>::iterator iii=m_SubDeviceList.begin(); iii!=m_SubDeviceList.end(); iii++)
-                {
-                    if (iii->first == static_cast<int>(ii) )
-                    {
-                        found = true;
-                        break;
-                    }
-                }
-                if (found == false)
-                    break;
-            }
-            m_SubDeviceList[ii] = subDeviceList[i].c_str();
-            emit OnSubDeviceListChanged_Signal(UpdateTriggerPluggedIn, 0, ii, m_SubDeviceList[ii].c_str(), "");
+            emit OnSubDeviceListChanged_Signal(UpdateTriggerPluggedOut, 0, nodeNumber, deviceName, info);
         }
     }
 
-    for (unsigned int i=0; i<m_SubDeviceList.size(); i++)
-    {
-        bool found = false;
+    return 0;
+}
+
+int CameraObserver::ProbeNode(int fileDescriptor, bool bSubDevice, const char *deviceName, std::string &info)
+{
+    v4l2_capability cap;
 
-        for (unsigned int ii=0; ii<subDeviceList.size(); ii++)
+    // video nodes and the sub-devices of vendor drivers answer VIDIOC_QUERYCAP
+    if (-1 != iohelper::xioctl(fileDescriptor, VIDIOC_QUERYCAP, &cap))
+    {
+        if (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE)
         {
-            if (subDeviceList[ii] == m_SubDeviceList[i])
-            {
-                found = true;
-                break;
-            }
+            LOG_EX("CameraObserver::ProbeNode %s is a single-plane video capture device", deviceName);
+            info = reinterpret_cast<const char*>(cap.card);
+            return 0;
         }
-
-        if (!found)
+        else if (cap.capabilities & V4L2_CAP_VIDEO_CAPTURE_MPLANE)
+        {
+            LOG_EX("CameraObserver::ProbeNode %s is a multi-plane video capture device", deviceName);
+            info = reinterpret_cast<const char*>(cap.card);
+            return 0;
+        }
+        else if (!bSubDevice)
         {
-            m_SubDeviceList.erase(i);
-            emit OnSubDeviceListChanged_Signal(UpdateTriggerPluggedOut, 0, i, m_SubDeviceList[i].c_str(), "");
+            LOG_EX("CameraObserver::ProbeNode %s is no video capture device", deviceName);
+            return -1;
         }
     }
+    else if (!bSubDevice)
+    {
+        LOG_EX("CameraObserver::ProbeNode %s is no V4L2 device", deviceName);
+        return -1;
+    }
 
+    // other sub-devices only implement the sub-device API, kernels before
+    // VIDIOC_SUBDEV_QUERYCAP do not know the ioctl and the open node is taken
+#ifdef VIDIOC_SUBDEV_QUERYCAP
+    v4l2_subdev_capability subDeviceCap;
+    if (-1 == iohelper::xioctl(fileDescriptor, VIDIOC_SUBDEV_QUERYCAP, &subDeviceCap) && ENOTTY != errno)
+    {
+        LOG_EX("CameraObserver::ProbeNode %s is no V4L2 sub-device errno=%d", deviceName, errno);
+        return -1;
+    }
+#endif
+
+    LOG_EX("CameraObserver::ProbeNode %s is a V4L2 sub-device", deviceName);
+    info = SUB_DEVICE_INFO;
     return 0;
 }
 
 // Callbacks
 
+void CameraObserver::OnDeviceReady(uint32_t cardNumber, uint64_t deviceID, const void *pPrivateData)
+{
+    if (!m_bTerminate)
+    {
+        emit OnCameraListChanged_Signal(UpdateTriggerPluggedIn, cardNumber, deviceID, "", "");
+    }
+}
+
+void CameraObserver::OnDeviceRemoved(uint32_t cardNumber, uint64_t deviceID, const void *pPrivateData)
+{
+    if (!m_bTerminate)
+    {
+        emit OnCameraListChanged_Signal(UpdateTriggerPluggedOut, cardNumber, deviceID, "", "");
+    }
+}
+
+void CameraObserver::OnMessage(const char *text, void *pPrivateData)
+{
+    if (!m_bTerminate)
+    {
+        LOG_EX("CameraObserver: message = '%s'", text);
+    }
+}
+
 void CameraObserver::OnSubDeviceReady(uint32_t cardNumber, uint64_t deviceID, const void *pPrivateData)
 {
     if (!m_bTerminate)
@@ -0,0 +1,272 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+#include "CapabilityCache.h"
+#include "Logger.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+// Raised when the layout of the file changes, older files are ignored
+#define CAPABILITY_CACHE_VERSION 2
+
+CapabilityCache::CapabilityCache(void)
+    : m_bIsStored(false)
+{
+}
+
+CapabilityCache::~CapabilityCache(void)
+{
+}
+
+void CapabilityCache::Clear()
+{
+    m_Key.clear();
+    m_PixelFormats.clear();
+    m_FrameSizes.clear();
+    m_Controls.clear();
+    m_bIsStored = false;
+}
+
+void CapabilityCache::SetKey(const QString &key)
+{
+    if (key != m_Key)
+    {
+        Clear();
+        m_Key = key;
+    }
+}
+
+int CapabilityCache::Load()
+{
+    QString filePath = GetFilePath();
+    if (filePath.isEmpty())
+    {
+        return -1;
+    }
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+    {
+        LOG_EX("CapabilityCache::Load no entry for %s", m_Key.toStdString().c_str());
+        return -1;
+    }
+
+    QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    // the file name is a hash, the key itself has to match as well
+    if (root.value("version").toInt() != CAPABILITY_CACHE_VERSION || root.value("key").toString() != m_Key)
+    {
+        LOG_EX("CapabilityCache::Load entry %s does not belong to %s", filePath.toStdString().c_str(), m_Key.toStdString().c_str());
+        return -1;
+    }
+
+    QList<CachedPixelFormat> pixelFormats;
+    std::map<uint32_t, QList<QString> > frameSizes;
+    for (const QJsonValue &value : root.value("pixelFormats").toArray())
+    {
+        QJsonObject object = value.toObject();
+        CachedPixelFormat pixelFormat;
+        pixelFormat.pixelFormat = static_cast<uint32_t>(object.value("pixelFormat").toDouble());
+        pixelFormat.description = object.value("description").toString();
+        pixelFormats.append(pixelFormat);
+
+        // formats with stepwise or continuous sizes have none stored
+        if (object.contains("frameSizes"))
+        {
+            QList<QString> &sizes = frameSizes[pixelFormat.pixelFormat];
+            for (const QJsonValue &size : object.value("frameSizes").toArray())
+            {
+                sizes.append(size.toString());
+            }
+        }
+    }
+
+    std::vector<CachedControl> controls;
+    for (const QJsonValue &value : root.value("controls").toArray())
+    {
+        QJsonObject object = value.toObject();
+        CachedControl control;
+        control.id = static_cast<uint32_t>(object.value("id").toDouble());
+        control.type = static_cast<uint32_t>(object.value("type").toDouble());
+        control.device = object.value("device").toInt();
+        control.name = object.value("name").toString();
+        controls.push_back(control);
+    }
+
+    if (pixelFormats.isEmpty() || controls.empty())
+    {
+        LOG_EX("CapabilityCache::Load entry %s is incomplete", filePath.toStdString().c_str());
+        return -1;
+    }
+
+    m_PixelFormats = pixelFormats;
+    m_FrameSizes = frameSizes;
+    m_Controls = controls;
+    m_bIsStored = true;
+
+    LOG_EX("CapabilityCache::Load %d pixel formats and %d controls of %s", static_cast<int>(m_PixelFormats.size()), static_cast<int>(m_Controls.size()), m_Key.toStdString().c_str());
+
+    return 0;
+}
+
+int CapabilityCache::Save()
+{
+    if (m_bIsStored)
+    {
+        return 0;
+    }
+
+    QString filePath = GetFilePath();
+    if (filePath.isEmpty() || !IsComplete())
+    {
+        return -1;
+    }
+
+    QJsonArray pixelFormats;
+    for (const CachedPixelFormat &pixelFormat : m_PixelFormats)
+    {
+        QJsonObject object;
+        object.insert("pixelFormat", static_cast<double>(pixelFormat.pixelFormat));
+        object.insert("description", pixelFormat.description);
+
+        std::map<uint32_t, QList<QString> >::const_iterator it = m_FrameSizes.find(pixelFormat.pixelFormat);
+        if (it != m_FrameSizes.end())
+        {
+            QJsonArray sizes;
+            for (const QString &size : it->second)
+            {
+                sizes.append(size);
+            }
+            object.insert("frameSizes", sizes);
+        }
+        pixelFormats.append(object);
+    }
+
+    QJsonArray controls;
+    for (const CachedControl &control : m_Controls)
+    {
+        QJsonObject object;
+        object.insert("id", static_cast<double>(control.id));
+        object.insert("type", static_cast<double>(control.type));
+        object.insert("device", control.device);
+        object.insert("name", control.name);
+        controls.append(object);
+    }
+
+    QJsonObject root;
+    root.insert("version", CAPABILITY_CACHE_VERSION);
+    root.insert("key", m_Key);
+    root.insert("pixelFormats", pixelFormats);
+    root.insert("controls", controls);
+
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+
+    // a viewer killed while writing must not leave half an entry behind
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly) || file.write(QJsonDocument(root).toJson(QJsonDocument::Compact)) < 0 || !file.commit())
+    {
+        LOG_EX("CapabilityCache::Save writing %s failed", filePath.toStdString().c_str());
+        return -1;
+    }
+
+    m_bIsStored = true;
+    LOG_EX("CapabilityCache::Save %s stored in %s", m_Key.toStdString().c_str(), filePath.toStdString().c_str());
+
+    return 0;
+}
+
+void CapabilityCache::Invalidate()
+{
+    QString filePath = GetFilePath();
+    if (!filePath.isEmpty())
+    {
+        QFile::remove(filePath);
+    }
+
+    QString key = m_Key;
+    Clear();
+    m_Key = key;
+}
+
+bool CapabilityCache::IsComplete() const
+{
+    return !m_PixelFormats.isEmpty() && !m_Controls.empty();
+}
+
+const QList<CachedPixelFormat> &CapabilityCache::GetPixelFormats() const
+{
+    return m_PixelFormats;
+}
+
+void CapabilityCache::SetPixelFormats(const QList<CachedPixelFormat> &pixelFormats)
+{
+    m_PixelFormats = pixelFormats;
+    m_bIsStored = false;
+}
+
+bool CapabilityCache::GetFrameSizes(uint32_t pixelFormat, QList<QString> &frameSizes) const
+{
+    std::map<uint32_t, QList<QString> >::const_iterator it = m_FrameSizes.find(pixelFormat);
+    if (it == m_FrameSizes.end())
+    {
+        return false;
+    }
+
+    frameSizes = it->second;
+    return true;
+}
+
+void CapabilityCache::SetFrameSizes(uint32_t pixelFormat, const QList<QString> &frameSizes)
+{
+    m_FrameSizes[pixelFormat] = frameSizes;
+    m_bIsStored = false;
+}
+
+const std::vector<CachedControl> &CapabilityCache::GetControls() const
+{
+    return m_Controls;
+}
+
+void CapabilityCache::SetControls(const std::vector<CachedControl> &controls)
+{
+    m_Controls = controls;
+    m_bIsStored = false;
+}
+
+QString CapabilityCache::GetFilePath() const
+{
+    if (m_Key.isEmpty())
+    {
+        return QString();
+    }
+
+    QString directory = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+    if (directory.isEmpty())
+    {
+        return QString();
+    }
+
+    QString fileName = QString::fromLatin1(QCryptographicHash::hash(m_Key.toUtf8(), QCryptographicHash::Sha1).toHex());
+    return directory + "/V4L2Viewer/capabilities/" + fileName + ".json";
+}
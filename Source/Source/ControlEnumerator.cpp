@@ -0,0 +1,114 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+#include "ControlEnumerator.h"
+
+#include <QMutexLocker>
+
+ControlEnumerator::ControlEnumerator(void)
+    : m_bRequested(false)
+    , m_bDescriptionsRequested(false)
+    , m_bAbort(false)
+{
+}
+
+ControlEnumerator::~ControlEnumerator(void)
+{
+    Stop();
+}
+
+void ControlEnumerator::Stop()
+{
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_bAbort = true;
+        m_bRequested = false;
+        m_bDescriptionsRequested = false;
+        m_Condition.wakeAll();
+    }
+
+    wait();
+}
+
+void ControlEnumerator::Request()
+{
+    QMutexLocker locker(&m_Mutex);
+
+    m_bRequested = true;
+    m_Condition.wakeAll();
+}
+
+void ControlEnumerator::RequestDescriptions()
+{
+    QMutexLocker locker(&m_Mutex);
+
+    m_bDescriptionsRequested = true;
+    m_Condition.wakeAll();
+}
+
+void ControlEnumerator::Cancel()
+{
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_bRequested = false;
+        m_bDescriptionsRequested = false;
+    }
+
+    // a pass taken before is finished when the lock can be taken
+    QMutexLocker enumerateLocker(&m_EnumerateMutex);
+}
+
+void ControlEnumerator::run()
+{
+    while (true)
+    {
+        bool bDescribe = false;
+        bool bEnumerate = false;
+        {
+            QMutexLocker locker(&m_Mutex);
+
+            while (!m_bAbort && !m_bRequested && !m_bDescriptionsRequested)
+            {
+                m_Condition.wait(&m_Mutex);
+            }
+
+            if (m_bAbort)
+            {
+                break;
+            }
+
+            bDescribe = m_bDescriptionsRequested;
+            bEnumerate = m_bRequested;
+            m_bDescriptionsRequested = false;
+            m_bRequested = false;
+            m_EnumerateMutex.lock();
+        }
+
+        // the values are read for the descriptions of the same pass
+        if (bDescribe)
+        {
+            emit DescribeControls_Signal();
+            emit ControlsDescribed_Signal();
+        }
+        if (bEnumerate)
+        {
+            emit EnumerateControls_Signal();
+        }
+
+        m_EnumerateMutex.unlock();
+    }
+}
@@ -0,0 +1,171 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+
+#include "ControlWriter.h"
+#include "Logger.h"
+
+#include <QMutexLocker>
+
+// Default limit for writes caused by dragging a slider
+#define DEFAULT_MAX_WRITE_RATE 30
+
+ControlWriter::ControlWriter(void)
+    : m_MinWriteIntervalMs(1000 / DEFAULT_MAX_WRITE_RATE)
+    , m_bAbort(false)
+    , m_QueuedCount(0)
+    , m_WrittenCount(0)
+{
+}
+
+ControlWriter::~ControlWriter(void)
+{
+    Stop();
+}
+
+void ControlWriter::Stop()
+{
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_bAbort = true;
+        m_PendingWrites.clear();
+        m_Condition.wakeAll();
+    }
+
+    wait();
+
+    LOG_EX("ControlWriter::Stop %llu values queued, %llu written", static_cast<unsigned long long>(GetQueuedCount()), static_cast<unsigned long long>(GetWrittenCount()));
+}
+
+void ControlWriter::Queue(int32_t id, int64_t value, bool bNotify)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    std::map<int32_t, PendingWrite>::iterator itWrite = m_PendingWrites.find(id);
+    if (itWrite == m_PendingWrites.end())
+    {
+        PendingWrite write = {value, bNotify};
+        m_PendingWrites[id] = write;
+    }
+    else
+    {
+        // the newest value wins, a requested notification is kept
+        itWrite->second.value = value;
+        itWrite->second.bNotify = itWrite->second.bNotify || bNotify;
+    }
+
+    m_QueuedCount++;
+    m_Condition.wakeAll();
+}
+
+void ControlWriter::Discard(int32_t id)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    m_PendingWrites.erase(id);
+}
+
+void ControlWriter::DiscardAll()
+{
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_PendingWrites.clear();
+    }
+
+    // a batch taken before is finished when the lock can be taken
+    QMutexLocker writeLocker(&m_WriteMutex);
+}
+
+void ControlWriter::SetMaxWriteRate(uint32_t writesPerSecond)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    m_MinWriteIntervalMs = (0 == writesPerSecond) ? 0 : 1000 / writesPerSecond;
+    m_Condition.wakeAll();
+}
+
+uint64_t ControlWriter::GetQueuedCount() const
+{
+    QMutexLocker locker(&m_Mutex);
+
+    return m_QueuedCount;
+}
+
+uint64_t ControlWriter::GetWrittenCount() const
+{
+    QMutexLocker locker(&m_Mutex);
+
+    return m_WrittenCount;
+}
+
+void ControlWriter::run()
+{
+    QElapsedTimer writeTimer;
+    std::map<int32_t, PendingWrite> writes;
+
+    while (true)
+    {
+        {
+            QMutexLocker locker(&m_Mutex);
+
+            while (!m_bAbort)
+            {
+                if (m_PendingWrites.empty())
+                {
+                    m_Condition.wait(&m_Mutex);
+                    continue;
+                }
+
+                // values queued while waiting replace the older ones
+                qint64 remaining = writeTimer.isValid() ? m_MinWriteIntervalMs - writeTimer.elapsed() : 0;
+                if (remaining > 0)
+                {
+                    m_Condition.wait(&m_Mutex, remaining);
+                    continue;
+                }
+
+                break;
+            }
+
+            if (m_bAbort)
+            {
+                break;
+            }
+
+            writes.swap(m_PendingWrites);
+            m_WriteMutex.lock();
+        }
+
+        bool bNotify = false;
+        for (const auto & write : writes)
+        {
+            emit WriteControl_Signal(write.first, write.second.value);
+            bNotify = bNotify || write.second.bNotify;
+        }
+
+        {
+            QMutexLocker locker(&m_Mutex);
+            m_WrittenCount += writes.size();
+        }
+        writes.clear();
+        writeTimer.start();
+
+        m_WriteMutex.unlock();
+
+        emit ControlWritten_Signal(bNotify);
+    }
+}
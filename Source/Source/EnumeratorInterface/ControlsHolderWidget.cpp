@@ -18,57 +18,90 @@
 
 #include "ControlsHolderWidget.h"
 
-ControlsHolderWidget::ControlsHolderWidget(QWidget *parent) : QWidget(parent)
+#include <QScrollBar>
+#include <QTimer>
+
+ControlsHolderWidget::ControlsHolderWidget(QWidget *parent)
+    : QWidget(parent)
+    , m_CreatedCount(0)
+    , m_bCreatePending(false)
 {
     ui.setupUi(this);
     setWindowFlags(Qt::FramelessWindowHint);
     connect(ui.m_ControlsList, SIGNAL(currentRowChanged(int)), this, SLOT(OnListItemChanged(int)));
+    connect(ui.m_ControlsList->verticalScrollBar(), SIGNAL(valueChanged(int)), this, SLOT(CreateVisibleElements()));
 }
 
-void ControlsHolderWidget::AddElement(IControlEnumerationHolder *controlWidget)
+void ControlsHolderWidget::AddElement(int32_t id, const QString &name, const ControlWidgetFactory &factory)
 {
+    QHash<int32_t, int>::const_iterator itRow = m_IdToRow.find(id);
+    if (itRow != m_IdToRow.end())
+    {
+        ControlElement &element = m_Elements[itRow.value()];
+        if (element.pWidget == nullptr)
+        {
+            element.factory = factory;
+        }
+        return;
+    }
+
     ui.m_ControlsList->blockSignals(true);
-    QListWidgetItem *item = new QListWidgetItem(ui.m_ControlsList);
-    item->setSizeHint(controlWidget->sizeHint());
-    ui.m_ControlsList->setItemWidget(item, controlWidget);
-    m_itemVector.append(controlWidget);
+    new QListWidgetItem(name, ui.m_ControlsList);
+    ControlElement element = {id, nullptr, factory, false, true};
+    m_IdToRow.insert(id, m_Elements.size());
+    m_Elements.append(element);
     ui.m_ControlsList->blockSignals(false);
+
+    ScheduleCreateVisibleElements();
 }
 
 void ControlsHolderWidget::RemoveElements()
 {
     ui.m_ControlsList->blockSignals(true);
-    for (QVector<IControlEnumerationHolder*>::iterator it = m_itemVector.begin(); it<m_itemVector.end(); ++it)
+    for (QVector<ControlElement>::iterator it = m_Elements.begin(); it<m_Elements.end(); ++it)
     {
-        delete *it;
-        *it = nullptr;
+        delete it->pWidget;
+        it->pWidget = nullptr;
     }
     ui.m_ControlsList->clear();
-    m_itemVector.clear();
+    m_Elements.clear();
+    m_IdToRow.clear();
+    m_CreatedCount = 0;
     ui.m_ControlsList->blockSignals(false);
 }
 
-bool ControlsHolderWidget::IsControlAlreadySet(int32_t id)
+void ControlsHolderWidget::SetElementEnabled(int32_t id, bool bEnabled)
 {
-    for (QVector<IControlEnumerationHolder*>::iterator it = m_itemVector.begin(); it<m_itemVector.end(); ++it)
+    QHash<int32_t, int>::const_iterator itRow = m_IdToRow.find(id);
+    if (itRow != m_IdToRow.end())
     {
-        if((*it)->GetWidgetControlId() == id)
+        ControlElement &element = m_Elements[itRow.value()];
+        element.bStateChanged = true;
+        element.bEnabled = bEnabled;
+        if (element.pWidget != nullptr)
         {
-            return true;
+            element.pWidget->setEnabled(bEnabled);
         }
     }
-    return false;
+}
+
+int ControlsHolderWidget::GetCreatedElementCount() const
+{
+    return m_CreatedCount;
+}
+
+bool ControlsHolderWidget::IsControlAlreadySet(int32_t id)
+{
+    return m_IdToRow.contains(id);
 }
 
 IControlEnumerationHolder* ControlsHolderWidget::GetControlWidget(int32_t id, bool &bIsSuccess)
 {
-    for (QVector<IControlEnumerationHolder*>::iterator it = m_itemVector.begin(); it<m_itemVector.end(); ++it)
+    QHash<int32_t, int>::const_iterator itRow = m_IdToRow.find(id);
+    if (itRow != m_IdToRow.end() && m_Elements[itRow.value()].pWidget != nullptr)
     {
-        if((*it)->GetWidgetControlId() == id)
-        {
-            bIsSuccess = true;
-            return (*it);
-        }
+        bIsSuccess = true;
+        return m_Elements[itRow.value()].pWidget;
     }
     bIsSuccess = false;
     return nullptr;
@@ -82,8 +115,91 @@ QSize ControlsHolderWidget::sizeHint() const
     return size;
 }
 
+void ControlsHolderWidget::showEvent(QShowEvent *event)
+{
+    QWidget::showEvent(event);
+    ScheduleCreateVisibleElements();
+}
+
+void ControlsHolderWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    ScheduleCreateVisibleElements();
+}
+
 void ControlsHolderWidget::OnListItemChanged(int row)
 {
-    QString info = dynamic_cast<IControlEnumerationHolder *>(ui.m_ControlsList->itemWidget(ui.m_ControlsList->item(row)))->GetControlInfo();
+    if (row < 0 || row >= m_Elements.size())
+    {
+        return;
+    }
+
+    // a row can be selected by keyboard before it was scrolled into view
+    CreateElementWidget(row);
+    QString info = m_Elements[row].pWidget->GetControlInfo();
     ui.m_DescriptionLabel->setText(info);
 }
+
+void ControlsHolderWidget::CreateVisibleElements()
+{
+    m_bCreatePending = false;
+
+    // a hidden list creates nothing, the widgets follow when it is shown
+    if (!isVisible())
+    {
+        return;
+    }
+
+    QListWidget *pList = ui.m_ControlsList;
+    int viewportHeight = pList->viewport()->height();
+    QListWidgetItem *pFirstItem = pList->itemAt(0, 0);
+    int row = (pFirstItem != nullptr) ? pList->row(pFirstItem) : 0;
+
+    for (; row < pList->count(); row++)
+    {
+        QRect itemRect = pList->visualItemRect(pList->item(row));
+
+        // rows not laid out yet have no geometry
+        if (!itemRect.isValid() || itemRect.top() >= viewportHeight)
+        {
+            break;
+        }
+
+        CreateElementWidget(row);
+    }
+}
+
+void ControlsHolderWidget::CreateElementWidget(int row)
+{
+    ControlElement &element = m_Elements[row];
+    if (element.pWidget != nullptr)
+    {
+        return;
+    }
+
+    element.pWidget = element.factory();
+    // the captured control data is not needed anymore
+    element.factory = ControlWidgetFactory();
+    if (element.bStateChanged)
+    {
+        element.pWidget->setEnabled(element.bEnabled);
+    }
+    m_CreatedCount++;
+
+    ui.m_ControlsList->blockSignals(true);
+    QListWidgetItem *item = ui.m_ControlsList->item(row);
+    item->setText(QString());
+    item->setSizeHint(element.pWidget->sizeHint());
+    ui.m_ControlsList->setItemWidget(item, element.pWidget);
+    ui.m_ControlsList->blockSignals(false);
+}
+
+void ControlsHolderWidget::ScheduleCreateVisibleElements()
+{
+    // the list lays out new rows in the event loop, their geometry is known afterwards
+    if (!m_bCreatePending)
+    {
+        m_bCreatePending = true;
+        QTimer::singleShot(0, this, SLOT(CreateVisibleElements()));
+    }
+}
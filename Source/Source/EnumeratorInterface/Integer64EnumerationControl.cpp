@@ -24,13 +24,11 @@ Integer64EnumerationControl::Integer64EnumerationControl(int32_t id, int64_t min
     IControlEnumerationHolder(id, name, parent),
     m_Min(min),
     m_Max(max),
-    m_Value(value)
+    m_Value(value),
+    m_Unit(unit),
+    m_bIsReadOnly(bIsReadOnly)
 {
-    m_ControlInfo = QString(tr("%1 control accepts 64-bit integers. \n Minimum: %2 \n Maximum: %3 \n Unit: %4")
-                          .arg(name)
-                          .arg(m_Min)
-                          .arg(m_Max)
-                          .arg(unit));
+    UpdateControlInfo();
     m_LineEdit.setText(QString::number(m_Value));
     m_CurrentValue.setText(QString::number(m_Value));
     m_Slider.setOrientation(Qt::Horizontal);
@@ -49,7 +47,6 @@ Integer64EnumerationControl::Integer64EnumerationControl(int32_t id, int64_t min
     if (bIsReadOnly)
     {
         setEnabled(false);
-        m_ControlInfo += tr("\n Control is READONLY");
     }
     else
     {
@@ -92,6 +89,43 @@ void Integer64EnumerationControl::UpdateValue(int64_t value)
     m_Slider.blockSignals(false);
 }
 
+void Integer64EnumerationControl::UpdateRange(int64_t min, int64_t max)
+{
+    if (min == m_Min && max == m_Max)
+    {
+        return;
+    }
+
+    m_Min = min;
+    m_Max = max;
+    UpdateControlInfo();
+
+    // the logarithmic exposure slider keeps its positions, only the mapping changes
+    m_Slider.blockSignals(true);
+    if (!m_NameOfControl.text().contains("exposure",Qt::CaseInsensitive))
+    {
+        m_Slider.setMaximum(ConvertToSliderValue(max));
+        m_Slider.setMinimum(ConvertToSliderValue(min));
+    }
+    m_Slider.blockSignals(false);
+
+    m_LineEdit.setMaxLength(int(std::ceil(std::log10(max+1))));
+}
+
+void Integer64EnumerationControl::UpdateControlInfo()
+{
+    m_ControlInfo = QString(tr("%1 control accepts 64-bit integers. \n Minimum: %2 \n Maximum: %3 \n Unit: %4")
+                          .arg(m_NameOfControl.text())
+                          .arg(m_Min)
+                          .arg(m_Max)
+                          .arg(m_Unit));
+
+    if (m_bIsReadOnly)
+    {
+        m_ControlInfo += tr("\n Control is READONLY");
+    }
+}
+
 void Integer64EnumerationControl::OnLineEditPressed()
 {
     int64_t value = static_cast<int64_t>(m_LineEdit.text().toLongLong());
@@ -25,13 +25,11 @@ IntegerEnumerationControl::IntegerEnumerationControl(int32_t id, int32_t min, in
     m_Min(min),
     m_Max(max),
     m_Value(value),
-    m_SliderValue(0)
+    m_SliderValue(0),
+    m_Unit(unit),
+    m_bIsReadOnly(bIsReadOnly)
 {
-    m_ControlInfo = QString(tr("%1 control accepts 32-bit integers. \n Minimum: %2 \n Maximum: %3 \n Unit: %4")
-                          .arg(name)
-                          .arg(m_Min)
-                          .arg(m_Max)
-                          .arg(unit));
+    UpdateControlInfo();
 
     m_LineEdit.setText(QString::number(m_Value));
     m_CurrentValue.setText(QString::number(m_Value));
@@ -52,7 +50,6 @@ IntegerEnumerationControl::IntegerEnumerationControl(int32_t id, int32_t min, in
     if (bIsReadOnly)
     {
         setEnabled(false);
-        m_ControlInfo += tr("\n Control is READONLY");
     }
     else
     {
@@ -96,6 +93,43 @@ void IntegerEnumerationControl::UpdateValue(int32_t value)
     m_Slider.blockSignals(false);
 }
 
+void IntegerEnumerationControl::UpdateRange(int32_t min, int32_t max)
+{
+    if (min == m_Min && max == m_Max)
+    {
+        return;
+    }
+
+    m_Min = min;
+    m_Max = max;
+    UpdateControlInfo();
+
+    // the logarithmic exposure slider keeps its positions, only the mapping changes
+    m_Slider.blockSignals(true);
+    if (m_id != V4L2_CID_EXPOSURE)
+    {
+        m_Slider.setMinimum(min);
+        m_Slider.setMaximum(max);
+    }
+    m_Slider.blockSignals(false);
+
+    m_LineEdit.setMaxLength(int(std::ceil(std::log10(max+1))));
+}
+
+void IntegerEnumerationControl::UpdateControlInfo()
+{
+    m_ControlInfo = QString(tr("%1 control accepts 32-bit integers. \n Minimum: %2 \n Maximum: %3 \n Unit: %4")
+                          .arg(m_NameOfControl.text())
+                          .arg(m_Min)
+                          .arg(m_Max)
+                          .arg(m_Unit));
+
+    if (m_bIsReadOnly)
+    {
+        m_ControlInfo += tr("\n Control is READONLY");
+    }
+}
+
 void IntegerEnumerationControl::OnLineEditPressed()
 {
     int32_t value = m_LineEdit.text().toInt();
@@ -61,20 +61,28 @@ ListIntEnumerationControl::ListIntEnumerationControl(int32_t id, int32_t value,
 void ListIntEnumerationControl::UpdateValue(QList<int64_t> list, int32_t value)
 {
     m_ComboBox.blockSignals(true);
-    m_ComboBox.clear();
-    for (QList<int64_t>::iterator it = list.begin(); it<list.end(); ++it)
-    {
-        m_ComboBox.addItem(QString::number(*it));
-    }
-
-    if (value >= list.count())
+    // an empty list keeps the items, only the value changed
+    if (list.empty() && m_ComboBox.count() > value)
     {
-        m_ComboBox.addItem("Unknown Value");
-        m_ComboBox.setCurrentText("Unknown Value");
+        m_ComboBox.setCurrentIndex(value);
     }
     else
     {
-        m_ComboBox.setCurrentText(QString::number(list.at(value)));
+        m_ComboBox.clear();
+        for (QList<int64_t>::iterator it = list.begin(); it<list.end(); ++it)
+        {
+            m_ComboBox.addItem(QString::number(*it));
+        }
+
+        if (value >= list.count())
+        {
+            m_ComboBox.addItem("Unknown Value");
+            m_ComboBox.setCurrentText("Unknown Value");
+        }
+        else
+        {
+            m_ComboBox.setCurrentText(QString::number(list.at(value)));
+        }
     }
 
     m_ComboBox.blockSignals(false);
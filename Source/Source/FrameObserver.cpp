@@ -18,53 +18,60 @@
 
 #include "DeviationCalculator.h"
 #include "FrameObserver.h"
+#include "IOHelper.h"
 #include "ImageTransform.h"
+#include "LocalMutexLockGuard.h"
 #include "Logger.h"
+#include "ThreadScheduling.h"
 
+#include <QElapsedTimer>
 #include <QPixmap>
 #include <errno.h>
 #include <fcntl.h>
 #include <linux/videodev2.h>
+#include <algorithm>
+#include <atomic>
 #include <sstream>
+#include <string.h>
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
 #define CLIP(color) (unsigned char)(((color) > 0xFF) ? 0xff : (((color) < 0) ? 0 : (color)))
 
-#define V4L2_PIX_FMT_Y10P     v4l2_fourcc('Y', '1', '0', 'P')
+// 1 ms sleeps of the capture thread, measured once per session
+#define CAPTURE_LATENCY_SAMPLES 20
 
-uint8_t *g_ConversionBuffer1 = 0;
-uint8_t *g_ConversionBuffer2 = 0;
+// distance of the loads of the first read benchmark
+#define READ_LATENCY_STRIDE 64
 
-uint32_t InternalConvertRAW10inRAW16ToRAW10g(const void *sourceBuffer, uint32_t length, const void *destBuffer)
+// set by the first stream which measured the wake up latency of the capture thread
+static std::atomic<bool> s_bWakeupLatencyMeasured(false);
+
+// Buffer of a dumped frame, released by the buffer thread of the logger
+struct FrameDumpContext
 {
-    uint8_t *destData = (unsigned char *)destBuffer;
-    uint8_t *srcData = (unsigned char *)sourceBuffer;
-    uint32_t srcCount = 0;
-    uint32_t destCount = 0;
+    FrameObserver *pFrameObserver;
+    uint32_t bufferIndex;
+};
 
-    while (srcCount < length)
+static const char* GetBufferCacheModeName(BufferCacheMode cacheMode)
+{
+    switch (cacheMode)
     {
-        unsigned char lsbits = 0;
-
-        for (int iii = 0; iii < 4; iii++)
-        {
-            *destData++ = *(srcData + 1); // bits [9:2]
-            destCount++;
-
-            lsbits |= (*srcData >> 6) << (iii * 2); // least significant bits [1:0]
-
-            srcData += 2; // move to next 16 bits
-
-            srcCount += 2;
-        }
-
-        *destData++ = lsbits; // every 5th byte contains the lsbs from the last 4 pixels
-        destCount++;
+        case BufferCacheSkipUnread: return "skip unread";
+        case BufferCacheSkipAlways: return "skip always";
+        default: return "maintained";
     }
+}
 
-    return destCount;
+// reads one byte of every cache line, the result only keeps the loads alive
+static uint8_t TouchFrame(const uint8_t *pBuffer, uint32_t length)
+{
+    uint8_t result = 0;
+    for (uint32_t i = 0; i < length; i += READ_LATENCY_STRIDE)
+        result ^= pBuffer[i];
+    return result;
 }
 
 FrameObserver::FrameObserver(bool showFrames)
@@ -84,17 +91,54 @@ FrameObserver::FrameObserver(bool showFrames)
     , m_bStreamStopped(true)
     , m_EnableLogging(0)
     , m_ShowFrames(showFrames)
+    , m_ColorMatrix(yuvconversion::ColorMatrixAuto)
+    , m_ColorRange(yuvconversion::ColorRangeAuto)
+    , m_PlaneCount(1)
+    , m_DriverQueueDepth(0)
+    , m_MinimumDriverQueueDepth(MAX_VIEWER_USER_BUFFER_COUNT)
+    , m_ScaleDenominator(1)
+    , m_bHighBitDepth(false)
+    , m_ToneMapping(tonemapping::GetDefaultParameters())
+    , m_bAutoShift(false)
+    , m_bUseBufferArena(false)
+    , m_BufferCacheMode(BufferCacheMaintained)
+    , m_bPrepareBuffers(false)
+    , m_bDumpFrames(false)
+    , m_PendingFrameDumps(0)
+    , m_RequestedUserBuffers(0)
+    , m_ActiveProcessingThreads(1)
+    , m_MaxProcessingThreads(1)
+    , m_NextProcessingThread(0)
+    , m_LastRenderedFrameId(0)
+    , m_dCaptureTimeSum(0.0)
+    , m_dCaptureTimeMax(0.0)
+    , m_CaptureCount(0)
+    , m_dTimeToFirstFrame(-1.0)
+    , m_bMeasureReadLatency(false)
+    , m_dDequeueTimeSum(0.0)
+    , m_dFirstReadTimeSum(0.0)
+    , m_dFirstReadTimeMax(0.0)
+    , m_ReadLatencyCount(0)
 {
-    m_pImageProcessingThread = QSharedPointer<ImageProcessingThread>(new ImageProcessingThread());
+    memset(m_PlaneOffset, 0, sizeof(m_PlaneOffset));
+    memset(m_PlaneLength, 0, sizeof(m_PlaneLength));
+    memset(m_PlaneStride, 0, sizeof(m_PlaneStride));
+
+    for (int i = 0; i < MAX_DECODE_WORKERS; i++)
+    {
+        QSharedPointer<ImageProcessingThread> pImageProcessingThread(new ImageProcessingThread());
+
+        connect(pImageProcessingThread.data(), SIGNAL(OnFrameReady_Signal(const QImage &, const QImage &, const unsigned long long &, const int &)), this, SLOT(OnFrameReadyFromThread(const QImage &, const QImage &, const unsigned long long &, const int &)));
 
-    connect(m_pImageProcessingThread.data(), SIGNAL(OnFrameReady_Signal(const QImage &, const unsigned long long &, const int &)), this, SLOT(OnFrameReadyFromThread(const QImage &, const unsigned long long &, const int &)));
+        m_ImageProcessingThreads.push_back(pImageProcessingThread);
+    }
 }
 
 FrameObserver::~FrameObserver()
 {
     StopStream();
 
-    m_pImageProcessingThread->StopThread();
+    StopImageProcessingThreads();
 
     // wait until the thread is stopped
     while (isRunning())
@@ -124,13 +168,91 @@ int FrameObserver::StartStream(bool blockingMode, int fileDescriptor, uint32_t p
 
     m_EnableLogging = enableLogging;
 
-    if (0 == g_ConversionBuffer1)
-        g_ConversionBuffer1 = (uint8_t*)malloc(m_nWidth * m_nHeight * 4);
+    ResetCaptureTime();
+    ResetMinimumDriverQueueDepth();
+    {
+        // references of frames which were not returned before the last stop
+        base::LocalMutexLockGuard guard(m_UsedBufferMutex);
+        m_BufferReferences.clear();
+    }
+    m_RequestedUserBuffers = 0;
+    m_dDequeueTimeSum = 0.0;
+    m_dFirstReadTimeSum = 0.0;
+    m_dFirstReadTimeMax = 0.0;
+    m_ReadLatencyCount = 0;
+
+    // resolve all format dependent conversion decisions once for the whole stream
+    yuvconversion::ColorMatrix colorMatrix = m_ColorMatrix;
+    yuvconversion::ColorRange colorRange = m_ColorRange;
+    if (yuvconversion::ColorMatrixAuto == colorMatrix || yuvconversion::ColorRangeAuto == colorRange)
+    {
+        v4l2_format fmt;
+        memset(&fmt, 0, sizeof(fmt));
+        fmt.type = m_BufferType;
+
+        if (-1 != iohelper::xioctl(m_nFileDescriptor, VIDIOC_G_FMT, &fmt))
+        {
+            uint32_t colorspace, ycbcrEncoding, quantization;
+            if (V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE == m_BufferType)
+            {
+                colorspace = fmt.fmt.pix_mp.colorspace;
+                ycbcrEncoding = fmt.fmt.pix_mp.ycbcr_enc;
+                quantization = fmt.fmt.pix_mp.quantization;
+            }
+            else
+            {
+                colorspace = fmt.fmt.pix.colorspace;
+                ycbcrEncoding = fmt.fmt.pix.ycbcr_enc;
+                quantization = fmt.fmt.pix.quantization;
+            }
+
+            if (yuvconversion::ColorMatrixAuto == colorMatrix)
+                colorMatrix = yuvconversion::ResolveColorMatrix(colorspace, ycbcrEncoding);
+            if (yuvconversion::ColorRangeAuto == colorRange)
+                colorRange = yuvconversion::ResolveColorRange(colorspace, quantization);
+        }
+    }
 
-    if (0 == g_ConversionBuffer2)
-        g_ConversionBuffer2 = (uint8_t*)malloc(m_nWidth * m_nHeight * 4);
+    // every image processing thread gets its own plan, the plans hold the
+    // scratch buffers and decoders of the conversion. Threads are started for
+    // the whole worker count of the plan, buffers added later put them to use
+    m_MaxProcessingThreads = 1;
+    m_NextProcessingThread = 0;
+    m_LastRenderedFrameId = 0;
+    for (uint32_t i = 0; i < m_MaxProcessingThreads; i++)
+    {
+        QSharedPointer<ConversionPlan> pConversionPlan(new ConversionPlan);
+        if (0 != ImageTransform::CreateConversionPlan(pixelFormat, width, height, bytesPerLine, payloadSize,
+                                                      colorMatrix, colorRange, m_bHighBitDepth, *pConversionPlan))
+        {
+            LOG_EX("FrameObserver::StartStream no conversion for pixel format 0x%08X", pixelFormat);
+        }
+        else
+        {
+            if (1 < m_PlaneCount && m_PlaneCount <= MAX_CONVERSION_PLANES)
+            {
+                // planes which live in separate memory planes of the buffer
+                pConversionPlan->planeCount = m_PlaneCount;
+                for (uint32_t plane = 0; plane < m_PlaneCount; plane++)
+                {
+                    pConversionPlan->planeOffset[plane] = m_PlaneOffset[plane];
+                    pConversionPlan->planeStride[plane] = m_PlaneStride[plane];
+                }
+            }
+            pConversionPlan->scaleDenominator = m_ScaleDenominator;
+            pConversionPlan->autoShiftFrames = m_bAutoShift ? AUTO_SHIFT_FRAMES : 0;
 
-    m_pImageProcessingThread->StartThread();
+            if (0 == i)
+            {
+                uint32_t idealThreadCount = std::max(1, QThread::idealThreadCount() - 1);
+                m_MaxProcessingThreads = std::min(pConversionPlan->maxWorkerCount, idealThreadCount);
+            }
+        }
+        m_ImageProcessingThreads[i]->SetConversionPlan(pConversionPlan);
+        m_ImageProcessingThreads[i]->StartThread();
+    }
+    m_ActiveProcessingThreads = 0;
+    UpdateActiveProcessingThreads();
 
     start();
 
@@ -140,25 +262,28 @@ int FrameObserver::StartStream(bool blockingMode, int fileDescriptor, uint32_t p
 int FrameObserver::StopStream()
 {
     int nResult = 0;
-    int count = 300;
 
-    m_pImageProcessingThread->StopThread();
+    StopImageProcessingThreads();
 
     m_IsStreamRunning = false;
 
-    while (!m_bStreamStopped && count-- > 0)
-        QThread::msleep(10);
-
-    if (count <= 0)
+    // returns as soon as the capture thread has left, a restart does not wait for a poll interval
+    if (!wait(3000))
         nResult = -1;
 
-    if (0 != g_ConversionBuffer1)
-        free(g_ConversionBuffer1);
-    g_ConversionBuffer1 = 0;
+    // the logger still references dumped buffers, they must not be freed before
+    while (0 < m_PendingFrameDumps.load())
+        QThread::msleep(10);
 
-    if (0 != g_ConversionBuffer2)
-        free(g_ConversionBuffer2);
-    g_ConversionBuffer2 = 0;
+    // the capture thread has stopped, its statistics are complete
+    if (m_bMeasureReadLatency && 0 < m_ReadLatencyCount)
+    {
+        LOG_EX("FrameObserver::StopStream cache %s, %s buffers: dequeue %.3f ms avg, first read %.3f ms avg/ %.3f ms max over %u frames",
+               GetBufferCacheModeName(m_BufferCacheMode), m_bPrepareBuffers ? "prepared" : "unprepared",
+               m_dDequeueTimeSum / m_ReadLatencyCount, m_dFirstReadTimeSum / m_ReadLatencyCount,
+               m_dFirstReadTimeMax, m_ReadLatencyCount);
+        m_ReadLatencyCount = 0;
+    }
 
     return nResult;
 }
@@ -181,59 +306,107 @@ void FrameObserver::DequeueAndProcessFrame()
 {
     v4l2_buffer buf;
     int result = 0;
+    QElapsedTimer captureTimer;
 
+    // the capture thread only dequeues and hands the frame over, all
+    // conversions run in the image processing threads
+    captureTimer.start();
     result = ReadFrame(buf);
     if (0 == result)
     {
         m_FrameId++;
         m_ReceivedFPS.trigger();
 
-        if (m_ShowFrames)
+        if (1 == m_FrameId)
+        {
+            base::LocalMutexLockGuard guard(m_CaptureTimeMutex);
+            if (m_SetupTimer.isValid() && m_dTimeToFirstFrame < 0.0)
+            {
+                m_dTimeToFirstFrame = m_SetupTimer.nsecsElapsed() / 1000000.0;
+                LOG_EX("FrameObserver::DequeueAndProcessFrame first frame %.1f ms after the stream setup", m_dTimeToFirstFrame);
+            }
+        }
+
+        // the dequeue does the cache maintenance, the first read shows what is left of it
+        if (m_bMeasureReadLatency)
         {
             uint8_t *buffer = 0;
             uint32_t length = 0;
+            double dequeueTime = captureTimer.nsecsElapsed() / 1000000.0;
 
             if (0 == GetFrameData(buf, buffer, length))
             {
+                QElapsedTimer readTimer;
+                readTimer.start();
+                volatile uint8_t touched = TouchFrame(buffer, length);
+                (void)touched;
+                double firstReadTime = readTimer.nsecsElapsed() / 1000000.0;
+
+                m_dDequeueTimeSum += dequeueTime;
+                m_dFirstReadTimeSum += firstReadTime;
+                m_dFirstReadTimeMax = std::max(m_dFirstReadTimeMax, firstReadTime);
+                m_ReadLatencyCount++;
+            }
+        }
 
-                if (m_PixelFormat == V4L2_PIX_FMT_Y10P ||
-                    m_PixelFormat == V4L2_PIX_FMT_SBGGR10P ||
-                    m_PixelFormat == V4L2_PIX_FMT_SGBRG10P ||
-                    m_PixelFormat == V4L2_PIX_FMT_SGRBG10P ||
-                    m_PixelFormat == V4L2_PIX_FMT_SRGGB10P)
-                {
-                    length = InternalConvertRAW10inRAW16ToRAW10g(buffer, m_PayloadSize, g_ConversionBuffer2);
-                    buffer = g_ConversionBuffer2;
-                }
+        // a buffer queued without invalidation while the display was off may
+        // hold stale cache lines, it goes back once and is shown the next time
+        bool bSkippedInvalidate = false;
+        {
+            base::LocalMutexLockGuard guard(m_UsedBufferMutex);
+            if (0 < m_DriverQueueDepth)
+                m_DriverQueueDepth--;
+            m_MinimumDriverQueueDepth = std::min(m_MinimumDriverQueueDepth, m_DriverQueueDepth);
+            if (buf.index < m_BufferSkipsInvalidate.size())
+                bSkippedInvalidate = m_BufferSkipsInvalidate[buf.index];
+        }
+
+        if ((m_ShowFrames || m_bDumpFrames) && !bSkippedInvalidate)
+        {
+            uint8_t *buffer = 0;
+            uint32_t length = 0;
+
+            if (0 == GetFrameData(buf, buffer, length))
+            {
+                // compressed frames only fill a part of the buffer
+                if (0 != buf.bytesused && buf.bytesused < length)
+                    length = buf.bytesused;
+
+                if (m_bDumpFrames)
+                    DumpFrame(buf.index, buffer, length);
 
-                if (length <= m_RealPayloadSize)
+                if (m_ShowFrames && length <= m_RealPayloadSize)
                 {
-                    if (m_pImageProcessingThread->QueueFrame(buf.index, buffer, length,
-                        m_nWidth, m_nHeight, m_PixelFormat,
-                        m_PayloadSize, m_BytesPerLine, m_FrameId))
+                    if (QueueFrameToProcessingThread(buf.index, buffer, length))
                     {
                         // when frame was not queued to image queue because queue is full
                         // frame should be queued to v4l2 queue again
-                        QueueSingleUserBuffer(buf.index);
+                        ReturnFrameBuffer(buf.index);
                     }
                 }
                 else
                 {
                     emit OnFrameID_Signal(m_FrameId);
-                    QueueSingleUserBuffer(buf.index);
+                    ReturnFrameBuffer(buf.index);
                 }
             }
             else
             {
                 emit OnFrameID_Signal(m_FrameId);
-                QueueSingleUserBuffer(buf.index);
+                ReturnFrameBuffer(buf.index);
             }
         }
         else
         {
             emit OnFrameID_Signal(m_FrameId);
-            QueueSingleUserBuffer(buf.index);
+            ReturnFrameBuffer(buf.index);
         }
+
+        double captureTime = captureTimer.nsecsElapsed() / 1000000.0;
+        base::LocalMutexLockGuard guard(m_CaptureTimeMutex);
+        m_dCaptureTimeSum += captureTime;
+        m_dCaptureTimeMax = std::max(m_dCaptureTimeMax, captureTime);
+        m_CaptureCount++;
     }
     else
     {
@@ -254,8 +427,41 @@ void FrameObserver::run()
 {
     m_IsStreamRunning = true;
 
+    threadscheduling::ApplyToCurrentThread(threadscheduling::ThreadRoleCapture);
+    threadscheduling::ReportSettings();
+
     while (m_IsStreamRunning)
     {
+        // measured after the first frame, so the sleeps do not delay it, and only
+        // once per session. The buffers are queued, so no frames are lost.
+        if (0 < m_FrameId && !s_bWakeupLatencyMeasured.exchange(true))
+        {
+            double averageLatency = 0.0;
+            double maximumLatency = 0.0;
+            if (0 == threadscheduling::MeasureWakeupLatency(CAPTURE_LATENCY_SAMPLES, 1000, averageLatency, maximumLatency))
+            {
+                LOG_EX("FrameObserver::run capture thread wake up latency %.1f us avg/ %.1f us max",
+                       averageLatency, maximumLatency);
+            }
+        }
+
+        // the buffers are created and prepared here, so neither the GUI nor the
+        // image processing threads wait for the ioctls
+        uint32_t requestedBuffers = m_RequestedUserBuffers.exchange(0);
+        if (0 < requestedBuffers)
+        {
+            uint32_t previousCount = GetUserBufferCount();
+            if (0 != AddUserBuffers(requestedBuffers))
+            {
+                LOG_EX("FrameObserver::run adding buffers failed, keeping %d buffers", previousCount);
+            }
+            else
+            {
+                LOG_EX("FrameObserver::run %d -> %d buffers", previousCount, GetUserBufferCount());
+                UpdateActiveProcessingThreads();
+            }
+        }
+
         fd_set fds;
         struct timeval tv;
         int result = -1;
@@ -309,12 +515,147 @@ double FrameObserver::GetRenderedFPS()
     return m_RenderedFPS.getFPS();
 }
 
-void FrameObserver::OnFrameReadyFromThread(const QImage &image, const unsigned long long &frameId, const int &bufIndex)
+double FrameObserver::GetAverageCaptureTime()
+{
+    base::LocalMutexLockGuard guard(m_CaptureTimeMutex);
+    return (m_CaptureCount > 0) ? (m_dCaptureTimeSum / m_CaptureCount) : 0.0;
+}
+
+double FrameObserver::GetMaximumCaptureTime()
+{
+    base::LocalMutexLockGuard guard(m_CaptureTimeMutex);
+    return m_dCaptureTimeMax;
+}
+
+void FrameObserver::ResetCaptureTime()
+{
+    base::LocalMutexLockGuard guard(m_CaptureTimeMutex);
+    m_dCaptureTimeSum = 0.0;
+    m_dCaptureTimeMax = 0.0;
+    m_CaptureCount = 0;
+}
+
+void FrameObserver::StartTimeToFirstFrame()
+{
+    base::LocalMutexLockGuard guard(m_CaptureTimeMutex);
+    m_SetupTimer.start();
+    m_dTimeToFirstFrame = -1.0;
+}
+
+double FrameObserver::GetTimeToFirstFrame()
+{
+    base::LocalMutexLockGuard guard(m_CaptureTimeMutex);
+    return m_dTimeToFirstFrame;
+}
+
+int FrameObserver::QueueFrameToProcessingThread(uint32_t bufferIndex, uint8_t *buffer, uint32_t length)
+{
+    // the first idle thread starting after the last used one takes the frame
+    for (uint32_t i = 0; i < m_ActiveProcessingThreads; i++)
+    {
+        uint32_t thread = (m_NextProcessingThread + i) % m_ActiveProcessingThreads;
+
+        if (0 == m_ImageProcessingThreads[thread]->QueueFrame(bufferIndex, buffer, length,
+                                                             m_nWidth, m_nHeight, m_PixelFormat,
+                                                             m_PayloadSize, m_BytesPerLine, m_FrameId))
+        {
+            m_NextProcessingThread = (thread + 1) % m_ActiveProcessingThreads;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+void FrameObserver::UpdateActiveProcessingThreads()
+{
+    // one frame stays with the capture and one with the display
+    uint32_t bufferCount = GetUserBufferCount();
+    uint32_t bufferLimit = (bufferCount > 2) ? bufferCount - 2 : 1;
+    uint32_t activeProcessingThreads = std::min(m_MaxProcessingThreads, bufferLimit);
+
+    if (activeProcessingThreads != m_ActiveProcessingThreads)
+    {
+        m_ActiveProcessingThreads = activeProcessingThreads;
+        m_NextProcessingThread = 0;
+        LOG_EX("FrameObserver::UpdateActiveProcessingThreads %d of %d image processing thread(s) with %d buffers",
+               m_ActiveProcessingThreads, m_MaxProcessingThreads, bufferCount);
+    }
+}
+
+void FrameObserver::StopImageProcessingThreads()
+{
+    for (size_t i = 0; i < m_ImageProcessingThreads.size(); i++)
+    {
+        m_ImageProcessingThreads[i]->StopThread();
+    }
+}
+
+void FrameObserver::DumpFrame(uint32_t bufferIndex, uint8_t *buffer, uint32_t length)
+{
+    std::stringstream fileName;
+    fileName << m_FrameDumpDirectory << "/Frame_" << m_FrameId << ".raw";
+
+    struct iovec plane;
+    plane.iov_base = buffer;
+    plane.iov_len = length;
+
+    // the reference is taken first, the logger may release it right away
+    {
+        base::LocalMutexLockGuard guard(m_UsedBufferMutex);
+        if (bufferIndex >= m_BufferReferences.size())
+            m_BufferReferences.resize(bufferIndex + 1, 0);
+        m_BufferReferences[bufferIndex] = 2;
+    }
+    m_PendingFrameDumps++;
+
+    FrameDumpContext *pContext = new FrameDumpContext;
+    pContext->pFrameObserver = this;
+    pContext->bufferIndex = bufferIndex;
+
+    // a full queue drops the dump, the logger counts it
+    if (!Logger::LogBuffer(fileName.str(), &plane, 1, ReleaseDumpedFrame, pContext))
+    {
+        delete pContext;
+        m_PendingFrameDumps--;
+        ReturnFrameBuffer(bufferIndex);
+    }
+}
+
+void FrameObserver::ReturnFrameBuffer(uint32_t bufferIndex)
+{
+    {
+        base::LocalMutexLockGuard guard(m_UsedBufferMutex);
+        if (bufferIndex < m_BufferReferences.size() && 0 < m_BufferReferences[bufferIndex] &&
+            0 < --m_BufferReferences[bufferIndex])
+            return;
+    }
+
+    QueueSingleUserBuffer(bufferIndex);
+}
+
+void FrameObserver::ReleaseDumpedFrame(void *pContext)
 {
-    m_RenderedFPS.trigger();
-    emit OnFrameReady_Signal(image, frameId);
+    FrameDumpContext *pDumpContext = static_cast<FrameDumpContext *>(pContext);
+    FrameObserver *pFrameObserver = pDumpContext->pFrameObserver;
 
-    QueueSingleUserBuffer(bufIndex);
+    pFrameObserver->ReturnFrameBuffer(pDumpContext->bufferIndex);
+    delete pDumpContext;
+    pFrameObserver->m_PendingFrameDumps--;
+}
+
+void FrameObserver::OnFrameReadyFromThread(const QImage &image, const QImage &displayImage, const unsigned long long &frameId, const int &bufIndex)
+{
+    // parallel threads can finish out of order, an older frame is not shown
+    // after a newer one. Corrupt frames only return their buffer
+    if (!image.isNull() && frameId > m_LastRenderedFrameId)
+    {
+        m_LastRenderedFrameId = frameId;
+        m_RenderedFPS.trigger();
+        emit OnFrameReady_Signal(image, displayImage, frameId);
+    }
+
+    ReturnFrameBuffer(bufIndex);
 }
 
 /*********************************************************************************************************/
@@ -349,6 +690,183 @@ int FrameObserver::DeleteAllUserBuffer()
     return result;
 }
 
+int FrameObserver::ReleaseAllUserBuffer()
+{
+    // the driver owns the memory of mapped buffers, nothing can be kept
+    return DeleteAllUserBuffer();
+}
+
+int FrameObserver::AddUserBuffers(uint32_t bufferCount)
+{
+    int result = -1;
+
+    return result;
+}
+
+void FrameObserver::RequestUserBuffers(uint32_t bufferCount)
+{
+    m_RequestedUserBuffers = bufferCount;
+}
+
+uint32_t FrameObserver::GetUserBufferCount()
+{
+    base::LocalMutexLockGuard guard(m_UsedBufferMutex);
+    return m_UserBufferContainerList.size();
+}
+
+uint32_t FrameObserver::GetMinimumDriverQueueDepth()
+{
+    base::LocalMutexLockGuard guard(m_UsedBufferMutex);
+    return m_MinimumDriverQueueDepth;
+}
+
+void FrameObserver::ResetMinimumDriverQueueDepth()
+{
+    base::LocalMutexLockGuard guard(m_UsedBufferMutex);
+    m_MinimumDriverQueueDepth = m_UserBufferContainerList.size();
+}
+
+int FrameObserver::CreateAdditionalBuffers(uint32_t memory, uint32_t bufferCount, uint32_t &createdCount)
+{
+    v4l2_create_buffers create;
+    memset(&create, 0, sizeof(create));
+    create.count = std::min<uint32_t>(bufferCount, MAX_VIEWER_USER_BUFFER_COUNT - m_UserBufferContainerList.size());
+    create.memory = memory;
+    create.format.type = m_BufferType;
+#ifdef V4L2_MEMORY_FLAG_NON_COHERENT
+    create.flags = GetMemoryFlags(memory);
+#endif
+
+    createdCount = 0;
+    if (0 == create.count)
+        return -1;
+
+    // the new buffers get the size of the current format
+    if (-1 == iohelper::xioctl(m_nFileDescriptor, VIDIOC_G_FMT, &create.format))
+    {
+        LOG_EX("FrameObserver::CreateAdditionalBuffers VIDIOC_G_FMT errno=%d=%s", errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        return -1;
+    }
+
+    if (-1 == iohelper::xioctl(m_nFileDescriptor, VIDIOC_CREATE_BUFS, &create))
+    {
+        LOG_EX("FrameObserver::CreateAdditionalBuffers VIDIOC_CREATE_BUFS errno=%d=%s", errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        return -1;
+    }
+
+    // the buffer indices have to continue the container list
+    if (create.index != m_UserBufferContainerList.size())
+    {
+        LOG_EX("FrameObserver::CreateAdditionalBuffers unexpected first index %d, %d buffers known",
+               create.index, static_cast<int>(m_UserBufferContainerList.size()));
+        return -1;
+    }
+
+    LOG_EX("FrameObserver::CreateAdditionalBuffers VIDIOC_CREATE_BUFS OK count=%d index=%d", create.count, create.index);
+    createdCount = create.count;
+
+    return (0 < createdCount) ? 0 : -1;
+}
+
+
+int FrameObserver::QueryPlaneLayout()
+{
+    v4l2_format fmt;
+    memset(&fmt, 0, sizeof(fmt));
+    fmt.type = m_BufferType;
+
+    m_PlaneCount = 1;
+    memset(m_PlaneOffset, 0, sizeof(m_PlaneOffset));
+    memset(m_PlaneLength, 0, sizeof(m_PlaneLength));
+    memset(m_PlaneStride, 0, sizeof(m_PlaneStride));
+
+    if (-1 == iohelper::xioctl(m_nFileDescriptor, VIDIOC_G_FMT, &fmt))
+    {
+        LOG_EX("FrameObserver::QueryPlaneLayout VIDIOC_G_FMT errno=%d=%s", errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        return -1;
+    }
+
+    if (V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE == m_BufferType)
+    {
+        m_PlaneCount = fmt.fmt.pix_mp.num_planes;
+        if (0 == m_PlaneCount || VIDEO_MAX_PLANES < m_PlaneCount)
+            m_PlaneCount = 1;
+
+        for (uint32_t i = 0; i < m_PlaneCount; i++)
+        {
+            m_PlaneLength[i] = fmt.fmt.pix_mp.plane_fmt[i].sizeimage;
+            m_PlaneStride[i] = fmt.fmt.pix_mp.plane_fmt[i].bytesperline;
+        }
+    }
+    else
+    {
+        m_PlaneLength[0] = fmt.fmt.pix.sizeimage;
+        m_PlaneStride[0] = fmt.fmt.pix.bytesperline;
+    }
+
+    LOG_EX("FrameObserver::QueryPlaneLayout plane count=%d", m_PlaneCount);
+
+    return 0;
+}
+
+uint32_t FrameObserver::GetCacheFlags(uint32_t index)
+{
+    uint32_t flags = SelectCacheFlags();
+
+    // the flags are fixed when the buffer is queued, the dequeue has to know
+    // whether the frame may be read although the display was switched on since
+    if (index >= m_BufferSkipsInvalidate.size())
+        m_BufferSkipsInvalidate.resize(index + 1, false);
+    m_BufferSkipsInvalidate[index] = (BufferCacheSkipUnread == m_BufferCacheMode) && (0 != (flags & V4L2_BUF_FLAG_NO_CACHE_INVALIDATE));
+
+    return flags;
+}
+
+uint32_t FrameObserver::SelectCacheFlags() const
+{
+    uint32_t flags = 0;
+
+    // capture buffers are never written by the CPU, so cleaning them is
+    // not needed. Invalidating is only skipped for frames nobody reads
+    switch (m_BufferCacheMode)
+    {
+        case BufferCacheSkipUnread:
+            flags = V4L2_BUF_FLAG_NO_CACHE_CLEAN | ((m_ShowFrames || m_bDumpFrames) ? 0 : V4L2_BUF_FLAG_NO_CACHE_INVALIDATE);
+            break;
+        case BufferCacheSkipAlways:
+            flags = V4L2_BUF_FLAG_NO_CACHE_CLEAN | V4L2_BUF_FLAG_NO_CACHE_INVALIDATE;
+            break;
+        default:
+            break;
+    }
+
+    return flags;
+}
+
+uint32_t FrameObserver::GetMemoryFlags(uint32_t memory)
+{
+#ifdef V4L2_MEMORY_FLAG_NON_COHERENT
+    if (V4L2_MEMORY_MMAP == memory && BufferCacheMaintained != m_BufferCacheMode)
+        return V4L2_MEMORY_FLAG_NON_COHERENT;
+#endif
+    return 0;
+}
+
+void FrameObserver::ReportCacheHintSupport(uint32_t memory, uint32_t capabilities)
+{
+    if (BufferCacheMaintained == m_BufferCacheMode)
+        return;
+
+#ifdef V4L2_BUF_CAP_SUPPORTS_MMAP_CACHE_HINTS
+    if (V4L2_MEMORY_MMAP == memory && (capabilities & V4L2_BUF_CAP_SUPPORTS_MMAP_CACHE_HINTS))
+    {
+        LOG_EX("FrameObserver::ReportCacheHintSupport cache mode %s", GetBufferCacheModeName(m_BufferCacheMode));
+        return;
+    }
+#endif
+    LOG_EX("FrameObserver::ReportCacheHintSupport the driver may ignore the cache hints (capabilities=0x%08X)", capabilities);
+}
+
 
 void FrameObserver::SwitchFrameTransfer2GUI(bool showFrames)
 {
@@ -356,6 +874,89 @@ void FrameObserver::SwitchFrameTransfer2GUI(bool showFrames)
 }
 
 
+void FrameObserver::SetScaleDenominator(uint32_t scaleDenominator)
+{
+    m_ScaleDenominator = scaleDenominator;
+}
+
+
+void FrameObserver::SetHighBitDepth(bool bHighBitDepth)
+{
+    m_bHighBitDepth = bHighBitDepth;
+}
+
+
+void FrameObserver::SetAutoShift(bool bAutoShift)
+{
+    m_bAutoShift = bAutoShift;
+}
+
+
+void FrameObserver::SetBufferArena(bool bUseBufferArena)
+{
+    m_bUseBufferArena = bUseBufferArena;
+}
+
+
+void FrameObserver::SetBufferQueuing(BufferCacheMode cacheMode, bool bPrepareBuffers)
+{
+    m_BufferCacheMode = cacheMode;
+    m_bPrepareBuffers = bPrepareBuffers;
+}
+
+
+void FrameObserver::SetReadLatencyBenchmark(bool bMeasureReadLatency)
+{
+    m_bMeasureReadLatency = bMeasureReadLatency;
+}
+
+
+void FrameObserver::SetFrameDump(bool bDumpFrames, const std::string &directory)
+{
+    m_bDumpFrames = bDumpFrames;
+    m_FrameDumpDirectory = directory;
+}
+
+
+void FrameObserver::SetToneMapping(const tonemapping::Parameters &toneMapping)
+{
+    if (tonemapping::IsEqual(toneMapping, m_ToneMapping))
+        return;
+
+    m_ToneMapping = toneMapping;
+
+    // neutral parameters do not need a table at all
+    QSharedPointer<const std::vector<uint8_t> > pToneTable;
+    if (!tonemapping::IsIdentity(toneMapping))
+    {
+        std::vector<uint8_t> *pTable = new std::vector<uint8_t>();
+        tonemapping::CreateTable(toneMapping, *pTable);
+        pToneTable = QSharedPointer<const std::vector<uint8_t> >(pTable);
+    }
+
+    for (size_t i = 0; i < m_ImageProcessingThreads.size(); i++)
+    {
+        m_ImageProcessingThreads[i]->SetToneTable(pToneTable, toneMapping);
+    }
+}
+
+
+void FrameObserver::SetWindowLevel(bool bAutoWindowLevel, uint16_t low, uint16_t high)
+{
+    for (size_t i = 0; i < m_ImageProcessingThreads.size(); i++)
+    {
+        m_ImageProcessingThreads[i]->SetWindowLevel(bAutoWindowLevel, low, high);
+    }
+}
+
+
+void FrameObserver::SetYuvConversion(yuvconversion::ColorMatrix colorMatrix, yuvconversion::ColorRange colorRange)
+{
+    m_ColorMatrix = colorMatrix;
+    m_ColorRange = colorRange;
+}
+
+
 void FrameObserver::setFileDescriptor(int fd)
 {
     m_nFileDescriptor = fd;
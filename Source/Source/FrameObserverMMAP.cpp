@@ -32,6 +32,7 @@
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 #include <QDebug>
+#include <QElapsedTimer>
 
 #include <sstream>
 
@@ -51,16 +52,25 @@ int FrameObserverMMAP::ReadFrame(v4l2_buffer &buf)
     buf.type = m_BufferType;
     buf.memory = V4L2_MEMORY_MMAP;
 
-    v4l2_plane plane;
+    v4l2_plane planes[VIDEO_MAX_PLANES];
     if(m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
     {
-        buf.m.planes = &plane;
-        buf.length = 1;
+        CLEAR(planes);
+        buf.m.planes = planes;
+        buf.length = m_PlaneCount;
     }
 
     if (m_IsStreamRunning)
         result = iohelper::xioctl(m_nFileDescriptor, VIDIOC_DQBUF, &buf);
 
+    // the plane array is not valid beyond this function, a single plane
+    // reports its filled length like a single-planar buffer
+    if(m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+    {
+        buf.bytesused = (0 == result && 1 == m_PlaneCount) ? planes[0].bytesused : 0;
+        buf.m.planes = NULL;
+    }
+
     return result;
 }
 
@@ -96,6 +106,90 @@ int FrameObserverMMAP::GetFrameData(v4l2_buffer &buf, uint8_t *&buffer, uint32_t
 // Frame buffer handling
 /*********************************************************************************************************/
 
+int FrameObserverMMAP::MapBuffer(uint32_t index, size_t pageSize, UserBuffer *&pUserBuffer)
+{
+    v4l2_buffer buf;
+    CLEAR(buf);
+    buf.type = m_BufferType;
+    buf.memory = V4L2_MEMORY_MMAP;
+    buf.index = index;
+
+    v4l2_plane planes[VIDEO_MAX_PLANES];
+    if(m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+    {
+        CLEAR(planes);
+        buf.m.planes = planes;
+        buf.length = VIDEO_MAX_PLANES;
+    }
+
+    if (-1 == iohelper::xioctl(m_nFileDescriptor, VIDIOC_QUERYBUF, &buf))
+    {
+        LOG_EX("FrameObserverMMAP::MapBuffer VIDIOC_QUERYBUF errno=%d=%s", errno, v4l2helper::ConvertErrno2String(errno).c_str());
+        return -1;
+    }
+
+    LOG_EX("FrameObserverMMAP::MapBuffer VIDIOC_QUERYBUF MMAP OK length=%d", buf.length);
+
+    UserBuffer *pTmpBuffer = new UserBuffer;
+
+    if (m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE && 1 < buf.length)
+    {
+        LOG_EX("FrameObserverMMAP::MapBuffer plane count=%d", buf.length);
+
+        // every plane starts on its own page behind the previous one
+        size_t bufferLength = 0;
+        m_PlaneCount = buf.length;
+        for (uint32_t i = 0; i < m_PlaneCount; i++)
+        {
+            m_PlaneOffset[i] = bufferLength;
+            m_PlaneLength[i] = buf.m.planes[i].length;
+            bufferLength += ((buf.m.planes[i].length + pageSize - 1) / pageSize) * pageSize;
+        }
+        pTmpBuffer->nBufferlength = bufferLength;
+
+        // reserve the address range first and map the planes into it
+        pTmpBuffer->pBuffer = (uint8_t*)mmap(NULL, pTmpBuffer->nBufferlength, PROT_NONE,
+                                             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        for (uint32_t i = 0; i < m_PlaneCount && MAP_FAILED != pTmpBuffer->pBuffer; i++)
+        {
+            void *pPlane = mmap(pTmpBuffer->pBuffer + m_PlaneOffset[i],
+                                m_PlaneLength[i],
+                                PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_FIXED,
+                                m_nFileDescriptor,
+                                buf.m.planes[i].m.mem_offset);
+            if (MAP_FAILED == pPlane)
+            {
+                LOG_EX("FrameObserverMMAP::MapBuffer mmap of plane %d failed errno=%d=%s", i, errno, v4l2helper::ConvertErrno2String(errno).c_str());
+                munmap(pTmpBuffer->pBuffer, pTmpBuffer->nBufferlength);
+                pTmpBuffer->pBuffer = (uint8_t*)MAP_FAILED;
+            }
+        }
+    }
+    else
+    {
+        m_PlaneCount = 1;
+        pTmpBuffer->nBufferlength = (m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE ? buf.m.planes[0].length : buf.length);
+        pTmpBuffer->pBuffer = (uint8_t*)mmap(NULL,
+                pTmpBuffer->nBufferlength,
+                            PROT_READ | PROT_WRITE,
+                            MAP_SHARED,
+                            m_nFileDescriptor,
+                            m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE ? buf.m.planes[0].m.mem_offset : buf.m.offset);
+    }
+    m_RealPayloadSize = pTmpBuffer->nBufferlength;
+
+    if (MAP_FAILED == pTmpBuffer->pBuffer)
+    {
+        delete pTmpBuffer;
+        return -1;
+    }
+
+    pUserBuffer = pTmpBuffer;
+    return 0;
+}
+
 int FrameObserverMMAP::CreateAllUserBuffer(uint32_t bufferCount, uint32_t bufferSize)
 {
     int result = -1;
@@ -110,6 +204,9 @@ int FrameObserverMMAP::CreateAllUserBuffer(uint32_t bufferCount, uint32_t buffer
         req.count  = bufferCount;
         req.type   = m_BufferType;
         req.memory = V4L2_MEMORY_MMAP;
+#ifdef V4L2_MEMORY_FLAG_NON_COHERENT
+        req.flags  = GetMemoryFlags(V4L2_MEMORY_MMAP);
+#endif
 
         // requests 4 video capture buffer. Driver is going to configure all parameter and doesn't allocate them.
         if (-1 == iohelper::xioctl(m_nFileDescriptor, VIDIOC_REQBUFS, &req))
@@ -128,6 +225,11 @@ int FrameObserverMMAP::CreateAllUserBuffer(uint32_t bufferCount, uint32_t buffer
             base::LocalMutexLockGuard guard(m_UsedBufferMutex);
 
             LOG_EX("FrameObserverMMAP::CreateAllUserBuffer VIDIOC_REQBUFS OK");
+#ifdef V4L2_MEMORY_FLAG_NON_COHERENT
+            ReportCacheHintSupport(V4L2_MEMORY_MMAP, req.capabilities);
+#else
+            ReportCacheHintSupport(V4L2_MEMORY_MMAP, 0);
+#endif
 
             // create local buffer container
             m_UserBufferContainerList.resize(bufferCount);
@@ -139,48 +241,17 @@ int FrameObserverMMAP::CreateAllUserBuffer(uint32_t bufferCount, uint32_t buffer
                 return -1;
             }
 
-            for (unsigned int x = 0; x < bufferCount; ++x)
-            {
-                v4l2_buffer buf;
-                CLEAR(buf);
-                buf.type = m_BufferType;
-                buf.memory = V4L2_MEMORY_MMAP;
-                buf.index = x;
-
-                v4l2_plane plane;
-                if(m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
-                {
-                    buf.m.planes = &plane;
-                    buf.length = 1;
-                    LOG_EX("FrameObserverMMAP::CreateAllUserBuffer plane count=%d", buf.length);
-                }
-
-                if (-1 == iohelper::xioctl(m_nFileDescriptor, VIDIOC_QUERYBUF, &buf))
-                {
-                    LOG_EX("FrameObserverMMAP::CreateAllUserBuffer VIDIOC_QUERYBUF errno=%d=%s", errno, v4l2helper::ConvertErrno2String(errno).c_str());
-                    return -1;
-                }
-
-                LOG_EX("FrameObserverMMAP::CreateAllUserBuffer VIDIOC_QUERYBUF MMAP OK length=%d", buf.length);
+            QueryPlaneLayout();
 
-                UserBuffer* pTmpBuffer = new UserBuffer;
-                pTmpBuffer->nBufferlength = (m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE ? buf.m.planes[0].length : buf.length);
-                m_RealPayloadSize = pTmpBuffer->nBufferlength;
-                pTmpBuffer->pBuffer = (uint8_t*)mmap(NULL,
-                        pTmpBuffer->nBufferlength,
-                                    PROT_READ | PROT_WRITE,
-                                    MAP_SHARED,
-                                    m_nFileDescriptor,
-                                    m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE ? buf.m.planes[0].m.mem_offset : buf.m.offset);
+            size_t pageSize = sysconf(_SC_PAGESIZE);
 
-                if (MAP_FAILED == pTmpBuffer->pBuffer)
+            for (unsigned int x = 0; x < bufferCount; ++x)
+            {
+                if (0 != MapBuffer(x, pageSize, m_UserBufferContainerList[x]))
                 {
-                    delete pTmpBuffer;
                     m_UserBufferContainerList.resize(0);
                     return -1;
                 }
-                else
-                    m_UserBufferContainerList[x] = pTmpBuffer;
             }
 
             result = 0;
@@ -195,6 +266,12 @@ int FrameObserverMMAP::QueueAllUserBuffer()
     int result = -1;
     base::LocalMutexLockGuard guard(m_UsedBufferMutex);
 
+    m_DriverQueueDepth = 0;
+
+    // all buffers are prepared first, so they reach the driver in quick succession
+    if (m_bPrepareBuffers)
+        PrepareUserBuffers(0, m_UserBufferContainerList.size());
+
     // queue the buffer
     for (uint32_t i=0; i<m_UserBufferContainerList.size(); i++)
     {
@@ -204,12 +281,14 @@ int FrameObserverMMAP::QueueAllUserBuffer()
         buf.type = m_BufferType;
         buf.index = i;
         buf.memory = V4L2_MEMORY_MMAP;
+        buf.flags = GetCacheFlags(buf.index);
 
-        v4l2_plane plane;
+        v4l2_plane planes[VIDEO_MAX_PLANES];
         if(m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
         {
-            buf.m.planes = &plane;
-            buf.length = 1;
+            CLEAR(planes);
+            buf.m.planes = planes;
+            buf.length = m_PlaneCount;
         }
 
         if (-1 == iohelper::xioctl(m_nFileDescriptor, VIDIOC_QBUF, &buf))
@@ -220,6 +299,7 @@ int FrameObserverMMAP::QueueAllUserBuffer()
         else
         {
             LOG_EX("FrameObserverMMAP::QueueUserBuffer VIDIOC_QBUF queue #%d buffer=%p OK", i, m_UserBufferContainerList[i]->pBuffer);
+            m_DriverQueueDepth++;
             result = 0;
         }
     }
@@ -239,12 +319,14 @@ int FrameObserverMMAP::QueueSingleUserBuffer(const int index)
         buf.type = m_BufferType;
         buf.index = index;
         buf.memory = V4L2_MEMORY_MMAP;
+        buf.flags = GetCacheFlags(buf.index);
 
-        v4l2_plane plane;
+        v4l2_plane planes[VIDEO_MAX_PLANES];
         if(m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
         {
-            buf.m.planes = &plane;
-            buf.length = 1;
+            CLEAR(planes);
+            buf.m.planes = planes;
+            buf.length = m_PlaneCount;
         }
 
         if (m_IsStreamRunning)
@@ -253,9 +335,88 @@ int FrameObserverMMAP::QueueSingleUserBuffer(const int index)
             {
                 LOG_EX("FrameObserverMMAP::QueueSingleUserBuffer VIDIOC_QBUF queue #%d buffer=%p failed, errno=%d=%s", index, m_UserBufferContainerList[index]->pBuffer, errno, v4l2helper::ConvertErrno2String(errno).c_str());
             }
+            else
+            {
+                m_DriverQueueDepth++;
+            }
+        }
+    }
+
+    return result;
+}
+
+int FrameObserverMMAP::AddUserBuffers(uint32_t bufferCount)
+{
+    uint32_t firstIndex = GetUserBufferCount();
+    uint32_t createdCount = 0;
+
+    // the buffers are created, mapped and prepared without the lock, the
+    // returned frames are queued meanwhile
+    if (0 != CreateAdditionalBuffers(V4L2_MEMORY_MMAP, bufferCount, createdCount))
+        return -1;
+
+    std::vector<UserBuffer*> userBuffers;
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    for (uint32_t x = 0; x < createdCount; x++)
+    {
+        UserBuffer *pUserBuffer = NULL;
+        if (0 != MapBuffer(firstIndex + x, pageSize, pUserBuffer))
+        {
+            // the driver keeps the buffers which could not be mapped unused
+            createdCount = x;
+            break;
+        }
+        userBuffers.push_back(pUserBuffer);
+    }
+
+    if (m_bPrepareBuffers && 0 < createdCount)
+        PrepareUserBuffers(firstIndex, createdCount);
+
+    {
+        base::LocalMutexLockGuard guard(m_UsedBufferMutex);
+        m_UserBufferContainerList.insert(m_UserBufferContainerList.end(), userBuffers.begin(), userBuffers.end());
+    }
+
+    for (uint32_t x = 0; x < createdCount; x++)
+        QueueSingleUserBuffer(firstIndex + x);
+
+    return (0 < createdCount) ? 0 : -1;
+}
+
+int FrameObserverMMAP::PrepareUserBuffers(uint32_t firstIndex, uint32_t bufferCount)
+{
+    int result = 0;
+    QElapsedTimer prepareTimer;
+    prepareTimer.start();
+
+    for (uint32_t i = firstIndex; i < firstIndex + bufferCount; i++)
+    {
+        v4l2_buffer buf;
+
+        CLEAR(buf);
+        buf.type = m_BufferType;
+        buf.index = i;
+        buf.memory = V4L2_MEMORY_MMAP;
+        buf.flags = SelectCacheFlags();
+
+        v4l2_plane planes[VIDEO_MAX_PLANES];
+        if(m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+        {
+            CLEAR(planes);
+            buf.m.planes = planes;
+            buf.length = m_PlaneCount;
+        }
+
+        // a buffer which is not prepared is still queued the normal way
+        if (-1 == iohelper::xioctl(m_nFileDescriptor, VIDIOC_PREPARE_BUF, &buf))
+        {
+            LOG_EX("FrameObserverMMAP::PrepareUserBuffers VIDIOC_PREPARE_BUF #%d failed, errno=%d=%s", i, errno, v4l2helper::ConvertErrno2String(errno).c_str());
+            result = -1;
         }
     }
 
+    LOG_EX("FrameObserverMMAP::PrepareUserBuffers %d buffers in %.3f ms", bufferCount, prepareTimer.nsecsElapsed() / 1000000.0);
+
     return result;
 }
 
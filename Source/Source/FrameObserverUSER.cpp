@@ -22,6 +22,7 @@
 #include "MemoryHelper.h"
 #include "V4L2Helper.h"
 
+#include <QElapsedTimer>
 #include <QPixmap>
 
 #include <errno.h>
@@ -32,16 +33,20 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cstdlib>
 #include <sstream>
 
 FrameObserverUSER::FrameObserverUSER(bool showFrames)
     : FrameObserver(showFrames)
+    , m_BufferSize(0)
+    , m_BufferCapacity(0)
 {
 }
 
 FrameObserverUSER::~FrameObserverUSER()
 {
+    FreeReusableBuffers();
 }
 
 int FrameObserverUSER::ReadFrame(v4l2_buffer &buf)
@@ -53,9 +58,25 @@ int FrameObserverUSER::ReadFrame(v4l2_buffer &buf)
     buf.type = m_BufferType;
     buf.memory = V4L2_MEMORY_USERPTR;
 
+    v4l2_plane planes[VIDEO_MAX_PLANES];
+    if (m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+    {
+        CLEAR(planes);
+        buf.m.planes = planes;
+        buf.length = m_PlaneCount;
+    }
+
     if (m_IsStreamRunning)
         result = iohelper::xioctl(m_nFileDescriptor, VIDIOC_DQBUF, &buf);
 
+    // the plane array is not valid beyond this function, a single plane
+    // reports its filled length like a single-planar buffer
+    if (m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+    {
+        buf.bytesused = (0 == result && 1 == m_PlaneCount) ? planes[0].bytesused : 0;
+        buf.m.planes = NULL;
+    }
+
     return result;
 }
 
@@ -65,8 +86,19 @@ int FrameObserverUSER::GetFrameData(v4l2_buffer &buf, uint8_t *&buffer, uint32_t
 
     if (m_IsStreamRunning)
     {
-        length = buf.length;
-        buffer = (uint8_t*)buf.m.userptr;
+        base::LocalMutexLockGuard guard(m_UsedBufferMutex);
+
+        // the planes of a multi-planar buffer are consecutive in one allocation
+        if (buf.index < m_UserBufferContainerList.size())
+        {
+            length = m_UserBufferContainerList[buf.index]->nBufferlength;
+            buffer = m_UserBufferContainerList[buf.index]->pBuffer;
+        }
+        else
+        {
+            length = 0;
+            buffer = 0;
+        }
 
         if (0 != buffer && 0 != length)
         {
@@ -113,6 +145,11 @@ int FrameObserverUSER::CreateAllUserBuffer(uint32_t bufferCount, uint32_t buffer
             base::LocalMutexLockGuard guard(m_UsedBufferMutex);
 
             LOG_EX("FrameObserverUSER::CreateAllUserBuffer VIDIOC_REQBUFS OK");
+#ifdef V4L2_MEMORY_FLAG_NON_COHERENT
+            ReportCacheHintSupport(V4L2_MEMORY_USERPTR, req.capabilities);
+#else
+            ReportCacheHintSupport(V4L2_MEMORY_USERPTR, 0);
+#endif
 
             // create local buffer container
             m_UserBufferContainerList.resize(bufferCount);
@@ -123,6 +160,54 @@ int FrameObserverUSER::CreateAllUserBuffer(uint32_t bufferCount, uint32_t buffer
                 return -1;
             }
 
+            // a multi-planar buffer gets one allocation with every plane aligned to 128 bytes
+            m_PlaneCount = 1;
+            m_PlaneOffset[0] = 0;
+            m_PlaneLength[0] = bufferSize;
+            if (m_BufferType == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE && 0 == QueryPlaneLayout() && 1 < m_PlaneCount)
+            {
+                bufferSize = 0;
+                for (uint32_t i = 0; i < m_PlaneCount; i++)
+                {
+                    m_PlaneOffset[i] = bufferSize;
+                    bufferSize += ((m_PlaneLength[i] + 127) / 128) * 128;
+                }
+                LOG_EX("FrameObserverUSER::CreateAllUserBuffer plane count=%d", m_PlaneCount);
+            }
+            else
+            {
+                m_PlaneCount = 1;
+                m_PlaneLength[0] = bufferSize;
+            }
+            m_BufferSize = bufferSize;
+
+            // the memory of the previous stream is taken over when every
+            // buffer of the new format fits into it
+            size_t allocationSize = ((bufferSize + 127) / 128) * 128;
+            if (m_BufferCapacity < allocationSize)
+                FreeReusableBuffers();
+            if (m_ReusableBuffers.empty())
+                m_BufferCapacity = allocationSize;
+
+            // all buffers in one pre-faulted and locked range, the page
+            // aligned slots also fulfil the 128 byte alignment
+            if (m_bUseBufferArena && m_BufferArena.Fits(bufferCount, bufferSize))
+            {
+                LOG_EX("FrameObserverUSER::CreateAllUserBuffer reusing the buffer arena");
+            }
+            else
+            {
+                m_BufferArena.Release();
+                if (m_bUseBufferArena && 0 != m_BufferArena.Create(bufferCount, bufferSize))
+                {
+                    LOG_EX("FrameObserverUSER::CreateAllUserBuffer buffer arena not available, allocating single buffers");
+                }
+            }
+            if (!m_BufferArena.IsValid() && !m_ReusableBuffers.empty())
+            {
+                LOG_EX("FrameObserverUSER::CreateAllUserBuffer reusing %d buffers", static_cast<int>(std::min<size_t>(bufferCount, m_ReusableBuffers.size())));
+            }
+
             // get the length and start address of each of the 4 buffer structs and assign the user buffer addresses
             for (unsigned int x = 0; x < m_UserBufferContainerList.size(); ++x)
             {
@@ -130,10 +215,20 @@ int FrameObserverUSER::CreateAllUserBuffer(uint32_t bufferCount, uint32_t buffer
                 pTmpBuffer->nBufferlength = bufferSize;
                 m_RealPayloadSize = pTmpBuffer->nBufferlength;
 
-                // buffer needs to be aligned to 128 bytes
-                if (bufferSize % 128)
-                    bufferSize = ((bufferSize / 128) + 1) * 128;
-                pTmpBuffer->pBuffer = static_cast<uint8_t*>(aligned_alloc(128, bufferSize));
+                // buffers need to be aligned to 128 bytes, arena slots and kept buffers are
+                if (m_BufferArena.IsValid())
+                {
+                    pTmpBuffer->pBuffer = m_BufferArena.GetSlot(x);
+                }
+                else if (!m_ReusableBuffers.empty())
+                {
+                    pTmpBuffer->pBuffer = m_ReusableBuffers.back();
+                    m_ReusableBuffers.pop_back();
+                }
+                else
+                {
+                    pTmpBuffer->pBuffer = static_cast<uint8_t*>(aligned_alloc(128, m_BufferCapacity));
+                }
 
                 if (!pTmpBuffer->pBuffer)
                 {
@@ -146,6 +241,9 @@ int FrameObserverUSER::CreateAllUserBuffer(uint32_t bufferCount, uint32_t buffer
                     m_UserBufferContainerList[x] = pTmpBuffer;
             }
 
+            // memory of the previous stream which is not needed any more
+            FreeReusableBuffers();
+
             result = 0;
         }
     }
@@ -158,31 +256,24 @@ int FrameObserverUSER::QueueAllUserBuffer()
     int result = -1;
     base::LocalMutexLockGuard guard(m_UsedBufferMutex);
 
+    m_DriverQueueDepth = 0;
+
+    // all buffers are prepared first, so they reach the driver in quick succession
+    if (m_bPrepareBuffers)
+        PrepareUserBuffers(0, m_UserBufferContainerList);
+
     // queue the buffer
     for (uint32_t i=0; i<m_UserBufferContainerList.size(); i++)
     {
         v4l2_buffer buf;
-        v4l2_plane plane;
+        v4l2_plane planes[VIDEO_MAX_PLANES];
         CLEAR(buf);
-        CLEAR(plane);
         buf.type = m_BufferType;
         buf.index = i;
         buf.memory = V4L2_MEMORY_USERPTR;
+        buf.flags = GetCacheFlags(buf.index);
 
-        if (buf.type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
-        {
-            buf.m.planes = &plane;
-            buf.length = 1;
-
-            plane.m.userptr = (unsigned long)m_UserBufferContainerList[i]->pBuffer;
-            plane.length = m_UserBufferContainerList[i]->nBufferlength;
-        }
-        else
-        {
-            buf.m.userptr = (unsigned long)m_UserBufferContainerList[i]->pBuffer;
-            buf.length = m_UserBufferContainerList[i]->nBufferlength;
-        }
-
+        SetBufferPointers(buf, planes, m_UserBufferContainerList[i]);
 
         if (-1 == iohelper::xioctl(m_nFileDescriptor, VIDIOC_QBUF, &buf))
         {
@@ -192,6 +283,7 @@ int FrameObserverUSER::QueueAllUserBuffer()
         else
         {
             LOG_EX("FrameObserverUSER::QueueAllUserBuffer VIDIOC_QBUF queue #%d buffer=%p OK", i, m_UserBufferContainerList[i]->pBuffer);
+            m_DriverQueueDepth++;
             result = 0;
         }
     }
@@ -207,12 +299,14 @@ int FrameObserverUSER::QueueSingleUserBuffer(const int index)
 
     if (index < static_cast<int>(m_UserBufferContainerList.size()))
     {
+        v4l2_plane planes[VIDEO_MAX_PLANES];
         CLEAR(buf);
         buf.type = m_BufferType;
         buf.index = index;
         buf.memory = V4L2_MEMORY_USERPTR;
-        buf.m.userptr = (unsigned long)m_UserBufferContainerList[index]->pBuffer;
-        buf.length = m_UserBufferContainerList[index]->nBufferlength;
+        buf.flags = GetCacheFlags(buf.index);
+
+        SetBufferPointers(buf, planes, m_UserBufferContainerList[index]);
 
         if (m_IsStreamRunning)
         {
@@ -220,9 +314,86 @@ int FrameObserverUSER::QueueSingleUserBuffer(const int index)
             {
                 LOG_EX("FrameObserverUSER::QueueSingleUserBuffer VIDIOC_QBUF queue #%d buffer=%p failed", index, m_UserBufferContainerList[index]->pBuffer);
             }
+            else
+            {
+                m_DriverQueueDepth++;
+            }
+        }
+    }
+
+    return result;
+}
+
+int FrameObserverUSER::AddUserBuffers(uint32_t bufferCount)
+{
+    uint32_t firstIndex = GetUserBufferCount();
+    uint32_t createdCount = 0;
+
+    // the buffers are created, allocated and prepared without the lock, the
+    // returned frames are queued meanwhile
+    if (0 != CreateAdditionalBuffers(V4L2_MEMORY_USERPTR, bufferCount, createdCount))
+        return -1;
+
+    // the arena has a fixed size, the added buffers are allocated one by one
+    std::vector<UserBuffer*> userBuffers;
+    for (uint32_t x = 0; x < createdCount; x++)
+    {
+        UserBuffer *pUserBuffer = new UserBuffer;
+        pUserBuffer->nBufferlength = m_BufferSize;
+        pUserBuffer->pBuffer = static_cast<uint8_t*>(aligned_alloc(128, m_BufferCapacity));
+        if (!pUserBuffer->pBuffer)
+        {
+            LOG_EX("FrameObserverUSER::AddUserBuffers buffer creation error");
+            delete pUserBuffer;
+            createdCount = x;
+            break;
         }
+        userBuffers.push_back(pUserBuffer);
+    }
+
+    if (m_bPrepareBuffers && 0 < createdCount)
+        PrepareUserBuffers(firstIndex, userBuffers);
+
+    {
+        base::LocalMutexLockGuard guard(m_UsedBufferMutex);
+        m_UserBufferContainerList.insert(m_UserBufferContainerList.end(), userBuffers.begin(), userBuffers.end());
     }
 
+    for (uint32_t x = 0; x < createdCount; x++)
+        QueueSingleUserBuffer(firstIndex + x);
+
+    return (0 < createdCount) ? 0 : -1;
+}
+
+int FrameObserverUSER::PrepareUserBuffers(uint32_t firstIndex, const std::vector<UserBuffer*> &userBuffers)
+{
+    int result = 0;
+    QElapsedTimer prepareTimer;
+    prepareTimer.start();
+
+    // the driver pins the pages of the user pointers here instead of at the first queuing
+    for (uint32_t x = 0; x < userBuffers.size(); x++)
+    {
+        v4l2_buffer buf;
+        v4l2_plane planes[VIDEO_MAX_PLANES];
+        CLEAR(buf);
+        buf.type = m_BufferType;
+        buf.index = firstIndex + x;
+        buf.memory = V4L2_MEMORY_USERPTR;
+        buf.flags = SelectCacheFlags();
+
+        SetBufferPointers(buf, planes, userBuffers[x]);
+
+        // a buffer which is not prepared is still queued the normal way
+        if (-1 == iohelper::xioctl(m_nFileDescriptor, VIDIOC_PREPARE_BUF, &buf))
+        {
+            LOG_EX("FrameObserverUSER::PrepareUserBuffers VIDIOC_PREPARE_BUF #%d failed, errno=%d=%s", buf.index, errno, v4l2helper::ConvertErrno2String(errno).c_str());
+            result = -1;
+        }
+    }
+
+    LOG_EX("FrameObserverUSER::PrepareUserBuffers %d buffers in %.3f ms", static_cast<int>(userBuffers.size()), prepareTimer.nsecsElapsed() / 1000000.0);
+
     return result;
 }
 
@@ -247,15 +418,74 @@ int FrameObserverUSER::DeleteAllUserBuffer()
         // delete all user buffer
         for (unsigned int x = 0; x < m_UserBufferContainerList.size(); x++)
         {
-            if (0 != m_UserBufferContainerList[x]->pBuffer)
+            if (0 != m_UserBufferContainerList[x]->pBuffer && !m_BufferArena.Contains(m_UserBufferContainerList[x]->pBuffer))
             free(m_UserBufferContainerList[x]->pBuffer);
             if (0 != m_UserBufferContainerList[x])
             delete m_UserBufferContainerList[x];
         }
 
         m_UserBufferContainerList.resize(0);
+        m_BufferArena.Release();
+        FreeReusableBuffers();
     }
 
     return result;
 }
 
+int FrameObserverUSER::ReleaseAllUserBuffer()
+{
+    int result = 0;
+
+    // the driver forgets the user pointers, the memory stays with the viewer
+    v4l2_requestbuffers req;
+    CLEAR(req);
+    req.count  = 0;
+    req.type   = m_BufferType;
+    req.memory = V4L2_MEMORY_USERPTR;
+
+    result = iohelper::xioctl(m_nFileDescriptor, VIDIOC_REQBUFS, &req);
+
+    {
+        base::LocalMutexLockGuard guard(m_UsedBufferMutex);
+
+        for (unsigned int x = 0; x < m_UserBufferContainerList.size(); x++)
+        {
+            if (0 != m_UserBufferContainerList[x]->pBuffer && !m_BufferArena.Contains(m_UserBufferContainerList[x]->pBuffer))
+                m_ReusableBuffers.push_back(m_UserBufferContainerList[x]->pBuffer);
+            delete m_UserBufferContainerList[x];
+        }
+
+        m_UserBufferContainerList.resize(0);
+    }
+
+    return result;
+}
+
+void FrameObserverUSER::FreeReusableBuffers()
+{
+    for (size_t x = 0; x < m_ReusableBuffers.size(); x++)
+        free(m_ReusableBuffers[x]);
+
+    m_ReusableBuffers.clear();
+}
+
+void FrameObserverUSER::SetBufferPointers(v4l2_buffer &buf, v4l2_plane *planes, const UserBuffer *pUserBuffer)
+{
+    if (buf.type == V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE)
+    {
+        memset(planes, 0, sizeof(v4l2_plane) * m_PlaneCount);
+        buf.m.planes = planes;
+        buf.length = m_PlaneCount;
+
+        for (uint32_t i = 0; i < m_PlaneCount; i++)
+        {
+            planes[i].m.userptr = (unsigned long)(pUserBuffer->pBuffer + m_PlaneOffset[i]);
+            planes[i].length = (1 == m_PlaneCount) ? pUserBuffer->nBufferlength : m_PlaneLength[i];
+        }
+    }
+    else
+    {
+        buf.m.userptr = (unsigned long)pUserBuffer->pBuffer;
+        buf.length = pUserBuffer->nBufferlength;
+    }
+}
@@ -18,11 +18,20 @@
 
 #include "ImageProcessingThread.h"
 #include "ImageTransform.h"
+#include "LocalMutexLockGuard.h"
+#include "ThreadScheduling.h"
 
 #include <linux/videodev2.h>
 
 ImageProcessingThread::ImageProcessingThread()
-    : m_bAbort(false)
+    : m_ToneMapping(tonemapping::GetDefaultParameters())
+    , m_bAutoWindowLevel(true)
+    , m_WindowLow(0)
+    , m_WindowHigh(0xFFFF)
+    , m_TableToneMapping(tonemapping::GetDefaultParameters())
+    , m_TableLow(0)
+    , m_TableHigh(0xFFFF)
+    , m_bAbort(false)
 {
 }
 
@@ -80,6 +89,59 @@ int ImageProcessingThread::QueueFrame(QSharedPointer<MyFrame> pFrame)
     return result;
 }
 
+void ImageProcessingThread::SetConversionPlan(QSharedPointer<ConversionPlan> pPlan)
+{
+    m_pConversionPlan = pPlan;
+}
+
+void ImageProcessingThread::SetToneTable(QSharedPointer<const std::vector<uint8_t> > pToneTable,
+                                         const tonemapping::Parameters &toneMapping)
+{
+    base::LocalMutexLockGuard guard(m_ToneTableMutex);
+    m_pToneTable = pToneTable;
+    m_ToneMapping = toneMapping;
+}
+
+void ImageProcessingThread::SetWindowLevel(bool bAutoWindowLevel, uint16_t low, uint16_t high)
+{
+    base::LocalMutexLockGuard guard(m_ToneTableMutex);
+    m_bAutoWindowLevel = bAutoWindowLevel;
+    m_WindowLow = low;
+    m_WindowHigh = high;
+}
+
+void ImageProcessingThread::CreateDisplayImage(const QImage &image, QImage &displayImage)
+{
+    tonemapping::Parameters toneMapping;
+    bool bAutoWindowLevel;
+    uint16_t low;
+    uint16_t high;
+    {
+        base::LocalMutexLockGuard guard(m_ToneTableMutex);
+        toneMapping = m_ToneMapping;
+        bAutoWindowLevel = m_bAutoWindowLevel;
+        low = m_WindowLow;
+        high = m_WindowHigh;
+    }
+
+    if (bAutoWindowLevel)
+        ImageTransform::GetImageRange(image, low, high);
+
+    // the table only changes with the window or the tone curve
+    if (m_WindowLevelTable.empty() || low != m_TableLow || high != m_TableHigh ||
+        !tonemapping::IsEqual(toneMapping, m_TableToneMapping))
+    {
+        ImageTransform::CreateWindowLevelTable(low, high, toneMapping, m_WindowLevelTable);
+        m_TableToneMapping = toneMapping;
+        m_TableLow = low;
+        m_TableHigh = high;
+    }
+
+    // every frame gets a new display image, the previous one may still be painted
+    displayImage = QImage();
+    ImageTransform::ApplyWindowLevel(image, m_WindowLevelTable, displayImage);
+}
+
 // stop the internal processing thread and wait until the thread is really stopped
 void ImageProcessingThread::StartThread()
 {
@@ -94,8 +156,7 @@ void ImageProcessingThread::StopThread()
     m_bAbort = true;
 
     // wait until the thread is stopped
-    while (isRunning())
-        QThread::msleep(10);
+    wait();
 
     m_FrameQueue.Clear();
 }
@@ -105,6 +166,8 @@ void ImageProcessingThread::run()
 {
     int result = 0;
 
+    threadscheduling::ApplyToCurrentThread(threadscheduling::ThreadRoleProcessing);
+
     while (!m_bAbort)
     {
         if(0 < m_FrameQueue.GetSize())
@@ -113,19 +176,40 @@ void ImageProcessingThread::run()
             uint64_t frameID = pFrame->GetFrameId();
             const uint8_t* pBuffer = pFrame->GetBuffer();
             uint32_t length = pFrame->GetBufferlength();
-            uint32_t width = pFrame->GetWidth();
-            uint32_t height = pFrame->GetHeight();
-            uint32_t pixelFormat = pFrame->GetPixelFormat();
-            uint32_t payloadSize = pFrame->GetPayloadSize();
-            uint32_t bytesPerLine = pFrame->GetBytesPerLine();
             uint32_t bufferIndex = pFrame->GetBufferIndex();
             QImage convertedImage;
-            result = ImageTransform::ConvertFrame(pBuffer, length,
-                                                  width, height, pixelFormat,
-                                                  payloadSize, bytesPerLine, convertedImage);
 
-            if (result == 0)
-                emit OnFrameReady_Signal(convertedImage, frameID, bufferIndex);
+            // the table is kept alive by the local reference during the conversion
+            QSharedPointer<const std::vector<uint8_t> > pToneTable;
+            {
+                base::LocalMutexLockGuard guard(m_ToneTableMutex);
+                pToneTable = m_pToneTable;
+            }
+            const uint8_t *pToneTableData = pToneTable.isNull() ? NULL : pToneTable->data();
+
+            // the stream start sets the plan, a thread without one does not
+            // fall back to resolving the format for every frame
+            if (!m_pConversionPlan.isNull())
+            {
+                m_pConversionPlan->pToneTable = pToneTableData;
+                result = ImageTransform::ConvertFrame(*m_pConversionPlan, pBuffer, length, convertedImage);
+            }
+            else
+            {
+                result = -1;
+            }
+
+            // a frame which could not be converted is still reported with a
+            // null image, so its buffer goes back to the driver
+            if (result != 0)
+                convertedImage = QImage();
+
+            // the GUI only paints, high bit depth frames are mapped here
+            QImage displayImage = convertedImage;
+            if (ImageTransform::IsHighBitDepth(convertedImage))
+                CreateDisplayImage(convertedImage, displayImage);
+
+            emit OnFrameReady_Signal(convertedImage, displayImage, frameID, bufferIndex);
         }
 
         QThread::msleep(1);
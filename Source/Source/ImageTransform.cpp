@@ -18,8 +18,11 @@
 
 #include "ImageTransform.h"
 #include "Logger.h"
+#include "MjpegDecoder.h"
 #include "videodev2_av.h"
 
+#include <algorithm>
+#include <cmath>
 #include <regex>
 
 #include <QFile>
@@ -29,10 +32,24 @@
 #include <linux/videodev2.h>
 #include <sstream>
 
-#define CLIP(color) (unsigned char)(((color) > 0xFF) ? 0xff : (((color) < 0) ? 0 : (color)))
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define TRANSFORM_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define TRANSFORM_USE_NEON
+#endif
+
+// The byte shuffles of the packed unpackers need SSSE3 which is dispatched at
+// runtime, the table lookup of AArch64 NEON is always available there.
+#if defined(TRANSFORM_USE_SSE2) && defined(__GNUC__)
+#include <tmmintrin.h>
+#define TRANSFORM_USE_SSSE3
+#elif defined(TRANSFORM_USE_NEON) && defined(__aarch64__)
+#define TRANSFORM_USE_NEON_TABLE
+#endif
 
-extern uint8_t *g_ConversionBuffer1;
-extern uint8_t *g_ConversionBuffer2;
+#define CLIP(color) (unsigned char)(((color) > 0xFF) ? 0xff : (((color) < 0) ? 0 : (color)))
 
 int g_shift10Bit = -1;
 int g_shift12Bit = -1;
@@ -41,8 +58,13 @@ ImageTransform::ImageTransform() {}
 
 ImageTransform::~ImageTransform() {}
 
-void ConvertMono12gToRGB24(const void *sourceBuffer, uint32_t width,
-                           uint32_t height, const void *destBuffer)
+/*********************************************************************************************************/
+// Packed 12 bit unpacking
+/*********************************************************************************************************/
+
+// Original byte wise implementations, they are the reference of the group wise kernels
+static void ReferenceRAW12gToRAW8(const void *sourceBuffer, uint32_t width,
+                                  uint32_t height, const void *destBuffer)
 {
     unsigned char *destdata = (unsigned char *)destBuffer;
     unsigned char *srcdata = (unsigned char *)sourceBuffer;
@@ -56,8 +78,6 @@ void ConvertMono12gToRGB24(const void *sourceBuffer, uint32_t width,
             if (((count + 1) % 3) != 0)
             {
                 *destdata++ = *srcdata;
-                *destdata++ = *srcdata;
-                *destdata++ = *srcdata;
             }
             count++;
             srcdata++;
@@ -65,128 +85,277 @@ void ConvertMono12gToRGB24(const void *sourceBuffer, uint32_t width,
     }
 }
 
-void ConvertMono10gToRGB24(const void *sourceBuffer, uint32_t width,
-                           uint32_t height, const void *destBuffer)
+// MIPI RAW12 packs 2 pixels into 3 bytes with the 4 bit LSBs in the last
+// byte. The 16 bit output is MSB aligned.
+
+// Unpacks one line, pDestination holds uint8_t or uint16_t samples
+typedef void (*UnpackLineFunction)(const uint8_t *pSource, void *pDestination, uint32_t width);
+
+static void UnpackRAW12gLineToRAW8(const uint8_t *pSource, void *pDestination, uint32_t width)
 {
-    unsigned char *destdata = (unsigned char *)destBuffer;
-    unsigned char *srcdata = (unsigned char *)sourceBuffer;
-    uint32_t count = 0;
-    uint32_t bytesPerLine = width * 1.25;
+    uint8_t *dst = static_cast<uint8_t *>(pDestination);
+    uint32_t x = 0;
 
-    for (unsigned int i = 0; i < height; i++)
+    for (; x + 2 <= width; x += 2, pSource += 3, dst += 2)
     {
-        for (unsigned int ii = 0; ii < bytesPerLine; ii++)
-        {
-            if (((count + 1) % 5) != 0)
-            {
-                *destdata++ = *srcdata;
-                *destdata++ = *srcdata;
-                *destdata++ = *srcdata;
-            }
-            count++;
-            srcdata++;
-        }
+        dst[0] = pSource[0];
+        dst[1] = pSource[1];
     }
+    if (x < width)
+        dst[0] = pSource[0];
 }
 
-void ConvertRAW12gToRAW8(const void *sourceBuffer, uint32_t width,
-                         uint32_t height, const void *destBuffer)
+static void UnpackRAW12gLineToRAW16(const uint8_t *pSource, void *pDestination, uint32_t width)
 {
-    unsigned char *destdata = (unsigned char *)destBuffer;
-    unsigned char *srcdata = (unsigned char *)sourceBuffer;
-    uint32_t count = 0;
-    uint32_t bytesPerLine = width * 1.5;
+    uint16_t *dst = static_cast<uint16_t *>(pDestination);
+    uint32_t x = 0;
 
-    for (unsigned int i = 0; i < height; i++)
+    for (; x + 2 <= width; x += 2, pSource += 3, dst += 2)
     {
-        for (unsigned int ii = 0; ii < bytesPerLine; ii++)
-        {
-            if (((count + 1) % 3) != 0)
-            {
-                *destdata++ = *srcdata;
-            }
-            count++;
-            srcdata++;
-        }
+        dst[0] = static_cast<uint16_t>((pSource[0] << 8) | ((pSource[2] & 0x0F) << 4));
+        dst[1] = static_cast<uint16_t>((pSource[1] << 8) | (pSource[2] & 0xF0));
     }
+    if (x < width)
+        dst[0] = static_cast<uint16_t>((pSource[0] << 8) | ((pSource[2] & 0x0F) << 4));
 }
 
-void ConvertRAW10gToRAW8(const void *sourceBuffer, uint32_t width,
-                         uint32_t height, const void *destBuffer)
+#if defined(TRANSFORM_USE_SSSE3)
+
+// Four groups of 3 bytes become 8 pixels
+__attribute__((target("ssse3")))
+static void UnpackRAW12gLineToRAW8Ssse3(const uint8_t *pSource, void *pDestination, uint32_t width)
 {
-    unsigned char *destdata = (unsigned char *)destBuffer;
-    unsigned char *srcdata = (unsigned char *)sourceBuffer;
-    uint32_t count = 0;
-    uint32_t bytesPerLine = width * 1.25;
+    uint8_t *dst = static_cast<uint8_t *>(pDestination);
+    const __m128i msbShuffle = _mm_setr_epi8(0, 1, 3, 4, 6, 7, 9, 10, -1, -1, -1, -1, -1, -1, -1, -1);
+    uint32_t groups = width / 2;
+    uint32_t group = 0;
 
-    for (unsigned int i = 0; i < height; i++)
+    for (; group + 6 <= groups; group += 4)
     {
-        for (unsigned int ii = 0; ii < bytesPerLine; ii++)
-        {
-            if (((count + 1) % 5) != 0)
-            {
-                *destdata++ = *srcdata;
-            }
-            count++;
-            srcdata++;
-        }
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSource + group * 3));
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + group * 2), _mm_shuffle_epi8(packed, msbShuffle));
     }
+
+    UnpackRAW12gLineToRAW8(pSource + group * 3, dst + group * 2, width - group * 2);
 }
 
-void ConvertRAW10ToRAW8(const void *sourceBuffer, uint32_t width,
-                        uint32_t height, const void *destBuffer)
+__attribute__((target("ssse3")))
+static void UnpackRAW12gLineToRAW16Ssse3(const uint8_t *pSource, void *pDestination, uint32_t width)
 {
-    unsigned char *destdata = (unsigned char *)destBuffer;
-    unsigned char *srcdata = (unsigned char *)sourceBuffer;
-    uint32_t count = 0;
-    uint32_t bytesPerLine = width * 2;
+    uint16_t *dst = static_cast<uint16_t *>(pDestination);
+    const __m128i msbShuffle = _mm_setr_epi8(-1, 0, -1, 1, -1, 3, -1, 4, -1, 6, -1, 7, -1, 9, -1, 10);
+    const __m128i lsbShuffle = _mm_setr_epi8(2, -1, 2, -1, 5, -1, 5, -1, 8, -1, 8, -1, 11, -1, 11, -1);
+    const __m128i lsbScale = _mm_setr_epi16(16, 1, 16, 1, 16, 1, 16, 1);
+    const __m128i lsbMask = _mm_set1_epi16(0x00F0);
+    uint32_t groups = width / 2;
+    uint32_t group = 0;
+
+    for (; group + 6 <= groups; group += 4)
+    {
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSource + group * 3));
+        __m128i msb = _mm_shuffle_epi8(packed, msbShuffle);
+        __m128i lsb = _mm_and_si128(_mm_mullo_epi16(_mm_shuffle_epi8(packed, lsbShuffle), lsbScale), lsbMask);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + group * 2), _mm_or_si128(msb, lsb));
+    }
 
-    for (unsigned int i = 0; i < height; i++)
+    UnpackRAW12gLineToRAW16(pSource + group * 3, dst + group * 2, width - group * 2);
+}
+
+#endif
+
+#if defined(TRANSFORM_USE_NEON_TABLE)
+
+// Same shuffles as the SSSE3 kernels, out of range table indices give 0
+static void UnpackRAW12gLineToRAW8Neon(const uint8_t *pSource, void *pDestination, uint32_t width)
+{
+    uint8_t *dst = static_cast<uint8_t *>(pDestination);
+    static const uint8_t msbIndex[16] = { 0, 1, 3, 4, 6, 7, 9, 10, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF };
+    const uint8x16_t msbShuffle = vld1q_u8(msbIndex);
+    uint32_t groups = width / 2;
+    uint32_t group = 0;
+
+    for (; group + 6 <= groups; group += 4)
     {
-        for (unsigned int ii = 0; ii < bytesPerLine; ii++)
+        vst1_u8(dst + group * 2, vget_low_u8(vqtbl1q_u8(vld1q_u8(pSource + group * 3), msbShuffle)));
+    }
+
+    UnpackRAW12gLineToRAW8(pSource + group * 3, dst + group * 2, width - group * 2);
+}
+
+static void UnpackRAW12gLineToRAW16Neon(const uint8_t *pSource, void *pDestination, uint32_t width)
+{
+    uint16_t *dst = static_cast<uint16_t *>(pDestination);
+    static const uint8_t msbIndex[16] = { 0xFF, 0, 0xFF, 1, 0xFF, 3, 0xFF, 4, 0xFF, 6, 0xFF, 7, 0xFF, 9, 0xFF, 10 };
+    static const uint8_t lsbIndex[16] = { 2, 0xFF, 2, 0xFF, 5, 0xFF, 5, 0xFF, 8, 0xFF, 8, 0xFF, 11, 0xFF, 11, 0xFF };
+    static const uint16_t lsbScaleValues[8] = { 16, 1, 16, 1, 16, 1, 16, 1 };
+    const uint8x16_t msbShuffle = vld1q_u8(msbIndex);
+    const uint8x16_t lsbShuffle = vld1q_u8(lsbIndex);
+    const uint16x8_t lsbScale = vld1q_u16(lsbScaleValues);
+    const uint16x8_t lsbMask = vdupq_n_u16(0x00F0);
+    uint32_t groups = width / 2;
+    uint32_t group = 0;
+
+    for (; group + 6 <= groups; group += 4)
+    {
+        uint8x16_t packed = vld1q_u8(pSource + group * 3);
+        uint16x8_t msb = vreinterpretq_u16_u8(vqtbl1q_u8(packed, msbShuffle));
+        uint16x8_t lsb = vandq_u16(vmulq_u16(vreinterpretq_u16_u8(vqtbl1q_u8(packed, lsbShuffle)), lsbScale), lsbMask);
+        vst1q_u16(dst + group * 2, vorrq_u16(msb, lsb));
+    }
+
+    UnpackRAW12gLineToRAW16(pSource + group * 3, dst + group * 2, width - group * 2);
+}
+
+#endif
+
+// Returns the line kernel of the 8 or 16 bit output
+static UnpackLineFunction GetScalarUnpacker(bool bSixteenBit)
+{
+    return bSixteenBit ? UnpackRAW12gLineToRAW16 : UnpackRAW12gLineToRAW8;
+}
+
+static UnpackLineFunction GetSimdUnpacker(bool bSixteenBit)
+{
+#if defined(TRANSFORM_USE_SSSE3)
+    if (0 != (ImageTransform::GetCpuFeatures() & CpuFeatureSSSE3))
+        return bSixteenBit ? UnpackRAW12gLineToRAW16Ssse3 : UnpackRAW12gLineToRAW8Ssse3;
+#elif defined(TRANSFORM_USE_NEON_TABLE)
+    return bSixteenBit ? UnpackRAW12gLineToRAW16Neon : UnpackRAW12gLineToRAW8Neon;
+#endif
+    return GetScalarUnpacker(bSixteenBit);
+}
+
+// The group wise kernels are compared once against the byte wise reference
+// (8 bit output) and the SIMD kernels against the scalar ones (both outputs).
+// The scalar kernels are used if any of them deviates.
+static bool ValidatePackedUnpackers()
+{
+    // several SIMD iterations plus a scalar tail, the reference needs whole groups
+    const uint32_t width = 4 * 23;
+    const uint32_t height = 3;
+    const uint32_t stride = width * 3 / 2;
+
+    std::vector<uint8_t> packed(stride * height);
+    for (size_t i = 0; i < packed.size(); i++)
+        packed[i] = static_cast<uint8_t>(i * 151 + (i >> 3) * 17);
+
+    std::vector<uint8_t> reference(width * height);
+    ReferenceRAW12gToRAW8(packed.data(), width, height, reference.data());
+
+    std::vector<uint16_t> scalar(width * height);
+    std::vector<uint16_t> simd(width * height);
+    for (int sixteenBit = 0; sixteenBit < 2; sixteenBit++)
+    {
+        UnpackLineFunction scalarUnpacker = GetScalarUnpacker(0 != sixteenBit);
+        UnpackLineFunction simdUnpacker = GetSimdUnpacker(0 != sixteenBit);
+        size_t lineBytes = width * (sixteenBit ? 2 : 1);
+        for (uint32_t y = 0; y < height; y++)
         {
-            if (((count + 1) % 2) != 0)
-            {
-                *destdata++ = *srcdata;
-            }
-            count++;
-            srcdata++;
+            scalarUnpacker(packed.data() + y * stride, reinterpret_cast<uint8_t *>(scalar.data()) + y * lineBytes, width);
+            simdUnpacker(packed.data() + y * stride, reinterpret_cast<uint8_t *>(simd.data()) + y * lineBytes, width);
+        }
+
+        size_t compareBytes = lineBytes * height;
+        if (0 != memcmp(scalar.data(), simd.data(), compareBytes) ||
+            (!sixteenBit && 0 != memcmp(scalar.data(), reference.data(), compareBytes)))
+        {
+            LOG_EX("ImageTransform::ValidatePackedUnpackers RAW12 unpacker of %d bit output deviates", sixteenBit ? 16 : 8);
+            return false;
         }
     }
+
+    LOG_EX("ImageTransform::ValidatePackedUnpackers OK");
+    return true;
+}
+
+// Unpacks a whole frame with the line kernel which fits the CPU. The source
+// stride is never smaller than the whole groups of a line. The tone table of
+// 8 bit output is applied to every line while it is still in the cache.
+static void UnpackPackedFrame(bool bSixteenBit, const uint8_t *pSource, uint32_t sourceStride,
+                              uint8_t *pDestination, uint32_t destinationStride, uint32_t width, uint32_t height,
+                              const uint8_t *toneTable)
+{
+    static const bool bSimdValid = ValidatePackedUnpackers();
+
+    UnpackLineFunction unpack = bSimdValid ? GetSimdUnpacker(bSixteenBit) : GetScalarUnpacker(bSixteenBit);
+
+    uint32_t minimumStride = ((width + 1) / 2) * 3;
+    sourceStride = std::max(sourceStride, minimumStride);
+
+    for (uint32_t y = 0; y < height; y++)
+    {
+        unpack(pSource + y * sourceStride, pDestination + y * destinationStride, width);
+        if (NULL != toneTable && !bSixteenBit)
+            tonemapping::ApplyTableToLine(toneTable, pDestination + y * destinationStride, width, 1);
+    }
 }
 
 void v4lconvert_bayer8_to_rgb24(const unsigned char *bayer, unsigned char *bgr,
                                 int width, int height,
-                                const unsigned int stride, unsigned int pixfmt);
+                                const unsigned int stride, unsigned int pixfmt,
+                                const uint8_t *toneTable);
 
-void  ConvertJetsonMono16ToRGB24(const void *sourceBuffer, uint32_t width, uint32_t height, QImage& dst, int shift)
+// Narrows 16 bit containers to 8 bit, every sample becomes (value >> shift) & 0xFF
+static void NarrowRAW16ToRAW8(const uint16_t *pSource, uint8_t *pDestination, uint32_t count, int shift)
 {
-    dst = QImage(width, height, QImage::Format_RGB888);
-    uint8_t *destdata = dst.bits();
-    uint16_t const *srcdata = reinterpret_cast<uint16_t const*>(sourceBuffer);
+    uint32_t i = 0;
+
+#if defined(TRANSFORM_USE_SSE2)
+    const __m128i shiftCount = _mm_cvtsi32_si128(shift);
+    const __m128i lowByteMask = _mm_set1_epi16(0x00FF);
 
-    for(unsigned int px = 0; px < width*height; ++px) {
-        uint8_t const val = (srcdata[px] >> shift) & 0xFF;
-        *destdata++ = val;
-        *destdata++ = val;
-        *destdata++ = val;
+    for (; i + 16 <= count; i += 16)
+    {
+        __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSource + i));
+        __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSource + i + 8));
+        first = _mm_and_si128(_mm_srl_epi16(first, shiftCount), lowByteMask);
+        second = _mm_and_si128(_mm_srl_epi16(second, shiftCount), lowByteMask);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pDestination + i), _mm_packus_epi16(first, second));
     }
-}
+#elif defined(TRANSFORM_USE_NEON)
+    const int16x8_t shiftCount = vdupq_n_s16(static_cast<int16_t>(-shift));
 
+    for (; i + 16 <= count; i += 16)
+    {
+        uint16x8_t first = vshlq_u16(vld1q_u16(pSource + i), shiftCount);
+        uint16x8_t second = vshlq_u16(vld1q_u16(pSource + i + 8), shiftCount);
+        // the narrowing keeps the low byte, as the mask of the scalar loop
+        vst1q_u8(pDestination + i, vcombine_u8(vmovn_u16(first), vmovn_u16(second)));
+    }
+#endif
 
+    for (; i < count; i++)
+    {
+        pDestination[i] = static_cast<uint8_t>((pSource[i] >> shift) & 0xFF);
+    }
+}
 
-void ConvertJetsonBayer16ToRGB24(const void *sourceBuffer, uint32_t width, uint32_t height, QImage& dst, int shift, unsigned int pixfmt)
+// Aligns 16 bit containers to the MSB, every sample becomes value << shift
+static void AlignRAW16ToRAW16(const uint16_t *pSource, uint16_t *pDestination, uint32_t count, int shift)
 {
-    uint8_t *destdata = g_ConversionBuffer1;
-    uint16_t const *srcdata = reinterpret_cast<uint16_t const*>(sourceBuffer);
+    uint32_t i = 0;
 
-    for(unsigned int px = 0; px < width*height; ++px) {
-        uint8_t const val = (srcdata[px] >> shift) & 0xFF;
-        *destdata++ = val;
+#if defined(TRANSFORM_USE_SSE2)
+    const __m128i shiftCount = _mm_cvtsi32_si128(shift);
+
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i value = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pSource + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(pDestination + i), _mm_sll_epi16(value, shiftCount));
     }
+#elif defined(TRANSFORM_USE_NEON)
+    const int16x8_t shiftCount = vdupq_n_s16(static_cast<int16_t>(shift));
 
-    dst = QImage(width, height, QImage::Format_RGB888);
-    v4lconvert_bayer8_to_rgb24(g_ConversionBuffer1, dst.bits(), width, height, width, pixfmt);
+    for (; i + 8 <= count; i += 8)
+    {
+        vst1q_u16(pDestination + i, vshlq_u16(vld1q_u16(pSource + i), shiftCount));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        pDestination[i] = static_cast<uint16_t>(pSource[i] << shift);
+    }
 }
 
 /* inspired by OpenCV's Bayer decoding */
@@ -339,21 +508,25 @@ static void v4lconvert_border_bayer8_line_to_bgr24(const unsigned char *bayer, c
     }
 }
 
-/* From libdc1394, which on turn was based on OpenCV's Bayer decoding */
+/* From libdc1394, which on turn was based on OpenCV's Bayer decoding.
+   The tone table is applied to every rendered line while it is in the cache */
 static void bayer8_to_rgbbgr24(const unsigned char *bayer, unsigned char *bgr,
                                int width, int height, const unsigned int stride,
                                unsigned int pixfmt, int start_with_green,
-                               int blue_line)
+                               int blue_line, const uint8_t *toneTable)
 {
     /* render the first line */
     v4lconvert_border_bayer8_line_to_bgr24(bayer, bayer + stride, bgr, width,
                                            start_with_green, blue_line);
+    if (NULL != toneTable)
+        tonemapping::ApplyTableToLine(toneTable, bgr, width, 3);
     bgr += width * 3;
 
     /* reduce height by 2 because of the special case top/bottom line */
     for (height -= 2; height; height--)
     {
         int t0, t1;
+        unsigned char *line = bgr;
         /* (width - 2) because of the border */
         const unsigned char *bayer_end = bayer + (width - 2);
 
@@ -510,6 +683,9 @@ static void bayer8_to_rgbbgr24(const unsigned char *bayer, unsigned char *bgr,
             }
         }
 
+        if (NULL != toneTable)
+            tonemapping::ApplyTableToLine(toneTable, line, width, 3);
+
         /* skip 2 border pixels and padding */
         bayer += (stride - width) + 2;
 
@@ -520,21 +696,26 @@ static void bayer8_to_rgbbgr24(const unsigned char *bayer, unsigned char *bgr,
     /* render the last line */
     v4lconvert_border_bayer8_line_to_bgr24(bayer + stride, bayer, bgr, width,
                                            !start_with_green, !blue_line);
+    if (NULL != toneTable)
+        tonemapping::ApplyTableToLine(toneTable, bgr, width, 3);
 }
 
 void v4lconvert_bayer8_to_rgb24(const unsigned char *bayer, unsigned char *bgr,
                                 int width, int height,
-                                const unsigned int stride, unsigned int pixfmt)
+                                const unsigned int stride, unsigned int pixfmt,
+                                const uint8_t *toneTable)
 {
     bayer8_to_rgbbgr24(bayer, bgr, width, height, stride, pixfmt,
                        pixfmt == V4L2_PIX_FMT_SGBRG8 /* start with green */
                            || pixfmt == V4L2_PIX_FMT_SGRBG8,
                        pixfmt != V4L2_PIX_FMT_SBGGR8 /* blue line */
-                           && pixfmt != V4L2_PIX_FMT_SGBRG8);
+                           && pixfmt != V4L2_PIX_FMT_SGBRG8,
+                       toneTable);
 }
 
+/* the tone table maps the sample once before it is replicated */
 void v4lconvert_grey_to_rgb24(const unsigned char *src, unsigned char *dest,
-                              int width, int height)
+                              int width, int height, const uint8_t *toneTable)
 {
     int j;
 
@@ -542,9 +723,10 @@ void v4lconvert_grey_to_rgb24(const unsigned char *src, unsigned char *dest,
     {
         for (j = 0; j < width; j++)
         {
-            *dest++ = *src;
-            *dest++ = *src;
-            *dest++ = *src;
+            unsigned char value = (NULL != toneTable) ? toneTable[*src] : *src;
+            *dest++ = value;
+            *dest++ = value;
+            *dest++ = value;
             src++;
         }
     }
@@ -566,9 +748,10 @@ void v4lconvert_swap_rgb(const unsigned char *src, unsigned char *dst,
     }
 }
 
+// The chroma order is a template parameter, so there is no per pixel format test
+template <bool isVYUY>
 void v4lconvert_uyvy_to_rgb24(const unsigned char *src, unsigned char *dest,
-                              int width, int height, int stride,
-                              unsigned int pixfmt)
+                              int width, int height, int stride)
 {
     int j;
 
@@ -576,19 +759,8 @@ void v4lconvert_uyvy_to_rgb24(const unsigned char *src, unsigned char *dest,
     {
         for (j = 0; j + 1 < width; j += 2)
         {
-
-            int u, v;
-
-            if (pixfmt == V4L2_PIX_FMT_UYVY)
-            {
-                u = src[0];
-                v = src[2];
-            }
-            else if (pixfmt == V4L2_PIX_FMT_VYUY)
-            {
-                u = src[2];
-                v = src[0];
-            }
+            int u = isVYUY ? src[2] : src[0];
+            int v = isVYUY ? src[0] : src[2];
 
             int u1 = (((u - 128) << 7) + (u - 128)) >> 6;
             int rg = (((u - 128) << 1) + (u - 128) + ((v - 128) << 2) +
@@ -768,16 +940,397 @@ void v4lconvert_remove_padding(const uint8_t **src,
     *src = conversionBuffer->data();
 }
 
-int ImageTransform::ConvertFrame(const uint8_t *pBuffer, uint32_t length,
-                                 uint32_t width, uint32_t height,
-                                 uint32_t pixelFormat, uint32_t &payloadSize,
-                                 uint32_t &bytesPerLine, QImage &convertedImage)
+
+/*********************************************************************************************************/
+// Conversion kernels which are selected by the conversion plan
+/*********************************************************************************************************/
+
+static const uint8_t *RemovePadding(ConversionPlan &plan, const uint8_t *pBuffer, int bytesPerPixel)
 {
-    int result = 0;
+    if (plan.bRemovePadding)
+    {
+        v4lconvert_remove_padding(&pBuffer, &plan.conversionBuffer, plan.width, plan.height,
+                                  bytesPerPixel, plan.bytesPerLine);
+    }
 
-    if (NULL == pBuffer || 0 == length)
-        return -1;
+    return pBuffer;
+}
+
+static void PlanConvertXBGR32(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    pBuffer = RemovePadding(plan, pBuffer, 4);
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_ARGB32);
+    memcpy(convertedImage.bits(), pBuffer, plan.width * plan.height * 4);
+}
+
+static void PlanConvertXRGB32(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    pBuffer = RemovePadding(plan, pBuffer, 4);
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB888);
+    v4lconvert_xrgb32_to_rgb32(pBuffer, convertedImage.bits(), plan.width, plan.height);
+}
+
+static void PlanConvertJPEG(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    if (0 != plan.pMjpegDecoder->Decode(pBuffer, plan.frameLength, plan.scaleDenominator,
+                                        plan.pToneTable, convertedImage))
+        convertedImage = QImage();
+}
+
+static void PlanConvertRGB565(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB888);
+    v4lconvert_rgb565_to_rgb24(pBuffer, convertedImage.bits(), plan.width, plan.height);
+}
+
+static void PlanConvertBGR24(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB888);
+    v4lconvert_swap_rgb(pBuffer, convertedImage.bits(), plan.width, plan.height);
+}
+
+template <bool isVYUY>
+static void PlanConvertUYVYApproximate(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB888);
+    v4lconvert_uyvy_to_rgb24<isVYUY>(pBuffer, convertedImage.bits(), plan.width, plan.height,
+                                     plan.bytesPerLine);
+}
+
+static void PlanConvertYUYVApproximate(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB888);
+    v4lconvert_yuyv_to_rgb24(pBuffer, convertedImage.bits(), plan.width, plan.height,
+                             plan.bytesPerLine);
+}
+
+static void PlanConvertYUV420Approximate(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB888);
+    v4lconvert_yuv420_to_rgb24(pBuffer, convertedImage.bits(), plan.width, plan.height, 1);
+}
+
+typedef void (*PackedYuvFunction)(const yuvconversion::Coefficients &coefficients,
+                                  const uint8_t *src, uint32_t srcStride,
+                                  uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                                  const uint8_t *toneTable);
+
+template <PackedYuvFunction convert>
+static void PlanConvertPackedYuv(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB32);
+    convert(plan.yuvCoefficients, pBuffer, plan.bytesPerLine,
+            convertedImage.bits(), convertedImage.bytesPerLine(), plan.width, plan.height, plan.pToneTable);
+}
+
+template <bool isYVU>
+static void PlanConvertPlanar420(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    const uint8_t *pFirstChroma = pBuffer + plan.planeOffset[1];
+    const uint8_t *pSecondChroma = pBuffer + plan.planeOffset[2];
+
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB32);
+    yuvconversion::ConvertPlanar420ToRGB32(plan.yuvCoefficients, pBuffer + plan.planeOffset[0], plan.planeStride[0],
+                                           isYVU ? pSecondChroma : pFirstChroma,
+                                           isYVU ? pFirstChroma : pSecondChroma, plan.planeStride[1],
+                                           convertedImage.bits(), convertedImage.bytesPerLine(),
+                                           plan.width, plan.height, plan.pToneTable);
+}
+
+template <bool crFirst, bool verticalSubsampling>
+static void PlanConvertSemiPlanar(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB32);
+    yuvconversion::ConvertSemiPlanarToRGB32(plan.yuvCoefficients,
+                                            pBuffer + plan.planeOffset[0], plan.planeStride[0],
+                                            pBuffer + plan.planeOffset[1], plan.planeStride[1],
+                                            crFirst, verticalSubsampling,
+                                            convertedImage.bits(), convertedImage.bytesPerLine(),
+                                            plan.width, plan.height, plan.pToneTable);
+}
+
+static void PlanConvertRGB24(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB888);
+    memcpy(convertedImage.bits(), pBuffer, plan.width * plan.height * 3);
+}
+
+static void PlanConvertRGB32(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB32);
+    memcpy(convertedImage.bits(), pBuffer, plan.width * plan.height * 4);
+}
+
+static void PlanConvertGrey(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    pBuffer = RemovePadding(plan, pBuffer, 1);
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB888);
+    v4lconvert_grey_to_rgb24(pBuffer, convertedImage.bits(), plan.width, plan.height, plan.pToneTable);
+}
+
+static void PlanConvertBayer8(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    pBuffer = RemovePadding(plan, pBuffer, 1);
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB888);
+    v4lconvert_bayer8_to_rgb24(pBuffer, convertedImage.bits(), plan.width, plan.height,
+                               plan.width, plan.bayerPixelFormat, plan.pToneTable);
+}
+
+static void PlanConvertMono12g(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_Grayscale8);
+    UnpackPackedFrame(false, pBuffer, plan.bytesPerLine,
+                      convertedImage.bits(), convertedImage.bytesPerLine(), plan.width, plan.height,
+                      plan.pToneTable);
+}
+
+static void PlanConvertBayer12g(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    // the table is applied after demosaicing, as for the 8 bit bayer formats
+    UnpackPackedFrame(false, pBuffer, plan.bytesPerLine,
+                      plan.conversionBuffer.data(), plan.width, plan.width, plan.height, NULL);
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB888);
+    v4lconvert_bayer8_to_rgb24(plan.conversionBuffer.data(), convertedImage.bits(),
+                               plan.width, plan.height, plan.width, plan.bayerPixelFormat, plan.pToneTable);
+}
+
+/*********************************************************************************************************/
+// 16 bit container and high bit depth kernels
+/*********************************************************************************************************/
+
+#if QT_VERSION >= QT_VERSION_CHECK(5,13,0)
+#define HIGH_BIT_DEPTH_SUPPORTED
+#endif
+
+// Returns the colors of the 2x2 bayer cell, 0 = red, 1 = green, 2 = blue
+static void GetBayerPattern(uint32_t bayerPixelFormat, int pattern[4])
+{
+    switch (bayerPixelFormat)
+    {
+    case V4L2_PIX_FMT_SBGGR8: pattern[0] = 2; pattern[1] = 1; pattern[2] = 1; pattern[3] = 0; break;
+    case V4L2_PIX_FMT_SGBRG8: pattern[0] = 1; pattern[1] = 2; pattern[2] = 0; pattern[3] = 1; break;
+    case V4L2_PIX_FMT_SGRBG8: pattern[0] = 1; pattern[1] = 0; pattern[2] = 2; pattern[3] = 1; break;
+    default:                  pattern[0] = 0; pattern[1] = 1; pattern[2] = 1; pattern[3] = 2; break;
+    }
+}
+
+// Bilinear demosaicing of one line. The neighbour lines are mirrored at the
+// image borders, so they keep the cell pattern. The destination gets R, G, B
+// and for four channels an opaque padding sample.
+template <typename Sample, typename Destination, int channels>
+static void DemosaicLine(const Sample *up, const Sample *line, const Sample *down,
+                         int width, int y, const int pattern[4], Destination *dst, Destination opaque)
+{
+    const int *linePattern = pattern + (y & 1) * 2;
+
+    for (int x = 0; x < width; x++, dst += channels)
+    {
+        int left = (x > 0) ? x - 1 : x + 1;
+        int right = (x < width - 1) ? x + 1 : x - 1;
+        int color = linePattern[x & 1];
+
+        uint32_t self = line[x];
+        if (1 != color)
+        {
+            dst[color] = static_cast<Destination>(self);
+            dst[1] = static_cast<Destination>((line[left] + line[right] + up[x] + down[x] + 2) >> 2);
+            dst[2 - color] = static_cast<Destination>((up[left] + up[right] + down[left] + down[right] + 2) >> 2);
+        }
+        else
+        {
+            // the horizontal neighbours of a green sample have the color of its line
+            int lineColor = linePattern[(x + 1) & 1];
+            dst[1] = static_cast<Destination>(self);
+            dst[lineColor] = static_cast<Destination>((line[left] + line[right] + 1) >> 1);
+            dst[2 - lineColor] = static_cast<Destination>((up[x] + down[x] + 1) >> 1);
+        }
+        if (4 == channels)
+            dst[3] = opaque;
+    }
+}
+
+// Bilinear demosaicing of MSB aligned 16 bit bayer data to RGBX64 (R, G, B, X halfwords)
+static void DemosaicRAW16ToRGBX64(const uint16_t *pRaw, uint32_t width, uint32_t height,
+                                  uint32_t bayerPixelFormat, uint16_t *pDestination, uint32_t destinationStride)
+{
+    int pattern[4];
+    GetBayerPattern(bayerPixelFormat, pattern);
+
+    int w = static_cast<int>(width);
+    int h = static_cast<int>(height);
+
+    for (int y = 0; y < h; y++)
+    {
+        const uint16_t *up = pRaw + ((y > 0) ? y - 1 : y + 1) * w;
+        const uint16_t *down = pRaw + ((y < h - 1) ? y + 1 : y - 1) * w;
+        DemosaicLine<uint16_t, uint16_t, 4>(up, pRaw + y * w, down, w, y, pattern,
+                                            pDestination + y * destinationStride, 0xFFFF);
+    }
+}
+
+// Collects which bits of the 16 bit containers are in use. Every 7th sample
+// is taken, so all colors of a bayer pattern are covered.
+static void AccumulateBitUsage(ConversionPlan &plan, const uint8_t *pBuffer)
+{
+    const uint16_t *pSource = reinterpret_cast<const uint16_t *>(pBuffer);
+    uint32_t count = plan.width * plan.height;
+
+    for (uint32_t i = 0; i < count; i += 7)
+    {
+        uint32_t value = pSource[i];
+        for (int bit = 0; value != 0; bit++, value >>= 1)
+            plan.bitUsage[bit] += (value & 1);
+        plan.bitUsageSamples++;
+    }
+
+    if (0 != --plan.autoShiftFrames)
+        return;
+
+    // The lowest bit which toggles with the noise is the LSB of the data.
+    // The highest bit seen in the image is a lower bound of its MSB, which
+    // matters for containers that replicate the MSBs into the padding.
+    int lsb = -1;
+    int msb = -1;
+    for (int bit = 0; bit < 16; bit++)
+    {
+        if (-1 == lsb && plan.bitUsage[bit] >= plan.bitUsageSamples / 100)
+            lsb = bit;
+        if (0 < plan.bitUsage[bit] && plan.bitUsage[bit] >= plan.bitUsageSamples / 1000)
+            msb = bit;
+    }
+
+    if (-1 == lsb || -1 == msb)
+    {
+        LOG_EX("ImageTransform::AccumulateBitUsage no signal, keeping shift %d", plan.shift);
+        return;
+    }
+
+    msb = std::min(15, std::max(msb, lsb + static_cast<int>(plan.bitDepth) - 1));
+    int shift = std::max(0, msb - 7);
+    LOG_EX("ImageTransform::AccumulateBitUsage data in bits %d..%d, shift %d (was %d)", msb, lsb, shift, plan.shift);
+    plan.shift = shift;
+}
+
+static void PlanConvertJetsonMono16(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    if (0 != plan.autoShiftFrames)
+        AccumulateBitUsage(plan, pBuffer);
+
+    const uint16_t *pSource = reinterpret_cast<const uint16_t *>(pBuffer);
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_Grayscale8);
+    for (uint32_t y = 0; y < plan.height; y++)
+    {
+        NarrowRAW16ToRAW8(pSource + y * plan.width, convertedImage.scanLine(y), plan.width, plan.shift);
+        if (NULL != plan.pToneTable)
+            tonemapping::ApplyTableToLine(plan.pToneTable, convertedImage.scanLine(y), plan.width, 1);
+    }
+}
+
+// Demosaicing straight from the 16 bit containers. Every source line is
+// converted once into a ring of three lines, which stays in the cache.
+template <typename Sample, typename Destination, int channels>
+static void DemosaicContainerRAW16(ConversionPlan &plan, const uint8_t *pBuffer, uint8_t *pDestination,
+                                   uint32_t destinationStride, Destination opaque)
+{
+    const uint16_t *pSource = reinterpret_cast<const uint16_t *>(pBuffer);
+    Sample *ring[3];
+    for (int i = 0; i < 3; i++)
+        ring[i] = reinterpret_cast<Sample *>(plan.conversionBuffer.data()) + i * plan.width;
+
+    int pattern[4];
+    GetBayerPattern(plan.bayerPixelFormat, pattern);
+
+    int w = static_cast<int>(plan.width);
+    int h = static_cast<int>(plan.height);
+
+    for (int y = -1; y < h; y++)
+    {
+        // the line below the current one enters the ring first
+        if (y + 1 < h)
+        {
+            if (1 == sizeof(Sample))
+                NarrowRAW16ToRAW8(pSource + (y + 1) * w, reinterpret_cast<uint8_t *>(ring[(y + 1) % 3]), w, plan.shift);
+            else
+                AlignRAW16ToRAW16(pSource + (y + 1) * w, reinterpret_cast<uint16_t *>(ring[(y + 1) % 3]), w,
+                                  std::max(0, 8 - plan.shift));
+        }
+        if (y < 0)
+            continue;
+
+        const Sample *up = ring[((y > 0) ? y - 1 : y + 1) % 3];
+        const Sample *down = ring[((y < h - 1) ? y + 1 : y - 1) % 3];
+        DemosaicLine<Sample, Destination, channels>(up, ring[y % 3], down, w, y, pattern,
+                                                    reinterpret_cast<Destination *>(pDestination + y * destinationStride),
+                                                    opaque);
+        // 16 bit output gets the table folded into its window/level instead
+        if (NULL != plan.pToneTable && 1 == sizeof(Destination))
+            tonemapping::ApplyTableToLine(plan.pToneTable, pDestination + y * destinationStride, w, channels);
+    }
+}
 
+static void PlanConvertJetsonBayer16(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    if (0 != plan.autoShiftFrames)
+        AccumulateBitUsage(plan, pBuffer);
+
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGB888);
+    DemosaicContainerRAW16<uint8_t, uint8_t, 3>(plan, pBuffer, convertedImage.bits(),
+                                                convertedImage.bytesPerLine(), 0);
+}
+
+#if defined(HIGH_BIT_DEPTH_SUPPORTED)
+
+static void PlanConvertMono12gTo16(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_Grayscale16);
+    UnpackPackedFrame(true, pBuffer, plan.bytesPerLine,
+                      convertedImage.bits(), convertedImage.bytesPerLine(), plan.width, plan.height, NULL);
+}
+
+static void PlanConvertJetsonMono16To16(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    if (0 != plan.autoShiftFrames)
+        AccumulateBitUsage(plan, pBuffer);
+
+    const uint16_t *pSource = reinterpret_cast<const uint16_t *>(pBuffer);
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_Grayscale16);
+    for (uint32_t y = 0; y < plan.height; y++)
+    {
+        // the 8 bit preview uses the bits [shift + 7 : shift], they become the MSBs
+        AlignRAW16ToRAW16(pSource + y * plan.width, reinterpret_cast<uint16_t *>(convertedImage.scanLine(y)),
+                          plan.width, std::max(0, 8 - plan.shift));
+    }
+}
+
+static void PlanConvertBayer12gTo16(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    uint16_t *pRaw = reinterpret_cast<uint16_t *>(plan.conversionBuffer.data());
+    UnpackPackedFrame(true, pBuffer, plan.bytesPerLine,
+                      plan.conversionBuffer.data(), plan.width * 2, plan.width, plan.height, NULL);
+
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGBX64);
+    DemosaicRAW16ToRGBX64(pRaw, plan.width, plan.height, plan.bayerPixelFormat,
+                          reinterpret_cast<uint16_t *>(convertedImage.bits()), convertedImage.bytesPerLine() / 2);
+}
+
+static void PlanConvertJetsonBayer16To16(ConversionPlan &plan, const uint8_t *pBuffer, QImage &convertedImage)
+{
+    if (0 != plan.autoShiftFrames)
+        AccumulateBitUsage(plan, pBuffer);
+
+    convertedImage = QImage(plan.width, plan.height, QImage::Format_RGBX64);
+    DemosaicContainerRAW16<uint16_t, uint16_t, 4>(plan, pBuffer, convertedImage.bits(),
+                                                  convertedImage.bytesPerLine(), 0xFFFF);
+}
+
+#endif
+
+/*********************************************************************************************************/
+// Plan creation
+/*********************************************************************************************************/
+
+static void DetectSocShifts()
+{
     if (g_shift10Bit == -1 || g_shift12Bit == -1)
     {
         const int tegraShift10Bit = 2;
@@ -817,299 +1370,732 @@ int ImageTransform::ConvertFrame(const uint8_t *pBuffer, uint32_t length,
             g_shift12Bit = tegraShift12Bit;
         }
     }
+}
 
-    std::vector<uint8_t> conversionBuffer;
+// Returns the significant bits of the 16 bit container formats
+static uint32_t GetContainerBitDepth(uint32_t pixelFormat)
+{
+    switch (pixelFormat)
+    {
+    case V4L2_PIX_FMT_XAVIER_Y10:
+    case V4L2_PIX_FMT_XAVIER_SGRBG10:
+    case V4L2_PIX_FMT_XAVIER_SRGGB10:
+    case V4L2_PIX_FMT_XAVIER_SGBRG10:
+    case V4L2_PIX_FMT_XAVIER_SBGGR10:
+    case V4L2_PIX_FMT_TX2_Y10:
+    case V4L2_PIX_FMT_TX2_SGRBG10:
+    case V4L2_PIX_FMT_TX2_SRGGB10:
+    case V4L2_PIX_FMT_TX2_SGBRG10:
+    case V4L2_PIX_FMT_TX2_SBGGR10:
+    case V4L2_PIX_FMT_Y10:
+    case V4L2_PIX_FMT_SGRBG10:
+    case V4L2_PIX_FMT_SRGGB10:
+    case V4L2_PIX_FMT_SGBRG10:
+    case V4L2_PIX_FMT_SBGGR10:
+    case V4L2_PIX_FMT_Y10P:
+    case V4L2_PIX_FMT_SGRBG10P:
+    case V4L2_PIX_FMT_SRGGB10P:
+    case V4L2_PIX_FMT_SGBRG10P:
+    case V4L2_PIX_FMT_SBGGR10P:
+        return 10;
+    default:
+        return 12;
+    }
+}
+
+static uint32_t DetectCpuFeatures()
+{
+    uint32_t features = CpuFeatureNone;
+
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        features |= CpuFeatureSSE2;
+    if (__builtin_cpu_supports("ssse3"))
+        features |= CpuFeatureSSSE3;
+    if (__builtin_cpu_supports("avx2"))
+        features |= CpuFeatureAVX2;
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    features |= CpuFeatureNEON;
+#endif
+
+    return features;
+}
+
+uint32_t ImageTransform::GetCpuFeatures()
+{
+    static const uint32_t cpuFeatures = DetectCpuFeatures();
+
+    return cpuFeatures;
+}
+
+// The fixed point kernels are checked once per matrix and range against the
+// floating point reference, a deviation is only reported in the log
+static void ValidateYuvKernels(yuvconversion::ColorMatrix colorMatrix, yuvconversion::ColorRange colorRange)
+{
+    static bool validated[4][3] = {};
+
+    if (!validated[colorMatrix][colorRange])
+    {
+        int maxDeviation = 0;
+        int result = yuvconversion::ValidateKernels(colorMatrix, colorRange, maxDeviation);
+
+        LOG_EX("ImageTransform::ValidateYuvKernels %s kernel matrix=%d range=%d max deviation=%d %s",
+               yuvconversion::GetKernelName(), colorMatrix, colorRange, maxDeviation,
+               (0 == result) ? "OK" : "exceeds tolerance");
+        validated[colorMatrix][colorRange] = true;
+    }
+}
+
+int ImageTransform::CreateConversionPlan(uint32_t pixelFormat, uint32_t width, uint32_t height,
+                                         uint32_t bytesPerLine, uint32_t payloadSize,
+                                         yuvconversion::ColorMatrix colorMatrix,
+                                         yuvconversion::ColorRange colorRange,
+                                         bool bHighBitDepth,
+                                         ConversionPlan &plan)
+{
+    DetectSocShifts();
+
+    // without driver information YCbCr data is treated as BT.601 limited range
+    if (yuvconversion::ColorMatrixAuto == colorMatrix)
+        colorMatrix = yuvconversion::ColorMatrixBT601;
+    if (yuvconversion::ColorRangeAuto == colorRange)
+        colorRange = yuvconversion::ColorRangeLimited;
+
+    plan.pixelFormat = pixelFormat;
+    plan.width = width;
+    plan.height = height;
+    plan.bytesPerLine = bytesPerLine;
+    plan.payloadSize = payloadSize;
+    plan.frameLength = payloadSize;
+    plan.bayerPixelFormat = 0;
+    plan.shift = 0;
+    plan.bRemovePadding = false;
+    plan.cpuFeatures = GetCpuFeatures();
+    plan.bHighBitDepth = false;
+    plan.bitDepth = 8;
+    plan.autoShiftFrames = 0;
+    memset(plan.bitUsage, 0, sizeof(plan.bitUsage));
+    plan.bitUsageSamples = 0;
+    plan.planeCount = 1;
+    memset(plan.planeOffset, 0, sizeof(plan.planeOffset));
+    memset(plan.planeStride, 0, sizeof(plan.planeStride));
+    plan.planeStride[0] = bytesPerLine;
+    plan.colorMatrix = colorMatrix;
+    plan.colorRange = colorRange;
+    memset(&plan.yuvCoefficients, 0, sizeof(plan.yuvCoefficients));
+    plan.pMjpegDecoder.clear();
+    plan.scaleDenominator = 1;
+    plan.maxWorkerCount = 1;
+    plan.pToneTable = NULL;
+    plan.bFusedToneTable = false;
+    plan.convertFunction = NULL;
+
+    bool bUseApproximateYuv = (yuvconversion::ColorMatrixApproximate == colorMatrix);
+    if (!bUseApproximateYuv)
+        yuvconversion::GetCoefficients(colorMatrix, colorRange, plan.yuvCoefficients);
+    plan.conversionBuffer.clear();
+
+    // Bytes per pixel of the formats whose line padding is removed before converting
+    uint32_t paddedBytesPerPixel = 0;
+    // Multi-stage conversions need an 8 bit intermediate image
+    bool bNeedsRaw8Buffer = false;
+    // YCbCr formats converted with the matrix kernels
+    bool bUsesYuvMatrix = false;
 
     switch (pixelFormat)
     {
     case V4L2_PIX_FMT_XBGR32:
     case V4L2_PIX_FMT_ABGR32:
-        {
-            int bytesPerPixel = 4;
-            v4lconvert_remove_padding (&pBuffer, &conversionBuffer, width, height, bytesPerPixel, bytesPerLine);
-            convertedImage = QImage (width, height, QImage::Format_ARGB32);
-            unsigned char *dst = convertedImage.bits ();
-            memcpy (dst, pBuffer, width * height * bytesPerPixel);
-        }
+        plan.convertFunction = PlanConvertXBGR32;
+        paddedBytesPerPixel = 4;
         break;
 
     case V4L2_PIX_FMT_XRGB32:
-        {
-            v4lconvert_remove_padding(&pBuffer, &conversionBuffer, width, height, 4,
-                                      bytesPerLine);
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_xrgb32_to_rgb32(pBuffer, convertedImage.bits(), width,
-                                       height);
-        }
+        plan.convertFunction = PlanConvertXRGB32;
+        paddedBytesPerPixel = 4;
         break;
 
     case V4L2_PIX_FMT_JPEG:
     case V4L2_PIX_FMT_MJPEG:
-        {
-            QPixmap pix;
-            pix.loadFromData(pBuffer, payloadSize, "JPG");
-            convertedImage = pix.toImage();
-        }
+        plan.convertFunction = PlanConvertJPEG;
+        plan.pMjpegDecoder = QSharedPointer<MjpegDecoder>(new MjpegDecoder());
+        // frames are independent, so several of them can be decoded at once
+        plan.maxWorkerCount = MAX_DECODE_WORKERS;
+        plan.bFusedToneTable = true;
         break;
     case V4L2_PIX_FMT_RGB565:
-        {
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_rgb565_to_rgb24(pBuffer, convertedImage.bits(), width,
-                                       height);
-        }
+        plan.convertFunction = PlanConvertRGB565;
         break;
     case V4L2_PIX_FMT_BGR24:
-        {
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_swap_rgb(pBuffer, convertedImage.bits(), width, height);
-        }
+        plan.convertFunction = PlanConvertBGR24;
         break;
-    case V4L2_PIX_FMT_VYUY:
     case V4L2_PIX_FMT_UYVY:
-        {
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_uyvy_to_rgb24(pBuffer, convertedImage.bits(), width, height,
-                                     bytesPerLine, pixelFormat);
-        }
+        plan.convertFunction = bUseApproximateYuv ? PlanConvertUYVYApproximate<false>
+                                                  : PlanConvertPackedYuv<yuvconversion::ConvertUYVYToRGB32>;
+        bUsesYuvMatrix = !bUseApproximateYuv;
+        break;
+    case V4L2_PIX_FMT_VYUY:
+        plan.convertFunction = bUseApproximateYuv ? PlanConvertUYVYApproximate<true>
+                                                  : PlanConvertPackedYuv<yuvconversion::ConvertVYUYToRGB32>;
+        bUsesYuvMatrix = !bUseApproximateYuv;
         break;
     case V4L2_PIX_FMT_YUYV:
-        {
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_yuyv_to_rgb24(pBuffer, convertedImage.bits(), width, height,
-                                     bytesPerLine);
-        }
+        plan.convertFunction = bUseApproximateYuv ? PlanConvertYUYVApproximate
+                                                  : PlanConvertPackedYuv<yuvconversion::ConvertYUYVToRGB32>;
+        bUsesYuvMatrix = !bUseApproximateYuv;
+        break;
+    case V4L2_PIX_FMT_YVYU:
+        plan.convertFunction = PlanConvertPackedYuv<yuvconversion::ConvertYVYUToRGB32>;
+        bUsesYuvMatrix = true;
         break;
     case V4L2_PIX_FMT_YUV420:
-        {
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_yuv420_to_rgb24(pBuffer, convertedImage.bits(), width,
-                                       height, 1);
-        }
+    case V4L2_PIX_FMT_YUV420M:
+        plan.convertFunction = (bUseApproximateYuv && V4L2_PIX_FMT_YUV420 == pixelFormat)
+                               ? PlanConvertYUV420Approximate : PlanConvertPlanar420<false>;
+        bUsesYuvMatrix = (plan.convertFunction != PlanConvertYUV420Approximate);
+        plan.planeCount = 3;
+        break;
+    case V4L2_PIX_FMT_YVU420:
+    case V4L2_PIX_FMT_YVU420M:
+        plan.convertFunction = PlanConvertPlanar420<true>;
+        bUsesYuvMatrix = true;
+        plan.planeCount = 3;
+        break;
+    case V4L2_PIX_FMT_NV12:
+    case V4L2_PIX_FMT_NV12M:
+        plan.convertFunction = PlanConvertSemiPlanar<false, true>;
+        bUsesYuvMatrix = true;
+        plan.planeCount = 2;
+        break;
+    case V4L2_PIX_FMT_NV21:
+    case V4L2_PIX_FMT_NV21M:
+        plan.convertFunction = PlanConvertSemiPlanar<true, true>;
+        bUsesYuvMatrix = true;
+        plan.planeCount = 2;
+        break;
+    case V4L2_PIX_FMT_NV16:
+    case V4L2_PIX_FMT_NV16M:
+        plan.convertFunction = PlanConvertSemiPlanar<false, false>;
+        bUsesYuvMatrix = true;
+        plan.planeCount = 2;
+        break;
+    case V4L2_PIX_FMT_NV61:
+    case V4L2_PIX_FMT_NV61M:
+        plan.convertFunction = PlanConvertSemiPlanar<true, false>;
+        bUsesYuvMatrix = true;
+        plan.planeCount = 2;
         break;
     case V4L2_PIX_FMT_RGB24:
-        {
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            memcpy(convertedImage.bits(), pBuffer, width * height * 3);
-        }
+        plan.convertFunction = PlanConvertRGB24;
         break;
     case V4L2_PIX_FMT_RGB32:
     case V4L2_PIX_FMT_BGR32:
-        {
-            convertedImage = QImage(width, height, QImage::Format_RGB32);
-            memcpy(convertedImage.bits(), pBuffer, width * height * 4);
-        }
+        plan.convertFunction = PlanConvertRGB32;
         break;
     case V4L2_PIX_FMT_GREY:
-        {
-            v4lconvert_remove_padding(&pBuffer, &conversionBuffer, width, height, 1,
-                                      bytesPerLine);
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_grey_to_rgb24(pBuffer, convertedImage.bits(), width, height);
-        }
+        plan.convertFunction = PlanConvertGrey;
+        paddedBytesPerPixel = 1;
         break;
     case V4L2_PIX_FMT_SBGGR8:
     case V4L2_PIX_FMT_SGBRG8:
     case V4L2_PIX_FMT_SGRBG8:
     case V4L2_PIX_FMT_SRGGB8:
-        {
-            v4lconvert_remove_padding(&pBuffer, &conversionBuffer, width, height, 1,
-                                      bytesPerLine);
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_bayer8_to_rgb24(pBuffer, convertedImage.bits(), width,
-                                       height, width, pixelFormat);
-        }
+        plan.convertFunction = PlanConvertBayer8;
+        plan.bayerPixelFormat = pixelFormat;
+        paddedBytesPerPixel = 1;
         break;
 
     /* L&T */
-    /* 10bit raw bayer packed, 5 bytes for every 4 pixels */
+    /* 10bit raw, the capture delivers it MSB aligned in 16 bit containers,
+       so it is read by the container kernels instead of being repacked */
     case V4L2_PIX_FMT_Y10P:
-        {
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            ConvertMono10gToRGB24(pBuffer, width, height, convertedImage.bits());
-            break;
-        }
+        plan.convertFunction = PlanConvertJetsonMono16;
+        plan.shift = 8;
+        break;
     case V4L2_PIX_FMT_SBGGR10P:
-        {
-            ConvertRAW10gToRAW8(pBuffer, width, height, g_ConversionBuffer1);
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_bayer8_to_rgb24(g_ConversionBuffer1, convertedImage.bits(),
-                                       width, height, width,
-                                       V4L2_PIX_FMT_SBGGR8);
-            break;
-        }
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SBGGR8;
+        plan.shift = 8;
+        break;
     case V4L2_PIX_FMT_SGBRG10P:
-        {
-            ConvertRAW10gToRAW8(pBuffer, width, height, g_ConversionBuffer1);
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_bayer8_to_rgb24(g_ConversionBuffer1, convertedImage.bits(),
-                                       width, height, width,
-                                       V4L2_PIX_FMT_SGBRG8);
-            break;
-        }
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SGBRG8;
+        plan.shift = 8;
+        break;
     case V4L2_PIX_FMT_SGRBG10P:
-        {
-            ConvertRAW10gToRAW8(pBuffer, width, height, g_ConversionBuffer1);
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_bayer8_to_rgb24(g_ConversionBuffer1, convertedImage.bits(),
-                                       width, height, width,
-                                       V4L2_PIX_FMT_SGRBG8);
-            break;
-        }
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SGRBG8;
+        plan.shift = 8;
+        break;
     case V4L2_PIX_FMT_SRGGB10P:
-        {
-            ConvertRAW10gToRAW8(pBuffer, width, height, g_ConversionBuffer1);
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_bayer8_to_rgb24(g_ConversionBuffer1, convertedImage.bits(),
-                                       width, height, width,
-                                       V4L2_PIX_FMT_SRGGB8);
-            break;
-        }
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SRGGB8;
+        plan.shift = 8;
+        break;
 
     /* 12bit raw bayer packed, 6 bytes for every 4 pixels */
     case V4L2_PIX_FMT_GREY12P:
     case V4L2_PIX_FMT_Y12P:
-        {
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            ConvertMono12gToRGB24(pBuffer, width, height, convertedImage.bits());
-            break;
-        }
+        plan.convertFunction = PlanConvertMono12g;
+        break;
     case V4L2_PIX_FMT_SBGGR12P:
-        {
-            ConvertRAW12gToRAW8(pBuffer, width, height, g_ConversionBuffer1);
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_bayer8_to_rgb24(g_ConversionBuffer1, convertedImage.bits(),
-                                       width, height, width,
-                                       V4L2_PIX_FMT_SBGGR8);
-            break;
-        }
+        plan.convertFunction = PlanConvertBayer12g;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SBGGR8;
+        bNeedsRaw8Buffer = true;
+        break;
     case V4L2_PIX_FMT_SGBRG12P:
-        {
-            ConvertRAW12gToRAW8(pBuffer, width, height, g_ConversionBuffer1);
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_bayer8_to_rgb24(g_ConversionBuffer1, convertedImage.bits(),
-                                       width, height, width,
-                                       V4L2_PIX_FMT_SGBRG8);
-            break;
-        }
+        plan.convertFunction = PlanConvertBayer12g;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SGBRG8;
+        bNeedsRaw8Buffer = true;
+        break;
     case V4L2_PIX_FMT_SGRBG12P:
-        {
-            ConvertRAW12gToRAW8(pBuffer, width, height, g_ConversionBuffer1);
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_bayer8_to_rgb24(g_ConversionBuffer1, convertedImage.bits(),
-                                       width, height, width,
-                                       V4L2_PIX_FMT_SGRBG8);
-            break;
-        }
+        plan.convertFunction = PlanConvertBayer12g;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SGRBG8;
+        bNeedsRaw8Buffer = true;
+        break;
     case V4L2_PIX_FMT_SRGGB12P:
-        {
-            ConvertRAW12gToRAW8(pBuffer, width, height, g_ConversionBuffer1);
-            convertedImage = QImage(width, height, QImage::Format_RGB888);
-            v4lconvert_bayer8_to_rgb24(g_ConversionBuffer1, convertedImage.bits(),
-                                       width, height, width,
-                                       V4L2_PIX_FMT_SRGGB8);
-            break;
-        }
+        plan.convertFunction = PlanConvertBayer12g;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SRGGB8;
+        bNeedsRaw8Buffer = true;
+        break;
 
     /* Special 10 and 12 bit pixel formats for NVidia Jetson */
 
     /* AGX Xavier and Xavier NX */
     case V4L2_PIX_FMT_XAVIER_Y10:
     case V4L2_PIX_FMT_XAVIER_Y12:
-        ConvertJetsonMono16ToRGB24(pBuffer, width, height, convertedImage, 7);
+        plan.convertFunction = PlanConvertJetsonMono16;
+        plan.shift = 7;
         break;
 
     case V4L2_PIX_FMT_XAVIER_SGRBG10:
     case V4L2_PIX_FMT_XAVIER_SGRBG12:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, 7, V4L2_PIX_FMT_SGRBG8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SGRBG8;
+        plan.shift = 7;
+        bNeedsRaw8Buffer = true;
         break;
 
     case V4L2_PIX_FMT_XAVIER_SRGGB10:
     case V4L2_PIX_FMT_XAVIER_SRGGB12:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, 7, V4L2_PIX_FMT_SRGGB8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SRGGB8;
+        plan.shift = 7;
+        bNeedsRaw8Buffer = true;
         break;
 
     case V4L2_PIX_FMT_XAVIER_SGBRG10:
     case V4L2_PIX_FMT_XAVIER_SGBRG12:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, 7, V4L2_PIX_FMT_SGBRG8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SGBRG8;
+        plan.shift = 7;
+        bNeedsRaw8Buffer = true;
         break;
 
     case V4L2_PIX_FMT_XAVIER_SBGGR10:
     case V4L2_PIX_FMT_XAVIER_SBGGR12:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, 7, V4L2_PIX_FMT_SBGGR8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SBGGR8;
+        plan.shift = 7;
+        bNeedsRaw8Buffer = true;
         break;
 
     /* TX2 and Nano */
     case V4L2_PIX_FMT_TX2_Y10:
     case V4L2_PIX_FMT_TX2_Y12:
-        ConvertJetsonMono16ToRGB24(pBuffer, width, height, convertedImage, 6);
+        plan.convertFunction = PlanConvertJetsonMono16;
+        plan.shift = 6;
         break;
 
     case V4L2_PIX_FMT_TX2_SGRBG10:
     case V4L2_PIX_FMT_TX2_SGRBG12:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, 6, V4L2_PIX_FMT_SGRBG8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SGRBG8;
+        plan.shift = 6;
+        bNeedsRaw8Buffer = true;
         break;
 
     case V4L2_PIX_FMT_TX2_SRGGB10:
     case V4L2_PIX_FMT_TX2_SRGGB12:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, 6, V4L2_PIX_FMT_SRGGB8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SRGGB8;
+        plan.shift = 6;
+        bNeedsRaw8Buffer = true;
         break;
 
     case V4L2_PIX_FMT_TX2_SGBRG10:
     case V4L2_PIX_FMT_TX2_SGBRG12:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, 6, V4L2_PIX_FMT_SGBRG8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SGBRG8;
+        plan.shift = 6;
+        bNeedsRaw8Buffer = true;
         break;
 
     case V4L2_PIX_FMT_TX2_SBGGR10:
     case V4L2_PIX_FMT_TX2_SBGGR12:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, 6, V4L2_PIX_FMT_SBGGR8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SBGGR8;
+        plan.shift = 6;
+        bNeedsRaw8Buffer = true;
         break;
 
     /* Nano/Generic 12 Bit */
     case V4L2_PIX_FMT_Y12:
-        ConvertJetsonMono16ToRGB24(pBuffer, width, height, convertedImage, g_shift12Bit);
+        plan.convertFunction = PlanConvertJetsonMono16;
+        plan.shift = g_shift12Bit;
         break;
 
     case V4L2_PIX_FMT_SGRBG12:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, g_shift12Bit, V4L2_PIX_FMT_SGRBG8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SGRBG8;
+        plan.shift = g_shift12Bit;
+        bNeedsRaw8Buffer = true;
         break;
 
     case V4L2_PIX_FMT_SRGGB12:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, g_shift12Bit, V4L2_PIX_FMT_SRGGB8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SRGGB8;
+        plan.shift = g_shift12Bit;
+        bNeedsRaw8Buffer = true;
         break;
 
     case V4L2_PIX_FMT_SGBRG12:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, g_shift12Bit, V4L2_PIX_FMT_SGBRG8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SGBRG8;
+        plan.shift = g_shift12Bit;
+        bNeedsRaw8Buffer = true;
         break;
 
     case V4L2_PIX_FMT_SBGGR12:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, g_shift12Bit, V4L2_PIX_FMT_SBGGR8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SBGGR8;
+        plan.shift = g_shift12Bit;
+        bNeedsRaw8Buffer = true;
         break;
 
     /* Nano/Generic 10 Bit */
     case V4L2_PIX_FMT_Y10:
-        ConvertJetsonMono16ToRGB24(pBuffer, width, height, convertedImage, g_shift10Bit);
+        plan.convertFunction = PlanConvertJetsonMono16;
+        plan.shift = g_shift10Bit;
         break;
 
     case V4L2_PIX_FMT_SGRBG10:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, g_shift10Bit, V4L2_PIX_FMT_SGRBG8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SGRBG8;
+        plan.shift = g_shift10Bit;
+        bNeedsRaw8Buffer = true;
         break;
 
     case V4L2_PIX_FMT_SRGGB10:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, g_shift10Bit, V4L2_PIX_FMT_SRGGB8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SRGGB8;
+        plan.shift = g_shift10Bit;
+        bNeedsRaw8Buffer = true;
         break;
 
     case V4L2_PIX_FMT_SGBRG10:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, g_shift10Bit, V4L2_PIX_FMT_SGBRG8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SGBRG8;
+        plan.shift = g_shift10Bit;
+        bNeedsRaw8Buffer = true;
         break;
 
     case V4L2_PIX_FMT_SBGGR10:
-        ConvertJetsonBayer16ToRGB24(pBuffer, width, height, convertedImage, g_shift10Bit, V4L2_PIX_FMT_SBGGR8);
+        plan.convertFunction = PlanConvertJetsonBayer16;
+        plan.bayerPixelFormat = V4L2_PIX_FMT_SBGGR8;
+        plan.shift = g_shift10Bit;
+        bNeedsRaw8Buffer = true;
         break;
 
-
     default:
+        LOG_EX("ImageTransform::CreateConversionPlan pixel format 0x%08X is not supported", pixelFormat);
+        return -1;
+    }
+
+    if (0 != paddedBytesPerPixel)
+    {
+        plan.bRemovePadding = (width * paddedBytesPerPixel != bytesPerLine);
+        if (plan.bRemovePadding)
+            plan.conversionBuffer.reserve(width * height * paddedBytesPerPixel);
+    }
+
+    // significant bits of the packed formats and of the 16 bit containers
+    if (PlanConvertMono12g == plan.convertFunction || PlanConvertBayer12g == plan.convertFunction)
+        plan.bitDepth = 12;
+    else if (PlanConvertJetsonMono16 == plan.convertFunction || PlanConvertJetsonBayer16 == plan.convertFunction)
+        plan.bitDepth = GetContainerBitDepth(pixelFormat);
+
+    // kernels which apply the tone table to every line they store
+    if (PlanConvertGrey == plan.convertFunction || PlanConvertBayer8 == plan.convertFunction ||
+        PlanConvertMono12g == plan.convertFunction || PlanConvertBayer12g == plan.convertFunction ||
+        PlanConvertJetsonMono16 == plan.convertFunction || PlanConvertJetsonBayer16 == plan.convertFunction)
+        plan.bFusedToneTable = true;
+
+#if defined(HIGH_BIT_DEPTH_SUPPORTED)
+    if (bHighBitDepth)
+    {
+        // formats with more than 8 bit switch to their 16 bit kernels
+        struct
+        {
+            ConvertFunction eightBit;
+            ConvertFunction sixteenBit;
+        } const highBitDepthKernels[] =
+        {
+            { PlanConvertMono12g, PlanConvertMono12gTo16 },
+            { PlanConvertJetsonMono16, PlanConvertJetsonMono16To16 },
+            { PlanConvertBayer12g, PlanConvertBayer12gTo16 },
+            { PlanConvertJetsonBayer16, PlanConvertJetsonBayer16To16 },
+        };
+
+        for (size_t i = 0; i < sizeof(highBitDepthKernels) / sizeof(highBitDepthKernels[0]); i++)
+        {
+            if (plan.convertFunction == highBitDepthKernels[i].eightBit)
+            {
+                plan.convertFunction = highBitDepthKernels[i].sixteenBit;
+                plan.bHighBitDepth = true;
+                break;
+            }
+        }
+    }
+#else
+    (void)bHighBitDepth;
+#endif
+
+    if (PlanConvertJetsonBayer16 == plan.convertFunction)
+        plan.conversionBuffer.resize(3 * width);
+#if defined(HIGH_BIT_DEPTH_SUPPORTED)
+    else if (PlanConvertJetsonBayer16To16 == plan.convertFunction)
+        plan.conversionBuffer.resize(3 * width * sizeof(uint16_t));
+#endif
+    else if (plan.bHighBitDepth && bNeedsRaw8Buffer)
+        plan.conversionBuffer.resize(width * height * sizeof(uint16_t));
+    else if (bNeedsRaw8Buffer)
+        plan.conversionBuffer.resize(width * height);
+
+    // default layout of a contiguous frame, observers with separate memory
+    // planes replace it with the layout of their buffers
+    if (2 == plan.planeCount)
+    {
+        plan.planeOffset[1] = bytesPerLine * height;
+        plan.planeStride[1] = bytesPerLine;
+    }
+    else if (3 == plan.planeCount)
+    {
+        plan.planeOffset[1] = bytesPerLine * height;
+        plan.planeStride[1] = bytesPerLine / 2;
+        plan.planeOffset[2] = plan.planeOffset[1] + plan.planeStride[1] * ((height + 1) / 2);
+        plan.planeStride[2] = bytesPerLine / 2;
+    }
+
+    if (bUsesYuvMatrix)
+    {
+        // the kernels without a legacy counterpart need coefficients as well
+        if (bUseApproximateYuv)
+        {
+            plan.colorMatrix = yuvconversion::ColorMatrixBT601;
+            yuvconversion::GetCoefficients(plan.colorMatrix, colorRange, plan.yuvCoefficients);
+        }
+
+        ValidateYuvKernels(plan.colorMatrix, plan.colorRange);
+        plan.bFusedToneTable = true;
+    }
+
+    return 0;
+}
+
+int ImageTransform::ConvertFrame(ConversionPlan &plan, const uint8_t *pBuffer, uint32_t length,
+                                 QImage &convertedImage)
+{
+    if (NULL == pBuffer || 0 == length || NULL == plan.convertFunction)
+        return -1;
+
+    plan.frameLength = length;
+    plan.convertFunction(plan, pBuffer, convertedImage);
+
+    if (NULL != plan.pToneTable && !plan.bFusedToneTable && !convertedImage.isNull())
+        ApplyToneTable(plan.pToneTable, convertedImage);
+
+    return convertedImage.isNull() ? -1 : 0;
+}
+
+/*********************************************************************************************************/
+// Window/level mapping
+/*********************************************************************************************************/
+
+bool ImageTransform::IsHighBitDepth(const QImage &image)
+{
+#if defined(HIGH_BIT_DEPTH_SUPPORTED)
+    return (QImage::Format_Grayscale16 == image.format() || QImage::Format_RGBX64 == image.format());
+#else
+    (void)image;
+    return false;
+#endif
+}
+
+void ImageTransform::CreateWindowLevelTable(uint16_t low, uint16_t high, const tonemapping::Parameters &toneMapping,
+                                            std::vector<uint8_t> &table)
+{
+    table.resize(65536);
+
+    if (high <= low)
+        high = low + 1;
+
+    uint32_t range = high - low;
+
+    if (tonemapping::IsIdentity(toneMapping))
+    {
+        for (uint32_t value = 0; value < 65536; value++)
+        {
+            if (value <= low)
+                table[value] = 0;
+            else if (value >= high)
+                table[value] = 255;
+            else
+                table[value] = static_cast<uint8_t>(((value - low) * 255 + range / 2) / range);
+        }
+        return;
+    }
+
+    // the tone curve is sampled once at 12 bit inside of the window, this
+    // keeps the rebuild cheap when the automatic window/level moves
+    const uint32_t curveSteps = 4095;
+    uint8_t curve[curveSteps + 1];
+    for (uint32_t step = 0; step <= curveSteps; step++)
+    {
+        curve[step] = static_cast<uint8_t>(std::lround(tonemapping::ApplyCurve(toneMapping,
+                                                                               static_cast<double>(step) / curveSteps) * 255.0));
+    }
+
+    for (uint32_t value = 0; value < 65536; value++)
+    {
+        uint32_t clamped = std::min(std::max(value, static_cast<uint32_t>(low)), static_cast<uint32_t>(high));
+        table[value] = curve[((clamped - low) * curveSteps + range / 2) / range];
+    }
+}
+
+int ImageTransform::ApplyWindowLevel(const QImage &source, const std::vector<uint8_t> &table, QImage &display)
+{
+    if (!IsHighBitDepth(source) || table.size() < 65536)
+        return -1;
+
+#if defined(HIGH_BIT_DEPTH_SUPPORTED)
+    const uint8_t *lut = table.data();
+    int width = source.width();
+    int height = source.height();
+
+    if (QImage::Format_Grayscale16 == source.format())
+    {
+        if (display.size() != source.size() || QImage::Format_Grayscale8 != display.format())
+            display = QImage(width, height, QImage::Format_Grayscale8);
+
+        for (int y = 0; y < height; y++)
+        {
+            const uint16_t *src = reinterpret_cast<const uint16_t *>(source.constScanLine(y));
+            uint8_t *dst = display.scanLine(y);
+            for (int x = 0; x < width; x++)
+                dst[x] = lut[src[x]];
+        }
+    }
+    else
+    {
+        if (display.size() != source.size() || QImage::Format_RGB32 != display.format())
+            display = QImage(width, height, QImage::Format_RGB32);
+
+        for (int y = 0; y < height; y++)
+        {
+            const uint16_t *src = reinterpret_cast<const uint16_t *>(source.constScanLine(y));
+            uint32_t *dst = reinterpret_cast<uint32_t *>(display.scanLine(y));
+            for (int x = 0; x < width; x++, src += 4)
+                dst[x] = 0xFF000000u | (lut[src[0]] << 16) | (lut[src[1]] << 8) | lut[src[2]];
+        }
+    }
+#endif
+
+    return 0;
+}
+
+int ImageTransform::GetImageRange(const QImage &source, uint16_t &low, uint16_t &high)
+{
+    if (!IsHighBitDepth(source))
+        return -1;
+
+    // 1024 bins over the 16 bit range, every 4th pixel of every 4th line
+    const int binShift = 6;
+    std::vector<uint32_t> histogram(65536 >> binShift, 0);
+    int channels = (QImage::Format_RGBX64 == source.format()) ? 4 : 1;
+    uint32_t sampleCount = 0;
+
+    for (int y = 0; y < source.height(); y += 4)
+    {
+        const uint16_t *src = reinterpret_cast<const uint16_t *>(source.constScanLine(y));
+        for (int x = 0; x < source.width(); x += 4)
+        {
+            // the brightest channel decides for color images
+            const uint16_t *pixel = src + x * channels;
+            uint16_t value = (4 == channels) ? std::max(std::max(pixel[0], pixel[1]), pixel[2]) : pixel[0];
+            histogram[value >> binShift]++;
+            sampleCount++;
+        }
+    }
+
+    uint32_t clipCount = sampleCount / 1000;
+    uint32_t sum = 0;
+    size_t lowBin = 0;
+    while (lowBin < histogram.size() - 1 && (sum += histogram[lowBin]) <= clipCount)
+        lowBin++;
+
+    sum = 0;
+    size_t highBin = histogram.size() - 1;
+    while (highBin > lowBin && (sum += histogram[highBin]) <= clipCount)
+        highBin--;
+
+    low = static_cast<uint16_t>(lowBin << binShift);
+    high = static_cast<uint16_t>(((highBin + 1) << binShift) - 1);
+
+    return 0;
+}
+
+int ImageTransform::ApplyToneTable(const uint8_t *toneTable, QImage &image)
+{
+    if (NULL == toneTable || image.isNull() || IsHighBitDepth(image))
         return -1;
+
+    if (QImage::Format_Indexed8 == image.format())
+    {
+        // only the color table has to be mapped
+        QVector<QRgb> colorTable = image.colorTable();
+        for (int i = 0; i < colorTable.size(); i++)
+        {
+            QRgb color = colorTable[i];
+            colorTable[i] = qRgba(toneTable[qRed(color)], toneTable[qGreen(color)], toneTable[qBlue(color)], qAlpha(color));
+        }
+        image.setColorTable(colorTable);
+        return 0;
+    }
+
+    uint32_t bytesPerPixel = 0;
+    switch (image.format())
+    {
+    case QImage::Format_Grayscale8:
+        bytesPerPixel = 1;
+        break;
+    case QImage::Format_RGB888:
+        bytesPerPixel = 3;
+        break;
+    case QImage::Format_RGB32:
+        bytesPerPixel = 4;
+        break;
+    default:
+        image = image.convertToFormat(QImage::Format_RGB32);
+        bytesPerPixel = 4;
+        break;
+    }
+
+    for (int line = 0; line < image.height(); line++)
+    {
+        tonemapping::ApplyTableToLine(toneTable, image.scanLine(line), image.width(), bytesPerPixel);
     }
 
-    return result;
+    return 0;
 }
@@ -18,10 +18,9 @@
 
 #include "Logger.h"
 
-#include <sstream>
-
 QSharedPointer<base::BaseLogger> Logger::m_pBaseLogger;
-bool Logger::m_LogSwitch = false;
+// messages before the initialization create a default log file
+std::atomic<bool> Logger::m_LogSwitch(true);
 
 Logger::Logger(void)
 {
@@ -42,59 +41,49 @@ void Logger::InitializeLogger(const std::string &logFilename)
 
 void Logger::Log(const std::string &message)
 {
-    if (m_LogSwitch)
+    if (m_LogSwitch && m_pBaseLogger != NULL)
         m_pBaseLogger->Log(message);
 }
 
-void Logger::LogEx(const char *filename, int line, const char *text, ...)
+base::LogRing &Logger::GetThreadRing()
 {
-    std::stringstream prefixStream;
-    if(line > -1)
-    {
-        prefixStream << filename << ":" << line << ": ";
-    }
-
-    std::string output = prefixStream.str();
-    va_list args;
-    char *string;
-    int sizeText = 0;
-
-    va_start(args, text);
-    sizeText = vsnprintf(NULL, 0, text, args) + 1;
-    va_end(args);
-
-    string = (char *)malloc(sizeof(char)*sizeText);
-
-    if (NULL == string)
-        output += "<conversion failed>";
-    else
-    {
-        va_start(args, text);
-        vsnprintf(string, sizeof(char)*sizeText, text, args);
-        va_end(args);
-        output += string;
-        free(string);
-    }
-
     if (m_pBaseLogger == NULL)
     {
         m_LogSwitch = true;
         Logger::InitializeLogger("Noname.log");
     }
 
-    if (m_LogSwitch)
-        m_pBaseLogger->Log(output);
+    return *base::BinaryLog::GetThreadRing();
 }
 
 void Logger::LogDump(const std::string &message, uint8_t *buffer, uint32_t length)
 {
-    if (m_LogSwitch)
+    if (m_LogSwitch && m_pBaseLogger != NULL)
         m_pBaseLogger->LogDump(message, buffer, length);
 }
 
 void Logger::LogBuffer(const std::string &filename, uint8_t *buffer, uint32_t length)
 {
-    m_pBaseLogger->LogBuffer(filename, buffer, length);
+    if (m_pBaseLogger != NULL)
+        m_pBaseLogger->LogBuffer(filename, buffer, length);
+}
+
+bool Logger::LogBuffer(const std::string &filename, const struct iovec *pPlanes, uint32_t planeCount,
+                       base::DumpReleaseFunction releaseFunction, void *pReleaseContext)
+{
+    if (m_pBaseLogger == NULL)
+        return false;
+
+    return m_pBaseLogger->LogBuffer(filename, pPlanes, planeCount, releaseFunction, pReleaseContext);
+}
+
+bool Logger::GetDumpStatistics(base::DumpStatistics &statistics)
+{
+    if (m_pBaseLogger == NULL)
+        return false;
+
+    m_pBaseLogger->GetDumpStatistics(statistics);
+    return true;
 }
 
 void Logger::LogSwitch(bool flag)
@@ -0,0 +1,161 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+
+#include "MjpegDecoder.h"
+#include "Logger.h"
+#include "ToneMapping.h"
+
+MjpegDecoder::MjpegDecoder()
+{
+#if defined(HAVE_LIBJPEG)
+    m_Decompressor.err = jpeg_std_error(&m_ErrorManager.base);
+    m_ErrorManager.base.error_exit = OnError;
+    m_ErrorManager.base.output_message = OnMessage;
+    jpeg_create_decompress(&m_Decompressor);
+#endif
+}
+
+MjpegDecoder::~MjpegDecoder()
+{
+#if defined(HAVE_LIBJPEG)
+    jpeg_destroy_decompress(&m_Decompressor);
+#endif
+}
+
+QImage &MjpegDecoder::GetPooledImage(int width, int height, QImage::Format format)
+{
+    // an image is free again once the display dropped its shallow copy
+    for (int i = 0; i < IMAGE_POOL_SIZE; i++)
+    {
+        QImage &image = m_ImagePool[i];
+        if (!image.isNull() && image.isDetached() &&
+            image.width() == width && image.height() == height && image.format() == format)
+        {
+            return image;
+        }
+    }
+
+    for (int i = 0; i < IMAGE_POOL_SIZE; i++)
+    {
+        if (m_ImagePool[i].isNull() || m_ImagePool[i].isDetached())
+        {
+            m_ImagePool[i] = QImage(width, height, format);
+            return m_ImagePool[i];
+        }
+    }
+
+    // all pooled images are still in use, replace the first one
+    m_ImagePool[0] = QImage(width, height, format);
+    return m_ImagePool[0];
+}
+
+#if defined(HAVE_LIBJPEG)
+
+void MjpegDecoder::OnError(j_common_ptr cinfo)
+{
+    ErrorManager *pErrorManager = reinterpret_cast<ErrorManager *>(cinfo->err);
+    longjmp(pErrorManager->jumpBuffer, 1);
+}
+
+void MjpegDecoder::OnMessage(j_common_ptr cinfo)
+{
+    // warnings of truncated frames are expected from USB cameras and would flood the log
+    (void)cinfo;
+}
+
+int MjpegDecoder::Decode(const uint8_t *pBuffer, uint32_t length, uint32_t scaleDenominator,
+                         const uint8_t *toneTable, QImage &image)
+{
+    if (NULL == pBuffer || 0 == length)
+        return -1;
+
+    if (setjmp(m_ErrorManager.jumpBuffer))
+    {
+        char message[JMSG_LENGTH_MAX];
+        m_ErrorManager.base.format_message(reinterpret_cast<j_common_ptr>(&m_Decompressor), message);
+        LOG_EX("MjpegDecoder::Decode corrupt frame: %s", message);
+        jpeg_abort_decompress(&m_Decompressor);
+        return -1;
+    }
+
+    jpeg_mem_src(&m_Decompressor, const_cast<uint8_t *>(pBuffer), length);
+    jpeg_read_header(&m_Decompressor, TRUE);
+
+    m_Decompressor.scale_num = 1;
+    m_Decompressor.scale_denom = (2 == scaleDenominator || 4 == scaleDenominator || 8 == scaleDenominator) ? scaleDenominator : 1;
+#if defined(JCS_EXTENSIONS)
+    // libjpeg-turbo writes QImage::Format_RGB32 (B, G, R, 0xFF in memory) directly
+    m_Decompressor.out_color_space = JCS_EXT_BGRX;
+    QImage::Format format = QImage::Format_RGB32;
+    const uint32_t bytesPerPixel = 4;
+#else
+    m_Decompressor.out_color_space = JCS_RGB;
+    QImage::Format format = QImage::Format_RGB888;
+    const uint32_t bytesPerPixel = 3;
+#endif
+
+    jpeg_start_decompress(&m_Decompressor);
+
+    QImage &outputImage = GetPooledImage(m_Decompressor.output_width, m_Decompressor.output_height, format);
+
+    JSAMPROW rows[16];
+    while (m_Decompressor.output_scanline < m_Decompressor.output_height)
+    {
+        JDIMENSION rowCount = 0;
+        for (; rowCount < 16 && m_Decompressor.output_scanline + rowCount < m_Decompressor.output_height; rowCount++)
+            rows[rowCount] = outputImage.scanLine(m_Decompressor.output_scanline + rowCount);
+
+        JDIMENSION readCount = jpeg_read_scanlines(&m_Decompressor, rows, rowCount);
+
+        // the tone table is applied while the decoded lines are still in the cache
+        for (JDIMENSION row = 0; NULL != toneTable && row < readCount; row++)
+            tonemapping::ApplyTableToLine(toneTable, rows[row], m_Decompressor.output_width, bytesPerPixel);
+    }
+
+    jpeg_finish_decompress(&m_Decompressor);
+
+    image = outputImage;
+
+    return 0;
+}
+
+#else
+
+int MjpegDecoder::Decode(const uint8_t *pBuffer, uint32_t length, uint32_t scaleDenominator,
+                         const uint8_t *toneTable, QImage &image)
+{
+    // without libjpeg the frame is decoded by the Qt image plugin in full size
+    (void)scaleDenominator;
+
+    if (NULL == pBuffer || 0 == length)
+        return -1;
+
+    if (!image.loadFromData(pBuffer, length, "JPG"))
+        return -1;
+
+    if (NULL != toneTable)
+    {
+        image = image.convertToFormat(QImage::Format_RGB32);
+        for (int line = 0; line < image.height(); line++)
+            tonemapping::ApplyTableToLine(toneTable, image.scanLine(line), image.width(), 4);
+    }
+
+    return 0;
+}
+
+#endif
@@ -0,0 +1,397 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+
+#include "ThreadScheduling.h"
+#include "LocalMutex.h"
+#include "LocalMutexLockGuard.h"
+#include "Logger.h"
+#include "V4L2Helper.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+namespace threadscheduling {
+
+static const char *s_RoleNames[ThreadRoleCount] = { "capture", "processing", "events", "logger" };
+
+// Scheduling a thread of the role got when it applied its settings
+struct EffectiveState
+{
+    bool bApplied;
+    int policy;
+    int priority;
+    std::string cpus;
+    int error;
+};
+
+static base::LocalMutex s_Mutex;
+static Settings s_Settings[ThreadRoleCount];
+static EffectiveState s_States[ThreadRoleCount];
+
+static const char *GetPolicyName(int policy)
+{
+    switch (policy)
+    {
+    case SCHED_FIFO:  return "fifo";
+    case SCHED_RR:    return "rr";
+    case SCHED_OTHER: return "other";
+    default:          return "unknown";
+    }
+}
+
+static int ParseCpuList(const std::string &text, std::vector<int> &cpus)
+{
+    std::stringstream stream(text);
+    std::string range;
+
+    cpus.clear();
+    while (std::getline(stream, range, ','))
+    {
+        int first = 0;
+        int last = 0;
+        char separator = 0;
+        int count = sscanf(range.c_str(), "%d%c%d", &first, &separator, &last);
+        if (1 == count)
+            last = first;
+        else if (3 != count || '-' != separator)
+            return -1;
+
+        if (first < 0 || last < first || last >= CPU_SETSIZE)
+            return -1;
+        for (int cpu = first; cpu <= last; cpu++)
+            cpus.push_back(cpu);
+    }
+
+    return cpus.empty() ? -1 : 0;
+}
+
+static std::string FormatCpuSet(const cpu_set_t &cpuSet)
+{
+    std::stringstream stream;
+    int first = -1;
+
+    // consecutive CPUs are written as ranges
+    for (int cpu = 0; cpu <= CPU_SETSIZE; cpu++)
+    {
+        bool bSet = (cpu < CPU_SETSIZE) && CPU_ISSET(cpu, &cpuSet);
+        if (bSet && -1 == first)
+        {
+            first = cpu;
+        }
+        else if (!bSet && -1 != first)
+        {
+            if (0 != stream.tellp())
+                stream << ",";
+            stream << first;
+            if (cpu - 1 != first)
+                stream << "-" << (cpu - 1);
+            first = -1;
+        }
+    }
+
+    return stream.str();
+}
+
+static int GetRole(const std::string &name, ThreadRole &role)
+{
+    for (int i = 0; i < ThreadRoleCount; i++)
+    {
+        if (name == s_RoleNames[i])
+        {
+            role = static_cast<ThreadRole>(i);
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+int ParseSettings(const std::string &text, Settings &settings)
+{
+    std::string schedule = text.substr(0, text.find('@'));
+    std::string cpuList = (std::string::npos != text.find('@')) ? text.substr(text.find('@') + 1) : "";
+    std::string policyName = schedule.substr(0, schedule.find(':'));
+
+    settings.policy = SCHED_OTHER;
+    settings.priority = 0;
+    settings.cpus.clear();
+    settings.bConfigured = false;
+
+    if ("fifo" == policyName)
+        settings.policy = SCHED_FIFO;
+    else if ("rr" == policyName)
+        settings.policy = SCHED_RR;
+    else if ("other" != policyName && !policyName.empty())
+        return -1;
+
+    if (std::string::npos != schedule.find(':'))
+    {
+        char *pEnd = NULL;
+        std::string priority = schedule.substr(schedule.find(':') + 1);
+        settings.priority = static_cast<int>(strtol(priority.c_str(), &pEnd, 10));
+        if (priority.empty() || '\0' != *pEnd)
+            return -1;
+    }
+    else if (SCHED_OTHER != settings.policy)
+    {
+        // the lowest real-time priority is already above all normal threads
+        settings.priority = 1;
+    }
+
+    if (settings.priority < sched_get_priority_min(settings.policy) ||
+        settings.priority > sched_get_priority_max(settings.policy))
+        return -1;
+
+    if (!cpuList.empty() && 0 != ParseCpuList(cpuList, settings.cpus))
+        return -1;
+
+    settings.bConfigured = true;
+    return 0;
+}
+
+int ParseCommandLine(int argc, char *argv[])
+{
+    int result = 0;
+    std::vector<std::string> errors;
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (0 != argument.compare(0, 8, "--sched-") || std::string::npos == argument.find('='))
+            continue;
+
+        std::string name = argument.substr(8, argument.find('=') - 8);
+        std::string value = argument.substr(argument.find('=') + 1);
+
+        ThreadRole role;
+        Settings settings;
+        if ("file" == name)
+        {
+            if (0 != LoadFile(value))
+                result = -1;
+        }
+        else if (0 != GetRole(name, role) || 0 != ParseSettings(value, settings))
+        {
+            errors.push_back(argument);
+            result = -1;
+        }
+        else
+        {
+            SetSettings(role, settings);
+        }
+    }
+
+    // logging starts the logger threads, so it comes after all settings are known
+    for (size_t i = 0; i < errors.size(); i++)
+        LOG_EX("threadscheduling::ParseCommandLine invalid option %s", errors[i].c_str());
+
+    return result;
+}
+
+int LoadFile(const std::string &fileName)
+{
+    std::ifstream file(fileName.c_str());
+    if (!file.is_open())
+    {
+        LOG_EX("threadscheduling::LoadFile cannot open %s", fileName.c_str());
+        return -1;
+    }
+
+    int result = 0;
+    int lineNumber = 0;
+    std::vector<int> invalidLines;
+    std::string line;
+    while (std::getline(file, line))
+    {
+        lineNumber++;
+        line = line.substr(0, line.find('#'));
+        line.erase(std::remove_if(line.begin(), line.end(), ::isspace), line.end());
+        if (line.empty())
+            continue;
+
+        ThreadRole role;
+        Settings settings;
+        std::string::size_type separator = line.find('=');
+        if (std::string::npos == separator ||
+            0 != GetRole(line.substr(0, separator), role) ||
+            0 != ParseSettings(line.substr(separator + 1), settings))
+        {
+            invalidLines.push_back(lineNumber);
+            result = -1;
+            continue;
+        }
+
+        SetSettings(role, settings);
+    }
+
+    for (size_t i = 0; i < invalidLines.size(); i++)
+        LOG_EX("threadscheduling::LoadFile %s line %d is invalid", fileName.c_str(), invalidLines[i]);
+
+    return result;
+}
+
+void SetSettings(ThreadRole role, const Settings &settings)
+{
+    base::LocalMutexLockGuard guard(s_Mutex);
+    s_Settings[role] = settings;
+}
+
+Settings GetSettings(ThreadRole role)
+{
+    base::LocalMutexLockGuard guard(s_Mutex);
+    return s_Settings[role];
+}
+
+int ApplyToCurrentThread(ThreadRole role)
+{
+    Settings settings = GetSettings(role);
+    if (!settings.bConfigured)
+        return 0;
+
+    int error = 0;
+    pthread_t thread = pthread_self();
+
+    // raising the priority needs CAP_SYS_NICE or an RLIMIT_RTPRIO
+    sched_param param;
+    memset(&param, 0, sizeof(param));
+    param.sched_priority = settings.priority;
+    int result = pthread_setschedparam(thread, settings.policy, &param);
+    if (0 != result)
+        error = result;
+
+    if (!settings.cpus.empty())
+    {
+        cpu_set_t cpuSet;
+        CPU_ZERO(&cpuSet);
+        for (size_t i = 0; i < settings.cpus.size(); i++)
+            CPU_SET(settings.cpus[i], &cpuSet);
+        result = pthread_setaffinity_np(thread, sizeof(cpuSet), &cpuSet);
+        if (0 != result)
+            error = result;
+    }
+
+    // the report shows what the kernel accepted, not what was requested
+    EffectiveState state;
+    state.bApplied = true;
+    state.error = error;
+    state.policy = SCHED_OTHER;
+    state.priority = 0;
+    if (0 == pthread_getschedparam(thread, &state.policy, &param))
+        state.priority = param.sched_priority;
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (0 == pthread_getaffinity_np(thread, sizeof(cpuSet), &cpuSet))
+        state.cpus = FormatCpuSet(cpuSet);
+
+    base::LocalMutexLockGuard guard(s_Mutex);
+    s_States[role] = state;
+
+    return (0 == error) ? 0 : -1;
+}
+
+int MeasureWakeupLatency(uint32_t samples, uint32_t periodUs, double &average, double &maximum)
+{
+    average = 0.0;
+    maximum = 0.0;
+
+    if (0 == samples)
+        return -1;
+
+    timespec deadline;
+    if (0 != clock_gettime(CLOCK_MONOTONIC, &deadline))
+        return -1;
+
+    double sum = 0.0;
+    for (uint32_t i = 0; i < samples; i++)
+    {
+        deadline.tv_nsec += periodUs * 1000;
+        while (deadline.tv_nsec >= 1000000000)
+        {
+            deadline.tv_nsec -= 1000000000;
+            deadline.tv_sec++;
+        }
+
+        if (0 != clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL))
+            return -1;
+
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        double delay = (now.tv_sec - deadline.tv_sec) * 1000000.0 + (now.tv_nsec - deadline.tv_nsec) / 1000.0;
+        sum += delay;
+        maximum = std::max(maximum, delay);
+    }
+
+    average = sum / samples;
+    return 0;
+}
+
+void ReportSettings()
+{
+    for (int i = 0; i < ThreadRoleCount; i++)
+    {
+        Settings settings;
+        EffectiveState state;
+        {
+            base::LocalMutexLockGuard guard(s_Mutex);
+            settings = s_Settings[i];
+            state = s_States[i];
+        }
+
+        if (!settings.bConfigured)
+        {
+            LOG_EX("threadscheduling::ReportSettings %s: default scheduling", s_RoleNames[i]);
+            continue;
+        }
+
+        std::string requestedCpus = "inherited";
+        if (!settings.cpus.empty())
+        {
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            for (size_t cpu = 0; cpu < settings.cpus.size(); cpu++)
+                CPU_SET(settings.cpus[cpu], &cpuSet);
+            requestedCpus = FormatCpuSet(cpuSet);
+        }
+
+        if (!state.bApplied)
+        {
+            LOG_EX("threadscheduling::ReportSettings %s: requested %s:%d cpus %s, no thread started yet",
+                   s_RoleNames[i], GetPolicyName(settings.policy), settings.priority, requestedCpus.c_str());
+        }
+        else
+        {
+            LOG_EX("threadscheduling::ReportSettings %s: requested %s:%d cpus %s, effective %s:%d cpus %s%s%s",
+                   s_RoleNames[i], GetPolicyName(settings.policy), settings.priority, requestedCpus.c_str(),
+                   GetPolicyName(state.policy), state.priority, state.cpus.c_str(),
+                   (0 != state.error) ? ", error " : "",
+                   (0 != state.error) ? v4l2helper::ConvertErrno2String(state.error).c_str() : "");
+        }
+    }
+}
+
+} // namespace threadscheduling
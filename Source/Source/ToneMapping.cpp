@@ -0,0 +1,90 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+#include "ToneMapping.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tonemapping
+{
+
+Parameters GetDefaultParameters()
+{
+    Parameters parameters;
+    parameters.gamma = 1.0;
+    parameters.contrast = 0;
+    parameters.brightness = 0;
+    return parameters;
+}
+
+bool IsIdentity(const Parameters &parameters)
+{
+    return IsEqual(parameters, GetDefaultParameters());
+}
+
+bool IsEqual(const Parameters &first, const Parameters &second)
+{
+    // gamma values closer than this do not change a single table entry
+    return (std::fabs(first.gamma - second.gamma) < 0.0001 &&
+            first.contrast == second.contrast &&
+            first.brightness == second.brightness);
+}
+
+double ApplyCurve(const Parameters &parameters, double value)
+{
+    double gamma = std::max(parameters.gamma, 0.01);
+    double result = std::pow(std::max(0.0, std::min(1.0, value)), 1.0 / gamma);
+
+    result = (result - 0.5) * (100 + parameters.contrast) / 100.0 + 0.5;
+    result += parameters.brightness / 100.0;
+
+    return std::max(0.0, std::min(1.0, result));
+}
+
+void CreateTable(const Parameters &parameters, std::vector<uint8_t> &table)
+{
+    table.resize(256);
+    for (int value = 0; value < 256; value++)
+    {
+        table[value] = static_cast<uint8_t>(std::lround(ApplyCurve(parameters, value / 255.0) * 255.0));
+    }
+}
+
+void ApplyTableToLine(const uint8_t *table, uint8_t *pixels, uint32_t width, uint32_t bytesPerPixel)
+{
+    if (4 == bytesPerPixel)
+    {
+        // B, G, R and the untouched padding byte of QImage::Format_RGB32
+        for (uint32_t x = 0; x < width; x++, pixels += 4)
+        {
+            pixels[0] = table[pixels[0]];
+            pixels[1] = table[pixels[1]];
+            pixels[2] = table[pixels[2]];
+        }
+    }
+    else
+    {
+        uint32_t count = width * bytesPerPixel;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            pixels[i] = table[pixels[i]];
+        }
+    }
+}
+
+} // namespace tonemapping
@@ -22,10 +22,22 @@
 #include <sys/eventfd.h>
 #include <unistd.h>
 
+#include <QElapsedTimer>
+
+#include <algorithm>
 
 #include "V4L2EventHandler.h"
+#include "Logger.h"
+#include "ThreadScheduling.h"
+
+// Control changes reach the GUI at most this often, auto exposure and
+// auto gain send an event per frame
+#define EVENT_DELIVERY_INTERVAL_MS 50
 
-V4L2EventHandler::V4L2EventHandler(const std::vector<int>  & fds) : m_Fds(fds)
+V4L2EventHandler::V4L2EventHandler(const std::vector<int>  & fds)
+    : m_Fds(fds)
+    , m_ReceivedEventCount(0)
+    , m_DeliveredEventCount(0)
 {
 
     m_eventFd = eventfd(0,0);
@@ -60,56 +72,115 @@ void V4L2EventHandler::UnsubscribeControl(int id)
 
 void V4L2EventHandler::run()
 {
+    threadscheduling::ApplyToCurrentThread(threadscheduling::ThreadRoleEvents);
 
+    // the descriptors do not change while the thread runs
+    std::vector<pollfd> pfds;
 
-    while (!isInterruptionRequested())
+    for (const auto fd : m_Fds)
     {
+        pollfd pfd = {
+            .fd = fd,
+            .events = POLLPRI,
+        };
 
-        std::vector<pollfd> pfds;
+        pfds.push_back(pfd);
+    }
 
-        for (const auto fd : m_Fds)
-        {
-            pollfd pfd = {
-                .fd = fd,
-                .events = POLLPRI,
-            };
+    pollfd event_pfd = {
+        .fd = m_eventFd,
+        .events = POLLIN,
+    };
 
-            pfds.push_back(pfd);
-        }
+    pfds.push_back(event_pfd);
 
-        pollfd event_pfd = {
-            .fd = m_eventFd,
-            .events = POLLIN,
-        };
+    QElapsedTimer deliveryTimer;
+    deliveryTimer.start();
 
-        pfds.push_back(event_pfd);
+    while (!isInterruptionRequested())
+    {
+        // sleep until the next event, or until the collected changes are due
+        int timeout = -1;
+        if (!m_PendingControls.empty())
+        {
+            timeout = std::max<qint64>(0, EVENT_DELIVERY_INTERVAL_MS - deliveryTimer.elapsed());
+        }
 
-        int ret = poll(pfds.data(),pfds.size(),-1);
+        int ret = poll(pfds.data(),pfds.size(),timeout);
         if (ret > 0)
         {
             for (const auto & pfd : pfds)
             {
                 if (pfd.revents & POLLPRI)
                 {
-                    v4l2_event event = {0};
-
-                    int error = ioctl(pfd.fd,VIDIOC_DQEVENT,&event);
-
-                    if (!error)
-                    {
-                        if (event.type == V4L2_EVENT_CTRL)
-                        {
-                            emit ControlChanged(event.id,event.u.ctrl);
-                        }
-                    }
+                    DrainEvents(pfd.fd);
                 }
             }
         }
+
+        if (!m_PendingControls.empty() && deliveryTimer.elapsed() >= EVENT_DELIVERY_INTERVAL_MS)
+        {
+            DeliverPendingControls();
+            deliveryTimer.restart();
+        }
     }
+
     eventfd_t value;
     eventfd_read(m_eventFd,&value);
 }
 
+void V4L2EventHandler::DrainEvents(int fd)
+{
+    v4l2_event event = {0};
+
+    do
+    {
+        if (ioctl(fd,VIDIOC_DQEVENT,&event))
+        {
+            break;
+        }
+
+        if (event.type == V4L2_EVENT_CTRL)
+        {
+            m_ReceivedEventCount++;
+
+            auto itControl = m_PendingControls.find(event.id);
+            if (itControl == m_PendingControls.end())
+            {
+                m_PendingControls[event.id] = event.u.ctrl;
+            }
+            else
+            {
+                // the latest value wins, but a flags or range change must still be reported
+                uint32_t changes = itControl->second.changes | event.u.ctrl.changes;
+                itControl->second = event.u.ctrl;
+                itControl->second.changes = changes;
+            }
+        }
+    } while (event.pending > 0);
+}
+
+void V4L2EventHandler::DeliverPendingControls()
+{
+    for (const auto & control : m_PendingControls)
+    {
+        m_DeliveredEventCount++;
+        emit ControlChanged(control.first,control.second);
+    }
+
+    m_PendingControls.clear();
+}
+
+uint64_t V4L2EventHandler::GetReceivedEventCount() const
+{
+    return m_ReceivedEventCount.load();
+}
+
+uint64_t V4L2EventHandler::GetDeliveredEventCount() const
+{
+    return m_DeliveredEventCount.load();
+}
+
 void V4L2EventHandler::Stop()
 {
     requestInterruption();
@@ -117,6 +188,9 @@ void V4L2EventHandler::Stop()
     eventfd_write(m_eventFd,0xfffffffffffffffe);
     eventfd_t value;
     eventfd_read(m_eventFd,&value);
+    wait();
+
+    LOG_EX("V4L2EventHandler::Stop %llu control events received, %llu delivered", static_cast<unsigned long long>(GetReceivedEventCount()), static_cast<unsigned long long>(GetDeliveredEventCount()));
 
 	for (const auto & fd : m_Fds)
     {
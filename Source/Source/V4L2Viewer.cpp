@@ -27,7 +27,7 @@
 #include "ButtonEnumerationControl.h"
 #include "ListEnumerationControl.h"
 #include "ListIntEnumerationControl.h"
-#include "CustomGraphicsView.h"
+#include "VideoSurfaceWidget.h"
 #include "CustomDialog.h"
 #include "GitRevision.h"
 
@@ -62,6 +62,9 @@
 
 #define EXPOSURE_MAX_VALUE 2147483647
 
+// two buffers stay with the driver while one is processed
+#define ADAPTIVE_BUFFER_COUNT_START 3
+
 static int32_t int64_2_int32(const int64_t value)
 {
     if (value > 0)
@@ -83,6 +86,7 @@ V4L2Viewer::V4L2Viewer(QWidget *parent, Qt::WindowFlags flags)
     , m_ShowFrames(true)
     , m_nStreamNumber(0)
     , m_bIsOpen(false)
+    , m_bIsDescribedFromOpen(false)
     , m_bIsStreaming(false)
     , m_sliderGainValue(0)
     , m_sliderBrightnessValue(0)
@@ -128,12 +132,15 @@ V4L2Viewer::V4L2Viewer(QWidget *parent, Qt::WindowFlags flags)
     // Start Camera
     connect(&m_Camera, SIGNAL(OnCameraListChanged_Signal(const int &, unsigned int, unsigned long long, const QString &, const QString &)), this, SLOT(OnCameraListChanged(const int &, unsigned int, unsigned long long, const QString &, const QString &)));
     connect(&m_Camera, SIGNAL(OnSubDeviceListChanged_Signal(const int &, unsigned int, unsigned long long, const QString &, const QString &)), this, SLOT(OnSubDeviceListChanged(const int &, unsigned int, unsigned long long, const QString &, const QString &)));
-    connect(&m_Camera, SIGNAL(OnCameraFrameReady_Signal(const QImage &, const unsigned long long &)),                                       this, SLOT(OnFrameReady(const QImage &, const unsigned long long &)), Qt::QueuedConnection);
+    connect(&m_Camera, SIGNAL(OnCameraFrameReady_Signal(const QImage &, const QImage &, const unsigned long long &)),                      this, SLOT(OnFrameReady(const QImage &, const QImage &, const unsigned long long &)), Qt::QueuedConnection);
     connect(&m_Camera, SIGNAL(OnCameraFrameID_Signal(const unsigned long long &)),                                                          this, SLOT(OnFrameID(const unsigned long long &)));
     connect(&m_Camera, SIGNAL(OnCameraPixelFormat_Signal(const QString &)),                                                                 this, SLOT(OnCameraPixelFormat(const QString &)));
 
     qRegisterMetaType<int32_t>("int32_t");
     qRegisterMetaType<int64_t>("int64_t");
+    qRegisterMetaType<QList<QString> >("QList<QString>");
+    qRegisterMetaType<QList<int64_t> >("QList<int64_t>");
+    qRegisterMetaType<DeviceState>("DeviceState");
 
     connect(&m_Camera, SIGNAL(PassAutoExposureValue(int64_t)), this, SLOT(OnUpdateAutoExposure(int64_t)), Qt::QueuedConnection);
     connect(&m_Camera, SIGNAL(PassAutoGainValue(int32_t)), this, SLOT(OnUpdateAutoGain(int32_t)), Qt::QueuedConnection);
@@ -147,6 +154,9 @@ V4L2Viewer::V4L2Viewer(QWidget *parent, Qt::WindowFlags flags)
 	connect(&m_Camera,SIGNAL(SendControlStateChange(int32_t, bool)),this,SLOT(PassControlStateChange(int32_t, bool)));
 
     connect(&m_Camera, SIGNAL(SendSignalToUpdateWidgets()), this, SLOT(OnReadAllValues()));
+    connect(&m_Camera, SIGNAL(SendControlValuesRead(int32_t)), this, SLOT(OnControlValuesRead(int32_t)));
+    connect(&m_Camera, SIGNAL(SendControlsDescribed(int32_t)), this, SLOT(OnControlsDescribed(int32_t)));
+    connect(&m_Camera, SIGNAL(SendDeviceState(const DeviceState &, uint32_t)), this, SLOT(OnDeviceStateChanged(const DeviceState &, uint32_t)));
 
     // Setup blocking mode radio buttons
     m_BlockingModeRadioButtonGroup = new QButtonGroup(this);
@@ -211,16 +221,6 @@ V4L2Viewer::V4L2Viewer(QWidget *parent, Qt::WindowFlags flags)
     ui.m_Splitter2->setStretchFactor(0, 75);
     ui.m_Splitter2->setStretchFactor(1, 25);
 
-    // Set the viewer scene
-    m_pScene = QSharedPointer<QGraphicsScene>(new QGraphicsScene());
-
-    m_PixmapItem = new QGraphicsPixmapItem();
-
-    ui.m_ImageView->setScene(m_pScene.data());
-    ui.m_ImageView->SetPixmapItem(m_PixmapItem);
-
-    m_pScene->addItem(m_PixmapItem);
-
     // add about widget to the menu bar
     m_pAboutWidget = new AboutWidget(this);
     m_pAboutWidget->SetVersion(QString("%1.%2.%3").arg(APP_VERSION_MAJOR).arg(APP_VERSION_MINOR).arg(APP_VERSION_PATCH));
@@ -228,6 +228,145 @@ V4L2Viewer::V4L2Viewer(QWidget *parent, Qt::WindowFlags flags)
     aboutWidgetAction->setDefaultWidget(m_pAboutWidget);
     ui.m_MenuAbout->addAction(aboutWidgetAction);
 
+    // add the YCbCr conversion choices to the settings menu, the value packs matrix and range
+    struct
+    {
+        const char *title;
+        yuvconversion::ColorMatrix matrix;
+        yuvconversion::ColorRange range;
+    } yuvConversions[] =
+    {
+        { "Auto (driver colorimetry)", yuvconversion::ColorMatrixAuto, yuvconversion::ColorRangeAuto },
+        { "BT.601 limited range", yuvconversion::ColorMatrixBT601, yuvconversion::ColorRangeLimited },
+        { "BT.601 full range", yuvconversion::ColorMatrixBT601, yuvconversion::ColorRangeFull },
+        { "BT.709 limited range", yuvconversion::ColorMatrixBT709, yuvconversion::ColorRangeLimited },
+        { "BT.709 full range", yuvconversion::ColorMatrixBT709, yuvconversion::ColorRangeFull },
+        { "Approximate (legacy)", yuvconversion::ColorMatrixApproximate, yuvconversion::ColorRangeLimited },
+    };
+    QMenu *yuvConversionMenu = ui.m_MenuOptions->addMenu(tr("YUV conversion"));
+    m_pYuvConversionGroup = new QActionGroup(this);
+    m_pYuvConversionGroup->setExclusive(true);
+    for (size_t i = 0; i < sizeof(yuvConversions) / sizeof(yuvConversions[0]); i++)
+    {
+        QAction *action = yuvConversionMenu->addAction(tr(yuvConversions[i].title));
+        action->setCheckable(true);
+        action->setChecked(0 == i);
+        action->setData((yuvConversions[i].matrix << 8) | yuvConversions[i].range);
+        m_pYuvConversionGroup->addAction(action);
+    }
+
+    // add the MJPEG preview scaling, the frames are reduced while decoding
+    QMenu *mjpegScaleMenu = ui.m_MenuOptions->addMenu(tr("MJPEG preview scale"));
+    m_pMjpegScaleGroup = new QActionGroup(this);
+    m_pMjpegScaleGroup->setExclusive(true);
+    for (int scaleDenominator = 1; scaleDenominator <= 8; scaleDenominator *= 2)
+    {
+        QAction *action = mjpegScaleMenu->addAction(QString("1/%1").arg(scaleDenominator));
+        action->setCheckable(true);
+        action->setChecked(1 == scaleDenominator);
+        action->setData(scaleDenominator);
+        m_pMjpegScaleGroup->addAction(action);
+    }
+
+    // 10 and 12 bit formats are shown through a window/level mapping of their
+    // 16 bit images, right button dragging on the image adjusts it manually
+    m_pHighBitDepthAction = ui.m_MenuOptions->addAction(tr("High bit depth preview"));
+    m_pHighBitDepthAction->setCheckable(true);
+    m_pHighBitDepthAction->setChecked(false);
+    m_pAutoWindowLevelAction = ui.m_MenuOptions->addAction(tr("Auto window/level"));
+    m_pAutoWindowLevelAction->setCheckable(true);
+    m_pAutoWindowLevelAction->setChecked(true);
+    connect(m_pAutoWindowLevelAction, SIGNAL(toggled(bool)), this, SLOT(OnAutoWindowLevelToggled(bool)));
+    connect(ui.m_ImageView, SIGNAL(AutoWindowLevelChanged(bool)), m_pAutoWindowLevelAction, SLOT(setChecked(bool)));
+    connect(ui.m_ImageView, SIGNAL(WindowLevelChanged(bool, int, int)), this, SLOT(OnWindowLevelChanged(bool, int, int)));
+
+    // 10 and 12 bit data in 16 bit containers, the SoC decides the alignment otherwise
+    m_pAutoShiftAction = ui.m_MenuOptions->addAction(tr("Detect 16 bit container alignment"));
+    m_pAutoShiftAction->setCheckable(true);
+    m_pAutoShiftAction->setChecked(false);
+
+    // large frames of user pointer streams without TLB misses and first touch page faults
+    m_pBufferArenaAction = ui.m_MenuOptions->addAction(tr("Huge page buffer arena (user pointer)"));
+    m_pBufferArenaAction->setCheckable(true);
+    m_pBufferArenaAction->setChecked(false);
+
+    // start with the fewest buffers and add more only if the driver runs dry
+    m_pAdaptiveBufferCountAction = ui.m_MenuOptions->addAction(tr("Adaptive buffer count"));
+    m_pAdaptiveBufferCountAction->setCheckable(true);
+    m_pAdaptiveBufferCountAction->setChecked(false);
+
+    // non-coherent platforms spend much of a frame on cache maintenance,
+    // the latency benchmark logs the cost of the chosen mode per stream
+    const struct
+    {
+        const char *title;
+        BufferCacheMode cacheMode;
+    } bufferCacheModes[] =
+    {
+        { "Maintained (driver default)", BufferCacheMaintained },
+        { "Skip for unread frames", BufferCacheSkipUnread },
+        { "Skip always (frames may be stale)", BufferCacheSkipAlways },
+    };
+    QMenu *bufferCacheMenu = ui.m_MenuOptions->addMenu(tr("Buffer cache maintenance"));
+    m_pBufferCacheGroup = new QActionGroup(this);
+    m_pBufferCacheGroup->setExclusive(true);
+    for (size_t i = 0; i < sizeof(bufferCacheModes) / sizeof(bufferCacheModes[0]); i++)
+    {
+        QAction *action = bufferCacheMenu->addAction(tr(bufferCacheModes[i].title));
+        action->setCheckable(true);
+        action->setChecked(0 == i);
+        action->setData(bufferCacheModes[i].cacheMode);
+        m_pBufferCacheGroup->addAction(action);
+    }
+    m_pPrepareBuffersAction = bufferCacheMenu->addAction(tr("Prepare buffers before queuing"));
+    m_pPrepareBuffersAction->setCheckable(true);
+    m_pPrepareBuffersAction->setChecked(false);
+    m_pReadLatencyAction = bufferCacheMenu->addAction(tr("Log dequeue to read latency"));
+    m_pReadLatencyAction->setCheckable(true);
+    m_pReadLatencyAction->setChecked(false);
+
+    // the buffers are written as they are, a slow disk drops frames instead of memory
+    m_pFrameDumpAction = ui.m_MenuOptions->addAction(tr("Write raw frames to home directory"));
+    m_pFrameDumpAction->setCheckable(true);
+    m_pFrameDumpAction->setChecked(false);
+
+    // display only gamma, contrast and brightness, the camera settings stay untouched
+    m_pToneMappingDialog = NULL;
+    m_pDisplayGammaSlider = NULL;
+    m_pDisplayContrastSlider = NULL;
+    m_pDisplayBrightnessSlider = NULL;
+    QAction *toneMappingAction = ui.m_MenuOptions->addAction(tr("Display tone curve..."));
+    connect(toneMappingAction, SIGNAL(triggered()), this, SLOT(OnToneMappingClicked()));
+
+    QAction *controlTimingAction = ui.m_MenuOptions->addAction(tr("Compare control read times"));
+    connect(controlTimingAction, SIGNAL(triggered()), this, SLOT(OnCompareControlReadTimes()));
+
+    // slider values are collapsed to the newest one and written at most this often
+    const struct
+    {
+        const char *title;
+        unsigned int writesPerSecond;
+    } controlWriteRates[] =
+    {
+        { "10 per second", 10 },
+        { "30 per second", 30 },
+        { "60 per second", 60 },
+        { "Unlimited", 0 },
+    };
+    QMenu *controlWriteRateMenu = ui.m_MenuOptions->addMenu(tr("Control write rate"));
+    m_pControlWriteRateGroup = new QActionGroup(this);
+    m_pControlWriteRateGroup->setExclusive(true);
+    for (size_t i = 0; i < sizeof(controlWriteRates) / sizeof(controlWriteRates[0]); i++)
+    {
+        QAction *action = controlWriteRateMenu->addAction(tr(controlWriteRates[i].title));
+        action->setCheckable(true);
+        action->setChecked(30 == controlWriteRates[i].writesPerSecond);
+        action->setData(controlWriteRates[i].writesPerSecond);
+        m_pControlWriteRateGroup->addAction(action);
+    }
+    connect(m_pControlWriteRateGroup, SIGNAL(triggered(QAction*)), this, SLOT(OnControlWriteRateChanged(QAction*)));
+    m_Camera.SetControlWriteRate(m_pControlWriteRateGroup->checkedAction()->data().toUInt());
+
     ui.menuBar->setNativeMenuBar(false);
 
     QMainWindow::showMaximized();
@@ -253,7 +392,7 @@ V4L2Viewer::V4L2Viewer(QWidget *parent, Qt::WindowFlags flags)
                                                 "titlebar-close-icon: url(:/V4L2Viewer/Cross128.png);"
                                                 "titlebar-normal-icon: url(:/V4L2Viewer/resize4.png);}");
 
-    LOG_EX(QString("V4L2Viewer git commit = %1").arg(GIT_VERSION).toStdString().c_str());
+    LOG_EX("V4L2Viewer git commit = %s", GIT_VERSION);
 
     ui.m_MenuLang->menuAction()->setEnabled(false);
     ui.m_MenuLang->menuAction()->setVisible(false);
@@ -532,6 +671,7 @@ void V4L2Viewer::OnOpenCloseButtonClicked()
             }
 
             // Start
+            m_OpenTimer.start();
             err = OpenAndSetupCamera(m_cameras[nRow], deviceName, selectedSubDeviceList);
             // Set up Qt image
             if (0 == err)
@@ -556,15 +696,21 @@ void V4L2Viewer::OnOpenCloseButtonClicked()
                 ui.m_FlipVerticalCheckBox->setEnabled(true);
                 ui.m_DisplayImagesCheckBox->setEnabled(true);
                 ui.m_SaveImageButton->setEnabled(true);
+                // the control values follow from the enumeration thread
+                LOG_EX("V4L2Viewer::OnOpenCloseButtonClicked camera interactive %lld ms after opening", static_cast<long long>(m_OpenTimer.elapsed()));
             }
             else
+            {
+                m_OpenTimer.invalidate();
                 CloseCamera(m_cameras[nRow]);
+            }
 
             m_bIsOpen = (0 == err);
         }
         else
         {
             m_bIsOpen = false;
+            m_bIsDescribedFromOpen = false;
 
             // Stop
             if (true == m_bIsStreaming)
@@ -621,6 +767,12 @@ void V4L2Viewer::OnOpenCloseButtonClicked()
 
 // The event handler for starting
 void V4L2Viewer::OnStartButtonClicked()
+{
+    m_Camera.StartTimeToFirstFrame();
+    StartStreamingWithCurrentFormat();
+}
+
+void V4L2Viewer::StartStreamingWithCurrentFormat()
 {
     uint32_t payloadSize = 0;
     uint32_t width = 0;
@@ -635,7 +787,7 @@ void V4L2Viewer::OnStartButtonClicked()
     result = m_Camera.ReadFrameSize(width, height);
     result = m_Camera.ReadPixelFormat(pixelFormat, bytesPerLine, pixelFormatText);
 
-    LOG_EX("V4L2Viewer::OnStartButtonClicked width=%d,height=%d", width, height);
+    LOG_EX("V4L2Viewer::StartStreamingWithCurrentFormat width=%d,height=%d", width, height);
 
     if (result == 0)
         StartStreaming(pixelFormat, payloadSize, width, height, bytesPerLine);
@@ -693,33 +845,34 @@ void V4L2Viewer::OnSliderExposureValueChange(int value)
     int64_t sliderExposureValue64 = static_cast<int64_t>(outValue);
 
     ui.m_edExposure->setText(QString("%1").arg(sliderExposureValue64));
-    m_Camera.SetExposure(sliderExposureValue64);
+    // dragging produces values faster than the driver takes them, only the newest is written
+    m_Camera.QueueControlWrite(V4L2_CID_EXPOSURE, sliderExposureValue64);
 }
 
 void V4L2Viewer::OnSliderGainValueChange(int value)
 {
     ui.m_edGain->setText(QString::number(value));
     m_sliderGainValue = static_cast<int32_t>(value);
-    m_Camera.SetGain(m_sliderGainValue);
+    m_Camera.QueueControlWrite(V4L2_CID_GAIN, m_sliderGainValue);
 }
 
 void V4L2Viewer::OnSliderGammaValueChange(int value)
 {
     ui.m_edGamma->setText(QString::number(value));
     m_sliderGammaValue = static_cast<int32_t>(value);
-    m_Camera.SetGamma(m_sliderGammaValue);
+    m_Camera.QueueControlWrite(V4L2_CID_GAMMA, m_sliderGammaValue);
 }
 
 void V4L2Viewer::OnSliderBrightnessValueChange(int value)
 {
     ui.m_edBrightness->setText(QString::number(value));
     m_sliderBrightnessValue = static_cast<int32_t>(value);
-    m_Camera.SetBrightness(m_sliderBrightnessValue);
+    m_Camera.QueueControlWrite(V4L2_CID_BRIGHTNESS, m_sliderBrightnessValue);
 }
 
 void V4L2Viewer::OnSlidersReleased()
 {
-    GetImageInformation();
+    OnReadAllValues();
 }
 
 void V4L2Viewer::OnCameraListButtonClicked()
@@ -761,119 +914,218 @@ void V4L2Viewer::ShowHideEnumerationControlWidget()
 
 void V4L2Viewer::PassIntDataToEnumerationWidget(int32_t id, int32_t min, int32_t max, int32_t value, QString name, QString unit, bool bIsReadOnly)
 {
-    if (!m_pEnumerationControlWidget->IsControlAlreadySet(id))
+    // values read before the camera was closed are still queued
+    if (!m_bIsOpen)
+    {
+        return;
+    }
+
+    bool bIsSucced;
+    IControlEnumerationHolder *obj = m_pEnumerationControlWidget->GetControlWidget(id, bIsSucced);
+    if (bIsSucced)
     {
-        IControlEnumerationHolder *ptr = new IntegerEnumerationControl(id, min, max, value, name, unit, bIsReadOnly, this);
-        connect(dynamic_cast<IntegerEnumerationControl*>(ptr), SIGNAL(PassNewValue(int32_t, int32_t)), &m_Camera, SLOT(SetEnumerationControlValue(int32_t, int32_t)));
-        connect(dynamic_cast<IntegerEnumerationControl*>(ptr), SIGNAL(PassSliderValue(int32_t, int32_t)), &m_Camera, SLOT(SetSliderEnumerationControlValue(int32_t, int32_t)));
-        m_pEnumerationControlWidget->AddElement(ptr);
+        dynamic_cast<IntegerEnumerationControl*>(obj)->UpdateRange(min, max);
+        dynamic_cast<IntegerEnumerationControl*>(obj)->UpdateValue(value);
     }
     else
     {
-        bool bIsSucced;
-        IControlEnumerationHolder *obj = m_pEnumerationControlWidget->GetControlWidget(id, bIsSucced);
-        if (bIsSucced)
+        // the widget is created when its row is shown, with the newest values passed until then
+        m_pEnumerationControlWidget->AddElement(id, name, [=]() -> IControlEnumerationHolder*
         {
-            dynamic_cast<IntegerEnumerationControl*>(obj)->UpdateValue(value);
-        }
+            IControlEnumerationHolder *ptr = new IntegerEnumerationControl(id, min, max, value, name, unit, bIsReadOnly, this);
+            connect(dynamic_cast<IntegerEnumerationControl*>(ptr), SIGNAL(PassNewValue(int32_t, int32_t)), &m_Camera, SLOT(SetEnumerationControlValue(int32_t, int32_t)));
+            connect(dynamic_cast<IntegerEnumerationControl*>(ptr), SIGNAL(PassSliderValue(int32_t, int32_t)), &m_Camera, SLOT(SetSliderEnumerationControlValue(int32_t, int32_t)));
+            return ptr;
+        });
     }
 }
 
 void V4L2Viewer::PassIntDataToEnumerationWidget(int32_t id, int64_t min, int64_t max, int64_t value, QString name, QString unit, bool bIsReadOnly)
 {
-    if (!m_pEnumerationControlWidget->IsControlAlreadySet(id))
+    if (!m_bIsOpen)
     {
-        IControlEnumerationHolder *ptr = new Integer64EnumerationControl(id, min, max, value, name, unit, bIsReadOnly, this);
-        connect(dynamic_cast<Integer64EnumerationControl*>(ptr), SIGNAL(PassNewValue(int32_t, int64_t)), &m_Camera, SLOT(SetEnumerationControlValue(int32_t, int64_t)));
-        connect(dynamic_cast<Integer64EnumerationControl*>(ptr), SIGNAL(PassSliderValue(int32_t, int64_t)), &m_Camera, SLOT(SetSliderEnumerationControlValue(int32_t, int64_t)));
-        m_pEnumerationControlWidget->AddElement(ptr);
+        return;
+    }
+
+    bool bIsSucced;
+    IControlEnumerationHolder *obj = m_pEnumerationControlWidget->GetControlWidget(id, bIsSucced);
+    if (bIsSucced)
+    {
+        dynamic_cast<Integer64EnumerationControl*>(obj)->UpdateRange(min, max);
+        dynamic_cast<Integer64EnumerationControl*>(obj)->UpdateValue(value);
     }
     else
     {
-        bool bIsSucced;
-        IControlEnumerationHolder *obj = m_pEnumerationControlWidget->GetControlWidget(id, bIsSucced);
-        if (bIsSucced)
+        m_pEnumerationControlWidget->AddElement(id, name, [=]() -> IControlEnumerationHolder*
         {
-            dynamic_cast<Integer64EnumerationControl*>(obj)->UpdateValue(value);
-        }
+            IControlEnumerationHolder *ptr = new Integer64EnumerationControl(id, min, max, value, name, unit, bIsReadOnly, this);
+            connect(dynamic_cast<Integer64EnumerationControl*>(ptr), SIGNAL(PassNewValue(int32_t, int64_t)), &m_Camera, SLOT(SetEnumerationControlValue(int32_t, int64_t)));
+            connect(dynamic_cast<Integer64EnumerationControl*>(ptr), SIGNAL(PassSliderValue(int32_t, int64_t)), &m_Camera, SLOT(SetSliderEnumerationControlValue(int32_t, int64_t)));
+            return ptr;
+        });
     }
 }
 
 void V4L2Viewer::PassBoolDataToEnumerationWidget(int32_t id, bool value, QString name, QString unit, bool bIsReadOnly)
 {
-    if (!m_pEnumerationControlWidget->IsControlAlreadySet(id))
+    if (!m_bIsOpen)
     {
-        IControlEnumerationHolder *ptr = new BooleanEnumerationControl(id, value, name, unit, bIsReadOnly, this);
-        connect(dynamic_cast<BooleanEnumerationControl*>(ptr), SIGNAL(PassNewValue(int32_t, bool)), &m_Camera, SLOT(SetEnumerationControlValue(int32_t, bool)));
-        m_pEnumerationControlWidget->AddElement(ptr);
+        return;
+    }
+
+    bool bIsSucced;
+    IControlEnumerationHolder *obj = m_pEnumerationControlWidget->GetControlWidget(id, bIsSucced);
+    if (bIsSucced)
+    {
+        dynamic_cast<BooleanEnumerationControl*>(obj)->UpdateValue(value);
     }
     else
     {
-        bool bIsSucced;
-        IControlEnumerationHolder *obj = m_pEnumerationControlWidget->GetControlWidget(id, bIsSucced);
-        if (bIsSucced)
+        m_pEnumerationControlWidget->AddElement(id, name, [=]() -> IControlEnumerationHolder*
         {
-            dynamic_cast<BooleanEnumerationControl*>(obj)->UpdateValue(value);
-        }
+            IControlEnumerationHolder *ptr = new BooleanEnumerationControl(id, value, name, unit, bIsReadOnly, this);
+            connect(dynamic_cast<BooleanEnumerationControl*>(ptr), SIGNAL(PassNewValue(int32_t, bool)), &m_Camera, SLOT(SetEnumerationControlValue(int32_t, bool)));
+            return ptr;
+        });
     }
 }
 
 void V4L2Viewer::PassButtonDataToEnumerationWidget(int32_t id, QString name, QString unit, bool bIsReadOnly)
 {
+    if (!m_bIsOpen)
+    {
+        return;
+    }
+
     if (!m_pEnumerationControlWidget->IsControlAlreadySet(id))
     {
-        IControlEnumerationHolder *ptr = new ButtonEnumerationControl(id, name, unit, bIsReadOnly, this);
-        connect(dynamic_cast<ButtonEnumerationControl*>(ptr), SIGNAL(PassActionPerform(int32_t)), &m_Camera, SLOT(SetEnumerationControlValue(int32_t)));
-        m_pEnumerationControlWidget->AddElement(ptr);
+        m_pEnumerationControlWidget->AddElement(id, name, [=]() -> IControlEnumerationHolder*
+        {
+            IControlEnumerationHolder *ptr = new ButtonEnumerationControl(id, name, unit, bIsReadOnly, this);
+            connect(dynamic_cast<ButtonEnumerationControl*>(ptr), SIGNAL(PassActionPerform(int32_t)), &m_Camera, SLOT(SetEnumerationControlValue(int32_t)));
+            return ptr;
+        });
     }
 }
 
 void V4L2Viewer::PassListDataToEnumerationWidget(int32_t id, int32_t value, QList<QString> list, QString name, QString unit, bool bIsReadOnly)
 {
-    if (!m_pEnumerationControlWidget->IsControlAlreadySet(id))
+    if (!m_bIsOpen)
     {
-        IControlEnumerationHolder *ptr = new ListEnumerationControl(id, value, list, name, unit, bIsReadOnly, this);
-        connect(dynamic_cast<ListEnumerationControl*>(ptr), SIGNAL(PassNewValue(int32_t, const char *)), &m_Camera, SLOT(SetEnumerationControlValueList(int32_t, const char*)));
-        m_pEnumerationControlWidget->AddElement(ptr);
+        return;
+    }
+
+    bool bIsSucced;
+    IControlEnumerationHolder *obj = m_pEnumerationControlWidget->GetControlWidget(id, bIsSucced);
+    if (bIsSucced)
+    {
+        dynamic_cast<ListEnumerationControl*>(obj)->UpdateValue(list, value);
     }
     else
     {
-        bool bIsSucced;
-        IControlEnumerationHolder *obj = m_pEnumerationControlWidget->GetControlWidget(id, bIsSucced);
-        if (bIsSucced)
+        // the menu items are only queried for menus which are shown
+        m_pEnumerationControlWidget->AddElement(id, name, [=]() -> IControlEnumerationHolder*
         {
-            dynamic_cast<ListEnumerationControl*>(obj)->UpdateValue(list, value);
-        }
+            QList<QString> items = list;
+            if (items.empty())
+            {
+                m_Camera.ReadControlMenu(id, items);
+            }
+            IControlEnumerationHolder *ptr = new ListEnumerationControl(id, value, items, name, unit, bIsReadOnly, this);
+            connect(dynamic_cast<ListEnumerationControl*>(ptr), SIGNAL(PassNewValue(int32_t, const char *)), &m_Camera, SLOT(SetEnumerationControlValueList(int32_t, const char*)));
+            return ptr;
+        });
     }
 }
 
 void V4L2Viewer::PassListDataToEnumerationWidget(int32_t id, int32_t value, QList<int64_t> list, QString name, QString unit, bool bIsReadOnly)
 {
-    if (!m_pEnumerationControlWidget->IsControlAlreadySet(id))
+    if (!m_bIsOpen)
+    {
+        return;
+    }
+
+    bool bIsSucced;
+    IControlEnumerationHolder *obj = m_pEnumerationControlWidget->GetControlWidget(id, bIsSucced);
+    if (bIsSucced)
     {
-        IControlEnumerationHolder *ptr = new ListIntEnumerationControl(id, value, list, name, unit, bIsReadOnly, this);
-        connect(dynamic_cast<ListIntEnumerationControl*>(ptr), SIGNAL(PassNewValue(int32_t, int64_t)), &m_Camera, SLOT(SetEnumerationControlValueIntList(int32_t, int64_t)));
-        m_pEnumerationControlWidget->AddElement(ptr);
+        dynamic_cast<ListIntEnumerationControl*>(obj)->UpdateValue(list, value);
     }
     else
     {
-        bool bIsSucced;
-        IControlEnumerationHolder *obj = m_pEnumerationControlWidget->GetControlWidget(id, bIsSucced);
-        if (bIsSucced)
+        m_pEnumerationControlWidget->AddElement(id, name, [=]() -> IControlEnumerationHolder*
         {
-            dynamic_cast<ListIntEnumerationControl*>(obj)->UpdateValue(list, value);
-        }
+            QList<int64_t> items = list;
+            if (items.empty())
+            {
+                m_Camera.ReadControlMenu(id, items);
+            }
+            IControlEnumerationHolder *ptr = new ListIntEnumerationControl(id, value, items, name, unit, bIsReadOnly, this);
+            connect(dynamic_cast<ListIntEnumerationControl*>(ptr), SIGNAL(PassNewValue(int32_t, int64_t)), &m_Camera, SLOT(SetEnumerationControlValueIntList(int32_t, int64_t)));
+            return ptr;
+        });
+    }
+}
+
+void V4L2Viewer::OnControlValuesRead(int32_t controlCount)
+{
+    if (m_OpenTimer.isValid())
+    {
+        LOG_EX("V4L2Viewer::OnControlValuesRead %d controls listed %lld ms after opening, %d widgets created", controlCount, static_cast<long long>(m_OpenTimer.elapsed()), m_pEnumerationControlWidget->GetCreatedElementCount());
+        m_OpenTimer.invalidate();
+    }
+}
+
+void V4L2Viewer::OnDeviceStateChanged(const DeviceState &state, uint32_t changedMask)
+{
+    if (!m_bIsOpen)
+        return;
+
+    // a slider held by the user keeps its position, the released slider refreshes anyway
+    if ((changedMask & DeviceStateGain) && !ui.m_sliderGain->isSliderDown())
+    {
+        ui.m_edGain->setText(QString("%1").arg(state.gain));
+        UpdateSlidersPositions(ui.m_sliderGain, state.gain);
+    }
+    if (changedMask & DeviceStateAutoGain)
+    {
+        ui.m_chkAutoGain->setChecked(state.bAutoGain);
+        ui.m_sliderGain->setEnabled(!state.bAutoGain);
+    }
+    if ((changedMask & DeviceStateExposure) && !ui.m_sliderExposure->isSliderDown())
+    {
+        ui.m_edExposure->setText(QString("%1").arg(state.exposure));
+        UpdateSlidersPositions(ui.m_sliderExposure, GetSliderValueFromLog(state.exposure));
+    }
+    if (changedMask & DeviceStateAutoExposure)
+    {
+        ui.m_chkAutoExposure->setChecked(state.bAutoExposure);
+        ui.m_sliderExposure->setEnabled(!state.bAutoExposure);
+    }
+    if ((changedMask & DeviceStateGamma) && !ui.m_sliderGamma->isSliderDown())
+    {
+        ui.m_edGamma->setText(QString("%1").arg(state.gamma));
+        UpdateSlidersPositions(ui.m_sliderGamma, state.gamma);
+    }
+    if ((changedMask & DeviceStateBrightness) && !ui.m_sliderBrightness->isSliderDown())
+    {
+        ui.m_edBrightness->setText(QString("%1").arg(state.brightness));
+        UpdateSlidersPositions(ui.m_sliderBrightness, state.brightness);
+    }
+    if (changedMask & DeviceStateAutoWhiteBalance)
+    {
+        ui.m_chkContWhiteBalance->setChecked(state.bAutoWhiteBalance);
+    }
+    if (changedMask & DeviceStateFrameSize)
+    {
+        ui.m_edWidth->setText(QString("%1").arg(state.width));
+        ui.m_edHeight->setText(QString("%1").arg(state.height));
     }
 }
 
 void V4L2Viewer::PassControlStateChange(int32_t id, bool enabled)
 {
-	bool bIsSucced;
-	IControlEnumerationHolder *obj = m_pEnumerationControlWidget->GetControlWidget(id, bIsSucced);
-	if (bIsSucced)
-	{
-		obj->setEnabled(enabled);
-	}
+	m_pEnumerationControlWidget->SetElementEnabled(id, enabled);
 
 	switch (id) {
 		case V4L2_CID_BRIGHTNESS:
@@ -964,10 +1216,7 @@ void V4L2Viewer::OnFlipHorizontal(int state)
     Q_UNUSED(state)
     if (!m_bIsStreaming)
     {
-        QImage image = m_PixmapItem->pixmap().toImage();
-        image = image.mirrored(true, false);
-        m_PixmapItem->setPixmap(QPixmap::fromImage(image));
-        m_PixmapItem->update();
+        ui.m_ImageView->SetImage(ui.m_ImageView->GetImage().mirrored(true, false));
     }
 }
 
@@ -976,10 +1225,7 @@ void V4L2Viewer::OnFlipVertical(int state)
     Q_UNUSED(state)
     if (!m_bIsStreaming)
     {
-        QImage image = m_PixmapItem->pixmap().toImage();
-        image = image.mirrored(false, true);
-        m_PixmapItem->setPixmap(QPixmap::fromImage(image));
-        m_PixmapItem->update();
+        ui.m_ImageView->SetImage(ui.m_ImageView->GetImage().mirrored(false, true));
     }
 }
 
@@ -990,35 +1236,39 @@ void V4L2Viewer::StartStreaming(uint32_t pixelFormat, uint32_t payloadSize, uint
     // disable the start button to show that the start acquisition is in process
     ui.m_StartButton->setEnabled(false);
 
-    ui.m_labelPixelFormats->setEnabled(false);
-	ui.m_labelFrameSizes->setEnabled(false);
-    ui.m_pixelFormats->setEnabled(false);
-	ui.m_frameSizes->setEnabled(false);
-
+    // pixel format, frame size and crop stay enabled, their changes restart the stream
     ui.m_labelFrameRate->setEnabled(false);
     ui.m_edFrameRate->setEnabled(false);
 
     ui.m_labelFrameRateAuto->setEnabled(false);
     ui.m_chkFrameRateAuto->setEnabled(false);
 
-    if (m_bIsCropAvailable)
-    {
-        ui.m_cropWidget->setEnabled(false);
-    }
-
     QApplication::processEvents();
 
     LOG_EX("V4L2Viewer::StartStreaming pixelFormat=%d,payloadSize=%d,width=%d,height=%d,bytesPerLine=%d", pixelFormat, payloadSize, width, height, bytesPerLine);
 
     // start streaming
 
-    if (m_Camera.CreateUserBuffer(m_NUMBER_OF_USED_FRAMES, payloadSize) == 0)
+    m_Camera.SetBufferArena(m_pBufferArenaAction->isChecked());
+    m_Camera.SetBufferQueuing(static_cast<BufferCacheMode>(m_pBufferCacheGroup->checkedAction()->data().toInt()),
+                              m_pPrepareBuffersAction->isChecked());
+    m_Camera.SetReadLatencyBenchmark(m_pReadLatencyAction->isChecked());
+    m_Camera.SetFrameDump(m_pFrameDumpAction->isChecked(), QDir::homePath().toStdString());
+    uint32_t bufferCount = m_pAdaptiveBufferCountAction->isChecked() ? ADAPTIVE_BUFFER_COUNT_START : m_NUMBER_OF_USED_FRAMES;
+    if (m_Camera.CreateUserBuffer(bufferCount, payloadSize) == 0)
     {
         LOG_EX("V4L2Viewer::StartStreaming streaming will be started");
         if (m_Camera.QueueAllUserBuffer() == 0)
         {
             if (m_Camera.StartStreaming() == 0)
             {
+                int yuvConversion = m_pYuvConversionGroup->checkedAction()->data().toInt();
+                m_Camera.SetYuvConversion(static_cast<yuvconversion::ColorMatrix>(yuvConversion >> 8),
+                                          static_cast<yuvconversion::ColorRange>(yuvConversion & 0xFF));
+                m_Camera.SetScaleDenominator(m_pMjpegScaleGroup->checkedAction()->data().toUInt());
+                m_Camera.SetHighBitDepth(m_pHighBitDepthAction->isChecked());
+                m_Camera.SetAutoShift(m_pAutoShiftAction->isChecked());
+
                 err = m_Camera.StartStreamChannel(pixelFormat,
                                                   payloadSize,
                                                   width,
@@ -1034,6 +1284,7 @@ void V4L2Viewer::StartStreaming(uint32_t pixelFormat, uint32_t payloadSize, uint
                     UpdateViewerLayout();
 
                     m_FramesReceivedTimer.start(1000);
+                    m_Camera.StartDeviceStateSync();
 
                     return;
                 }
@@ -1119,10 +1370,29 @@ void V4L2Viewer::OnStopButtonClicked()
     UpdateViewerLayout();
 
     m_FramesReceivedTimer.stop();
+    m_Camera.StopDeviceStateSync();
 
     m_Camera.DeleteUserBuffer();
 }
 
+bool V4L2Viewer::SuspendStreaming()
+{
+    if (!m_bIsStreaming)
+        return false;
+
+    // the restart is measured up to its first frame
+    m_Camera.StartTimeToFirstFrame();
+
+    m_FramesReceivedTimer.stop();
+    m_Camera.StopDeviceStateSync();
+    m_Camera.StopStreamChannel();
+    m_Camera.StopStreaming();
+    m_Camera.ReleaseUserBuffer();
+    m_bIsStreaming = false;
+
+    return true;
+}
+
 void V4L2Viewer::OnSaveImageClicked()
 {
     QString filename = "/Frame_"+QString::number(m_SavedFramesCounter)+m_LastImageSaveFormat;
@@ -1131,16 +1401,14 @@ void V4L2Viewer::OnSaveImageClicked()
     if (fullPath.contains(".png"))
     {
         m_LastImageSaveFormat = ".png";
-        QPixmap pixmap = m_PixmapItem->pixmap();
-        QImage image = pixmap.toImage();
+        QImage image = ui.m_ImageView->GetImage();
         image.save(fullPath,"png");
         m_SavedFramesCounter++;
     }
     else if(fullPath.contains(".raw"))
     {
         m_LastImageSaveFormat = ".raw";
-        QPixmap pixmap = m_PixmapItem->pixmap();
-        QImage image = pixmap.toImage();
+        QImage image = ui.m_ImageView->GetImage();
 #if QT_VERSION >= QT_VERSION_CHECK(5,10,0)
         int size = image.sizeInBytes();
 #else
@@ -1156,7 +1424,7 @@ void V4L2Viewer::OnSaveImageClicked()
 }
 
 // The event handler to show the processed frame
-void V4L2Viewer::OnFrameReady(const QImage &image, const unsigned long long &frameId)
+void V4L2Viewer::OnFrameReady(const QImage &image, const QImage &displayImage, const unsigned long long &frameId)
 {
     if (m_ShowFrames && m_bIsStreaming)
     {
@@ -1164,24 +1432,19 @@ void V4L2Viewer::OnFrameReady(const QImage &image, const unsigned long long &fra
         {
             if (ui.m_FlipHorizontalCheckBox->isChecked() || ui.m_FlipVerticalCheckBox->isChecked())
             {
-                QImage tmpImage;
-                if (ui.m_FlipVerticalCheckBox->isChecked())
-                    tmpImage = image.mirrored(false, true);
-                else
-                    tmpImage = image;
-                if (ui.m_FlipHorizontalCheckBox->isChecked())
-                    tmpImage = tmpImage.mirrored(true, false);
-                m_pScene->setSceneRect(0, 0, tmpImage.width(), tmpImage.height());
-                m_PixmapItem->setPixmap(QPixmap::fromImage(tmpImage));
-                ui.m_ImageView->show();
+                bool bHorizontal = ui.m_FlipHorizontalCheckBox->isChecked();
+                bool bVertical = ui.m_FlipVerticalCheckBox->isChecked();
+                QImage tmpImage = image.mirrored(bHorizontal, bVertical);
+                // 8 bit frames are their own display image and are only mirrored once
+                QImage tmpDisplayImage = (displayImage.cacheKey() == image.cacheKey()) ?
+                                         tmpImage : displayImage.mirrored(bHorizontal, bVertical);
+                ui.m_ImageView->SetImage(tmpImage, tmpDisplayImage);
 
                 ui.m_FrameIdLabel->setText(QString("Frame ID: %1, W: %2, H: %3").arg(frameId).arg(tmpImage.width()).arg(tmpImage.height()));
             }
             else
             {
-                m_pScene->setSceneRect(0, 0, image.width(), image.height());
-                m_PixmapItem->setPixmap(QPixmap::fromImage(image));
-                ui.m_ImageView->show();
+                ui.m_ImageView->SetImage(image, displayImage);
                 ui.m_FrameIdLabel->setText(QString("Frame ID: %1, W: %2, H: %3").arg(frameId).arg(image.width()).arg(image.height()));
             }
             if (!m_bIsImageFitByFirstImage)
@@ -1205,28 +1468,26 @@ void V4L2Viewer::OnFrameID(const unsigned long long &frameId)
 // This event handler is triggered through a Qt signal posted by the camera observer
 void V4L2Viewer::OnCameraListChanged(const int &reason, unsigned int cardNumber, unsigned long long deviceID, const QString &deviceName, const QString &info)
 {
-    bool bUpdateList = false;
+    int nRow = FindCameraListRow(deviceName);
 
     // We only react on new cameras being found and known cameras being unplugged
     if (UpdateTriggerPluggedIn == reason)
     {
-        bUpdateList = true;
-
-        std::string manuName;
-        std::string devName = deviceName.toLatin1().data();
+        if (-1 == nRow)
+        {
+            UpdateCameraListBox(cardNumber, deviceID, deviceName, info);
+        }
     }
-    else if (UpdateTriggerPluggedOut == reason)
+    else if (UpdateTriggerPluggedOut == reason && -1 != nRow)
     {
-        if ( true == m_bIsOpen )
+        // the open camera is the current row, other cameras are just removed
+        if ( true == m_bIsOpen && nRow == ui.m_CamerasListBox->currentRow() )
         {
             OnOpenCloseButtonClicked();
         }
-        bUpdateList = true;
-    }
 
-    if ( true == bUpdateList )
-    {
-        UpdateCameraListBox(cardNumber, deviceID, deviceName, info);
+        delete ui.m_CamerasListBox->takeItem(nRow);
+        m_cameras.erase(m_cameras.begin() + nRow);
     }
 
     ui.m_OpenCloseButton->setEnabled( 0 < m_cameras.size() || m_bIsOpen );
@@ -1294,14 +1555,28 @@ void V4L2Viewer::UpdateCameraListBox(uint32_t cardNumber, uint64_t cameraID, con
     ui.m_OpenCloseButton->setEnabled((0 < m_cameras.size()) || m_bIsOpen);
 }
 
+int V4L2Viewer::FindCameraListRow(const QString &deviceName)
+{
+    for (int row = 0; row < ui.m_CamerasListBox->count(); row++)
+    {
+        CameraListCustomItem *pItem = dynamic_cast<CameraListCustomItem*>(ui.m_CamerasListBox->itemWidget(ui.m_CamerasListBox->item(row)));
+
+        if (NULL != pItem && pItem->GetCameraName().startsWith("Camera: " + deviceName + " ("))
+        {
+            return row;
+        }
+    }
+
+    return -1;
+}
+
 // Update the viewer range
 void V4L2Viewer::UpdateViewerLayout()
 {
     if (!m_bIsOpen)
     {
         QPixmap pix(":/V4L2Viewer/icon_camera_256.png");
-        m_pScene->setSceneRect(0, 0, pix.width(), pix.height());
-        m_PixmapItem->setPixmap(pix);
+        ui.m_ImageView->SetImage(pix.toImage());
         ui.m_ImageView->show();
         m_bIsStreaming = false;
     }
@@ -1335,12 +1610,108 @@ void V4L2Viewer::UpdateViewerLayout()
 // The event handler to resize the image to fit to window
 void V4L2Viewer::OnZoomFitButtonClicked()
 {
-    ui.m_ImageView->SetScaleFactorToDefault();
-    ui.m_ImageView->fitInView(m_pScene->sceneRect(), Qt::KeepAspectRatio);
-    double scaleFitToView = ui.m_ImageView->transform().m11();
+    double scaleFitToView = ui.m_ImageView->FitToView();
     ui.m_ZoomLabel->setText(QString("%1%").arg(scaleFitToView * 100, 1, 'f',1));
 }
 
+// The event handler for the automatic window/level of 16 bit previews
+void V4L2Viewer::OnAutoWindowLevelToggled(bool checked)
+{
+    ui.m_ImageView->SetAutoWindowLevel(checked);
+}
+
+// The event handler to map the following 16 bit previews with the new window/level
+void V4L2Viewer::OnWindowLevelChanged(bool bAutoWindowLevel, int low, int high)
+{
+    m_Camera.SetWindowLevel(bAutoWindowLevel, static_cast<uint16_t>(low), static_cast<uint16_t>(high));
+}
+
+// The event handler to open the display tone curve dialog
+void V4L2Viewer::OnToneMappingClicked()
+{
+    if (NULL == m_pToneMappingDialog)
+    {
+        m_pToneMappingDialog = new QDialog(this);
+        m_pToneMappingDialog->setWindowTitle(tr("Display tone curve"));
+
+        // gamma in hundredths, contrast and brightness in percent
+        m_pDisplayGammaSlider = new QSlider(Qt::Horizontal, m_pToneMappingDialog);
+        m_pDisplayGammaSlider->setRange(10, 400);
+        m_pDisplayGammaSlider->setValue(100);
+        m_pDisplayContrastSlider = new QSlider(Qt::Horizontal, m_pToneMappingDialog);
+        m_pDisplayContrastSlider->setRange(-100, 100);
+        m_pDisplayContrastSlider->setValue(0);
+        m_pDisplayBrightnessSlider = new QSlider(Qt::Horizontal, m_pToneMappingDialog);
+        m_pDisplayBrightnessSlider->setRange(-100, 100);
+        m_pDisplayBrightnessSlider->setValue(0);
+        QPushButton *resetButton = new QPushButton(tr("Reset"), m_pToneMappingDialog);
+
+        QFormLayout *layout = new QFormLayout(m_pToneMappingDialog);
+        layout->addRow(tr("Gamma"), m_pDisplayGammaSlider);
+        layout->addRow(tr("Contrast"), m_pDisplayContrastSlider);
+        layout->addRow(tr("Brightness"), m_pDisplayBrightnessSlider);
+        layout->addRow(resetButton);
+
+        connect(m_pDisplayGammaSlider, SIGNAL(valueChanged(int)), this, SLOT(OnToneMappingChanged()));
+        connect(m_pDisplayContrastSlider, SIGNAL(valueChanged(int)), this, SLOT(OnToneMappingChanged()));
+        connect(m_pDisplayBrightnessSlider, SIGNAL(valueChanged(int)), this, SLOT(OnToneMappingChanged()));
+        connect(resetButton, SIGNAL(clicked()), this, SLOT(OnToneMappingReset()));
+    }
+
+    m_pToneMappingDialog->show();
+    m_pToneMappingDialog->raise();
+}
+
+// The event handler for changes of the display tone curve
+void V4L2Viewer::OnToneMappingChanged()
+{
+    tonemapping::Parameters toneMapping;
+    toneMapping.gamma = m_pDisplayGammaSlider->value() / 100.0;
+    toneMapping.contrast = m_pDisplayContrastSlider->value();
+    toneMapping.brightness = m_pDisplayBrightnessSlider->value();
+
+    m_Camera.SetToneMapping(toneMapping);
+    ui.m_ImageView->SetToneMapping(toneMapping);
+}
+
+// The event handler to restore the neutral display tone curve
+void V4L2Viewer::OnToneMappingReset()
+{
+    m_pDisplayGammaSlider->setValue(100);
+    m_pDisplayContrastSlider->setValue(0);
+    m_pDisplayBrightnessSlider->setValue(0);
+}
+
+// The event handler to change the rate limit of the control writer
+void V4L2Viewer::OnControlWriteRateChanged(QAction *action)
+{
+    m_Camera.SetControlWriteRate(action->data().toUInt());
+}
+
+// The event handler to compare the control read paths
+void V4L2Viewer::OnCompareControlReadTimes()
+{
+    if (!m_bIsOpen)
+    {
+        CustomDialog::Warning(this, tr("Video4Linux"), tr("Open a camera to compare the control read times."));
+        return;
+    }
+
+    double singleTimeMs = 0;
+    double transactionTimeMs = 0;
+    uint32_t controlCount = 0;
+    int result = m_Camera.CompareControlReadTimes(singleTimeMs, transactionTimeMs, controlCount);
+
+    QString text = tr("%1 controls\nOne by one: %2 ms\nAs transaction: %3 ms")
+                   .arg(controlCount).arg(singleTimeMs, 0, 'f', 3).arg(transactionTimeMs, 0, 'f', 3);
+    if (0 != result)
+    {
+        text += tr("\nSome controls could not be read in the transaction, see the log.");
+    }
+
+    CustomDialog::Info(this, tr("Video4Linux"), text);
+}
+
 // The event handler for resize the image
 void V4L2Viewer::OnZoomInButtonClicked()
 {
@@ -1361,7 +1732,7 @@ void V4L2Viewer::UpdateZoomButtons()
     ui.m_ZoomFitButton->setEnabled(m_bIsOpen);
     ui.m_ZoomLabel->setEnabled(m_bIsOpen);
 
-    if (ui.m_ImageView->GetScaleFactorValue() >= CustomGraphicsView::MAX_ZOOM_IN)
+    if (ui.m_ImageView->GetScaleFactorValue() >= VideoSurfaceWidget::MAX_ZOOM_IN)
     {
         ui.m_ZoomInButton->setEnabled(false);
     }
@@ -1370,7 +1741,7 @@ void V4L2Viewer::UpdateZoomButtons()
         ui.m_ZoomInButton->setEnabled(m_bIsOpen);
     }
 
-    if (ui.m_ImageView->GetScaleFactorValue() <= CustomGraphicsView::MAX_ZOOM_OUT)
+    if (ui.m_ImageView->GetScaleFactorValue() <= VideoSurfaceWidget::MAX_ZOOM_OUT)
     {
         ui.m_ZoomOutButton->setEnabled(false);
     }
@@ -1415,7 +1786,33 @@ void V4L2Viewer::OnUpdateFramesReceived()
 {
     auto const fpsReceived = m_Camera.GetReceivedFPS();
     auto const fpsRendered = m_Camera.GetRenderedFPS();
+
+    uint32_t bufferCount = 0;
+    if (m_bIsStreaming && m_pAdaptiveBufferCountAction->isChecked())
+        m_Camera.AdaptBufferCount(bufferCount);
+
     ui.m_FramesPerSecondLabel->setText(QString::asprintf("%.2f received/ %.2f rendered", fpsReceived, fpsRendered));
+    QString toolTip = QString::asprintf("paint time: %.2f ms avg/ %.2f ms max\n"
+                                        "capture time: %.3f ms avg/ %.3f ms max",
+                                        ui.m_ImageView->GetAveragePaintTime(),
+                                        ui.m_ImageView->GetMaximumPaintTime(),
+                                        m_Camera.GetAverageCaptureTime(),
+                                        m_Camera.GetMaximumCaptureTime());
+    if (0 != bufferCount)
+        toolTip += QString::asprintf("\nbuffers: %u (adaptive)", bufferCount);
+    double timeToFirstFrame = m_Camera.GetTimeToFirstFrame();
+    if (0.0 <= timeToFirstFrame)
+        toolTip += QString::asprintf("\ntime to first frame: %.1f ms", timeToFirstFrame);
+    base::DumpStatistics dumpStatistics;
+    if (m_pFrameDumpAction->isChecked() && Logger::GetDumpStatistics(dumpStatistics))
+        toolTip += QString::asprintf("\nraw frames: %llu written/ %llu dropped/ %llu failed, %u pending",
+                                     static_cast<unsigned long long>(dumpStatistics.writtenCount),
+                                     static_cast<unsigned long long>(dumpStatistics.droppedCount),
+                                     static_cast<unsigned long long>(dumpStatistics.failedCount),
+                                     dumpStatistics.pendingCount);
+    ui.m_FramesPerSecondLabel->setToolTip(toolTip);
+    ui.m_ImageView->ResetPaintTime();
+    m_Camera.ResetCaptureTime();
 }
 
 void V4L2Viewer::OnWidth()
@@ -1427,6 +1824,7 @@ void V4L2Viewer::OnHeight()
 {
     uint32_t width = 0;
     uint32_t height = 0;
+    bool bRestartStreaming = SuspendStreaming();
 
     LOG_EX("V4L2Viewer::OnHeight: setting frame size to width=%d, height=%d", ui.m_edWidth->text().toInt(), ui.m_edHeight->text().toInt());
 
@@ -1446,6 +1844,9 @@ void V4L2Viewer::OnHeight()
     ui.m_edHeight->setText(QString("%1").arg(height));
 
     LOG_EX("V4L2Viewer::OnHeight: read frame size back from camera as width=%d, height=%d", ui.m_edWidth->text().toInt(), ui.m_edHeight->text().toInt());
+
+    if (bRestartStreaming)
+        StartStreamingWithCurrentFormat();
 }
 
 void V4L2Viewer::OnGain()
@@ -1462,7 +1863,7 @@ void V4L2Viewer::OnGain()
     }
     else
     {
-        GetImageInformation();
+        OnReadAllValues();
     }
 }
 
@@ -1491,11 +1892,11 @@ void V4L2Viewer::OnExposure()
     if (m_Camera.SetExposure(nVal) < 0)
     {
 	CustomDialog::Error( this, tr("Video4Linux"), tr("FAILED TO SAVE Exposure!") );
-	GetImageInformation();
+	OnReadAllValues();
     }
     else
     {
-	GetImageInformation();
+	OnReadAllValues();
     }
 }
 
@@ -1522,6 +1923,7 @@ void V4L2Viewer::OnPixelFormatChanged(const QString &item)
     std::string tmp = item.toStdString();
     char *s = (char*)tmp.c_str();
     uint32_t result = 0;
+    bool bRestartStreaming = SuspendStreaming();
 
     if (tmp.size() == 4)
     {
@@ -1545,6 +1947,9 @@ void V4L2Viewer::OnPixelFormatChanged(const QString &item)
 	ui.m_frameSizes->blockSignals(false);
 
     GetImageInformation();
+
+    if (bRestartStreaming)
+        StartStreamingWithCurrentFormat();
 }
 
 void V4L2Viewer::OnGamma()
@@ -1561,7 +1966,7 @@ void V4L2Viewer::OnGamma()
     }
     else
     {
-        GetImageInformation();
+        OnReadAllValues();
     }
 }
 
@@ -1579,7 +1984,7 @@ void V4L2Viewer::OnBrightness()
     }
     else
     {
-        GetImageInformation();
+        OnReadAllValues();
     }
 }
 
@@ -1631,6 +2036,7 @@ void V4L2Viewer::OnCropXOffset()
     int32_t yOffset;
     uint32_t width;
     uint32_t height;
+    bool bRestartStreaming = SuspendStreaming();
 
     if (m_Camera.ReadCrop(xOffset, yOffset, width, height) == 0)
     {
@@ -1649,6 +2055,9 @@ void V4L2Viewer::OnCropXOffset()
             }
         }
     }
+
+    if (bRestartStreaming)
+        StartStreamingWithCurrentFormat();
 }
 
 void V4L2Viewer::OnCropYOffset()
@@ -1657,6 +2066,7 @@ void V4L2Viewer::OnCropYOffset()
     int32_t yOffset;
     uint32_t width;
     uint32_t height;
+    bool bRestartStreaming = SuspendStreaming();
 
     if (m_Camera.ReadCrop(xOffset, yOffset, width, height) == 0)
     {
@@ -1674,6 +2084,9 @@ void V4L2Viewer::OnCropYOffset()
             }
         }
     }
+
+    if (bRestartStreaming)
+        StartStreamingWithCurrentFormat();
 }
 
 void V4L2Viewer::OnCropWidth()
@@ -1682,6 +2095,7 @@ void V4L2Viewer::OnCropWidth()
     int32_t yOffset;
     uint32_t width;
     uint32_t height;
+    bool bRestartStreaming = SuspendStreaming();
 
     if (m_Camera.ReadCrop(xOffset, yOffset, width, height) == 0)
     {
@@ -1701,6 +2115,9 @@ void V4L2Viewer::OnCropWidth()
     }
 
     OnReadAllValues();
+
+    if (bRestartStreaming)
+        StartStreamingWithCurrentFormat();
 }
 
 void V4L2Viewer::OnCropHeight()
@@ -1709,6 +2126,7 @@ void V4L2Viewer::OnCropHeight()
     int32_t yOffset;
     uint32_t width;
     uint32_t height;
+    bool bRestartStreaming = SuspendStreaming();
     if (m_Camera.ReadCrop(xOffset, yOffset, width, height) == 0)
     {
         m_bIsImageFitByFirstImage = false;
@@ -1727,17 +2145,48 @@ void V4L2Viewer::OnCropHeight()
     }
 
     OnReadAllValues();
+
+    if (bRestartStreaming)
+        StartStreamingWithCurrentFormat();
 }
 
 void V4L2Viewer::OnReadAllValues()
 {
-    GetImageInformation();
+    // while streaming the values are read on the enumeration thread and only the changes come back
+    if (m_bIsStreaming)
+        m_Camera.RequestControlValues();
+    else
+        GetImageInformation();
 }
 
 /////////////////////// Tools /////////////////////////////////////
 
 void V4L2Viewer::GetImageInformation(const bool isCalledFromOnOpen)
 {
+    m_Camera.PrepareFrameRate();
+    m_Camera.PrepareCrop();
+
+    // the controls are described on the enumeration thread, the panel is
+    // filled by OnControlsDescribed once they are known
+    m_bIsDescribedFromOpen = m_bIsDescribedFromOpen || isCalledFromOnOpen;
+    m_Camera.RequestControlDescriptions();
+}
+
+void V4L2Viewer::OnControlsDescribed(int32_t controlCount)
+{
+    if (!m_bIsOpen)
+    {
+        return;
+    }
+
+    bool isCalledFromOnOpen = m_bIsDescribedFromOpen;
+    m_bIsDescribedFromOpen = false;
+
+    if (isCalledFromOnOpen && m_OpenTimer.isValid())
+    {
+        LOG_EX("V4L2Viewer::OnControlsDescribed %d controls described %lld ms after opening", controlCount, static_cast<long long>(m_OpenTimer.elapsed()));
+    }
+
     uint32_t width = 0;
     uint32_t height = 0;
     int32_t xOffset = 0;
@@ -1759,10 +2208,6 @@ void V4L2Viewer::GetImageInformation(const bool isCalledFromOnOpen)
     QString pixelFormatText;
     uint32_t bytesPerLine = 0;
 
-    m_Camera.EnumAllControlNewStyle();
-    m_Camera.PrepareFrameRate();
-    m_Camera.PrepareCrop();
-
     if(isCalledFromOnOpen)
     {
         SetDefaultLabels();
@@ -1855,13 +2300,13 @@ void V4L2Viewer::GetImageInformation(const bool isCalledFromOnOpen)
 
     if (m_Camera.ReadExposure(exposure) != -2)
     {
-        LOG_EX("V4L2Viewer::GetImageInformation: exposure controllable, exposure: %d", exposure);
+        LOG_EX("V4L2Viewer::OnControlsDescribed: exposure controllable, exposure: %d", exposure);
         ui.m_edExposure->setEnabled(true);
         ui.m_labelExposure->setEnabled(true);
     }
     else
     {
-        LOG_EX("V4L2Viewer::GetImageInformation: exposure not controllable");
+        LOG_EX("V4L2Viewer::OnControlsDescribed: exposure not controllable");
         ui.m_edExposure->setEnabled(false);
         ui.m_labelExposure->setEnabled(false);
     }
@@ -1878,7 +2323,7 @@ void V4L2Viewer::GetImageInformation(const bool isCalledFromOnOpen)
                 ui.m_labelExposure->setText(ui.m_labelExposure->text() + " (" + QString(deviceChar.c_str()) + ")");
             }
         }
-        LOG_EX("V4L2Viewer::GetImageInformation: setting text to exposure");
+        LOG_EX("V4L2Viewer::OnControlsDescribed: setting text to exposure");
         ui.m_edExposure->setText(QString("%1").arg(exposure));
         m_MinimumExposure = minExp;
         m_MaximumExposure = maxExp;
@@ -1934,7 +2379,7 @@ void V4L2Viewer::GetImageInformation(const bool isCalledFromOnOpen)
 
     if(m_Camera.ReadFrameSize(width, height) == 0)
     {
-        LOG_EX("V4L2Viewer::GetImageInformation: width=%d, height=%d", width, height);
+        LOG_EX("V4L2Viewer::OnControlsDescribed: width=%d, height=%d", width, height);
         ui.m_edWidth->setEnabled(true);
         ui.m_edHeight->setEnabled(true);
         ui.m_edWidth->setText(QString("%1").arg(width));
@@ -2017,6 +2462,9 @@ void V4L2Viewer::GetImageInformation(const bool isCalledFromOnOpen)
 
     ui.m_sliderExposure->setDisabled(autoexposure && ui.m_sliderExposure->isEnabled());
     ui.m_sliderGain->setDisabled(autogain && ui.m_sliderGain->isEnabled());
+
+    // the reads above route through the maps of the enumeration, they are complete now
+    m_Camera.RequestControlValues();
 }
 
 void V4L2Viewer::UpdateCameraFormat()
@@ -2144,7 +2592,12 @@ void V4L2Viewer::SetTitleText()
 
 void V4L2Viewer::OnFrameSizeIndexChanged(int index)
 {
+    bool bRestartStreaming = SuspendStreaming();
+
 	m_Camera.SetFrameSizeByIndex(index);
 
 	GetImageInformation();
+
+    if (bRestartStreaming)
+        StartStreamingWithCurrentFormat();
 }
@@ -0,0 +1,446 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+#include "VideoSurfaceWidget.h"
+#include "ImageTransform.h"
+#include <QElapsedTimer>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QScrollBar>
+#include <QToolTip>
+#include <QWheelEvent>
+
+#include <algorithm>
+#include <cmath>
+
+double VideoSurfaceWidget::MAX_ZOOM_IN = 16.0;
+double VideoSurfaceWidget::MAX_ZOOM_OUT = 1/8.0;
+double VideoSurfaceWidget::ZOOM_INCREMENT = 2.0;
+
+// 16 bit values the window/level moves per pixel of right button dragging
+#define WINDOW_LEVEL_STEP 128
+
+VideoSurfaceWidget::VideoSurfaceWidget(QWidget *parent): QAbstractScrollArea(parent)
+  , m_bDisplayImageDirty(false)
+  , m_bAutoWindowLevel(true)
+  , m_WindowLow(0)
+  , m_WindowHigh(0xFFFF)
+  , m_ToneMapping(tonemapping::GetDefaultParameters())
+  , m_bIsWindowing(false)
+  , m_dScaleFactor(1.0)
+  , m_bIsZoomAllowed(false)
+  , m_bIsPanning(false)
+  , m_dPaintTimeSum(0.0)
+  , m_dPaintTimeMax(0.0)
+  , m_PaintCount(0)
+{
+    // The whole damaged area is painted in paintEvent, so Qt does not need
+    // to erase the viewport before
+    viewport()->setAttribute(Qt::WA_OpaquePaintEvent);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+}
+
+void VideoSurfaceWidget::SetImage(const QImage &image)
+{
+    SetImage(image, QImage());
+}
+
+void VideoSurfaceWidget::SetImage(const QImage &image, const QImage &displayImage)
+{
+    bool bGeometryChanged = (image.size() != m_Image.size());
+
+    m_Image = image;
+    m_DisplayImage = displayImage;
+    // without a display image it is mapped here before the next paint
+    m_bDisplayImageDirty = displayImage.isNull();
+
+    if (bGeometryChanged)
+    {
+        UpdateScrollBars();
+        viewport()->update();
+    }
+    else
+    {
+        // Only the visible image area has changed, the background stays as it is
+        viewport()->update(GetImageRect() & viewport()->rect());
+    }
+}
+
+QImage VideoSurfaceWidget::GetImage() const
+{
+    return m_Image;
+}
+
+void VideoSurfaceWidget::SetAutoWindowLevel(bool state)
+{
+    if (state == m_bAutoWindowLevel)
+        return;
+
+    m_bAutoWindowLevel = state;
+    if (!m_Image.isNull())
+        SetImage(m_Image);
+
+    emit AutoWindowLevelChanged(state);
+    emit WindowLevelChanged(m_bAutoWindowLevel, m_WindowLow, m_WindowHigh);
+}
+
+void VideoSurfaceWidget::SetWindowLevel(uint16_t low, uint16_t high)
+{
+    m_WindowLow = low;
+    m_WindowHigh = std::max(high, static_cast<uint16_t>(low + 1));
+    m_WindowLevelTable.clear();
+    m_bDisplayImageDirty = true;
+    viewport()->update();
+
+    emit WindowLevelChanged(m_bAutoWindowLevel, m_WindowLow, m_WindowHigh);
+}
+
+void VideoSurfaceWidget::UpdateAutoWindowLevel()
+{
+    uint16_t low = 0;
+    uint16_t high = 0xFFFF;
+    if (0 == ImageTransform::GetImageRange(m_Image, low, high) &&
+        (low != m_WindowLow || high != m_WindowHigh))
+    {
+        m_WindowLow = low;
+        m_WindowHigh = high;
+        m_WindowLevelTable.clear();
+    }
+}
+
+void VideoSurfaceWidget::SetToneMapping(const tonemapping::Parameters &toneMapping)
+{
+    if (tonemapping::IsEqual(toneMapping, m_ToneMapping))
+        return;
+
+    m_ToneMapping = toneMapping;
+    m_WindowLevelTable.clear();
+    m_bDisplayImageDirty = true;
+    viewport()->update();
+}
+
+void VideoSurfaceWidget::UpdateDisplayImage()
+{
+    if (!m_bDisplayImageDirty)
+        return;
+
+    m_bDisplayImageDirty = false;
+
+    if (!ImageTransform::IsHighBitDepth(m_Image))
+    {
+        m_DisplayImage = m_Image;
+        return;
+    }
+
+    if (m_bAutoWindowLevel)
+        UpdateAutoWindowLevel();
+
+    if (m_WindowLevelTable.empty())
+        ImageTransform::CreateWindowLevelTable(m_WindowLow, m_WindowHigh, m_ToneMapping, m_WindowLevelTable);
+
+    // a display image of the processing thread is never written
+    m_DisplayImage = QImage();
+    ImageTransform::ApplyWindowLevel(m_Image, m_WindowLevelTable, m_DisplayImage);
+}
+
+QRect VideoSurfaceWidget::GetImageRect() const
+{
+    int scaledWidth = static_cast<int>(std::lround(m_Image.width() * m_dScaleFactor));
+    int scaledHeight = static_cast<int>(std::lround(m_Image.height() * m_dScaleFactor));
+    int viewWidth = viewport()->width();
+    int viewHeight = viewport()->height();
+
+    // Center the image while it is smaller than the view, otherwise follow the scroll bars
+    int x = (scaledWidth < viewWidth) ? (viewWidth - scaledWidth) / 2 : -horizontalScrollBar()->value();
+    int y = (scaledHeight < viewHeight) ? (viewHeight - scaledHeight) / 2 : -verticalScrollBar()->value();
+
+    return QRect(x, y, scaledWidth, scaledHeight);
+}
+
+QPointF VideoSurfaceWidget::MapToImage(const QPoint &position) const
+{
+    QRect imageRect = GetImageRect();
+    return QPointF((position.x() - imageRect.x()) / m_dScaleFactor,
+                   (position.y() - imageRect.y()) / m_dScaleFactor);
+}
+
+void VideoSurfaceWidget::UpdateScrollBars()
+{
+    QRect imageRect = GetImageRect();
+    int viewWidth = viewport()->width();
+    int viewHeight = viewport()->height();
+
+    horizontalScrollBar()->setPageStep(viewWidth);
+    horizontalScrollBar()->setSingleStep(std::max(1, viewWidth / 20));
+    horizontalScrollBar()->setRange(0, std::max(0, imageRect.width() - viewWidth));
+    verticalScrollBar()->setPageStep(viewHeight);
+    verticalScrollBar()->setSingleStep(std::max(1, viewHeight / 20));
+    verticalScrollBar()->setRange(0, std::max(0, imageRect.height() - viewHeight));
+}
+
+void VideoSurfaceWidget::paintEvent(QPaintEvent *event)
+{
+    QElapsedTimer paintTimer;
+    paintTimer.start();
+
+    QPainter painter(viewport());
+    QRect imageRect = GetImageRect();
+
+    // Background outside of the image
+    QRegion background = QRegion(event->rect()).subtracted(QRegion(imageRect));
+    const QBrush backgroundBrush = viewport()->palette().brush(viewport()->backgroundRole());
+#if QT_VERSION >= QT_VERSION_CHECK(5,8,0)
+    for (const QRect &rect : background)
+#else
+    for (const QRect &rect : background.rects())
+#endif
+    {
+        painter.fillRect(rect, backgroundBrush);
+    }
+
+    // Only the damaged part of the image is scaled and drawn
+    QRect damagedRect = event->rect() & imageRect;
+    if (!m_Image.isNull() && !damagedRect.isEmpty())
+    {
+        UpdateDisplayImage();
+
+        QRectF sourceRect((damagedRect.x() - imageRect.x()) / m_dScaleFactor,
+                          (damagedRect.y() - imageRect.y()) / m_dScaleFactor,
+                          damagedRect.width() / m_dScaleFactor,
+                          damagedRect.height() / m_dScaleFactor);
+        painter.drawImage(QRectF(damagedRect), m_DisplayImage, sourceRect);
+    }
+
+    painter.end();
+
+    double paintTime = paintTimer.nsecsElapsed() / 1000000.0;
+    m_dPaintTimeSum += paintTime;
+    m_dPaintTimeMax = std::max(m_dPaintTimeMax, paintTime);
+    m_PaintCount++;
+}
+
+void VideoSurfaceWidget::resizeEvent(QResizeEvent *event)
+{
+    QAbstractScrollArea::resizeEvent(event);
+    UpdateScrollBars();
+}
+
+void VideoSurfaceWidget::scrollContentsBy(int dx, int dy)
+{
+    Q_UNUSED(dx)
+    Q_UNUSED(dy)
+    viewport()->update();
+}
+
+void VideoSurfaceWidget::wheelEvent(QWheelEvent *event)
+{
+    if (m_bIsZoomAllowed)
+    {
+#if QT_VERSION >= QT_VERSION_CHECK(5,14,0)
+        QPoint point = event->position().toPoint();
+#else
+        QPoint point = event->pos();
+#endif
+        if (event->angleDelta().y() > 0)
+        {
+            if (m_dScaleFactor < MAX_ZOOM_IN)
+            {
+                ZoomAt(m_dScaleFactor * ZOOM_INCREMENT, point);
+            }
+        }
+        else
+        {
+            if (m_dScaleFactor > MAX_ZOOM_OUT)
+            {
+                ZoomAt(m_dScaleFactor / ZOOM_INCREMENT, point);
+            }
+        }
+    }
+}
+
+void VideoSurfaceWidget::mousePressEvent(QMouseEvent *event)
+{
+    if (m_Image.isNull())
+    {
+        return;
+    }
+
+    QPoint mousePos = event->pos();
+    QPointF imagePointF = MapToImage(mousePos);
+
+    if (imagePointF.x() < m_Image.width() && imagePointF.y() < m_Image.height() &&
+        imagePointF.x() >= 0 && imagePointF.y() >= 0)
+    {
+        int x = static_cast<int>(imagePointF.x());
+        int y = static_cast<int>(imagePointF.y());
+
+        if (ImageTransform::IsHighBitDepth(m_Image))
+        {
+            // the raw 16 bit values instead of the displayed ones
+            QRgba64 myPixel = m_Image.pixelColor(x, y).rgba64();
+
+            QToolTip::showText(viewport()->mapToGlobal(mousePos), QString("x:%1, y:%2, r:%3/g:%4/b:%5 (16 bit)")
+                               .arg(x).arg(y)
+                               .arg(myPixel.red())
+                               .arg(myPixel.green())
+                               .arg(myPixel.blue()), this);
+        }
+        else
+        {
+            QColor myPixel = m_Image.pixel(x, y);
+
+            QToolTip::showText(viewport()->mapToGlobal(mousePos), QString("x:%1, y:%2, r:%3/g:%4/b:%5")
+                               .arg(x).arg(y)
+                               .arg(myPixel.red())
+                               .arg(myPixel.green())
+                               .arg(myPixel.blue()), this);
+        }
+    }
+
+    if (event->button() == Qt::LeftButton)
+    {
+        m_bIsPanning = true;
+        m_LastPanPosition = mousePos;
+    }
+    else if (event->button() == Qt::RightButton && ImageTransform::IsHighBitDepth(m_Image))
+    {
+        // dragging starts from the window of the shown frame
+        if (m_bAutoWindowLevel)
+            UpdateAutoWindowLevel();
+
+        m_bIsWindowing = true;
+        m_LastWindowPosition = mousePos;
+    }
+}
+
+void VideoSurfaceWidget::mouseMoveEvent(QMouseEvent *event)
+{
+    if (m_bIsPanning)
+    {
+        QPoint delta = event->pos() - m_LastPanPosition;
+        m_LastPanPosition = event->pos();
+        horizontalScrollBar()->setValue(horizontalScrollBar()->value() - delta.x());
+        verticalScrollBar()->setValue(verticalScrollBar()->value() - delta.y());
+    }
+    else if (m_bIsWindowing)
+    {
+        // horizontal dragging changes the window width, vertical the level
+        QPoint delta = event->pos() - m_LastWindowPosition;
+        m_LastWindowPosition = event->pos();
+
+        int width = m_WindowHigh - m_WindowLow;
+        int center = (m_WindowHigh + m_WindowLow) / 2;
+        width = std::max(1, std::min(0xFFFF, width + delta.x() * WINDOW_LEVEL_STEP));
+        center = std::max(0, std::min(0xFFFF, center - delta.y() * WINDOW_LEVEL_STEP));
+
+        SetAutoWindowLevel(false);
+        SetWindowLevel(static_cast<uint16_t>(std::max(0, center - width / 2)),
+                       static_cast<uint16_t>(std::min(0xFFFF, center + (width + 1) / 2)));
+    }
+}
+
+void VideoSurfaceWidget::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+    {
+        m_bIsPanning = false;
+    }
+    else if (event->button() == Qt::RightButton)
+    {
+        m_bIsWindowing = false;
+    }
+}
+
+void VideoSurfaceWidget::ZoomAt(double scaleFactor, const QPoint &anchor)
+{
+    QPointF imagePoint = MapToImage(anchor);
+
+    m_dScaleFactor = scaleFactor;
+    UpdateScrollBars();
+
+    horizontalScrollBar()->setValue(static_cast<int>(std::lround(imagePoint.x() * m_dScaleFactor)) - anchor.x());
+    verticalScrollBar()->setValue(static_cast<int>(std::lround(imagePoint.y() * m_dScaleFactor)) - anchor.y());
+
+    viewport()->update();
+    emit UpdateZoomLabel();
+}
+
+void VideoSurfaceWidget::SetScaleFactorToDefault()
+{
+    m_dScaleFactor = 1.0;
+    UpdateScrollBars();
+    viewport()->update();
+}
+
+double VideoSurfaceWidget::GetScaleFactorValue()
+{
+    return m_dScaleFactor;
+}
+
+double VideoSurfaceWidget::FitToView()
+{
+    if (!m_Image.isNull())
+    {
+        double scaleX = static_cast<double>(viewport()->width()) / m_Image.width();
+        double scaleY = static_cast<double>(viewport()->height()) / m_Image.height();
+        m_dScaleFactor = std::min(scaleX, scaleY);
+        UpdateScrollBars();
+        viewport()->update();
+    }
+
+    return m_dScaleFactor;
+}
+
+void VideoSurfaceWidget::OnZoomIn()
+{
+    if (m_dScaleFactor < MAX_ZOOM_IN)
+    {
+        ZoomAt(m_dScaleFactor * ZOOM_INCREMENT, viewport()->rect().center());
+    }
+}
+
+void VideoSurfaceWidget::OnZoomOut()
+{
+    if (m_dScaleFactor > MAX_ZOOM_OUT)
+    {
+        ZoomAt(m_dScaleFactor / ZOOM_INCREMENT, viewport()->rect().center());
+    }
+}
+
+void VideoSurfaceWidget::SetZoomAllowed(bool state)
+{
+    m_bIsZoomAllowed = state;
+}
+
+double VideoSurfaceWidget::GetAveragePaintTime()
+{
+    return (m_PaintCount > 0) ? (m_dPaintTimeSum / m_PaintCount) : 0.0;
+}
+
+double VideoSurfaceWidget::GetMaximumPaintTime()
+{
+    return m_dPaintTimeMax;
+}
+
+void VideoSurfaceWidget::ResetPaintTime()
+{
+    m_dPaintTimeSum = 0.0;
+    m_dPaintTimeMax = 0.0;
+    m_PaintCount = 0;
+}
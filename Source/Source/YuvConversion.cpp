@@ -0,0 +1,568 @@
+/* Allied Vision V4L2Viewer - Graphical Video4Linux Viewer Example
+   Copyright (C) 2021 Allied Vision Technologies GmbH
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License
+   as published by the Free Software Foundation; either version 2
+   of the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, write to the Free Software
+   Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.  */
+
+#include "YuvConversion.h"
+#include "ToneMapping.h"
+
+#include <linux/videodev2.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define YUV_USE_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define YUV_USE_NEON
+#endif
+
+// Largest per channel difference between the fixed point kernels and the
+// floating point reference which is accepted by ValidateKernels
+#define MAX_REFERENCE_DEVIATION 2
+
+namespace yuvconversion
+{
+
+static void GetMatrixWeights(ColorMatrix colorMatrix, double &kr, double &kb)
+{
+    if (ColorMatrixBT709 == colorMatrix)
+    {
+        kr = 0.2126;
+        kb = 0.0722;
+    }
+    else
+    {
+        kr = 0.299;
+        kb = 0.114;
+    }
+}
+
+static void GetRangeScales(ColorRange colorRange, double &yScale, double &cScale, double &yOffset)
+{
+    if (ColorRangeFull == colorRange)
+    {
+        yScale = 1.0;
+        cScale = 1.0;
+        yOffset = 0.0;
+    }
+    else
+    {
+        yScale = 255.0 / 219.0;
+        cScale = 255.0 / 224.0;
+        yOffset = 16.0;
+    }
+}
+
+int GetCoefficients(ColorMatrix colorMatrix, ColorRange colorRange, Coefficients &coefficients)
+{
+    if (ColorMatrixBT601 != colorMatrix && ColorMatrixBT709 != colorMatrix)
+        return -1;
+
+    if (ColorRangeLimited != colorRange && ColorRangeFull != colorRange)
+        return -1;
+
+    double kr, kb, yScale, cScale, yOffset;
+    GetMatrixWeights(colorMatrix, kr, kb);
+    GetRangeScales(colorRange, yScale, cScale, yOffset);
+    double kg = 1.0 - kr - kb;
+
+    coefficients.yGain = static_cast<uint16_t>(std::lround(yScale * 64.0 * 65536.0 / 257.0));
+    // the rounding constant of the final shift is folded into the bias
+    coefficients.yBias = static_cast<int16_t>(std::lround(yOffset * yScale * 64.0) - 32);
+    coefficients.rv = static_cast<int16_t>(std::lround(2.0 * (1.0 - kr) * cScale * 64.0));
+    coefficients.gu = static_cast<int16_t>(std::lround(2.0 * kb * (1.0 - kb) / kg * cScale * 64.0));
+    coefficients.gv = static_cast<int16_t>(std::lround(2.0 * kr * (1.0 - kr) / kg * cScale * 64.0));
+    coefficients.bu = static_cast<int16_t>(std::lround(2.0 * (1.0 - kb) * cScale * 64.0));
+
+    return 0;
+}
+
+ColorMatrix ResolveColorMatrix(uint32_t colorspace, uint32_t ycbcrEncoding)
+{
+    if (V4L2_YCBCR_ENC_DEFAULT == ycbcrEncoding)
+        ycbcrEncoding = V4L2_MAP_YCBCR_ENC_DEFAULT(colorspace);
+
+    if (V4L2_YCBCR_ENC_709 == ycbcrEncoding || V4L2_YCBCR_ENC_XV709 == ycbcrEncoding)
+        return ColorMatrixBT709;
+
+    return ColorMatrixBT601;
+}
+
+ColorRange ResolveColorRange(uint32_t colorspace, uint32_t quantization)
+{
+    // the default of YCbCr data only depends on the colorspace
+    if (V4L2_QUANTIZATION_DEFAULT == quantization)
+        quantization = (V4L2_COLORSPACE_JPEG == colorspace) ? V4L2_QUANTIZATION_FULL_RANGE : V4L2_QUANTIZATION_LIM_RANGE;
+
+    if (V4L2_QUANTIZATION_FULL_RANGE == quantization)
+        return ColorRangeFull;
+
+    return ColorRangeLimited;
+}
+
+static inline uint8_t Clamp8(int value)
+{
+    return static_cast<uint8_t>((value < 0) ? 0 : ((value > 255) ? 255 : value));
+}
+
+// Scalar version of the fixed point math, bit exact with the vector kernels.
+// The destination is one QImage::Format_RGB32 pixel (B, G, R, 0xFF in memory)
+static inline void ConvertPixel(const Coefficients &c, int y, int u, int v, uint8_t *dst)
+{
+    int yy = static_cast<int>((static_cast<uint32_t>(y * 257) * c.yGain) >> 16) - c.yBias;
+    int uu = u - 128;
+    int vv = v - 128;
+
+    dst[0] = Clamp8((yy + c.bu * uu) >> 6);
+    dst[1] = Clamp8((yy - c.gu * uu - c.gv * vv) >> 6);
+    dst[2] = Clamp8((yy + c.rv * vv) >> 6);
+    dst[3] = 0xFF;
+}
+
+#if defined(YUV_USE_SSE2)
+
+struct SimdCoefficients
+{
+    __m128i yGain;
+    __m128i yBias;
+    __m128i rv;
+    __m128i gu;
+    __m128i gv;
+    __m128i bu;
+    __m128i chromaOffset;
+    __m128i alpha;
+    __m128i zero;
+};
+
+static inline void LoadSimdCoefficients(const Coefficients &c, SimdCoefficients &k)
+{
+    k.yGain = _mm_set1_epi16(static_cast<short>(c.yGain));
+    k.yBias = _mm_set1_epi16(c.yBias);
+    k.rv = _mm_set1_epi16(c.rv);
+    k.gu = _mm_set1_epi16(c.gu);
+    k.gv = _mm_set1_epi16(c.gv);
+    k.bu = _mm_set1_epi16(c.bu);
+    k.chromaOffset = _mm_set1_epi16(128);
+    k.alpha = _mm_set1_epi8(static_cast<char>(0xFF));
+    k.zero = _mm_setzero_si128();
+}
+
+// Converts 8 pixels, y/u/v hold one 8 bit value per 16 bit lane
+static inline void ConvertAndStore8(const SimdCoefficients &k, __m128i y, __m128i u, __m128i v, uint8_t *dst)
+{
+    __m128i y257 = _mm_or_si128(y, _mm_slli_epi16(y, 8));
+    __m128i yy = _mm_sub_epi16(_mm_mulhi_epu16(y257, k.yGain), k.yBias);
+    __m128i uu = _mm_sub_epi16(u, k.chromaOffset);
+    __m128i vv = _mm_sub_epi16(v, k.chromaOffset);
+
+    __m128i b = _mm_srai_epi16(_mm_adds_epi16(yy, _mm_mullo_epi16(uu, k.bu)), 6);
+    __m128i g = _mm_srai_epi16(_mm_subs_epi16(_mm_subs_epi16(yy, _mm_mullo_epi16(uu, k.gu)),
+                                              _mm_mullo_epi16(vv, k.gv)), 6);
+    __m128i r = _mm_srai_epi16(_mm_adds_epi16(yy, _mm_mullo_epi16(vv, k.rv)), 6);
+
+    __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+    __m128i ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), k.alpha);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 16), _mm_unpackhi_epi16(bg, ra));
+}
+
+#elif defined(YUV_USE_NEON)
+
+// Converts 8 pixels and returns the 8 bit channels
+static inline void Convert8(const Coefficients &c, uint8x8_t y8, uint8x8_t u8, uint8x8_t v8,
+                            uint8x8_t &b, uint8x8_t &g, uint8x8_t &r)
+{
+    uint16x8_t y257 = vmulq_n_u16(vmovl_u8(y8), 257);
+    uint32x4_t yLow = vmull_n_u16(vget_low_u16(y257), c.yGain);
+    uint32x4_t yHigh = vmull_n_u16(vget_high_u16(y257), c.yGain);
+    int16x8_t yy = vsubq_s16(vreinterpretq_s16_u16(vcombine_u16(vshrn_n_u32(yLow, 16), vshrn_n_u32(yHigh, 16))),
+                             vdupq_n_s16(c.yBias));
+    int16x8_t uu = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(u8)), vdupq_n_s16(128));
+    int16x8_t vv = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(v8)), vdupq_n_s16(128));
+
+    b = vqmovun_s16(vshrq_n_s16(vqaddq_s16(yy, vmulq_n_s16(uu, c.bu)), 6));
+    g = vqmovun_s16(vshrq_n_s16(vqsubq_s16(vqsubq_s16(yy, vmulq_n_s16(uu, c.gu)), vmulq_n_s16(vv, c.gv)), 6));
+    r = vqmovun_s16(vshrq_n_s16(vqaddq_s16(yy, vmulq_n_s16(vv, c.rv)), 6));
+}
+
+static inline void Store8(uint8x8_t b, uint8x8_t g, uint8x8_t r, uint8_t *dst)
+{
+    uint8x8x4_t bgra;
+    bgra.val[0] = b;
+    bgra.val[1] = g;
+    bgra.val[2] = r;
+    bgra.val[3] = vdup_n_u8(0xFF);
+    vst4_u8(dst, bgra);
+}
+
+#endif
+
+// Packed 4:2:2 line. lumaFirst selects YUYV/YVYU against UYVY/VYUY,
+// uFirst selects which chroma sample comes first within a pixel pair
+template <bool lumaFirst, bool uFirst>
+static void ConvertPackedLine(const Coefficients &c, const uint8_t *src, uint8_t *dst, uint32_t width)
+{
+    uint32_t x = 0;
+
+#if defined(YUV_USE_SSE2)
+    SimdCoefficients k;
+    LoadSimdCoefficients(c, k);
+    const __m128i lowByteMask = _mm_set1_epi16(0x00FF);
+    const __m128i lowWordMask = _mm_set1_epi32(0x0000FFFF);
+
+    for (; x + 8 <= width; x += 8, src += 16, dst += 32)
+    {
+        __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        __m128i lowBytes = _mm_and_si128(packed, lowByteMask);
+        __m128i highBytes = _mm_srli_epi16(packed, 8);
+        __m128i y = lumaFirst ? lowBytes : highBytes;
+        __m128i chroma = lumaFirst ? highBytes : lowBytes;
+
+        // spread the first and second chroma sample of each pair to both pixels
+        __m128i first = _mm_and_si128(chroma, lowWordMask);
+        __m128i second = _mm_srli_epi32(chroma, 16);
+        first = _mm_or_si128(first, _mm_slli_epi32(first, 16));
+        second = _mm_or_si128(second, _mm_slli_epi32(second, 16));
+
+        ConvertAndStore8(k, y, uFirst ? first : second, uFirst ? second : first, dst);
+    }
+#elif defined(YUV_USE_NEON)
+    for (; x + 16 <= width; x += 16, src += 32, dst += 64)
+    {
+        uint8x8x4_t packed = vld4_u8(src);
+        uint8x8_t y0 = packed.val[lumaFirst ? 0 : 1];
+        uint8x8_t y1 = packed.val[lumaFirst ? 2 : 3];
+        uint8x8_t c0 = packed.val[lumaFirst ? 1 : 0];
+        uint8x8_t c1 = packed.val[lumaFirst ? 3 : 2];
+        uint8x8_t u = uFirst ? c0 : c1;
+        uint8x8_t v = uFirst ? c1 : c0;
+
+        uint8x8_t b0, g0, r0, b1, g1, r1;
+        Convert8(c, y0, u, v, b0, g0, r0);
+        Convert8(c, y1, u, v, b1, g1, r1);
+
+        // even and odd pixels back into line order
+        uint8x8x2_t b = vzip_u8(b0, b1);
+        uint8x8x2_t g = vzip_u8(g0, g1);
+        uint8x8x2_t r = vzip_u8(r0, r1);
+        Store8(b.val[0], g.val[0], r.val[0], dst);
+        Store8(b.val[1], g.val[1], r.val[1], dst + 32);
+    }
+#endif
+
+    for (; x + 1 < width; x += 2, src += 4, dst += 8)
+    {
+        int y0 = src[lumaFirst ? 0 : 1];
+        int y1 = src[lumaFirst ? 2 : 3];
+        int c0 = src[lumaFirst ? 1 : 0];
+        int c1 = src[lumaFirst ? 3 : 2];
+        int u = uFirst ? c0 : c1;
+        int v = uFirst ? c1 : c0;
+
+        ConvertPixel(c, y0, u, v, dst);
+        ConvertPixel(c, y1, u, v, dst + 4);
+    }
+}
+
+template <bool lumaFirst, bool uFirst>
+static void ConvertPacked(const Coefficients &c, const uint8_t *src, uint32_t srcStride,
+                          uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                          const uint8_t *toneTable)
+{
+    for (uint32_t line = 0; line < height; line++)
+    {
+        ConvertPackedLine<lumaFirst, uFirst>(c, src + line * srcStride, dst + line * dstStride, width);
+        if (NULL != toneTable)
+            tonemapping::ApplyTableToLine(toneTable, dst + line * dstStride, width, 4);
+    }
+}
+
+void ConvertYUYVToRGB32(const Coefficients &coefficients, const uint8_t *src, uint32_t srcStride,
+                        uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                        const uint8_t *toneTable)
+{
+    ConvertPacked<true, true>(coefficients, src, srcStride, dst, dstStride, width, height, toneTable);
+}
+
+void ConvertYVYUToRGB32(const Coefficients &coefficients, const uint8_t *src, uint32_t srcStride,
+                        uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                        const uint8_t *toneTable)
+{
+    ConvertPacked<true, false>(coefficients, src, srcStride, dst, dstStride, width, height, toneTable);
+}
+
+void ConvertUYVYToRGB32(const Coefficients &coefficients, const uint8_t *src, uint32_t srcStride,
+                        uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                        const uint8_t *toneTable)
+{
+    ConvertPacked<false, true>(coefficients, src, srcStride, dst, dstStride, width, height, toneTable);
+}
+
+void ConvertVYUYToRGB32(const Coefficients &coefficients, const uint8_t *src, uint32_t srcStride,
+                        uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                        const uint8_t *toneTable)
+{
+    ConvertPacked<false, false>(coefficients, src, srcStride, dst, dstStride, width, height, toneTable);
+}
+
+// Planar line, every chroma sample is used for two horizontal pixels
+static void ConvertPlanarLine(const Coefficients &c, const uint8_t *srcY, const uint8_t *srcU,
+                              const uint8_t *srcV, uint8_t *dst, uint32_t width)
+{
+    uint32_t x = 0;
+
+#if defined(YUV_USE_SSE2)
+    SimdCoefficients k;
+    LoadSimdCoefficients(c, k);
+
+    for (; x + 8 <= width; x += 8)
+    {
+        int32_t u4, v4;
+        memcpy(&u4, srcU + x / 2, sizeof(u4));
+        memcpy(&v4, srcV + x / 2, sizeof(v4));
+
+        __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcY + x)), k.zero);
+        __m128i u = _mm_cvtsi32_si128(u4);
+        __m128i v = _mm_cvtsi32_si128(v4);
+        u = _mm_unpacklo_epi8(_mm_unpacklo_epi8(u, u), k.zero);
+        v = _mm_unpacklo_epi8(_mm_unpacklo_epi8(v, v), k.zero);
+
+        ConvertAndStore8(k, y, u, v, dst + x * 4);
+    }
+#elif defined(YUV_USE_NEON)
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16_t y = vld1q_u8(srcY + x);
+        uint8x8_t u8 = vld1_u8(srcU + x / 2);
+        uint8x8_t v8 = vld1_u8(srcV + x / 2);
+        uint8x8x2_t u = vzip_u8(u8, u8);
+        uint8x8x2_t v = vzip_u8(v8, v8);
+
+        uint8x8_t b, g, r;
+        Convert8(c, vget_low_u8(y), u.val[0], v.val[0], b, g, r);
+        Store8(b, g, r, dst + x * 4);
+        Convert8(c, vget_high_u8(y), u.val[1], v.val[1], b, g, r);
+        Store8(b, g, r, dst + x * 4 + 32);
+    }
+#endif
+
+    for (; x < width; x++)
+    {
+        ConvertPixel(c, srcY[x], srcU[x / 2], srcV[x / 2], dst + x * 4);
+    }
+}
+
+void ConvertPlanar420ToRGB32(const Coefficients &coefficients,
+                             const uint8_t *srcY, uint32_t strideY,
+                             const uint8_t *srcU, const uint8_t *srcV, uint32_t strideUV,
+                             uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                             const uint8_t *toneTable)
+{
+    for (uint32_t line = 0; line < height; line++)
+    {
+        ConvertPlanarLine(coefficients, srcY + line * strideY,
+                          srcU + (line / 2) * strideUV, srcV + (line / 2) * strideUV,
+                          dst + line * dstStride, width);
+        if (NULL != toneTable)
+            tonemapping::ApplyTableToLine(toneTable, dst + line * dstStride, width, 4);
+    }
+}
+
+// Semi-planar line, the chroma plane holds interleaved pairs for every two pixels
+template <bool uFirst>
+static void ConvertSemiPlanarLine(const Coefficients &c, const uint8_t *srcY, const uint8_t *srcUV,
+                                  uint8_t *dst, uint32_t width)
+{
+    uint32_t x = 0;
+
+#if defined(YUV_USE_SSE2)
+    SimdCoefficients k;
+    LoadSimdCoefficients(c, k);
+    const __m128i lowWordMask = _mm_set1_epi32(0x0000FFFF);
+
+    for (; x + 8 <= width; x += 8)
+    {
+        __m128i y = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcY + x)), k.zero);
+        __m128i chroma = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcUV + x)), k.zero);
+
+        __m128i first = _mm_and_si128(chroma, lowWordMask);
+        __m128i second = _mm_srli_epi32(chroma, 16);
+        first = _mm_or_si128(first, _mm_slli_epi32(first, 16));
+        second = _mm_or_si128(second, _mm_slli_epi32(second, 16));
+
+        ConvertAndStore8(k, y, uFirst ? first : second, uFirst ? second : first, dst + x * 4);
+    }
+#elif defined(YUV_USE_NEON)
+    for (; x + 16 <= width; x += 16)
+    {
+        uint8x16_t y = vld1q_u8(srcY + x);
+        uint8x8x2_t chroma = vld2_u8(srcUV + x);
+        uint8x8x2_t u = vzip_u8(chroma.val[uFirst ? 0 : 1], chroma.val[uFirst ? 0 : 1]);
+        uint8x8x2_t v = vzip_u8(chroma.val[uFirst ? 1 : 0], chroma.val[uFirst ? 1 : 0]);
+
+        uint8x8_t b, g, r;
+        Convert8(c, vget_low_u8(y), u.val[0], v.val[0], b, g, r);
+        Store8(b, g, r, dst + x * 4);
+        Convert8(c, vget_high_u8(y), u.val[1], v.val[1], b, g, r);
+        Store8(b, g, r, dst + x * 4 + 32);
+    }
+#endif
+
+    for (; x < width; x++)
+    {
+        const uint8_t *pair = srcUV + (x & ~1u);
+        ConvertPixel(c, srcY[x], pair[uFirst ? 0 : 1], pair[uFirst ? 1 : 0], dst + x * 4);
+    }
+}
+
+template <bool uFirst>
+static void ConvertSemiPlanar(const Coefficients &c, const uint8_t *srcY, uint32_t strideY,
+                              const uint8_t *srcUV, uint32_t strideUV, uint32_t chromaShift,
+                              uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                              const uint8_t *toneTable)
+{
+    for (uint32_t line = 0; line < height; line++)
+    {
+        ConvertSemiPlanarLine<uFirst>(c, srcY + line * strideY, srcUV + (line >> chromaShift) * strideUV,
+                                      dst + line * dstStride, width);
+        if (NULL != toneTable)
+            tonemapping::ApplyTableToLine(toneTable, dst + line * dstStride, width, 4);
+    }
+}
+
+void ConvertSemiPlanarToRGB32(const Coefficients &coefficients,
+                              const uint8_t *srcY, uint32_t strideY,
+                              const uint8_t *srcUV, uint32_t strideUV,
+                              bool crFirst, bool verticalSubsampling,
+                              uint8_t *dst, uint32_t dstStride, uint32_t width, uint32_t height,
+                              const uint8_t *toneTable)
+{
+    uint32_t chromaShift = verticalSubsampling ? 1 : 0;
+
+    if (crFirst)
+        ConvertSemiPlanar<false>(coefficients, srcY, strideY, srcUV, strideUV, chromaShift, dst, dstStride, width, height, toneTable);
+    else
+        ConvertSemiPlanar<true>(coefficients, srcY, strideY, srcUV, strideUV, chromaShift, dst, dstStride, width, height, toneTable);
+}
+
+void ReferenceConvertPixel(ColorMatrix colorMatrix, ColorRange colorRange,
+                           uint8_t y, uint8_t u, uint8_t v,
+                           uint8_t &r, uint8_t &g, uint8_t &b)
+{
+    double kr, kb, yScale, cScale, yOffset;
+    GetMatrixWeights(colorMatrix, kr, kb);
+    GetRangeScales(colorRange, yScale, cScale, yOffset);
+    double kg = 1.0 - kr - kb;
+
+    double yy = (y - yOffset) * yScale;
+    double cb = (u - 128.0) * cScale;
+    double cr = (v - 128.0) * cScale;
+
+    r = Clamp8(static_cast<int>(std::lround(yy + 2.0 * (1.0 - kr) * cr)));
+    g = Clamp8(static_cast<int>(std::lround(yy - 2.0 * kb * (1.0 - kb) / kg * cb - 2.0 * kr * (1.0 - kr) / kg * cr)));
+    b = Clamp8(static_cast<int>(std::lround(yy + 2.0 * (1.0 - kb) * cb)));
+}
+
+// Compares a converted luma ramp with constant chroma against the reference
+static void CompareWithReference(ColorMatrix colorMatrix, ColorRange colorRange, int u, int v,
+                                 const std::vector<uint8_t> &dst, uint32_t width, int &maxDeviation)
+{
+    for (uint32_t x = 0; x < width; x++)
+    {
+        uint8_t r, g, b;
+        ReferenceConvertPixel(colorMatrix, colorRange, static_cast<uint8_t>(x),
+                              static_cast<uint8_t>(u), static_cast<uint8_t>(v), r, g, b);
+
+        maxDeviation = std::max(maxDeviation, std::abs(dst[x * 4 + 0] - b));
+        maxDeviation = std::max(maxDeviation, std::abs(dst[x * 4 + 1] - g));
+        maxDeviation = std::max(maxDeviation, std::abs(dst[x * 4 + 2] - r));
+    }
+}
+
+int ValidateKernels(ColorMatrix colorMatrix, ColorRange colorRange, int &maxDeviation)
+{
+    const uint32_t width = 256;
+    const int chromaStep = 5;
+
+    Coefficients coefficients;
+    maxDeviation = 0;
+
+    if (0 != GetCoefficients(colorMatrix, colorRange, coefficients))
+        return -1;
+
+    // one line per chroma pair, the luma ramps over the whole range
+    std::vector<uint8_t> yuyv(width * 2);
+    std::vector<uint8_t> uyvy(width * 2);
+    std::vector<uint8_t> lumaPlane(width);
+    std::vector<uint8_t> chromaPlane(width);
+    std::vector<uint8_t> dst(width * 4);
+
+    for (uint32_t x = 0; x < width; x++)
+        lumaPlane[x] = static_cast<uint8_t>(x);
+
+    for (int u = 0; u <= 255; u += chromaStep)
+    {
+        for (int v = 0; v <= 255; v += chromaStep)
+        {
+            for (uint32_t x = 0; x < width; x += 2)
+            {
+                yuyv[x * 2 + 0] = static_cast<uint8_t>(x);
+                yuyv[x * 2 + 1] = static_cast<uint8_t>(u);
+                yuyv[x * 2 + 2] = static_cast<uint8_t>(x + 1);
+                yuyv[x * 2 + 3] = static_cast<uint8_t>(v);
+
+                uyvy[x * 2 + 0] = static_cast<uint8_t>(u);
+                uyvy[x * 2 + 1] = static_cast<uint8_t>(x);
+                uyvy[x * 2 + 2] = static_cast<uint8_t>(v);
+                uyvy[x * 2 + 3] = static_cast<uint8_t>(x + 1);
+
+                chromaPlane[x + 0] = static_cast<uint8_t>(u);
+                chromaPlane[x + 1] = static_cast<uint8_t>(v);
+            }
+
+            ConvertYUYVToRGB32(coefficients, yuyv.data(), width * 2, dst.data(), width * 4, width, 1);
+            CompareWithReference(colorMatrix, colorRange, u, v, dst, width, maxDeviation);
+
+            ConvertUYVYToRGB32(coefficients, uyvy.data(), width * 2, dst.data(), width * 4, width, 1);
+            CompareWithReference(colorMatrix, colorRange, u, v, dst, width, maxDeviation);
+
+            ConvertSemiPlanarToRGB32(coefficients, lumaPlane.data(), width, chromaPlane.data(), width,
+                                     false, true, dst.data(), width * 4, width, 1);
+            CompareWithReference(colorMatrix, colorRange, u, v, dst, width, maxDeviation);
+        }
+    }
+
+    return (maxDeviation <= MAX_REFERENCE_DEVIATION) ? 0 : -1;
+}
+
+const char *GetKernelName()
+{
+#if defined(YUV_USE_SSE2)
+    return "SSE2";
+#elif defined(YUV_USE_NEON)
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace yuvconversion
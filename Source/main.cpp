@@ -17,11 +17,13 @@
 
 
 #include "V4L2Viewer.h"
+#include "ThreadScheduling.h"
 #include <QDebug>
 
 int main( int argc, char *argv[] )
 {
     QApplication a( argc, argv );
+    threadscheduling::ParseCommandLine(argc, argv);
     Q_INIT_RESOURCE(V4L2Viewer);
     V4L2Viewer w;
     w.show();
@@ -23,13 +23,21 @@ set(GIT_REVISION_FILE ${CMAKE_CURRENT_BINARY_DIR}/GitRevision.h)
 
 list(APPEND HEADER_FILES
   ${HEADERS_PATH}/BaseLogger.h
+  ${HEADERS_PATH}/BinaryLog.h
+  ${HEADERS_PATH}/BufferArena.h
   ${HEADERS_PATH}/Camera.h
+  ${HEADERS_PATH}/CapabilityCache.h
   ${HEADERS_PATH}/CameraObserver.h
+  ${HEADERS_PATH}/ControlEnumerator.h
+  ${HEADERS_PATH}/ControlWriter.h
   ${HEADERS_PATH}/FrameObserver.h
   ${HEADERS_PATH}/FrameObserverMMAP.h
   ${HEADERS_PATH}/FrameObserverUSER.h
   ${HEADERS_PATH}/ImageProcessingThread.h
   ${HEADERS_PATH}/ImageTransform.h
+  ${HEADERS_PATH}/MjpegDecoder.h
+  ${HEADERS_PATH}/YuvConversion.h
+  ${HEADERS_PATH}/ToneMapping.h
   ${HEADERS_PATH}/IOHelper.h
   ${HEADERS_PATH}/LocalMutex.h
   ${HEADERS_PATH}/LocalMutexLockGuard.h
@@ -39,6 +47,7 @@ list(APPEND HEADER_FILES
   ${HEADERS_PATH}/MyFrameQueue.h
   ${HEADERS_PATH}/SelectSubDeviceDialog.h
   ${HEADERS_PATH}/Thread.h
+  ${HEADERS_PATH}/ThreadScheduling.h
   ${HEADERS_PATH}/V4L2Helper.h
   ${HEADERS_PATH}/V4L2Viewer.h
   ${HEADERS_PATH}/videodev2_av.h
@@ -54,7 +63,7 @@ list(APPEND HEADER_FILES
   ${HEADERS_PATH}/EnumeratorInterface/ButtonEnumerationControl.h
   ${HEADERS_PATH}/EnumeratorInterface/ListEnumerationControl.h
   ${HEADERS_PATH}/EnumeratorInterface/ListIntEnumerationControl.h
-  ${HEADERS_PATH}/CustomGraphicsView.h
+  ${HEADERS_PATH}/VideoSurfaceWidget.h
   ${HEADERS_PATH}/CustomDialog.h
   ${HEADERS_PATH}/V4L2EventHandler.h
   ${HEADERS_PATH}/FPSCalculator.h
@@ -62,19 +71,28 @@ list(APPEND HEADER_FILES
 
 list(APPEND SOURCE_FILES
   ${SOURCES_PATH}/BaseLogger.cpp
+  ${SOURCES_PATH}/BinaryLog.cpp
+  ${SOURCES_PATH}/BufferArena.cpp
   ${SOURCES_PATH}/Camera.cpp
+  ${SOURCES_PATH}/CapabilityCache.cpp
   ${SOURCES_PATH}/CameraObserver.cpp
+  ${SOURCES_PATH}/ControlEnumerator.cpp
+  ${SOURCES_PATH}/ControlWriter.cpp
   ${SOURCES_PATH}/FrameObserver.cpp
   ${SOURCES_PATH}/FrameObserverMMAP.cpp
   ${SOURCES_PATH}/FrameObserverUSER.cpp
   ${SOURCES_PATH}/ImageProcessingThread.cpp
   ${SOURCES_PATH}/ImageTransform.cpp
+  ${SOURCES_PATH}/MjpegDecoder.cpp
+  ${SOURCES_PATH}/YuvConversion.cpp
+  ${SOURCES_PATH}/ToneMapping.cpp
   ${SOURCES_PATH}/IOHelper.cpp
   ${SOURCES_PATH}/Logger.cpp
   ${SOURCES_PATH}/MyFrame.cpp
   ${SOURCES_PATH}/MyFrameQueue.cpp
   ${SOURCES_PATH}/SelectSubDeviceDialog.cpp
   ${SOURCES_PATH}/Thread.cpp
+  ${SOURCES_PATH}/ThreadScheduling.cpp
   ${SOURCES_PATH}/V4L2Helper.cpp
   ${SOURCES_PATH}/V4L2Viewer.cpp
   ${SOURCES_PATH}/AboutWidget.cpp
@@ -89,7 +107,7 @@ list(APPEND SOURCE_FILES
   ${SOURCES_PATH}/EnumeratorInterface/ButtonEnumerationControl.cpp
   ${SOURCES_PATH}/EnumeratorInterface/ListEnumerationControl.cpp
   ${SOURCES_PATH}/EnumeratorInterface/ListIntEnumerationControl.cpp
-  ${SOURCES_PATH}/CustomGraphicsView.cpp
+  ${SOURCES_PATH}/VideoSurfaceWidget.cpp
   ${SOURCES_PATH}/CustomDialog.cpp
   ${SOURCES_PATH}/V4L2EventHandler.cpp
   ${SOURCES_PATH}/FPSCalculator.cpp
@@ -154,6 +172,20 @@ list(APPEND RESOURCES
 add_library(V4L2ViewerLib STATIC ${SOURCE_FILES} ${HEADER_FILES} ${RESOURCES})
 
 target_link_libraries(V4L2ViewerLib PUBLIC ${QT_LIBRARIES})
+
+# LOG_EX compiles to nothing, for measurements without any logging cost
+option(V4L2VIEWER_DISABLE_LOGGING "Remove all LOG_EX messages at compile time" OFF)
+if(V4L2VIEWER_DISABLE_LOGGING)
+  target_compile_definitions(V4L2ViewerLib PUBLIC LOGGER_DISABLED)
+endif()
+
+# libjpeg(-turbo) decodes MJPEG directly, otherwise the Qt image plugin is used
+find_package(JPEG)
+if(JPEG_FOUND)
+  target_compile_definitions(V4L2ViewerLib PRIVATE HAVE_LIBJPEG)
+  target_include_directories(V4L2ViewerLib PRIVATE ${JPEG_INCLUDE_DIR})
+  target_link_libraries(V4L2ViewerLib PUBLIC ${JPEG_LIBRARIES})
+endif()
 target_include_directories(V4L2ViewerLib
   PUBLIC
     ${HEADERS_PATH}